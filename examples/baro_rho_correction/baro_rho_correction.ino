@@ -264,8 +264,10 @@ Variable* calcWaterPress = new Variable(
 // For this, we're using the conversion between mbar and mm pure water at 4°C
 // This calculation gives a final result in mm of water
 float calculateWaterDepthRaw(void) {
-    float waterDepth = calculateWaterPressure() * 10.1972;
-    if (calculateWaterPressure() == -9999) waterDepth = -9999;
+    // Read the (cached) calculated pressure rather than recalculating it
+    float waterPressure = calcWaterPress->getValue();
+    float waterDepth    = waterPressure * 10.1972;
+    if (waterPressure == -9999) waterDepth = -9999;
     // Serial.print(F("'Raw' water depth is "));  // for debugging
     // Serial.println(waterDepth);  // for debugging
     return waterDepth;
@@ -285,6 +287,8 @@ const char* waterDepthVarCode       = "CalcDepth";
 Variable* calcRawDepth = new Variable(
     calculateWaterDepthRaw, waterDepthVarResolution, waterDepthVarName,
     waterDepthVarUnit, waterDepthVarCode, waterDepthUUID);
+// List the variables the calculation reads so the pressure is calculated first
+Variable* rawDepthInputs[] = {calcWaterPress};
 /** End [calculated_uncorrected_depth] */
 
 /** Start [calculated_corrected_depth] */
@@ -294,7 +298,8 @@ float calculateWaterDepthTempCorrected(void) {
     const float gravitationalConstant =
         9.80665;  // m/s2, meters per second squared
     // First get water pressure in Pa for the calculation: 1 mbar = 100 Pa
-    float waterPressurePa  = 100 * calculateWaterPressure();
+    float waterPressure    = calcWaterPress->getValue();
+    float waterPressurePa  = 100 * waterPressure;
     float waterTempertureC = ms5803Temp->getValue();
     // Converting water depth for the changes of pressure with depth
     // Water density (kg/m3) from equation 6 from
@@ -307,7 +312,7 @@ float calculateWaterDepthTempCorrected(void) {
     // from P = rho * g * h
     float rhoDepth = 1000 * waterPressurePa /
         (waterDensity * gravitationalConstant);
-    if (calculateWaterPressure() == -9999 || waterTempertureC == -9999) {
+    if (waterPressure == -9999 || waterTempertureC == -9999) {
         rhoDepth = -9999;
     }
     // Serial.print(F("Temperature corrected water depth is "));  // for
@@ -329,6 +334,8 @@ const char* rhoDepthVarCode       = "DensityDepth";
 Variable* calcCorrDepth = new Variable(
     calculateWaterDepthTempCorrected, rhoDepthVarResolution, rhoDepthVarName,
     rhoDepthVarUnit, rhoDepthVarCode, rhoDepthUUID);
+// List the variables the calculation reads so the pressure is calculated first
+Variable* corrDepthInputs[] = {calcWaterPress, ms5803Temp};
 /** End [calculated_corrected_depth] */
 
 
@@ -449,6 +456,10 @@ void setup() {
     dataLogger.setLoggerPins(wakePin, sdCardSSPin, sdCardPwrPin, buttonPin,
                              greenLED);
 
+    // Tell the calculated depths which variables they are calculated from
+    calcRawDepth->setDependencies(rawDepthInputs, 1);
+    calcCorrDepth->setDependencies(corrDepthInputs, 2);
+
     // Begin the logger
     dataLogger.begin();
 
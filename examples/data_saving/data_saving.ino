@@ -588,7 +588,7 @@ void loop() {
                     if (Logger::markedEpochTime != 0 &&
                         Logger::markedEpochTime % 86400 == 0) {
                         Serial.println(F("Running a daily clock sync..."));
-                        loggerAllVars.setRTClock(modem.getNISTTime());
+                        loggerAllVars.setRTClock(modem.getUTCTime());
                     }
 
                     // Disconnect from the network
@@ -247,7 +247,7 @@ void setup() {
     // Connect to the network
     if (modem.connectInternet()) {
         // Synchronize the RTC
-        logger1min.setRTClock(modem.getNISTTime());
+        logger1min.setRTClock(modem.getUTCTime());
         modem.updateModemMetadata();
         // Disconnect from the network
         modem.disconnectInternet();
@@ -387,7 +387,7 @@ void loop() {
         // Connect to the network
         if (modem.connectInternet()) {
             // Synchronize the RTC
-            logger1min.setRTClock(modem.getNISTTime());
+            logger1min.setRTClock(modem.getUTCTime());
             // Disconnect from the network
             modem.disconnectInternet();
         }
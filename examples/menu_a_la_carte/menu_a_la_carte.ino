@@ -2262,7 +2262,7 @@ void loop() {
                 if (Logger::markedEpochTime != 0 &&
                     Logger::markedEpochTime % 86400 == 0) {
                     Serial.println(F("Running a daily clock sync..."));
-                    dataLogger.setRTClock(modem.getNISTTime());
+                    dataLogger.setRTClock(modem.getUTCTime());
                     dataLogger.watchDogTimer.resetWatchDog();
                     modem.updateModemMetadata();
                     dataLogger.watchDogTimer.resetWatchDog();
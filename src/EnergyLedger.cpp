@@ -0,0 +1,260 @@
+/**
+ * @file EnergyLedger.cpp
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Implements the EnergyLedger class.
+ */
+
+#include "EnergyLedger.h"
+
+// Initialize the static members
+energyCycleRecord EnergyLedger::_lastCycle = {0, 0, 0, 0, 0, 0, 0,
+                                              0, 0, 0, 0, 0, 0};
+
+
+// Constructor
+EnergyLedger::EnergyLedger() {
+    _awakeCurrent  = 0;
+    _idleCurrent   = 0;
+    _sleepCurrent  = 0;
+    _sdCardCurrent = 0;
+    _modemCurrent  = 0;
+    _sensorCount   = 0;
+    _cycleStart    = 0;
+    _totalSeconds  = 0;
+    clearCycleTimes();
+}
+// Destructor
+EnergyLedger::~EnergyLedger() {}
+
+
+void EnergyLedger::setProcessorCurrent(float awake_mA, float idle_mA,
+                                       float sleep_mA) {
+    _awakeCurrent = awake_mA;
+    _idleCurrent  = idle_mA;
+    _sleepCurrent = sleep_mA;
+}
+void EnergyLedger::setSDCardCurrent(float on_mA) {
+    _sdCardCurrent = on_mA;
+}
+void EnergyLedger::setModemCurrent(float on_mA) {
+    _modemCurrent = on_mA;
+}
+
+
+bool EnergyLedger::addSensor(Sensor* sensor, float powered_mA,
+                             float active_mA, float measuring_mA) {
+    sensorEntry* entry = findSensor(sensor);
+    if (entry == NULL) {
+        if (_sensorCount >= MS_ENERGY_LEDGER_MAX_SENSORS) {
+            MS_DBG(F("The energy ledger is full; not adding"),
+                   sensor->getSensorNameAndLocation());
+            return false;
+        }
+        entry         = &_sensors[_sensorCount++];
+        entry->sensor = sensor;
+        entry->charge = 0;
+        for (uint8_t s = 0; s < SENSOR_STATE_COUNT; s++) {
+            entry->stateMillis[s] = 0;
+        }
+    }
+    // A negative current is the same as the state the sensor was in before
+    if (active_mA < 0) active_mA = powered_mA;
+    if (measuring_mA < 0) measuring_mA = active_mA;
+    entry->current[SENSOR_STATE_POWERED]   = powered_mA;
+    entry->current[SENSOR_STATE_ACTIVE]    = active_mA;
+    entry->current[SENSOR_STATE_MEASURING] = measuring_mA;
+    return true;
+}
+
+
+void EnergyLedger::addAwakeTime(uint32_t awakeMillis) {
+    _awakeMillis += awakeMillis;
+}
+void EnergyLedger::addIdleTime(uint32_t idleMillis) {
+    _idleMillis += idleMillis;
+}
+void EnergyLedger::addSDCardTime(uint32_t onMillis) {
+    _sdCardMillis += onMillis;
+}
+void EnergyLedger::addModemTime(uint32_t onMillis) {
+    _modemMillis += onMillis;
+}
+void EnergyLedger::addSensorTime(Sensor* sensor, sensorEnergyState state,
+                                 uint32_t stateMillis) {
+    sensorEntry* entry = findSensor(sensor);
+    if (entry != NULL && state < SENSOR_STATE_COUNT) {
+        entry->stateMillis[state] += stateMillis;
+    }
+}
+
+
+bool EnergyLedger::closeCycle(uint32_t epochTime, bool sdCardAlwaysOn) {
+    uint32_t cycleSeconds = epochTime - _cycleStart;
+    // Nothing before the first cycle can be trusted, and a jump in the clock
+    // makes the time asleep unknown
+    if (_cycleStart == 0 || epochTime <= _cycleStart || cycleSeconds > 86400L) {
+        MS_DBG(F("Starting a new energy cycle at"), epochTime);
+        _cycleStart = epochTime;
+        clearCycleTimes();
+        return false;
+    }
+    uint32_t cycleMillis = cycleSeconds * 1000L;
+
+    // The processor
+    uint32_t awake  = min(_awakeMillis, cycleMillis);
+    uint32_t idle   = min(_idleMillis, awake);
+    float processor = charge(_awakeCurrent, awake - idle) +
+        charge(_idleCurrent, idle) + charge(_sleepCurrent, cycleMillis - awake);
+
+    // The SD card and the modem
+    uint32_t sdCard = sdCardAlwaysOn ? cycleMillis
+                                     : min(_sdCardMillis, cycleMillis);
+    uint32_t modem  = min(_modemMillis, cycleMillis);
+
+    // The sensors; each state's time is part of the time in the state before
+    float sensors = 0;
+    for (uint8_t i = 0; i < _sensorCount; i++) {
+        sensorEntry* entry     = &_sensors[i];
+        uint32_t     powered   = entry->stateMillis[SENSOR_STATE_POWERED];
+        uint32_t     active    = entry->stateMillis[SENSOR_STATE_ACTIVE];
+        uint32_t     measuring = entry->stateMillis[SENSOR_STATE_MEASURING];
+        // Power to the sensor isn't switched by this library; if it was not
+        // put to sleep either it stayed active while the logger slept
+        if (entry->sensor->getPowerPin() < 0) {
+            powered = cycleMillis;
+            if (entry->sensor->getMillisSensorActivated() != 0) {
+                active = cycleMillis;
+            }
+        }
+        active    = min(active, powered);
+        measuring = min(measuring, active);
+        entry->charge =
+            charge(entry->current[SENSOR_STATE_POWERED], powered - active) +
+            charge(entry->current[SENSOR_STATE_ACTIVE], active - measuring) +
+            charge(entry->current[SENSOR_STATE_MEASURING], measuring);
+        sensors += entry->charge;
+    }
+
+    _totalSeconds += cycleSeconds;
+    _lastCycle.cycleEnd        = epochTime;
+    _lastCycle.cycleSeconds    = cycleSeconds;
+    _lastCycle.awakeMillis     = awake;
+    _lastCycle.idleMillis      = idle;
+    _lastCycle.sdCardMillis    = sdCard;
+    _lastCycle.modemMillis     = modem;
+    _lastCycle.processorCharge = processor;
+    _lastCycle.sdCardCharge    = charge(_sdCardCurrent, sdCard);
+    _lastCycle.modemCharge     = charge(_modemCurrent, modem);
+    _lastCycle.sensorCharge    = sensors;
+    _lastCycle.cycleCharge     = processor + _lastCycle.sdCardCharge +
+        _lastCycle.modemCharge + sensors;
+    _lastCycle.totalCharge += _lastCycle.cycleCharge;
+    _lastCycle.dailyCharge = _lastCycle.totalCharge * 86400.0f /
+        static_cast<float>(_totalSeconds);
+    MS_DBG(F("The last"), cycleSeconds, F("s used"), _lastCycle.cycleCharge,
+           F("mAh"));
+
+    _cycleStart = epochTime;
+    clearCycleTimes();
+    return true;
+}
+
+
+const energyCycleRecord& EnergyLedger::getLastCycle(void) {
+    return _lastCycle;
+}
+float EnergyLedger::getSensorCharge(Sensor* sensor) {
+    sensorEntry* entry = findSensor(sensor);
+    if (entry == NULL) return -9999;
+    return entry->charge;
+}
+
+
+void EnergyLedger::printReport(Stream* stream) {
+    if (_lastCycle.cycleSeconds == 0) {
+        stream->println(F("No energy cycle has been completed yet."));
+        return;
+    }
+    stream->print(F("Used "));
+    stream->print(_lastCycle.cycleCharge, 3);
+    stream->print(F(" mAh in the last "));
+    stream->print(_lastCycle.cycleSeconds);
+    stream->print(F(" s; "));
+    stream->print(_lastCycle.dailyCharge, 1);
+    stream->print(F(" mAh per day on average and "));
+    stream->print(_lastCycle.totalCharge, 1);
+    stream->println(F(" mAh in total"));
+
+    stream->print(F("  Processor: "));
+    stream->print(_lastCycle.processorCharge, 3);
+    stream->print(F(" mAh (awake "));
+    stream->print(_lastCycle.awakeMillis / 1000.0f, 1);
+    stream->print(F(" s, of which idle "));
+    stream->print(_lastCycle.idleMillis / 1000.0f, 1);
+    stream->println(F(" s)"));
+    stream->print(F("  SD card: "));
+    stream->print(_lastCycle.sdCardCharge, 3);
+    stream->print(F(" mAh (on "));
+    stream->print(_lastCycle.sdCardMillis / 1000.0f, 1);
+    stream->println(F(" s)"));
+    stream->print(F("  Modem: "));
+    stream->print(_lastCycle.modemCharge, 3);
+    stream->print(F(" mAh (on "));
+    stream->print(_lastCycle.modemMillis / 1000.0f, 1);
+    stream->println(F(" s)"));
+    for (uint8_t i = 0; i < _sensorCount; i++) {
+        stream->print(F("  "));
+        stream->print(_sensors[i].sensor->getSensorNameAndLocation());
+        stream->print(F(": "));
+        stream->print(_sensors[i].charge, 3);
+        stream->println(F(" mAh"));
+    }
+}
+
+
+float EnergyLedger::getCycleCharge(void) {
+    if (_lastCycle.cycleSeconds == 0) return -9999;
+    return _lastCycle.cycleCharge;
+}
+float EnergyLedger::getDailyCharge(void) {
+    if (_lastCycle.cycleSeconds == 0) return -9999;
+    return _lastCycle.dailyCharge;
+}
+float EnergyLedger::getTotalCharge(void) {
+    if (_lastCycle.cycleSeconds == 0) return -9999;
+    return _lastCycle.totalCharge;
+}
+float EnergyLedger::getAwakeTime(void) {
+    if (_lastCycle.cycleSeconds == 0) return -9999;
+    return _lastCycle.awakeMillis / 1000.0f;
+}
+
+
+EnergyLedger::sensorEntry* EnergyLedger::findSensor(Sensor* sensor) {
+    for (uint8_t i = 0; i < _sensorCount; i++) {
+        if (_sensors[i].sensor == sensor) return &_sensors[i];
+    }
+    return NULL;
+}
+
+
+void EnergyLedger::clearCycleTimes(void) {
+    _awakeMillis  = 0;
+    _idleMillis   = 0;
+    _sdCardMillis = 0;
+    _modemMillis  = 0;
+    for (uint8_t i = 0; i < _sensorCount; i++) {
+        for (uint8_t s = 0; s < SENSOR_STATE_COUNT; s++) {
+            _sensors[i].stateMillis[s] = 0;
+        }
+    }
+}
+
+
+// mA * ms / (3600 s/h * 1000 ms/s) = mAh
+float EnergyLedger::charge(float current_mA, uint32_t onMillis) {
+    return current_mA * static_cast<float>(onMillis) / 3600000.0f;
+}
@@ -0,0 +1,523 @@
+/**
+ * @file EnergyLedger.h
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Contains the EnergyLedger class and the variable subclasses
+ * EnergyLedger_CycleCharge, EnergyLedger_DailyCharge,
+ * EnergyLedger_TotalCharge, and EnergyLedger_AwakeTime.
+ *
+ * @copydetails EnergyLedger
+ */
+
+// Header Guards
+#ifndef SRC_ENERGYLEDGER_H_
+#define SRC_ENERGYLEDGER_H_
+
+// Debugging Statement
+// #define MS_ENERGYLEDGER_DEBUG
+
+#ifdef MS_ENERGYLEDGER_DEBUG
+#define MS_DEBUGGING_STD "EnergyLedger"
+#endif
+
+// Included Dependencies
+#include "ModSensorDebugger.h"
+#undef MS_DEBUGGING_STD
+#include "VariableBase.h"
+#include "SensorBase.h"
+
+/**
+ * @brief The largest number of sensors whose on-time an EnergyLedger can
+ * keep.
+ *
+ * Each sensor costs 30 bytes of RAM.
+ */
+#ifndef MS_ENERGY_LEDGER_MAX_SENSORS
+#define MS_ENERGY_LEDGER_MAX_SENSORS 8
+#endif
+
+/// Decimals places in string representation; the charge used in a cycle
+/// should have 3.
+#define ENERGY_CYCLE_CHARGE_RESOLUTION 3
+/// Decimals places in string representation; the charge used per day should
+/// have 1.
+#define ENERGY_DAILY_CHARGE_RESOLUTION 1
+/// Decimals places in string representation; the total charge used should
+/// have 1.
+#define ENERGY_TOTAL_CHARGE_RESOLUTION 1
+/// Decimals places in string representation; the time awake should have 1.
+#define ENERGY_AWAKE_TIME_RESOLUTION 1
+
+/**
+ * @brief The states of a sensor that an EnergyLedger keeps the time of.
+ *
+ * The states nest:  a sensor is only active while it is powered and only
+ * measuring while it is active.
+ */
+typedef enum sensorEnergyState {
+    /// From Sensor::powerUp() to Sensor::powerDown().
+    SENSOR_STATE_POWERED = 0,
+    /// From Sensor::wake() to Sensor::sleep().
+    SENSOR_STATE_ACTIVE,
+    /// From Sensor::startSingleMeasurement() until the result is collected.
+    SENSOR_STATE_MEASURING,
+    /// The number of states; not a state itself.
+    SENSOR_STATE_COUNT
+} sensorEnergyState;
+
+/**
+ * @brief The summary of one logging cycle kept by an EnergyLedger.
+ *
+ * A cycle runs from the start of one logging interval to the start of the
+ * next, so it includes the time spent asleep.  All charges are in mAh.
+ */
+typedef struct energyCycleRecord {
+    /// The logger time (seconds since Jan 1, 1970) when the cycle ended.
+    uint32_t cycleEnd;
+    /// The length of the cycle in seconds.
+    uint32_t cycleSeconds;
+    /// The milliseconds the processor was awake.
+    uint32_t awakeMillis;
+    /// The milliseconds of the time awake the processor idled in waits.
+    uint32_t idleMillis;
+    /// The milliseconds the SD card was powered.
+    uint32_t sdCardMillis;
+    /// The milliseconds the modem was on.
+    uint32_t modemMillis;
+    /// The charge used by the processor and the rest of the board.
+    float processorCharge;
+    /// The charge used by the SD card.
+    float sdCardCharge;
+    /// The charge used by the modem.
+    float modemCharge;
+    /// The charge used by all of the sensors together.
+    float sensorCharge;
+    /// The charge used by everything in the cycle.
+    float cycleCharge;
+    /// The average charge used per day since the ledger started.
+    float dailyCharge;
+    /// The total charge used since the ledger started.
+    float totalCharge;
+} energyCycleRecord;
+
+
+/**
+ * @brief The energy ledger adds up how long each part of a logger is switched
+ * on and combines that with the current each part draws to estimate the
+ * charge taken from the battery.
+ *
+ * The ledger keeps the time the processor is awake (and, of that, how long it
+ * idles waiting on sensors or the modem), the time the SD card is powered, the
+ * time the modem is on, and for each sensor added the time it is powered,
+ * active, and measuring.  These come from the same time stamps the library
+ * already uses to schedule the sensors and the modem.  The currents are not
+ * measured; they are supplied by the program from data sheets or from a bench
+ * meter, so the result is only as good as those numbers.
+ *
+ * Attach the ledger to a logger with Logger::attachEnergyLedger().  At the
+ * start of each logging interval the logger closes the cycle before it and
+ * the charge it used is worked out:
+ * - the processor draws its awake current while awake, its idle current while
+ * idling in a wait, and its sleep current for the rest of the cycle.  The
+ * sleep current should cover everything on the board that is always on.
+ * - the SD card draws its current while its power is switched on.  If the
+ * logger has no SD card power pin, the card is counted as on for the whole
+ * cycle, so give its idle current instead.
+ * - the modem draws its current from the time it is woken until it is powered
+ * down.
+ * - each sensor draws its powered current while it warms up, its active
+ * current while it stabilizes and between measurements, and its measuring
+ * current while it measures.  A sensor without a power pin is counted as
+ * powered for the whole cycle, and as active for the whole cycle if its
+ * sleep() function leaves it awake.
+ *
+ * The summary of the last cycle is kept in an #energyCycleRecord and can be
+ * printed with printReport().  The charge for the cycle, the average per day,
+ * the total, and the time awake can also be logged or published like any
+ * other variable with the EnergyLedger_CycleCharge, EnergyLedger_DailyCharge,
+ * EnergyLedger_TotalCharge, and EnergyLedger_AwakeTime variables.  Because the
+ * cycle is closed before the sensors are updated, these always describe the
+ * interval before the one they are logged with.
+ *
+ * @note Only one ledger should be attached; the values for the variables are
+ * static so that the variables can call them.
+ */
+class EnergyLedger {
+ public:
+    /**
+     * @brief Construct a new EnergyLedger object with all currents zero.
+     */
+    EnergyLedger();
+    /**
+     * @brief Destroy the EnergyLedger object - no action taken.
+     */
+    ~EnergyLedger();
+
+    /**
+     * @brief Set the current drawn by the processor and the rest of the
+     * board.
+     *
+     * @param awake_mA The current while the processor is awake, in mA
+     * @param idle_mA The current while the processor idles in a wait for a
+     * sensor or the modem, in mA
+     * @param sleep_mA The current while the logger sleeps between intervals,
+     * in mA
+     */
+    void setProcessorCurrent(float awake_mA, float idle_mA, float sleep_mA);
+    /**
+     * @brief Set the current drawn by the SD card while it is powered.
+     *
+     * @param on_mA The current in mA
+     */
+    void setSDCardCurrent(float on_mA);
+    /**
+     * @brief Set the current drawn by the modem while it is on.
+     *
+     * @param on_mA The current in mA; this should be the average over a
+     * typical connection, including registration and sending
+     */
+    void setModemCurrent(float on_mA);
+    /**
+     * @brief Add a sensor to the ledger.
+     *
+     * Adding a sensor that is already in the ledger changes its currents.
+     *
+     * @param sensor The sensor to keep the time of
+     * @param powered_mA The current while the sensor is powered but not yet
+     * active, in mA
+     * @param active_mA The current while the sensor is active but not
+     * measuring, in mA; optional with a default value of -1, which uses the
+     * powered current
+     * @param measuring_mA The current while the sensor is measuring, in mA;
+     * optional with a default value of -1, which uses the active current
+     * @return **bool** True if the sensor was added; false if the ledger
+     * already has #MS_ENERGY_LEDGER_MAX_SENSORS sensors
+     */
+    bool addSensor(Sensor* sensor, float powered_mA, float active_mA = -1,
+                   float measuring_mA = -1);
+
+    /**
+     * @anchor energy_ledger_times
+     * @name Functions to add time to the current cycle
+     *
+     * These are called by the logger and the variable array; a program does
+     * not normally need them.
+     */
+    /**@{*/
+    /**
+     * @brief Add time the processor was awake.
+     *
+     * @param awakeMillis The milliseconds awake
+     */
+    void addAwakeTime(uint32_t awakeMillis);
+    /**
+     * @brief Add time the processor idled while waiting; this is part of the
+     * time awake, not in addition to it.
+     *
+     * @param idleMillis The milliseconds idling
+     */
+    void addIdleTime(uint32_t idleMillis);
+    /**
+     * @brief Add time the SD card was powered.
+     *
+     * @param onMillis The milliseconds powered
+     */
+    void addSDCardTime(uint32_t onMillis);
+    /**
+     * @brief Add time the modem was on.
+     *
+     * @param onMillis The milliseconds on
+     */
+    void addModemTime(uint32_t onMillis);
+    /**
+     * @brief Add time a sensor spent in one of its states.
+     *
+     * Sensors that were not added to the ledger are ignored.
+     *
+     * @param sensor The sensor
+     * @param state The state the time was spent in
+     * @param stateMillis The milliseconds in the state
+     */
+    void addSensorTime(Sensor* sensor, sensorEnergyState state,
+                       uint32_t stateMillis);
+    /**@}*/
+
+    /**
+     * @brief End the current cycle, work out the charge it used, and start a
+     * new one.
+     *
+     * The first call only starts the first cycle.  A cycle longer than a day
+     * or with the time running backwards (such as when the clock is first
+     * set) is dropped.
+     *
+     * @param epochTime The logger time (seconds since Jan 1, 1970) at the
+     * start of the new cycle
+     * @param sdCardAlwaysOn True if the SD card's power is not switched
+     * @return **bool** True if a cycle was added to the totals
+     */
+    bool closeCycle(uint32_t epochTime, bool sdCardAlwaysOn = false);
+
+    /**
+     * @brief Get the summary of the last cycle closed.
+     *
+     * @return **const energyCycleRecord&** The summary; all zero until a
+     * cycle has been closed
+     */
+    static const energyCycleRecord& getLastCycle(void);
+    /**
+     * @brief Get the charge a sensor used in the last cycle closed.
+     *
+     * @param sensor The sensor
+     * @return **float** The charge in mAh, or -9999 if the sensor is not in
+     * the ledger
+     */
+    float getSensorCharge(Sensor* sensor);
+
+    /**
+     * @brief Print the charge used in the last cycle by each part of the
+     * logger to a stream.
+     *
+     * @param stream An Arduino stream instance
+     */
+    void printReport(Stream* stream);
+
+    /**
+     * @anchor energy_ledger_static_functions
+     * @name Functions to return the values of the last cycle
+     *
+     * @note These must be static so that the ledger variables can call them.
+     */
+    /**@{*/
+    /**
+     * @brief Get the charge used in the last cycle.
+     *
+     * @return **float** The charge in mAh, or -9999 before the first cycle
+     */
+    static float getCycleCharge(void);
+    /**
+     * @brief Get the average charge used per day since the ledger started.
+     *
+     * @return **float** The charge in mAh per day, or -9999 before the first
+     * cycle
+     */
+    static float getDailyCharge(void);
+    /**
+     * @brief Get the total charge used since the ledger started.
+     *
+     * @return **float** The charge in mAh, or -9999 before the first cycle
+     */
+    static float getTotalCharge(void);
+    /**
+     * @brief Get the time the processor was awake in the last cycle.
+     *
+     * @return **float** The time in seconds, or -9999 before the first cycle
+     */
+    static float getAwakeTime(void);
+    /**@}*/
+
+ protected:
+    /**
+     * @brief The currents and the time in each state of one sensor.
+     */
+    typedef struct {
+        /// The sensor.
+        Sensor* sensor;
+        /// The current in each state, in mA.
+        float current[SENSOR_STATE_COUNT];
+        /// The milliseconds spent in each state in the current cycle.
+        uint32_t stateMillis[SENSOR_STATE_COUNT];
+        /// The charge used in the last cycle, in mAh.
+        float charge;
+    } sensorEntry;
+
+    /**
+     * @brief Find the entry for a sensor.
+     *
+     * @param sensor The sensor
+     * @return **sensorEntry\*** The entry, or NULL if the sensor is not in the
+     * ledger
+     */
+    sensorEntry* findSensor(Sensor* sensor);
+    /**
+     * @brief Clear the times of the current cycle.
+     */
+    void clearCycleTimes(void);
+    /**
+     * @brief Convert a current and a time to a charge.
+     *
+     * @param current_mA The current in mA
+     * @param onMillis The time in milliseconds
+     * @return **float** The charge in mAh
+     */
+    static float charge(float current_mA, uint32_t onMillis);
+
+    /**
+     * @brief The processor currents while awake, idling, and asleep, in mA.
+     */
+    float _awakeCurrent;
+    float _idleCurrent;    ///< @copydoc _awakeCurrent
+    float _sleepCurrent;   ///< @copydoc _awakeCurrent
+    float _sdCardCurrent;  ///< The SD card current while powered, in mA.
+    float _modemCurrent;   ///< The modem current while on, in mA.
+
+    /**
+     * @brief The sensors in the ledger.
+     */
+    sensorEntry _sensors[MS_ENERGY_LEDGER_MAX_SENSORS];
+    /**
+     * @brief The number of sensors in the ledger.
+     */
+    uint8_t _sensorCount;
+
+    /**
+     * @brief The logger time at the start of the current cycle, or 0 before
+     * the first one.
+     */
+    uint32_t _cycleStart;
+    /**
+     * @brief The milliseconds awake in the current cycle.
+     */
+    uint32_t _awakeMillis;
+    uint32_t _idleMillis;    ///< The milliseconds idling in the cycle.
+    uint32_t _sdCardMillis;  ///< The milliseconds the card was powered.
+    uint32_t _modemMillis;   ///< The milliseconds the modem was on.
+
+    /**
+     * @brief The seconds in all of the cycles added to the totals.
+     */
+    uint32_t _totalSeconds;
+
+    // NOTE:  This must be static so that the ledger variables can call the
+    // member functions that return its values.  (Non-static member functions
+    // cannot be called without an object.)
+    /**
+     * @brief The summary of the last cycle closed.
+     */
+    static energyCycleRecord _lastCycle;
+};
+
+
+/**
+ * @brief The Variable sub-class used for the charge a logger used in its last
+ * logging interval.
+ *
+ * The value is in milliampere hours and has a resolution of 0.001 mAh.
+ */
+class EnergyLedger_CycleCharge : public Variable {
+ public:
+    /**
+     * @brief Construct a new EnergyLedger_CycleCharge object.
+     *
+     * @param parentLedger The ledger providing the result values.
+     * @param uuid A universally unique identifier (UUID or GUID) for the
+     * variable; optional with the default value of an empty string.
+     * @param varCode A short code to help identify the variable in files;
+     * optional with a default value of "cycleCharge".
+     */
+    explicit EnergyLedger_CycleCharge(EnergyLedger* parentLedger,
+                                      const char*   uuid    = "",
+                                      const char*   varCode = "cycleCharge")
+        : Variable(&parentLedger->getCycleCharge,
+                   (uint8_t)ENERGY_CYCLE_CHARGE_RESOLUTION,
+                   &*"electricCharge", &*"milliampereHour", varCode, uuid) {}
+    /**
+     * @brief Destroy the EnergyLedger_CycleCharge object - no action needed.
+     */
+    ~EnergyLedger_CycleCharge() {}
+};
+
+
+/**
+ * @brief The Variable sub-class used for the average charge a logger has used
+ * per day.
+ *
+ * The value is in milliampere hours per day and has a resolution of 0.1
+ * mAh/day.
+ */
+class EnergyLedger_DailyCharge : public Variable {
+ public:
+    /**
+     * @brief Construct a new EnergyLedger_DailyCharge object.
+     *
+     * @param parentLedger The ledger providing the result values.
+     * @param uuid A universally unique identifier (UUID or GUID) for the
+     * variable; optional with the default value of an empty string.
+     * @param varCode A short code to help identify the variable in files;
+     * optional with a default value of "dailyCharge".
+     */
+    explicit EnergyLedger_DailyCharge(EnergyLedger* parentLedger,
+                                      const char*   uuid    = "",
+                                      const char*   varCode = "dailyCharge")
+        : Variable(&parentLedger->getDailyCharge,
+                   (uint8_t)ENERGY_DAILY_CHARGE_RESOLUTION,
+                   &*"electricCharge", &*"milliampereHourPerDay", varCode,
+                   uuid) {}
+    /**
+     * @brief Destroy the EnergyLedger_DailyCharge object - no action needed.
+     */
+    ~EnergyLedger_DailyCharge() {}
+};
+
+
+/**
+ * @brief The Variable sub-class used for the total charge a logger has used
+ * since it started.
+ *
+ * The value is in milliampere hours and has a resolution of 0.1 mAh.
+ */
+class EnergyLedger_TotalCharge : public Variable {
+ public:
+    /**
+     * @brief Construct a new EnergyLedger_TotalCharge object.
+     *
+     * @param parentLedger The ledger providing the result values.
+     * @param uuid A universally unique identifier (UUID or GUID) for the
+     * variable; optional with the default value of an empty string.
+     * @param varCode A short code to help identify the variable in files;
+     * optional with a default value of "totalCharge".
+     */
+    explicit EnergyLedger_TotalCharge(EnergyLedger* parentLedger,
+                                      const char*   uuid    = "",
+                                      const char*   varCode = "totalCharge")
+        : Variable(&parentLedger->getTotalCharge,
+                   (uint8_t)ENERGY_TOTAL_CHARGE_RESOLUTION,
+                   &*"electricCharge", &*"milliampereHour", varCode, uuid) {}
+    /**
+     * @brief Destroy the EnergyLedger_TotalCharge object - no action needed.
+     */
+    ~EnergyLedger_TotalCharge() {}
+};
+
+
+/**
+ * @brief The Variable sub-class used for the time the processor was awake in
+ * the last logging interval.
+ *
+ * The value is in seconds and has a resolution of 0.1 s.
+ */
+class EnergyLedger_AwakeTime : public Variable {
+ public:
+    /**
+     * @brief Construct a new EnergyLedger_AwakeTime object.
+     *
+     * @param parentLedger The ledger providing the result values.
+     * @param uuid A universally unique identifier (UUID or GUID) for the
+     * variable; optional with the default value of an empty string.
+     * @param varCode A short code to help identify the variable in files;
+     * optional with a default value of "awakeTime".
+     */
+    explicit EnergyLedger_AwakeTime(EnergyLedger* parentLedger,
+                                    const char*   uuid    = "",
+                                    const char*   varCode = "awakeTime")
+        : Variable(&parentLedger->getAwakeTime,
+                   (uint8_t)ENERGY_AWAKE_TIME_RESOLUTION, &*"timeElapsed",
+                   &*"second", varCode, uuid) {}
+    /**
+     * @brief Destroy the EnergyLedger_AwakeTime object - no action needed.
+     */
+    ~EnergyLedger_AwakeTime() {}
+};
+
+#endif  // SRC_ENERGYLEDGER_H_
@@ -0,0 +1,93 @@
+/**
+ * @file LogBuffer.cpp
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Implements the LogBuffer class.
+ */
+
+#include "LogBuffer.h"
+
+
+// Constructor
+LogBuffer::LogBuffer() {
+    _buffer = NULL;
+    _size   = 0;
+    clear();
+}
+
+
+void LogBuffer::begin(uint8_t* buffer, uint16_t bufferSize) {
+    _buffer = buffer;
+    _size   = buffer == NULL ? 0 : bufferSize;
+    clear();
+}
+
+
+size_t LogBuffer::write(uint8_t c) {
+    if (_count >= _size) {
+        _overflowed = true;
+        return 0;
+    }
+    uint16_t tail = _head + _count;
+    if (tail >= _size) tail -= _size;
+    _buffer[tail] = c;
+    _count++;
+    return 1;
+}
+
+
+int LogBuffer::available(void) {
+    return _count;
+}
+int LogBuffer::read(void) {
+    if (_count == 0) return -1;
+    uint8_t c = _buffer[_head];
+    _head++;
+    if (_head >= _size) _head = 0;
+    _count--;
+    return c;
+}
+int LogBuffer::peek(void) {
+    if (_count == 0) return -1;
+    return _buffer[_head];
+}
+void LogBuffer::flush(void) {}
+
+
+uint16_t LogBuffer::getSize(void) {
+    return _size;
+}
+uint16_t LogBuffer::getFree(void) {
+    return _size - _count;
+}
+bool LogBuffer::hasOverflowed(void) {
+    return _overflowed;
+}
+
+
+void LogBuffer::truncate(uint16_t length) {
+    if (length < _count) _count = length;
+    _overflowed = false;
+}
+void LogBuffer::clear(void) {
+    _head       = 0;
+    _count      = 0;
+    _overflowed = false;
+}
+
+
+// If the ring wraps around the end of the memory, the older part (from the
+// head to the end of the memory) goes first
+size_t LogBuffer::writeTo(Print* out) {
+    size_t   written    = 0;
+    uint16_t firstBlock = _size - _head;
+    if (firstBlock > _count) firstBlock = _count;
+    if (firstBlock > 0) written += out->write(_buffer + _head, firstBlock);
+    if (_count > firstBlock) {
+        written += out->write(_buffer, _count - firstBlock);
+    }
+    clear();
+    return written;
+}
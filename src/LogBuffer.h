@@ -0,0 +1,144 @@
+/**
+ * @file LogBuffer.h
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Contains the LogBuffer class.
+ *
+ * @copydetails LogBuffer
+ */
+
+// Header Guards
+#ifndef SRC_LOGBUFFER_H_
+#define SRC_LOGBUFFER_H_
+
+// Included Dependencies
+#include <Arduino.h>
+
+/**
+ * @brief A first-in-first-out ring of bytes in RAM that data records can be
+ * printed into like any other Arduino stream.
+ *
+ * The logger uses this to hold several records between writes to the SD card.
+ * The memory for the ring is supplied by the program; the buffer does not
+ * allocate anything itself.  Bytes that do not fit are dropped and the buffer
+ * is flagged as having overflowed, so the writer can roll back the partial
+ * record with truncate().
+ */
+class LogBuffer : public Stream {
+ public:
+    /**
+     * @brief Construct a new LogBuffer object with no memory attached.
+     */
+    LogBuffer();
+
+    /**
+     * @brief Attach the memory for the ring and empty it.
+     *
+     * @param buffer The memory to hold the bytes; this must stay allocated for
+     * as long as the buffer is in use
+     * @param bufferSize The number of bytes in the memory
+     */
+    void begin(uint8_t* buffer, uint16_t bufferSize);
+
+    /**
+     * @brief Add one byte to the end of the ring.
+     *
+     * @param c The byte to add
+     * @return **size_t** 1 if the byte was added, 0 if the ring was full
+     */
+    size_t write(uint8_t c);
+    using Print::write;
+
+    /**
+     * @brief Get the number of bytes waiting in the ring.
+     *
+     * @return **int** The number of bytes
+     */
+    int available(void);
+    /**
+     * @brief Remove and return the oldest byte in the ring.
+     *
+     * @return **int** The byte, or -1 if the ring is empty
+     */
+    int read(void);
+    /**
+     * @brief Return the oldest byte in the ring without removing it.
+     *
+     * @return **int** The byte, or -1 if the ring is empty
+     */
+    int peek(void);
+    /**
+     * @brief Does nothing; the bytes are only moved out by writeTo() or
+     * read().
+     */
+    void flush(void);
+
+    /**
+     * @brief Get the total number of bytes the ring can hold.
+     *
+     * @return **uint16_t** The size of the attached memory
+     */
+    uint16_t getSize(void);
+    /**
+     * @brief Get the number of bytes that can still be added.
+     *
+     * @return **uint16_t** The free space
+     */
+    uint16_t getFree(void);
+    /**
+     * @brief Check whether any byte has been dropped since the last time the
+     * buffer was emptied or truncated.
+     *
+     * @return **bool** True if a write did not fit
+     */
+    bool hasOverflowed(void);
+
+    /**
+     * @brief Drop the newest bytes so that only the given number remain and
+     * clear the overflow flag.
+     *
+     * @param length The number of (oldest) bytes to keep
+     */
+    void truncate(uint16_t length);
+    /**
+     * @brief Empty the ring.
+     */
+    void clear(void);
+
+    /**
+     * @brief Move everything in the ring to another stream and empty it.
+     *
+     * The bytes are handed over in at most two contiguous blocks, so an SD
+     * card file gets them in as few writes as possible.
+     *
+     * @param out The stream to write to
+     * @return **size_t** The number of bytes the stream accepted
+     */
+    size_t writeTo(Print* out);
+
+ private:
+    /**
+     * @brief The memory holding the ring
+     */
+    uint8_t* _buffer;
+    /**
+     * @brief The number of bytes in the memory
+     */
+    uint16_t _size;
+    /**
+     * @brief The position of the oldest byte in the ring
+     */
+    uint16_t _head;
+    /**
+     * @brief The number of bytes in the ring
+     */
+    uint16_t _count;
+    /**
+     * @brief True if a byte has been dropped because the ring was full
+     */
+    bool _overflowed;
+};
+
+#endif  // SRC_LOGBUFFER_H_
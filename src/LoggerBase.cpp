@@ -9,6 +9,7 @@
 
 #include "LoggerBase.h"
 #include "dataPublisherBase.h"
+#include "ProcessorIdle.h"
 
 /**
  * @brief To prevent compiler/linker crashes with enable interrupt library, we
@@ -28,6 +29,15 @@ int8_t Logger::_loggerTimeZone = 0;
 int8_t Logger::_loggerRTCOffset = 0;
 // Initialize the static timestamps
 uint32_t Logger::markedEpochTime = 0;
+// Initialize the clock cache as empty
+uint32_t Logger::_clockEpoch          = 0;
+uint32_t Logger::_clockMillis         = 0;
+bool     Logger::_clockValid          = false;
+uint32_t Logger::_cachedDateTimeEpoch = EPOCH_TIME_OFF;
+DateTime Logger::_cachedDateTime(0);
+// Initialize the formatted marked time as not yet written
+char     Logger::_markedISO8601[ISO8601_BUFFER_SIZE] = "";
+uint32_t Logger::_markedISO8601Epoch                 = 0;
 // Initialize the testing/logging flags
 volatile bool Logger::isLoggingNow = false;
 volatile bool Logger::isTestingNow = false;
@@ -55,19 +65,60 @@ Logger::Logger(const char* loggerID, uint16_t loggingIntervalMinutes,
 
     // Set the initial pin values
     _SDCardPowerPin = -1;
+    _SDCardPowered  = false;
     setSDCardSS(SDCardSSPin);
     setRTCWakePin(mcuWakePin);
     _ledPin    = -1;
     _buttonPin = -1;
 
     // Initialize with no file name
-    _fileName = "";
+    _fileName[0]   = '\0';
+    _logFileFormat = LOG_FILE_CSV;
+
+    // Write every record immediately until a log buffer is given
+    _recordsPerFlush = 0;
+    _flushBytes      = 0;
+    _bufferedRecords = 0;
+    _largestRecord   = 0;
+    _lowBatteryVar   = NULL;
+    _lowBatteryLevel = -9999;
+
+    // Keep one file that grows as needed until told otherwise
+    _logRotation     = LOG_ROTATE_NEVER;
+    _fileBytes       = 0;
+    _fileDataEnd     = 0;
+    _lastAppendBytes = 0;
+    _filePeriod      = 0;
+
+    // Records are not numbered or journaled unless asked for
+    _journalEnabled    = false;
+    _recordSequence    = 0;
+    _journalSlot       = 0;
+    _journalWriteCount = 0;
+
+    // Publish straight to the remotes unless asked to queue
+    _publishQueueEnabled = false;
+    _queueDrainSeconds   = 60;
+    _queueDrainBytes     = 0;
+    _batchQueue          = NULL;
+    _batchStart          = 0;
 
     // Start with no feature UUID
     _samplingFeatureUUID = NULL;
 
     // Start with no modem attached
     _logModem = NULL;
+    // The modem is only woken once the sensors are done, unless asked
+    _earlyModemWake = false;
+    // Sync the clock every day unless asked to track its drift
+    _clockDriftTracking     = false;
+    _clockDriftCompensation = false;
+    _maxClockError          = 5;
+    memset(&_clockDrift, 0, sizeof(_clockDrift));
+    // Keep no energy ledger unless one is attached
+    _energyLedger   = NULL;
+    _millisWoke     = 0;
+    _millisSDCardOn = 0;
 
     // Clear arrays
     for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
@@ -90,19 +141,60 @@ Logger::Logger(const char* loggerID, uint16_t loggingIntervalMinutes,
 
     // Set the initial pin values
     _SDCardPowerPin = -1;
+    _SDCardPowered  = false;
     _SDCardSSPin    = -1;
     _mcuWakePin     = -1;
     _ledPin         = -1;
     _buttonPin      = -1;
 
     // Initialize with no file name
-    _fileName = "";
+    _fileName[0]   = '\0';
+    _logFileFormat = LOG_FILE_CSV;
+
+    // Write every record immediately until a log buffer is given
+    _recordsPerFlush = 0;
+    _flushBytes      = 0;
+    _bufferedRecords = 0;
+    _largestRecord   = 0;
+    _lowBatteryVar   = NULL;
+    _lowBatteryLevel = -9999;
+
+    // Keep one file that grows as needed until told otherwise
+    _logRotation     = LOG_ROTATE_NEVER;
+    _fileBytes       = 0;
+    _fileDataEnd     = 0;
+    _lastAppendBytes = 0;
+    _filePeriod      = 0;
+
+    // Records are not numbered or journaled unless asked for
+    _journalEnabled    = false;
+    _recordSequence    = 0;
+    _journalSlot       = 0;
+    _journalWriteCount = 0;
+
+    // Publish straight to the remotes unless asked to queue
+    _publishQueueEnabled = false;
+    _queueDrainSeconds   = 60;
+    _queueDrainBytes     = 0;
+    _batchQueue          = NULL;
+    _batchStart          = 0;
 
     // Start with no feature UUID
     _samplingFeatureUUID = NULL;
 
     // Start with no modem attached
     _logModem = NULL;
+    // The modem is only woken once the sensors are done, unless asked
+    _earlyModemWake = false;
+    // Sync the clock every day unless asked to track its drift
+    _clockDriftTracking     = false;
+    _clockDriftCompensation = false;
+    _maxClockError          = 5;
+    memset(&_clockDrift, 0, sizeof(_clockDrift));
+    // Keep no energy ledger unless one is attached
+    _energyLedger   = NULL;
+    _millisWoke     = 0;
+    _millisSDCardOn = 0;
 
     // Clear arrays
     for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
@@ -119,19 +211,60 @@ Logger::Logger() {
 
     // Set the initial pin values
     _SDCardPowerPin = -1;
+    _SDCardPowered  = false;
     _SDCardSSPin    = -1;
     _mcuWakePin     = -1;
     _ledPin         = -1;
     _buttonPin      = -1;
 
     // Initialize with no file name
-    _fileName = "";
+    _fileName[0]   = '\0';
+    _logFileFormat = LOG_FILE_CSV;
+
+    // Write every record immediately until a log buffer is given
+    _recordsPerFlush = 0;
+    _flushBytes      = 0;
+    _bufferedRecords = 0;
+    _largestRecord   = 0;
+    _lowBatteryVar   = NULL;
+    _lowBatteryLevel = -9999;
+
+    // Keep one file that grows as needed until told otherwise
+    _logRotation     = LOG_ROTATE_NEVER;
+    _fileBytes       = 0;
+    _fileDataEnd     = 0;
+    _lastAppendBytes = 0;
+    _filePeriod      = 0;
+
+    // Records are not numbered or journaled unless asked for
+    _journalEnabled    = false;
+    _recordSequence    = 0;
+    _journalSlot       = 0;
+    _journalWriteCount = 0;
+
+    // Publish straight to the remotes unless asked to queue
+    _publishQueueEnabled = false;
+    _queueDrainSeconds   = 60;
+    _queueDrainBytes     = 0;
+    _batchQueue          = NULL;
+    _batchStart          = 0;
 
     // Start with no feature UUID
     _samplingFeatureUUID = NULL;
 
     // Start with no modem attached
     _logModem = NULL;
+    // The modem is only woken once the sensors are done, unless asked
+    _earlyModemWake = false;
+    // Sync the clock every day unless asked to track its drift
+    _clockDriftTracking     = false;
+    _clockDriftCompensation = false;
+    _maxClockError          = 5;
+    memset(&_clockDrift, 0, sizeof(_clockDrift));
+    // Keep no energy ledger unless one is attached
+    _energyLedger   = NULL;
+    _millisWoke     = 0;
+    _millisSDCardOn = 0;
 
     // Clear arrays
     for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
@@ -167,6 +300,7 @@ void Logger::setSamplingFeatureUUID(const char* samplingFeatureUUID) {
 // Sets up a pin controlling the power to the SD card
 void Logger::setSDCardPwr(int8_t SDCardPowerPin) {
     _SDCardPowerPin = SDCardPowerPin;
+    _SDCardPowered  = false;
     if (_SDCardPowerPin >= 0) {
         pinMode(_SDCardPowerPin, OUTPUT);
         digitalWrite(_SDCardPowerPin, LOW);
@@ -177,16 +311,27 @@ void Logger::setSDCardPwr(int8_t SDCardPowerPin) {
 void Logger::turnOnSDcard(bool waitToSettle) {
     if (_SDCardPowerPin >= 0) {
         digitalWrite(_SDCardPowerPin, HIGH);
+        if (!_SDCardPowered) _millisSDCardOn = millis();
+        _SDCardPowered = true;
         // TODO(SRGDamia1):  figure out how long to wait
         if (waitToSettle) { delay(6); }
     }
 }
 void Logger::turnOffSDcard(bool waitForHousekeeping) {
-    if (_SDCardPowerPin >= 0) {
+    if (_SDCardPowerPin >= 0 && _SDCardPowered) {
+        // A file kept open by the log buffer must not lose its cached blocks
+        if (logFile.isOpen()) {
+            logFile.sync();
+            logFile.close();
+        }
         // TODO(SRGDamia1): set All SPI pins to INPUT?
         // TODO(SRGDamia1): set ALL SPI pins HIGH (~30k pullup)
         pinMode(_SDCardPowerPin, OUTPUT);
         digitalWrite(_SDCardPowerPin, LOW);
+        _SDCardPowered = false;
+        if (_energyLedger != NULL) {
+            _energyLedger->addSDCardTime(millis() - _millisSDCardOn);
+        }
         // TODO(SRGDamia1):  wait in lower power mode
         if (waitForHousekeeping) {
             // Specs say up to 1s for internal housekeeping after each write
@@ -298,10 +443,30 @@ String Logger::getVarCodeAtI(uint8_t position_i) {
 String Logger::getVarUUIDAtI(uint8_t position_i) {
     return _internalArray->arrayOfVars[position_i]->getVarUUID();
 }
+// These return the names, unit, code and UUID without copying them
+const char* Logger::getParentSensorNameCharsAtI(uint8_t position_i) {
+    return _internalArray->arrayOfVars[position_i]->getParentSensorNameChars();
+}
+const char* Logger::getVarNameCharsAtI(uint8_t position_i) {
+    return _internalArray->arrayOfVars[position_i]->getVarNameChars();
+}
+const char* Logger::getVarUnitCharsAtI(uint8_t position_i) {
+    return _internalArray->arrayOfVars[position_i]->getVarUnitChars();
+}
+const char* Logger::getVarCodeCharsAtI(uint8_t position_i) {
+    return _internalArray->arrayOfVars[position_i]->getVarCodeChars();
+}
+const char* Logger::getVarUUIDCharsAtI(uint8_t position_i) {
+    return _internalArray->arrayOfVars[position_i]->getVarUUIDChars();
+}
 // This returns the current value of the variable as a string with the
 // correct number of significant figures
 String Logger::getValueStringAtI(uint8_t position_i) {
-    return _internalArray->arrayOfVars[position_i]->getValueString();
+    return String(getValueCharsAtI(position_i));
+}
+// This returns the value as formatted by the variable array, without copying
+const char* Logger::getValueCharsAtI(uint8_t position_i) {
+    return _internalArray->getValueChars(position_i);
 }
 
 
@@ -317,17 +482,32 @@ void Logger::attachModem(loggerModem& modem) {
 }
 
 
+// Sets whether the modem registers while the sensors measure
+void Logger::setEarlyModemWake(bool enable) {
+    _earlyModemWake = enable;
+}
+
+
+// Sets whether the clock's drift is fitted and used to schedule syncs
+void Logger::setClockDriftTracking(bool enable, bool compensate,
+                                   uint16_t maxErrorSeconds) {
+    _clockDriftTracking     = enable;
+    _clockDriftCompensation = enable && compensate;
+    _maxClockError          = maxErrorSeconds;
+}
+
+
 // Takes advantage of the modem to synchronize the clock
 bool Logger::syncRTC() {
     bool success = false;
     if (_logModem != NULL) {
-        // Synchronize the RTC with NIST
-        PRINTOUT(F("Attempting to connect to the internet and synchronize RTC "
-                   "with NIST"));
+        // Synchronize the RTC with the network, an SNTP server, or NIST
+        PRINTOUT(F("Attempting to connect to the internet and synchronize "
+                   "RTC"));
         PRINTOUT(F("This may take up to two minutes!"));
         if (_logModem->modemWake()) {
             if (_logModem->connectInternet(120000L)) {
-                setRTClock(_logModem->getNISTTime());
+                setRTClock(_logModem->getUTCTime());
                 success = true;
                 _logModem->updateModemMetadata();
             } else {
@@ -369,21 +549,363 @@ void Logger::registerDataPublisher(dataPublisher* publisher) {
 void Logger::publishDataToRemotes(void) {
     MS_DBG(F("Sending out remote data."));
 
-    for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
-        if (dataPublishers[i] != NULL) {
-            PRINTOUT(F("\nSending data to ["), i, F("]"),
-                     dataPublishers[i]->getEndpoint());
-            // dataPublishers[i]->publishData(_logModem->getClient());
-            dataPublishers[i]->publishData();
-            watchDogTimer.resetWatchDog();
+    // Publishers sending to the same place share one connection, and all of
+    // them are closed again before the modem can disconnect
+    dataPublisher::keepConnectionsOpen(true);
+
+    // Go through the queue on the SD card if there is one
+    if (!usesPublishQueue() || !publishThroughQueue()) {
+        for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+            if (dataPublishers[i] != NULL) {
+                PRINTOUT(F("\nSending data to ["), i, F("]"),
+                         dataPublishers[i]->getEndpoint());
+                // dataPublishers[i]->publishData(_logModem->getClient());
+                dataPublishers[i]->publishData();
+                watchDogTimer.resetWatchDog();
+            }
         }
     }
+
+    dataPublisher::closeConnections();
 }
 void Logger::sendDataToRemotes(void) {
     publishDataToRemotes();
 }
 
 
+// Sets up the queue on the SD card for records that could not be published
+void Logger::setPublishQueue(bool enable, uint16_t drainSeconds,
+                             uint32_t drainBytes) {
+    _publishQueueEnabled = enable;
+    _queueDrainSeconds   = drainSeconds;
+    _queueDrainBytes     = drainBytes;
+}
+
+
+// Keeps the current record for every publisher when it can't be sent at all
+void Logger::queueDataForRemotes(void) {
+    if (!usesPublishQueue()) return;
+    // The card isn't powered between batches when records are buffered
+    if (_SDCardPowerPin >= 0 && !_SDCardPowered) turnOnSDcard(true);
+    File queue;
+    if (!openPublishQueue(queue)) return;
+    uint32_t length = getPublishQueueLength(queue);
+    writePublishQueueRecord(queue, length);
+    queue.close();
+    MS_DBG(F("Queued record"), length, F("to publish later"));
+}
+
+
+// Checks if any publisher sends on this logging interval
+bool Logger::isPublishingDue(void) {
+    bool anyPublishers = false;
+    for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+        if (dataPublishers[i] == NULL) continue;
+        anyPublishers = true;
+        if (dataPublishers[i]->isSendDue(getIntervalNumber())) return true;
+    }
+    return !anyPublishers;
+}
+
+
+// Swaps a record of the batch being published in for the current one
+bool Logger::loadQueuedRecord(uint16_t record) {
+    if (_batchQueue == NULL) return false;
+    return readPublishQueueRecord(*_batchQueue, _batchStart + record);
+}
+
+
+// Protected helper function - This sends each publisher what it's missing,
+// oldest first, and queues whatever is not accepted
+bool Logger::publishThroughQueue(void) {
+    if (_SDCardPowerPin >= 0 && !_SDCardPowered) turnOnSDcard(true);
+    File queue;
+    if (!openPublishQueue(queue)) return false;
+
+    publishQueueIndex index;
+    readPublishQueueIndex(index);
+    uint32_t length = getPublishQueueLength(queue);
+
+    // The new record only has to join the queue first if anyone is behind
+    // or waiting for their turn; otherwise it's sent directly and only
+    // queued for those that fail
+    bool due[MAX_NUMBER_SENDERS];
+    bool behind = false;
+    for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+        if (index.cursor[i] > length) index.cursor[i] = length;
+        due[i] = dataPublishers[i] != NULL &&
+            dataPublishers[i]->isSendDue(getIntervalNumber());
+        if (dataPublishers[i] != NULL &&
+            (index.cursor[i] < length || !due[i])) {
+            behind = true;
+        }
+    }
+    if (behind) writePublishQueueRecord(queue, length++);
+
+    uint32_t liveEpoch   = Logger::markedEpochTime;
+    uint32_t startMillis = millis();
+    uint32_t startBytes  = dataPublisher::getTxByteCount();
+    bool     failed[MAX_NUMBER_SENDERS];
+    bool     anyFailed = false;
+    for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+        failed[i] = !due[i];
+        if (!due[i]) continue;
+        PRINTOUT(F("\nSending data to ["), i, F("]"),
+                 dataPublishers[i]->getEndpoint());
+        if (!behind) {
+            failed[i] = !dataPublishers[i]->publishSucceeded(
+                dataPublishers[i]->publishData());
+            anyFailed |= failed[i];
+        }
+        watchDogTimer.resetWatchDog();
+    }
+
+    // Take turns, one batch each, so the first publisher can't spend the
+    // whole budget; a publisher stops for this wake at its first failure
+    bool progressed = true;
+    while (progressed && !isQueueBudgetSpent(startMillis, startBytes)) {
+        progressed = false;
+        for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+            if (failed[i] || index.cursor[i] >= length) continue;
+            if (isQueueBudgetSpent(startMillis, startBytes)) break;
+            uint32_t waiting = length - index.cursor[i];
+            uint16_t batch   = MS_PUBLISH_BATCH_SIZE;
+            if (waiting < batch) batch = waiting;
+
+            _batchQueue       = &queue;
+            _batchStart       = index.cursor[i];
+            uint16_t accepted = dataPublishers[i]->publishBatch(batch);
+            _batchQueue       = NULL;
+            // Damaged records count as accepted, so they don't block the
+            // queue; a publisher may also take fewer than offered
+            index.cursor[i] += accepted;
+            if (accepted == 0) {
+                failed[i] = true;
+            } else {
+                progressed = true;
+            }
+            watchDogTimer.resetWatchDog();
+        }
+    }
+    // Put back the current record after sending older ones
+    Logger::markedEpochTime = liveEpoch;
+    _internalArray->restoreValueStrings();
+
+    if (anyFailed) {
+        writePublishQueueRecord(queue, length++);
+        // Only those that missed the new record are waiting for it
+        for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+            if (!failed[i]) index.cursor[i] = length;
+        }
+    }
+
+    // Once every publisher has every record, start the queue over
+    uint32_t sentToAll = length;
+    for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+        if (dataPublishers[i] != NULL && index.cursor[i] < sentToAll) {
+            sentToAll = index.cursor[i];
+        }
+    }
+    if (sentToAll == length && length > 0) {
+        queue.truncate(MS_PUBLISH_QUEUE_HEADER_SIZE);
+        memset(index.cursor, 0, sizeof(index.cursor));
+        length = 0;
+    } else if (sentToAll > 0 && sentToAll >= length - sentToAll) {
+        // Publishers sending in batches at different times may never all
+        // catch up together, so drop what they all have once it's at least
+        // half the queue; copying then costs no more than what is dropped
+        length = compactPublishQueue(queue, index, sentToAll, length);
+    }
+    queue.close();
+    writePublishQueueIndex(index);
+    MS_DBG(length, F("records in the publish queue"));
+    return true;
+}
+
+
+// Protected helper function - This removes the records at the start of the
+// queue that every publisher has
+uint32_t Logger::compactPublishQueue(File& queue, publishQueueIndex& index,
+                                     uint32_t drop, uint32_t length) {
+    MS_DBG(F("Dropping"), drop, F("published records from the queue"));
+    // The places are saved first: if the power is cut while records are being
+    // moved, they may be sent again, but none are skipped
+    for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+        index.cursor[i] = index.cursor[i] > drop ? index.cursor[i] - drop : 0;
+    }
+    writePublishQueueIndex(index);
+
+    uint32_t recordSize = getPublishQueueRecordSize();
+    uint32_t from       = MS_PUBLISH_QUEUE_HEADER_SIZE + drop * recordSize;
+    uint32_t to         = MS_PUBLISH_QUEUE_HEADER_SIZE;
+    uint32_t end        = MS_PUBLISH_QUEUE_HEADER_SIZE + length * recordSize;
+    uint8_t  chunk[64];
+    while (from < end) {
+        uint16_t n = end - from < sizeof(chunk) ? end - from : sizeof(chunk);
+        queue.seekSet(from);
+        if (queue.read(chunk, n) != n) break;
+        queue.seekSet(to);
+        queue.write(chunk, n);
+        from += n;
+        to += n;
+        watchDogTimer.resetWatchDog();
+    }
+    queue.truncate(MS_PUBLISH_QUEUE_HEADER_SIZE + (length - drop) * recordSize);
+    return length - drop;
+}
+
+
+// Protected helper function - This opens the queue, starting a new one if
+// the old one can't be used
+bool Logger::openPublishQueue(File& queue) {
+    if (!initializeSDCard()) return false;
+    // Queued values are loaded back into the array's own value slots
+    if (_internalArray->getValueStringSlotCount() < getArrayVarCount()) {
+        PRINTOUT(F("The variable array needs a value slot for every variable "
+                   "to queue records for publishing"));
+        return false;
+    }
+
+    uint16_t recordSize = getPublishQueueRecordSize();
+    uint8_t  header[MS_PUBLISH_QUEUE_HEADER_SIZE];
+    memcpy(header, MS_PUBLISH_QUEUE_MAGIC, 4);
+    header[4] = getArrayVarCount();
+    header[5] = MS_VALUE_STRING_LENGTH;
+    header[6] = recordSize & 0xFF;
+    header[7] = recordSize >> 8;
+
+    if (queue.open(MS_PUBLISH_QUEUE_FILE_NAME, O_RDWR)) {
+        uint8_t existing[MS_PUBLISH_QUEUE_HEADER_SIZE];
+        if (queue.read(existing, sizeof(existing)) == sizeof(existing) &&
+            memcmp(existing, header, sizeof(header)) == 0) {
+            return true;
+        }
+        PRINTOUT(F("Discarding a publish queue written for other variables"));
+        queue.remove();
+    }
+    if (!queue.open(MS_PUBLISH_QUEUE_FILE_NAME, O_RDWR | O_CREAT)) {
+        MS_DBG(F("Unable to create the publish queue"));
+        return false;
+    }
+    queue.write(header, sizeof(header));
+    // Places in an old queue mean nothing in a new one
+    sd.remove(MS_PUBLISH_INDEX_FILE_NAME);
+    return true;
+}
+
+
+// Protected helper function - The time, the text of each value, and a CRC
+uint16_t Logger::getPublishQueueRecordSize(void) {
+    return 8 +
+        MS_VALUE_STRING_LENGTH * static_cast<uint16_t>(getArrayVarCount());
+}
+
+
+// Protected helper function - A record cut short at the end doesn't count
+uint32_t Logger::getPublishQueueLength(File& queue) {
+    return (queue.fileSize() - MS_PUBLISH_QUEUE_HEADER_SIZE) /
+        getPublishQueueRecordSize();
+}
+
+
+// Protected helper function - This writes the current record into the queue
+void Logger::writePublishQueueRecord(File& queue, uint32_t position) {
+    uint32_t crc = 0;
+    queue.seekSet(MS_PUBLISH_QUEUE_HEADER_SIZE +
+                  position * getPublishQueueRecordSize());
+    writeWithCRC32(&queue, &Logger::markedEpochTime, 4, crc);
+    for (uint8_t i = 0; i < getArrayVarCount(); i++) {
+        // Pad with nulls so the record doesn't depend on what was in the slot
+        char value[MS_VALUE_STRING_LENGTH];
+        strncpy(value, getValueCharsAtI(i), MS_VALUE_STRING_LENGTH);
+        value[MS_VALUE_STRING_LENGTH - 1] = '\0';
+        writeWithCRC32(&queue, value, MS_VALUE_STRING_LENGTH, crc);
+    }
+    queue.write(reinterpret_cast<const uint8_t*>(&crc), 4);
+}
+
+
+// Protected helper function - This swaps a queued record in for the current
+// one
+bool Logger::readPublishQueueRecord(File& queue, uint32_t position) {
+    uint32_t epochTime;
+    uint32_t storedCRC;
+    queue.seekSet(MS_PUBLISH_QUEUE_HEADER_SIZE +
+                  position * getPublishQueueRecordSize());
+    if (queue.read(&epochTime, 4) != 4 ||
+        !_internalArray->readValueStrings(&queue) ||
+        queue.read(&storedCRC, 4) != 4) {
+        return false;
+    }
+    uint32_t crc = updateCRC32(0, &epochTime, 4);
+    for (uint8_t i = 0; i < getArrayVarCount(); i++) {
+        crc = updateCRC32(crc, getValueCharsAtI(i), MS_VALUE_STRING_LENGTH);
+    }
+    if (crc != storedCRC) {
+        MS_DBG(F("Skipping damaged queued record"), position);
+        return false;
+    }
+    Logger::markedEpochTime = epochTime;
+    return true;
+}
+
+
+// Protected helper function - This reads the publishers' places in the queue
+void Logger::readPublishQueueIndex(publishQueueIndex& index) {
+    File indexFile;
+    if (!indexFile.open(MS_PUBLISH_INDEX_FILE_NAME, O_READ) ||
+        indexFile.read(&index, sizeof(index)) != sizeof(index) ||
+        index.magic != MS_PUBLISH_INDEX_MAGIC ||
+        index.crc != updateCRC32(0, &index, offsetof(publishQueueIndex, crc))) {
+        // Without an index, everything queued is sent to everyone again
+        memset(&index, 0, sizeof(index));
+    }
+    if (indexFile.isOpen()) indexFile.close();
+}
+
+
+// Protected helper function - This saves the publishers' places in the queue
+void Logger::writePublishQueueIndex(publishQueueIndex& index) {
+    index.magic = MS_PUBLISH_INDEX_MAGIC;
+    index.crc   = updateCRC32(0, &index, offsetof(publishQueueIndex, crc));
+    File indexFile;
+    if (!indexFile.open(MS_PUBLISH_INDEX_FILE_NAME, O_RDWR | O_CREAT)) {
+        MS_DBG(F("Unable to save the publish queue index"));
+        return;
+    }
+    indexFile.write(reinterpret_cast<const uint8_t*>(&index), sizeof(index));
+    indexFile.close();
+}
+
+
+// Protected helper function - This checks the limits on emptying the queue
+bool Logger::isQueueBudgetSpent(uint32_t startMillis, uint32_t startBytes) {
+    if (millis() - startMillis >= _queueDrainSeconds * 1000UL) return true;
+    return _queueDrainBytes > 0 &&
+        dataPublisher::getTxByteCount() - startBytes >= _queueDrainBytes;
+}
+
+
+// Protected helper function - Batching publishers keep their records in the
+// queue between sends
+bool Logger::usesPublishQueue(void) {
+    if (_publishQueueEnabled) return true;
+    for (uint8_t i = 0; i < MAX_NUMBER_SENDERS; i++) {
+        if (dataPublishers[i] != NULL && dataPublishers[i]->sendsInBatches()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Protected helper function - Intervals are counted from the epoch so that
+// the publishers' turns don't move when the logger restarts
+uint32_t Logger::getIntervalNumber(void) {
+    return Logger::markedEpochTime / (_loggingIntervalMinutes * 60UL);
+}
+
+
 // ===================================================================== //
 // Public functions to access the clock in proper format and time zone
 // ===================================================================== //
@@ -391,6 +913,8 @@ void Logger::sendDataToRemotes(void) {
 // Sets the static timezone that the data will be logged in - this must be set
 void Logger::setLoggerTimeZone(int8_t timeZone) {
     _loggerTimeZone = timeZone;
+    // The formatted marked time includes the time zone
+    _markedISO8601[0] = '\0';
 // Some helpful prints for debugging
 #ifdef STANDARD_SERIAL_OUTPUT
     const char* prtout1 = "Logger timezone is set to UTC";
@@ -460,69 +984,71 @@ int8_t Logger::getTZOffset(void) {
     return Logger::_loggerRTCOffset;
 }
 
-// This gets the current epoch time (unix time, ie, the number of seconds
-// from January 1, 1970 00:00:00 UTC) and corrects it to the specified time zone
+// This reads the clock itself
 #if defined MS_SAMD_DS3231 || not defined ARDUINO_ARCH_SAMD
 
-uint32_t Logger::getNowEpoch(void) {
-    uint32_t currentEpochTime = rtc.now().getEpoch();
-    // Do NOT apply an offset if the timestamp is obviously bad
-    if (isRTCSane(currentEpochTime))
-        currentEpochTime += ((uint32_t)_loggerRTCOffset) * 3600;
-    return currentEpochTime;
+uint32_t Logger::readRTCEpoch(void) {
+    return rtc.now().getEpoch();
 }
 void Logger::setNowEpoch(uint32_t ts) {
     rtc.setEpoch(ts);
+    resetClockCache();
 }
 
 #elif defined ARDUINO_ARCH_SAMD
 
+uint32_t Logger::readRTCEpoch(void) {
+    return zero_sleep_rtc.getEpoch();
+}
+void Logger::setNowEpoch(uint32_t ts) {
+    zero_sleep_rtc.setEpoch(ts);
+    resetClockCache();
+}
+
+#endif
+
+// This gets the current epoch time (unix time, ie, the number of seconds
+// from January 1, 1970 00:00:00 UTC) and corrects it to the specified time zone
 uint32_t Logger::getNowEpoch(void) {
-    uint32_t currentEpochTime = zero_sleep_rtc.getEpoch();
+    // Only go out to the clock once per wake, then count with millis()
+    uint32_t elapsedMillis = millis() - _clockMillis;
+    if (!_clockValid || elapsedMillis > MS_CLOCK_REFRESH_MS) {
+        _clockEpoch   = readRTCEpoch();
+        _clockMillis  = millis();
+        _clockValid   = true;
+        elapsedMillis = 0;
+    }
+    // The reading may have been taken late in its second, so this lags the
+    // clock by less than a second; see the note on getNowEpoch()
+    uint32_t currentEpochTime = _clockEpoch + elapsedMillis / 1000;
     // Do NOT apply an offset if the timestamp is obviously bad
     if (isRTCSane(currentEpochTime))
         currentEpochTime += ((uint32_t)_loggerRTCOffset) * 3600;
     return currentEpochTime;
 }
-void Logger::setNowEpoch(uint32_t ts) {
-    zero_sleep_rtc.setEpoch(ts);
+void Logger::resetClockCache(void) {
+    _clockValid = false;
 }
 
-#endif
-
 // This converts the current UNIX timestamp (ie, the number of seconds
 // from January 1, 1970 00:00:00 UTC) into a DateTime object
 // The DateTime object constructor requires the number of seconds from
 // January 1, 2000 (NOT 1970) as input, so we need to subtract.
 DateTime Logger::dtFromEpoch(uint32_t epochTime) {
-    DateTime dt(epochTime - EPOCH_TIME_OFF);
-    return dt;
+    if (epochTime != _cachedDateTimeEpoch) {
+        _cachedDateTime      = DateTime(epochTime - EPOCH_TIME_OFF);
+        _cachedDateTimeEpoch = epochTime;
+    }
+    return _cachedDateTime;
 }
 
 // This converts a date-time object into a ISO8601 formatted string
 // It assumes the supplied date/time is in the LOGGER's timezone and adds
 // the LOGGER's offset as the time zone offset in the string.
 String Logger::formatDateTime_ISO8601(DateTime& dt) {
-    // Set up an inital string
-    String dateTimeStr;
-    // Convert the DateTime object to a String
-    dt.addToString(dateTimeStr);
-    dateTimeStr.replace(" ", "T");
-    String tzString = String(_loggerTimeZone);
-    if (-24 <= _loggerTimeZone && _loggerTimeZone <= -10) {
-        tzString += F(":00");
-    } else if (-10 < _loggerTimeZone && _loggerTimeZone < 0) {
-        tzString = tzString.substring(0, 1) + '0' + tzString.substring(1, 2) +
-            F(":00");
-    } else if (_loggerTimeZone == 0) {
-        tzString = 'Z';
-    } else if (0 < _loggerTimeZone && _loggerTimeZone < 10) {
-        tzString = "+0" + tzString + F(":00");
-    } else if (10 <= _loggerTimeZone && _loggerTimeZone <= 24) {
-        tzString = "+" + tzString + F(":00");
-    }
-    dateTimeStr += tzString;
-    return dateTimeStr;
+    char dateTimeChars[ISO8601_BUFFER_SIZE];
+    formatDateTime_ISO8601(dt, dateTimeChars);
+    return String(dateTimeChars);
 }
 
 
@@ -536,6 +1062,65 @@ String Logger::formatDateTime_ISO8601(uint32_t epochTime) {
 }
 
 
+// This writes the ISO8601 string straight into a char buffer
+void Logger::formatDateTime_ISO8601(DateTime& dt, char* buffer) {
+    char* tz = writeDateTimeChars(dt, buffer, 'T');
+    if (_loggerTimeZone == 0) {
+        strcpy(tz, "Z");
+        return;
+    }
+    // The offset is always a sign and two digits of hours, ie -05:00
+    *tz++ = _loggerTimeZone < 0 ? '-' : '+';
+    tz    = writeTwoDigits(tz, abs(_loggerTimeZone));
+    strcpy(tz, ":00");
+}
+void Logger::formatDateTime_ISO8601(uint32_t epochTime, char* buffer) {
+    DateTime dt = dtFromEpoch(epochTime);
+    formatDateTime_ISO8601(dt, buffer);
+}
+
+
+// This formats the marked time only once per marked time
+const char* Logger::getMarkedISO8601(void) {
+    if (_markedISO8601[0] == '\0' ||
+        _markedISO8601Epoch != Logger::markedEpochTime) {
+        formatDateTime_ISO8601(Logger::markedEpochTime, _markedISO8601);
+        _markedISO8601Epoch = Logger::markedEpochTime;
+    }
+    return _markedISO8601;
+}
+
+
+// This writes the date and time fields with leading zeros, as
+// DateTime::addToString() does, but into a char buffer
+char* Logger::writeDateTimeChars(DateTime& dt, char* buffer, char separator) {
+    uint16_t year = dt.year();
+    char*    next = writeTwoDigits(buffer, year / 100);
+    next          = writeTwoDigits(next, year % 100);
+    *next++       = '-';
+    next          = writeTwoDigits(next, dt.month());
+    *next++       = '-';
+    next          = writeTwoDigits(next, dt.date());
+    *next++       = separator;
+    next          = writeTwoDigits(next, dt.hour());
+    *next++       = ':';
+    next          = writeTwoDigits(next, dt.minute());
+    *next++       = ':';
+    next          = writeTwoDigits(next, dt.second());
+    *next         = '\0';
+    return next;
+}
+
+
+// Every field is 0-99, so each is exactly two characters with no need for
+// itoa() and a strlen() to find where it ended
+char* Logger::writeTwoDigits(char* buffer, uint8_t value) {
+    buffer[0] = '0' + value / 10;
+    buffer[1] = '0' + value % 10;
+    return buffer + 2;
+}
+
+
 // This sets the real time clock to the given time
 bool Logger::setRTClock(uint32_t UTCEpochSeconds) {
     // If the timestamp is zero, just exit
@@ -551,16 +1136,33 @@ bool Logger::setRTClock(uint32_t UTCEpochSeconds) {
     uint32_t set_logTZ = UTCEpochSeconds +
         ((uint32_t)getLoggerTimeZone()) * 3600;
     uint32_t set_rtcTZ = set_logTZ - ((uint32_t)getTZOffset()) * 3600;
-    MS_DBG(F("    Time for Logger supplied by NIST:"), set_logTZ, F("->"),
+    MS_DBG(F("    Time for Logger supplied by modem:"), set_logTZ, F("->"),
            formatDateTime_ISO8601(set_logTZ));
 
     // Check the current RTC time
     uint32_t cur_logTZ = getNowEpoch();
     MS_DBG(F("    Current Time on RTC:"), cur_logTZ, F("->"),
            formatDateTime_ISO8601(cur_logTZ));
-    MS_DBG(F("    Offset between NIST and RTC:"), abs(set_logTZ - cur_logTZ));
+    MS_DBG(F("    Offset between modem and RTC:"), abs(set_logTZ - cur_logTZ));
+
+    // Fit the drift with the offset, then set the clock however small it is
+    if (_clockDriftTracking) {
+        int32_t accuracy = _logModem != NULL
+            ? _logModem->getTimeSourceAccuracy(_logModem->getLastTimeSource())
+            : -9999;
+        updateClockDrift(UTCEpochSeconds,
+                         static_cast<int32_t>(set_logTZ - cur_logTZ),
+                         accuracy > 0 ? accuracy : 1000);
+        if (set_logTZ == cur_logTZ) {
+            PRINTOUT(F("Clock already set to the second."));
+            return false;
+        }
+        setNowEpoch(set_rtcTZ);
+        PRINTOUT(F("Clock set!"));
+        return true;
+    }
 
-    // If the RTC and NIST disagree by more than 5 seconds, set the clock
+    // If the RTC and modem disagree by more than 5 seconds, set the clock
     if (abs(set_logTZ - cur_logTZ) > 5) {
         setNowEpoch(set_rtcTZ);
         PRINTOUT(F("Clock set!"));
@@ -586,6 +1188,189 @@ bool Logger::isRTCSane(uint32_t epochTime) {
 }
 
 
+// This gets the drift fitted to the clock
+float Logger::getClockDrift(void) {
+    return _clockDrift.fitSpan > 0 ? _clockDrift.driftPerDay : 0;
+}
+
+
+// This predicts how far off the clock will be at the given time
+float Logger::getPredictedClockError(uint32_t epochTime) {
+    if (_clockDrift.lastSync == 0 || _clockDrift.fitSpan == 0) return -9999;
+    uint32_t utcTime = epochTime - static_cast<int32_t>(_loggerTimeZone) * 3600;
+    int32_t  elapsed = utcTime - _clockDrift.lastSync;
+    float    days    = elapsed > 0 ? elapsed / 86400.0 : 0;
+
+    // Each sync is only good to the second the clock counts in plus the
+    // accuracy of the time it was synced to, so the fitted drift could be off
+    // by two of those over the time fitted, or by as much as it last changed
+    float syncError  = 1 + _clockDrift.syncAccuracy / 1000.0;
+    float driftError = 2 * syncError * 86400 / _clockDrift.fitSpan +
+        _clockDrift.driftChange;
+    // Compensation takes out the fitted drift, to the nearest second
+    float uncorrected = _clockDriftCompensation
+        ? 0.5
+        : fabs(_clockDrift.driftPerDay * days + _clockDrift.correction -
+               _clockDrift.syncOffset / 1000.0);
+    return syncError + uncorrected + driftError * days;
+}
+
+
+// Protected helper function - This decides if the clock is synced this
+// interval
+bool Logger::isClockSyncDue(void) {
+    if (!isRTCSane(Logger::markedEpochTime)) return true;
+    // Syncs are only ever made at noon
+    if (Logger::markedEpochTime % 86400 != 43200) return false;
+    if (!_clockDriftTracking) return true;
+
+    uint32_t utcTime = Logger::markedEpochTime -
+        static_cast<int32_t>(_loggerTimeZone) * 3600;
+    if (_clockDrift.lastSync == 0 || _clockDrift.fitSpan == 0) {
+        MS_DBG(F("Clock drift not fitted yet; syncing daily"));
+        return true;
+    }
+    if (utcTime - _clockDrift.lastSync >=
+        MS_CLOCK_SYNC_MAX_DAYS * 86400UL - 3600) {
+        return true;
+    }
+    // If waiting until tomorrow's noon would let the error pass the limit,
+    // sync now
+    float tomorrow = getPredictedClockError(Logger::markedEpochTime + 86400);
+    MS_DBG(F("Clock error predicted for tomorrow:"), tomorrow, F("s"));
+    return tomorrow > _maxClockError;
+}
+
+
+// Protected helper function - This adds a sync to the drift fit
+void Logger::updateClockDrift(uint32_t UTCEpochSeconds, int32_t offset,
+                              uint32_t accuracyMillis) {
+    if (_clockDrift.lastSync != 0 && UTCEpochSeconds > _clockDrift.lastSync) {
+        uint32_t span = UTCEpochSeconds - _clockDrift.lastSync;
+        // What the clock gained on its own is what it's ahead by now plus
+        // whatever compensation already took back
+        float gained = _clockDrift.syncOffset / 1000.0 - offset -
+            _clockDrift.correction;
+        // Syncs only hours apart say little about the drift
+        if (span >= 21600UL) {
+            float driftPerDay = gained * 86400 / span;
+            // Keep how far this stretch strayed from the fit by more than the
+            // syncs can explain, as a sign the drift itself is changing
+            if (_clockDrift.fitSpan > 0) {
+                float noise = (1 + _clockDrift.syncAccuracy / 1000.0) * 86400 /
+                    span;
+                _clockDrift.driftChange = fabs(driftPerDay -
+                                               _clockDrift.driftPerDay) -
+                    noise;
+                if (_clockDrift.driftChange < 0) _clockDrift.driftChange = 0;
+            }
+            // Weight each stretch between syncs by its length, forgetting the
+            // oldest once the fit is long enough
+            uint32_t kept = _clockDrift.fitSpan;
+            if (kept + span > MS_CLOCK_DRIFT_MAX_SPAN) {
+                kept = span < MS_CLOCK_DRIFT_MAX_SPAN
+                    ? MS_CLOCK_DRIFT_MAX_SPAN - span
+                    : 0;
+            }
+            _clockDrift.driftPerDay = (_clockDrift.driftPerDay * kept +
+                                       driftPerDay * span) /
+                (kept + span);
+            _clockDrift.fitSpan = kept + span;
+            PRINTOUT(F("Clock gained"), gained, F("s in"), span / 86400.0,
+                     F("days; fitted drift is"), _clockDrift.driftPerDay,
+                     F("s/day over"), _clockDrift.fitSpan / 86400.0,
+                     F("days"));
+        }
+    }
+    // A clock set to a whole second starts its next second then, so it is
+    // left behind by the part of the second the time had already counted
+    _clockDrift.lastSync     = UTCEpochSeconds;
+    _clockDrift.syncOffset   = offset != 0 ? 500 : 0;
+    _clockDrift.correction   = 0;
+    _clockDrift.syncAccuracy = accuracyMillis;
+    writeClockDrift();
+}
+
+
+// Protected helper function - This steps the clock to take out the drift
+// predicted since the last sync
+void Logger::compensateClockDrift(void) {
+    if (!_clockDriftCompensation || _clockDrift.lastSync == 0 ||
+        _clockDrift.fitSpan == 0) {
+        return;
+    }
+    uint32_t now = getNowEpoch();
+    // The clock wakes the logger at the top of each minute
+    if (now % 60 < 2 || now % 60 > 55) return;
+
+    uint32_t utcTime = now - static_cast<int32_t>(_loggerTimeZone) * 3600;
+    int32_t  elapsed = utcTime - _clockDrift.lastSync;
+    // How far ahead the clock should be now
+    float ahead = _clockDrift.driftPerDay * elapsed / 86400 +
+        _clockDrift.correction - _clockDrift.syncOffset / 1000.0;
+    if (fabs(ahead) <= 0.5) return;
+    int32_t step = -lround(ahead);
+
+    // Setting the clock restarts its second, so write just after it ticks to
+    // keep the part of the second already counted.  The processor idles
+    // between reads, so the clock is read at most ~110 times rather than
+    // thousands, and no more than 10ms of the second is lost.
+    uint32_t rtcEpoch = readRTCEpoch();
+    uint32_t start    = millis();
+    while (readRTCEpoch() == rtcEpoch && millis() - start < 1100L) {
+        idleProcessorUntil(millis() + 10);
+    }
+    setNowEpoch(rtcEpoch + 1 + step);
+    _clockDrift.correction += step;
+    MS_DBG(F("Stepped the clock"), step, F("s to correct for drift"));
+    writeClockDrift();
+}
+
+
+// Protected helper function - This reads the saved drift fit
+bool Logger::readClockDrift(void) {
+    if (!initializeSDCard()) return false;
+    File             driftFile;
+    clockDriftRecord saved;
+    if (!driftFile.open(MS_CLOCK_DRIFT_FILE_NAME, O_READ)) return false;
+    bool valid = driftFile.read(&saved, sizeof(saved)) == sizeof(saved) &&
+        saved.magic == MS_CLOCK_DRIFT_MAGIC &&
+        saved.crc ==
+            updateCRC32(0, &saved, offsetof(clockDriftRecord, crc));
+    driftFile.close();
+    // A record cut short by a reset just starts the fit over
+    if (!valid) return false;
+    _clockDrift = saved;
+    PRINTOUT(F("Clock drift of"), getClockDrift(), F("s/day fitted over"),
+             _clockDrift.fitSpan / 86400.0, F("days"));
+    return true;
+}
+
+
+// Protected helper function - This saves the drift fit
+bool Logger::writeClockDrift(void) {
+    // Leave the card as it was found
+    bool powered = _SDCardPowerPin < 0 || _SDCardPowered;
+    if (!powered) turnOnSDcard(true);
+    _clockDrift.magic = MS_CLOCK_DRIFT_MAGIC;
+    _clockDrift.crc   = updateCRC32(0, &_clockDrift,
+                                  offsetof(clockDriftRecord, crc));
+    File driftFile;
+    bool success = initializeSDCard() &&
+        driftFile.open(MS_CLOCK_DRIFT_FILE_NAME, O_RDWR | O_CREAT);
+    if (success) {
+        driftFile.seekSet(0);
+        success = driftFile.write(reinterpret_cast<const uint8_t*>(
+                                      &_clockDrift),
+                                  sizeof(_clockDrift)) == sizeof(_clockDrift);
+        driftFile.close();
+    }
+    if (!success) { MS_DBG(F("Unable to save the clock drift")); }
+    if (!powered) turnOffSDcard(true);
+    return success;
+}
+
+
 // This sets static variables for the date/time - this is needed so that all
 // data outputs (SD, EnviroDIY, serial printing, etc) print the same time
 // for updating the sensors - even though the routines to update the sensors
@@ -703,6 +1488,32 @@ void Logger::wakeISR(void) {
 }
 
 
+// Attaches an energy ledger and hands it to the variable array
+void Logger::attachEnergyLedger(EnergyLedger& ledger) {
+    _energyLedger = &ledger;
+    if (_internalArray != NULL) _internalArray->setEnergyLedger(&ledger);
+}
+
+
+// Closes the ledger's cycle at the start of a logging interval
+void Logger::closeEnergyCycle(void) {
+    if (_energyLedger == NULL) return;
+    uint32_t now = millis();
+    _energyLedger->addAwakeTime(now - _millisWoke);
+    _millisWoke = now;
+    if (_SDCardPowered) {
+        _energyLedger->addSDCardTime(now - _millisSDCardOn);
+        _millisSDCardOn = now;
+    }
+    if (_energyLedger->closeCycle(Logger::markedEpochTime,
+                                  _SDCardPowerPin < 0)) {
+#if defined(STANDARD_SERIAL_OUTPUT)
+        _energyLedger->printReport(&STANDARD_SERIAL_OUTPUT);
+#endif
+    }
+}
+
+
 // Puts the system to sleep to conserve battery life.
 // This DOES NOT sleep or wake the sensors!!
 void Logger::systemSleep(void) {
@@ -712,6 +1523,11 @@ void Logger::systemSleep(void) {
         return;
     }
 
+    // millis() stops while asleep, so the time awake is credited now
+    if (_energyLedger != NULL) {
+        _energyLedger->addAwakeTime(millis() - _millisWoke);
+    }
+
 #if defined MS_SAMD_DS3231 || not defined ARDUINO_ARCH_SAMD
 
     // Unfortunately, because of the way the alarm on the DS3231 is set up, it
@@ -926,6 +1742,10 @@ void Logger::systemSleep(void) {
     zero_sleep_rtc.disableAlarm();
 #endif
 
+    // millis() didn't count while asleep, so the clock must be read again
+    resetClockCache();
+    _millisWoke = millis();
+
     // Wake-up message
     MS_DBG(F("\n\n\n... zzzZZ Processor is now awake!"));
 
@@ -940,26 +1760,117 @@ void Logger::systemSleep(void) {
 
 // This sets a file name, if you want to decide on it in advance
 void Logger::setFileName(String& fileName) {
-    _fileName = fileName;
+    setFileName(fileName.c_str());
 }
 // Same as above, with a character array (overload function)
 void Logger::setFileName(const char* fileName) {
-    String StrName = String(fileName);
-    setFileName(StrName);
+    // Any buffered records not yet written will go to the new file
+    if (logFile.isOpen()) logFile.close();
+    if (strlen(fileName) > MS_MAX_FILE_NAME_LENGTH) {
+        PRINTOUT(F("File name is too long; using the first"),
+                 MS_MAX_FILE_NAME_LENGTH, F("characters"));
+    }
+    strncpy(_fileName, fileName, MS_MAX_FILE_NAME_LENGTH);
+    _fileName[MS_MAX_FILE_NAME_LENGTH] = '\0';
+    // The end of the data in the new file isn't known until it's opened
+    _fileDataEnd     = 0;
+    _lastAppendBytes = 0;
+}
+
+
+// Sets/Gets the layout of the files on the SD card
+void Logger::setLogFileFormat(logFileFormat format) {
+    _logFileFormat = format;
+}
+logFileFormat Logger::getLogFileFormat(void) {
+    return _logFileFormat;
 }
 
 
 // This generates a file name from the logger id and the current date
 // This will be used if the setFileName function is not called before
 // the begin() function is called.
-void Logger::generateAutoFileName(void) {
+void Logger::generateAutoFileName(uint32_t epochTime) {
     // Generate the file name from logger ID and date
-    String fileName = String(_loggerID);
-    fileName += "_";
-    fileName += formatDateTime_ISO8601(getNowEpoch()).substring(0, 10);
-    fileName += ".csv";
+    char   fileName[MS_MAX_LOGGER_ID_LENGTH + ISO8601_BUFFER_SIZE + 5];
+    size_t idLength = strlen(_loggerID);
+    if (idLength > MS_MAX_LOGGER_ID_LENGTH) {
+        PRINTOUT(F("Logger ID is too long for the file name; using the first"),
+                 MS_MAX_LOGGER_ID_LENGTH, F("characters"));
+        idLength = MS_MAX_LOGGER_ID_LENGTH;
+    }
+    memcpy(fileName, _loggerID, idLength);
+    fileName[idLength] = '_';
+    char*    date      = fileName + idLength + 1;
+    uint32_t now  = epochTime != 0 ? epochTime : getNowEpoch();
+    DateTime dt   = dtFromEpoch(now);
+    char*    end  = writeDateTimeChars(dt, date, '_');
+    switch (_logRotation) {
+        // Keep only the YYYY-MM of the date
+        case LOG_ROTATE_MONTHLY: end = date + 7; break;
+        // Keep the date and the time, leaving out the colons FAT can't use
+        case LOG_ROTATE_BY_SIZE:
+            end = writeTwoDigits(date + 11, dt.hour());
+            end = writeTwoDigits(end, dt.minute());
+            end = writeTwoDigits(end, dt.second());
+            break;
+        // Keep only the YYYY-MM-DD of the date
+        default: end = date + 10; break;
+    }
+    strcpy(end, _logFileFormat == LOG_FILE_BINARY ? ".bin" : ".csv");
     setFileName(fileName);
-    _fileName = fileName;
+    _filePeriod = getRotationPeriod(now);
+}
+
+
+// Sets/Gets the rotation policy for the data files
+void Logger::setLogRotation(logRotation rotation, uint32_t fileBytes) {
+    _logRotation = rotation;
+    _fileBytes   = fileBytes;
+}
+logRotation Logger::getLogRotation(void) {
+    return _logRotation;
+}
+
+
+// Protected helper function - This gets the day or month a file belongs to
+uint32_t Logger::getRotationPeriod(uint32_t epochTime) {
+    DateTime dt     = dtFromEpoch(epochTime);
+    uint32_t period = dt.year() * 100UL + dt.month();
+    if (_logRotation == LOG_ROTATE_DAILY) period = period * 100 + dt.date();
+    return period;
+}
+
+
+// Protected helper function - This checks if a record is for a new day or month
+bool Logger::isRotationPeriodOver(uint32_t epochTime) {
+    if (_logRotation != LOG_ROTATE_DAILY && _logRotation != LOG_ROTATE_MONTHLY)
+        return false;
+    return getRotationPeriod(epochTime) != _filePeriod;
+}
+
+
+// Protected helper function - This checks if the current file is full
+bool Logger::isLogFileFull(void) {
+    // Assume the next write will be about the size of the last one
+    return _logRotation == LOG_ROTATE_BY_SIZE && _fileBytes > 0 &&
+        _fileDataEnd + _lastAppendBytes > _fileBytes;
+}
+
+
+// Protected helper function - This finishes one file and names the next
+void Logger::rotateLogFile(uint32_t epochTime) {
+    if (_fileName[0] != '\0') {
+        MS_DBG(F("Finished with log file"), _fileName);
+        // Give back the reserved space the data never reached
+        if (_fileBytes > 0 && _fileDataEnd > 0 &&
+            (logFile.isOpen() || openFile(_fileName, false, false)) &&
+            _fileDataEnd < logFile.fileSize()) {
+            logFile.truncate(_fileDataEnd);
+        }
+        if (logFile.isOpen()) logFile.close();
+    }
+    generateAutoFileName(epochTime);
 }
 
 
@@ -968,7 +1879,7 @@ void Logger::generateAutoFileName(void) {
  *
  * THIS IS NOT A FUNCTION, it is a pre-processor macro
  */
-#define STREAM_CSV_ROW(firstCol, function)                       \
+#define STREAM_CSV_ROW(firstCol, function, journalCols)          \
     stream->print("\"");                                         \
     stream->print(firstCol);                                     \
     stream->print("\",");                                        \
@@ -978,6 +1889,7 @@ void Logger::generateAutoFileName(void) {
         stream->print("\"");                                     \
         if (i + 1 != getArrayVarCount()) { stream->print(","); } \
     }                                                            \
+    if (_journalEnabled) { stream->print(journalCols); }         \
     stream->println();
 
 // This sends a file header out over an Arduino stream
@@ -999,42 +1911,161 @@ void Logger::printFileHeader(Stream* stream) {
     }
 
     // Next line will be the parent sensor names
-    STREAM_CSV_ROW(F("Sensor Name:"), getParentSensorNameAtI(i))
+    // The record journal adds a record number and a CRC to the end of each
+    // row
+    STREAM_CSV_ROW(F("Sensor Name:"), getParentSensorNameCharsAtI(i),
+                   F(",\"Logger\",\"Logger\""))
     // Next comes the ODM2 variable name
-    STREAM_CSV_ROW(F("Variable Name:"), getVarNameAtI(i))
+    STREAM_CSV_ROW(F("Variable Name:"), getVarNameCharsAtI(i),
+                   F(",\"Record Number\",\"Record CRC32\""))
     // Next comes the ODM2 unit name
-    STREAM_CSV_ROW(F("Result Unit:"), getVarUnitAtI(i))
+    STREAM_CSV_ROW(F("Result Unit:"), getVarUnitCharsAtI(i),
+                   F(",\"count\",\"dimensionless\""))
     // Next comes the variable UUIDs
     // We'll only add UUID's if we see a UUID for the first variable
-    if (getVarUUIDAtI(0).length() > 1) {
-        STREAM_CSV_ROW(F("Result UUID:"), getVarUUIDAtI(i))
+    if (strlen(getVarUUIDCharsAtI(0)) > 1) {
+        STREAM_CSV_ROW(F("Result UUID:"), getVarUUIDCharsAtI(i),
+                       F(",\"\",\"\""))
     }
 
     // We'll finish up the the custom variable codes
-    String dtRowHeader = F("Date and Time in UTC");
+    char dtRowHeader[25] = "Date and Time in UTC";
     if (_loggerTimeZone > 0) {
-        dtRowHeader += '+' + _loggerTimeZone;
-    } else if (_loggerTimeZone < 0) {
-        dtRowHeader += _loggerTimeZone;
+        strcat(dtRowHeader, "+");
     }
-    STREAM_CSV_ROW(dtRowHeader, getVarCodeAtI(i));
+    if (_loggerTimeZone != 0) {
+        itoa(_loggerTimeZone, dtRowHeader + strlen(dtRowHeader), 10);
+    }
+    STREAM_CSV_ROW(dtRowHeader, getVarCodeCharsAtI(i),
+                   F(",\"RecordNumber\",\"RecordCRC32\""));
 }
 
 
 // This prints a comma separated list of volues of sensor data - including the
 // time -  out over an Arduino stream
 void Logger::printSensorDataCSV(Stream* stream) {
-    String csvString = "";
-    dtFromEpoch(Logger::markedEpochTime).addToString(csvString);
-    csvString += ',';
-    stream->print(csvString);
+    char     dateTimeChars[ISO8601_BUFFER_SIZE];
+    DateTime markedDateTime = dtFromEpoch(Logger::markedEpochTime);
+    writeDateTimeChars(markedDateTime, dateTimeChars, ' ');
+    // The CRC is only worked out when it is printed, with the record journal
+    // on
+    uint32_t crc = 0;
+    stream->print(dateTimeChars);
+    if (_journalEnabled) {
+        crc = updateCRC32(crc, dateTimeChars, strlen(dateTimeChars));
+    }
     for (uint8_t i = 0; i < getArrayVarCount(); i++) {
-        stream->print(getValueStringAtI(i));
-        if (i + 1 != getArrayVarCount()) { stream->print(','); }
+        const char* value = getValueCharsAtI(i);
+        stream->print(',');
+        stream->print(value);
+        if (_journalEnabled) {
+            crc = updateCRC32(crc, ",", 1);
+            crc = updateCRC32(crc, value, strlen(value));
+        }
+    }
+    if (_journalEnabled) {
+        // The CRC covers everything before the comma in front of it,
+        // including the record number
+        char number[11];
+        ultoa(_recordSequence, number, 10);
+        writeWithCRC32(stream, ",", 1, crc);
+        writeWithCRC32(stream, number, strlen(number), crc);
+        // Always 8 digits, so the line length doesn't depend on the CRC
+        char hex[10] = ",";
+        for (uint8_t i = 0; i < 8; i++) {
+            hex[i + 1] = "0123456789ABCDEF"[(crc >> (28 - 4 * i)) & 0x0F];
+        }
+        hex[9] = '\0';
+        stream->print(hex);
     }
     stream->println();
 }
 
+
+// This writes the header of a binary file, describing every variable so the
+// file can be converted without the logger program that wrote it
+void Logger::printBinaryFileHeader(Stream* stream) {
+    uint32_t crc           = 0;
+    uint8_t  version       = MS_BINARY_LOG_VERSION;
+    uint8_t  variableCount = getArrayVarCount();
+    int8_t   timeZone      = _loggerTimeZone;
+    // The epoch time and the CRC plus a float per variable
+    uint16_t recordSize = 8 + 4 * static_cast<uint16_t>(variableCount);
+    // The record journal adds the record number
+    if (_journalEnabled) {
+        version = MS_BINARY_LOG_VERSION_JOURNAL;
+        recordSize += 4;
+    }
+
+    writeWithCRC32(stream, MS_BINARY_LOG_MAGIC, 4, crc);
+    writeWithCRC32(stream, &version, 1, crc);
+    writeWithCRC32(stream, &variableCount, 1, crc);
+    writeWithCRC32(stream, &timeZone, 1, crc);
+    writeWithCRC32(stream, &recordSize, 2, crc);
+
+    writeStringWithCRC32(stream, _loggerID, crc);
+    writeStringWithCRC32(stream, _fileName, crc);
+    writeStringWithCRC32(stream, _samplingFeatureUUID, crc);
+
+    for (uint8_t i = 0; i < variableCount; i++) {
+        Variable* var        = _internalArray->arrayOfVars[i];
+        uint8_t   resolution = var->getResolution();
+        writeWithCRC32(stream, &resolution, 1, crc);
+        // The names and units only exist as Strings, but this is only done
+        // once for each new file
+        writeStringWithCRC32(stream, var->getParentSensorName().c_str(), crc);
+        writeStringWithCRC32(stream, var->getVarName().c_str(), crc);
+        writeStringWithCRC32(stream, var->getVarUnit().c_str(), crc);
+        writeStringWithCRC32(stream, var->getVarUUIDChars(), crc);
+        writeStringWithCRC32(stream, var->getVarCodeChars(), crc);
+    }
+
+    stream->write(reinterpret_cast<const uint8_t*>(&crc), 4);
+}
+
+
+// This writes one fixed-width record of the unformatted values
+// NOTE:  Both AVR and SAMD boards are little-endian, so the bytes of each
+// number can be written straight from memory.
+void Logger::writeBinaryRecord(Stream* stream) {
+    uint32_t crc = 0;
+    writeWithCRC32(stream, &Logger::markedEpochTime, 4, crc);
+    if (_journalEnabled) writeWithCRC32(stream, &_recordSequence, 4, crc);
+    for (uint8_t i = 0; i < getArrayVarCount(); i++) {
+        float value = _internalArray->arrayOfVars[i]->getValue();
+        writeWithCRC32(stream, &value, 4, crc);
+    }
+    stream->write(reinterpret_cast<const uint8_t*>(&crc), 4);
+}
+
+
+// Protected helper function - The standard reflected CRC-32, one bit at a time
+uint32_t Logger::updateCRC32(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc                  = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+
+// Protected helper function - This writes bytes and checksums them
+void Logger::writeWithCRC32(Stream* stream, const void* data, size_t length,
+                            uint32_t& crc) {
+    stream->write(static_cast<const uint8_t*>(data), length);
+    crc = updateCRC32(crc, data, length);
+}
+void Logger::writeStringWithCRC32(Stream* stream, const char* text,
+                                  uint32_t& crc) {
+    if (text == NULL) text = "";
+    writeWithCRC32(stream, text, strlen(text) + 1, crc);
+}
+
+
 // Protected helper function - This checks if the SD card is available and ready
 bool Logger::initializeSDCard(void) {
     // If we don't know the slave select of the sd card, we can't use it
@@ -1060,46 +2091,50 @@ bool Logger::initializeSDCard(void) {
 
 // Protected helper function - This sets a timestamp on a file
 void Logger::setFileTimestamp(File fileToStamp, uint8_t stampFlag) {
-    fileToStamp.timestamp(
-        stampFlag, dtFromEpoch(getNowEpoch()).year(),
-        dtFromEpoch(getNowEpoch()).month(), dtFromEpoch(getNowEpoch()).date(),
-        dtFromEpoch(getNowEpoch()).hour(), dtFromEpoch(getNowEpoch()).minute(),
-        dtFromEpoch(getNowEpoch()).second());
+    DateTime now = dtFromEpoch(getNowEpoch());
+    fileToStamp.timestamp(stampFlag, now.year(), now.month(), now.date(),
+                          now.hour(), now.minute(), now.second());
 }
 
 
-// Protected helper function - This opens or creates a file, converting a string
-// file name to a character file name
-bool Logger::openFile(String& filename, bool createFile,
+// Protected helper function - This opens or creates a file
+bool Logger::openFile(const char* filename, bool createFile,
                       bool writeDefaultHeader) {
     // Initialise the SD card
     // skip everything else if there's no SD card, otherwise it might hang
     if (!initializeSDCard()) return false;
 
-    // Convert the string filename to a character file name for SdFat
-    uint8_t fileNameLength = filename.length() + 1;
-    char    charFileName[fileNameLength];
-    filename.toCharArray(charFileName, fileNameLength);
+    // Let go of any file held open for the log buffer
+    if (logFile.isOpen()) logFile.close();
 
     // First attempt to open an already existing file (in write mode), so we
     // don't try to re-create something that's already there.
     // This should also prevent the header from being written over and over
     // in the file.
-    if (logFile.open(charFileName, O_WRITE | O_AT_END)) {
+    if (logFile.open(filename, O_WRITE | O_AT_END)) {
         MS_DBG(F("Opened existing file:"), filename);
         // Set access date time
         setFileTimestamp(logFile, T_ACCESS);
         return true;
     } else if (createFile) {
-        // Create and then open the file in write mode
-        if (logFile.open(charFileName, O_CREAT | O_WRITE | O_AT_END)) {
+        // Create and then open the file in write mode, reserving the space
+        // for the logger's own data file if requested
+        bool preallocated = _fileBytes > 0 &&
+            strcmp(filename, _fileName) == 0 &&
+            createPreallocatedFile(filename, _fileBytes);
+        if (preallocated ||
+            logFile.open(filename, O_CREAT | O_WRITE | O_AT_END)) {
             MS_DBG(F("Created new file:"), filename);
             // Set creation date time
             setFileTimestamp(logFile, T_CREATE);
             // Write out a header, if requested
             if (writeDefaultHeader) {
                 // Add header information
-                printFileHeader(&logFile);
+                if (_logFileFormat == LOG_FILE_BINARY) {
+                    printBinaryFileHeader(&logFile);
+                } else {
+                    printFileHeader(&logFile);
+                }
 // Print out the header for debugging
 #if defined DEBUGGING_SERIAL_OUTPUT && defined MS_DEBUGGING_STD
                 MS_DBG(F("\n \\/---- File Header ----\\/"));
@@ -1133,7 +2168,7 @@ bool Logger::openFile(String& filename, bool createFile,
 // specified, it will also write a header to the file based on the sensors in
 // the group. This can be used to force a logger to create a file with a
 // secondary file name.
-bool Logger::createLogFile(String& filename, bool writeDefaultHeader) {
+bool Logger::createLogFile(const char* filename, bool writeDefaultHeader) {
     // Attempt to create and open a file
     if (openFile(filename, true, writeDefaultHeader)) {
         // Close the file to save it (only do this if we'd opened it)
@@ -1146,8 +2181,11 @@ bool Logger::createLogFile(String& filename, bool writeDefaultHeader) {
         return false;
     }
 }
+bool Logger::createLogFile(String& filename, bool writeDefaultHeader) {
+    return createLogFile(filename.c_str(), writeDefaultHeader);
+}
 bool Logger::createLogFile(bool writeDefaultHeader) {
-    if (_fileName == "") generateAutoFileName();
+    if (_fileName[0] == '\0') generateAutoFileName();
     return createLogFile(_fileName, writeDefaultHeader);
 }
 
@@ -1158,7 +2196,7 @@ bool Logger::createLogFile(bool writeDefaultHeader) {
 // setFileName(String)/setFileName(void) or can be specified in the function. If
 // the file does not already exist, the file will be created. This can be used
 // to force a logger to write to a file with a secondary file name.
-bool Logger::logToSD(String& filename, String& rec) {
+bool Logger::logToSD(const char* filename, String& rec) {
     // First attempt to open the file without creating a new one
     if (!openFile(filename, false, false)) {
         // Next try to create the file, bail if we couldn't create it
@@ -1184,31 +2222,75 @@ bool Logger::logToSD(String& filename, String& rec) {
     logFile.close();
     return true;
 }
+bool Logger::logToSD(String& filename, String& rec) {
+    return logToSD(filename.c_str(), rec);
+}
 bool Logger::logToSD(String& rec) {
     // Get a new file name if the name is blank
-    if (_fileName == "") generateAutoFileName();
+    if (_fileName[0] == '\0') generateAutoFileName();
     return logToSD(_fileName, rec);
 }
 // NOTE:  This is structured differently than the version with a string input
 // record.  This is to avoid the creation/passing of very long strings.
 bool Logger::logToSD(void) {
-    // Get a new file name if the name is blank
-    if (_fileName == "") generateAutoFileName();
+    // Number every record, whether or not it is ever written
+    if (_journalEnabled) _recordSequence++;
+
+    // A record from a new day or month starts a new file, but only once the
+    // records from the old one held in the log buffer are written to it.  If
+    // they can't be written they stay in the buffer with this record and the
+    // change is tried again with the next one.
+    uint32_t recordEpoch = Logger::markedEpochTime != 0
+        ? Logger::markedEpochTime
+        : getNowEpoch();
+    if (isRotationPeriodOver(recordEpoch) && flushLogBuffer()) {
+        rotateLogFile(recordEpoch);
+    }
 
-    // First attempt to open the file without creating a new one
-    if (!openFile(_fileName, false, false)) {
-        // Next try to create a new file, bail if we couldn't create it
-        // Generate a filename with the current date, if the file name isn't set
-        if (_fileName == "") generateAutoFileName();
-        // Do add a default header to the new file!
-        if (!openFile(_fileName, true, true)) {
-            PRINTOUT(F("Unable to write to SD card!"));
-            return false;
+    // Hold the record in RAM if there's a log buffer
+    if (_recordsPerFlush > 0) {
+        // Make room first if the buffer may not hold another record
+        if (_logBuffer.getFree() < _largestRecord) flushLogBuffer();
+
+        uint16_t waiting = _logBuffer.available();
+        writeLogRecord(&_logBuffer);
+        if (_logBuffer.hasOverflowed()) {
+            // Drop the partial record, write out what was already waiting,
+            // and then write this record straight to the file
+            MS_DBG(F("Record does not fit in the log buffer!"));
+            _logBuffer.truncate(waiting);
+            if (!flushLogBuffer() || !openLogFile()) return false;
+            writeLogRecord(&logFile);
+            markLogFileEnd();
+            logFile.sync();
+            if (_journalEnabled) {
+                updateLogJournal(_fileName, _fileDataEnd, _recordSequence);
+            }
+        } else {
+            _bufferedRecords++;
+            uint16_t recordSize = _logBuffer.available() - waiting;
+            if (recordSize > _largestRecord) _largestRecord = recordSize;
         }
+// Echo the line to the serial port
+#if defined(STANDARD_SERIAL_OUTPUT)
+        PRINTOUT(F("\n \\/---- Line Saved to Log Buffer ----\\/"));
+        printSensorDataCSV(&STANDARD_SERIAL_OUTPUT);
+        PRINTOUT('\n');
+#endif
+
+        if (_bufferedRecords >= _recordsPerFlush ||
+            (_flushBytes > 0 && _logBuffer.available() >= _flushBytes) ||
+            isBatteryLow()) {
+            return flushLogBuffer();
+        }
+        return true;
     }
 
+    if (!openLogFile()) return false;
+
     // Write the data
-    printSensorDataCSV(&logFile);
+    writeLogRecord(&logFile);
+    markLogFileEnd();
 // Echo the line to the serial port
 #if defined(STANDARD_SERIAL_OUTPUT)
     PRINTOUT(F("\n \\/---- Line Saved to SD Card ----\\/"));
@@ -1223,10 +2305,453 @@ bool Logger::logToSD(void) {
     // Close the file to save it
     // logFile.sync();
     logFile.close();
+    // Only note the new end once the record is safely on the card
+    if (_journalEnabled) {
+        updateLogJournal(_fileName, _fileDataEnd, _recordSequence);
+    }
+    return true;
+}
+
+
+// Sets up the RAM buffer for batching records
+void Logger::setLogBuffer(uint8_t* buffer, uint16_t bufferSize,
+                          uint8_t recordsPerFlush, uint16_t flushBytes) {
+    // Don't strand anything already waiting in the old buffer
+    flushLogBuffer();
+    _logBuffer.begin(buffer, bufferSize);
+    _recordsPerFlush = buffer == NULL ? 0 : recordsPerFlush;
+    _flushBytes      = flushBytes;
+    _bufferedRecords = 0;
+    _largestRecord   = 0;
+}
+
+
+// This writes everything in the log buffer to the (held open) file
+bool Logger::flushLogBuffer(void) {
+    if (_logBuffer.available() == 0) return true;
+
+    // The card is only powered for the write when records are buffered
+    if (_SDCardPowerPin >= 0 && !_SDCardPowered) turnOnSDcard(true);
+    if (!openLogFile()) return false;
+
+    MS_DBG(F("Writing"), _bufferedRecords, F("buffered records,"),
+           _logBuffer.available(), F("bytes, to"), _fileName);
+    _logBuffer.writeTo(&logFile);
+    markLogFileEnd();
+    _bufferedRecords = 0;
+
+    // Set write/modification date time
+    setFileTimestamp(logFile, T_WRITE);
+    // Set access date time
+    setFileTimestamp(logFile, T_ACCESS);
+    // Commit the data and the directory entry, but keep the file open for the
+    // next batch
+    logFile.sync();
+    if (_journalEnabled) {
+        updateLogJournal(_fileName, _fileDataEnd, _recordSequence);
+    }
+    return true;
+}
+
+
+// Sets a battery variable that will force records to be written right away
+void Logger::setLowBatteryFlush(Variable* batteryVar, float minimumLevel) {
+    _lowBatteryVar   = batteryVar;
+    _lowBatteryLevel = minimumLevel;
+}
+
+
+// Protected helper function - This checks the battery variable
+bool Logger::isBatteryLow(void) {
+    if (_lowBatteryVar == NULL) return false;
+    float level = _lowBatteryVar->getValue();
+    return level != -9999 && level < _lowBatteryLevel;
+}
+
+
+// Protected helper function - This writes a record in the chosen layout
+void Logger::writeLogRecord(Stream* stream) {
+    if (_logFileFormat == LOG_FILE_BINARY) {
+        writeBinaryRecord(stream);
+    } else {
+        printSensorDataCSV(stream);
+    }
+}
+
+
+// Protected helper function - This opens the current log file for appending
+bool Logger::openLogFile(void) {
+    // Move on to a new file first if this one is full; new days and months
+    // are handled by logToSD(), by the time of each record
+    if (isLogFileFull()) rotateLogFile(getNowEpoch());
+
+    // A file kept open between batches doesn't need the card re-started
+    if (logFile.isOpen()) return true;
+
+    // Get a new file name if the name is blank
+    if (_fileName[0] == '\0') generateAutoFileName();
+
+    // First attempt to open the file without creating a new one
+    if (openFile(_fileName, false, false)) {
+        // Append after the data, not after the space reserved for it
+        if (_fileBytes > 0) {
+            if (_fileDataEnd == 0) _fileDataEnd = findLogFileDataEnd();
+            logFile.seekSet(_fileDataEnd);
+        }
+    } else {
+        // Journal the new file before its header is written, so a header cut
+        // short can be recognized and the file started over
+        logJournalEntry lastEntry;
+        uint32_t        lastSequence = 0;
+        if (_journalEnabled) {
+            if (readLogJournal(lastEntry)) lastSequence = lastEntry.sequence;
+            updateLogJournal(_fileName, 0, lastSequence);
+        }
+        // Next try to create a new file, bail if we couldn't create it
+        // Do add a default header to the new file!
+        if (!openFile(_fileName, true, true)) {
+            PRINTOUT(F("Unable to write to SD card!"));
+            return false;
+        }
+        if (_journalEnabled) {
+            logFile.sync();
+            updateLogJournal(_fileName, logFile.curPosition(),
+                             lastSequence);
+        }
+    }
+    _fileDataEnd = logFile.curPosition();
+    return true;
+}
+
+
+// Protected helper function - This notes where the data now ends
+void Logger::markLogFileEnd(void) {
+    uint32_t dataEnd = logFile.curPosition();
+    _lastAppendBytes = dataEnd - _fileDataEnd;
+    _fileDataEnd     = dataEnd;
+}
+
+
+// Protected helper function - This creates a file with all of its clusters
+// allocated up front.  The clusters are erased so the end of the data can be
+// found again after a restart.
+bool Logger::createPreallocatedFile(const char* fileName, uint32_t fileBytes) {
+    uint32_t firstBlock;
+    uint32_t lastBlock;
+    if (!logFile.createContiguous(fileName, fileBytes)) {
+        MS_DBG(F("Unable to reserve"), fileBytes, F("bytes for"), fileName);
+        return false;
+    }
+    if (!logFile.contiguousRange(&firstBlock, &lastBlock) ||
+        !sd.card()->erase(firstBlock, lastBlock)) {
+        MS_DBG(F("Unable to erase the space reserved for"), fileName);
+        logFile.remove();
+        return false;
+    }
+    MS_DBG(F("Reserved"), fileBytes, F("contiguous bytes for"), fileName);
     return true;
 }
 
 
+// Protected helper function - This finds where the data stops and the erased
+// space starts.  Only the bytes needed for a binary search are read.
+uint32_t Logger::findLogFileDataEnd(void) {
+    uint32_t dataEnd = logFile.fileSize();
+    File     reader;
+    if (dataEnd == 0 || !reader.open(_fileName, O_READ)) {
+        return dataEnd;
+    }
+
+    // A file that doesn't end in erased space has nothing to search
+    reader.seekSet(dataEnd - 1);
+    int lastByte = reader.read();
+    if (lastByte != 0x00 && lastByte != 0xFF) {
+        reader.close();
+        return dataEnd;
+    }
+
+    if (_logFileFormat == LOG_FILE_BINARY) {
+        // Skip the header: the fixed fields, the three strings about the
+        // file, a resolution and five strings per variable, and the CRC
+        uint8_t fixed[9];
+        reader.seekSet(0);
+        reader.read(fixed, sizeof(fixed));
+        uint16_t recordSize = fixed[7] | (fixed[8] << 8);
+        uint16_t strings    = 3 + 5 * static_cast<uint16_t>(fixed[5]);
+        while (strings > 0) {
+            int c = reader.read();
+            if (c < 0) break;
+            // The resolution byte comes before each variable's strings
+            if (c == 0 && --strings > 0 && (strings % 5) == 0) reader.read();
+        }
+        uint32_t headerEnd = reader.curPosition() + 4;
+
+        // Search for the first record whose CRC doesn't match its contents
+        uint32_t low  = 0;
+        uint32_t high = recordSize < 8 || dataEnd < headerEnd
+            ? 0
+            : (dataEnd - headerEnd) / recordSize;
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            reader.seekSet(headerEnd + mid * recordSize);
+            uint32_t crc = 0;
+            for (uint16_t i = 0; i < recordSize - 4; i++) {
+                uint8_t c = reader.read();
+                crc       = updateCRC32(crc, &c, 1);
+            }
+            uint32_t storedCRC = 0;
+            reader.read(&storedCRC, 4);
+            if (crc == storedCRC) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        dataEnd = headerEnd + low * recordSize;
+    } else {
+        // Search for the first erased byte; text never contains either value
+        uint32_t low  = 0;
+        uint32_t high = dataEnd - 1;
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            reader.seekSet(mid);
+            int c = reader.read();
+            if (c == 0x00 || c == 0xFF) {
+                high = mid;
+            } else {
+                low = mid + 1;
+            }
+        }
+        dataEnd = low;
+    }
+    reader.close();
+    MS_DBG(F("Data in"), _fileName, F("ends at byte"), dataEnd);
+    return dataEnd;
+}
+
+
+// Turns the record journal on or off
+void Logger::setLogJournal(bool enable) {
+    _journalEnabled = enable;
+}
+
+
+// This checks the records written after the last journal entry and cuts off
+// any partial record left by a reset or power loss part way through a write
+bool Logger::recoverLogFile(void) {
+    logJournalEntry entry;
+    if (!initializeSDCard() || !readLogJournal(entry)) {
+        MS_DBG(F("No record journal to recover from"));
+        return false;
+    }
+
+    File dataFile;
+    if (!dataFile.open(entry.fileName, O_RDWR)) {
+        MS_DBG(F("Unable to open journaled file"), entry.fileName);
+        return false;
+    }
+    uint32_t fileSize = dataFile.fileSize();
+
+    // A file journaled before its header was finished has no records, so
+    // it's simplest to start it over
+    if (entry.dataEnd == 0) {
+        MS_DBG(F("Removing unfinished file"), entry.fileName);
+        dataFile.remove();
+        _recordSequence = entry.sequence;
+        return true;
+    }
+
+    // Binary records are all the size given in the file header, which may
+    // differ from what the current variable array would write
+    uint16_t recordSize = 0;
+    uint8_t  fixed[9];
+    dataFile.seekSet(0);
+    if (dataFile.read(fixed, sizeof(fixed)) == sizeof(fixed) &&
+        memcmp(fixed, MS_BINARY_LOG_MAGIC, 4) == 0) {
+        if (fixed[4] != MS_BINARY_LOG_VERSION_JOURNAL) {
+            MS_DBG(F("Journaled file"), entry.fileName,
+                   F("does not have numbered records"));
+            dataFile.close();
+            return false;
+        }
+        recordSize = fixed[7] | (fixed[8] << 8);
+    }
+
+    // Everything before the journal entry was synced, so only the records
+    // after it need to be checked
+    uint32_t dataEnd  = entry.dataEnd;
+    uint32_t sequence = entry.sequence;
+    uint16_t recordLength;
+    dataFile.seekSet(dataEnd);
+    while (dataEnd < fileSize &&
+           (recordLength = checkJournalRecord(dataFile, recordSize,
+                                              sequence)) > 0) {
+        dataEnd += recordLength;
+    }
+
+    if (dataEnd < fileSize) {
+        if (_fileBytes > 0) {
+            // Zero the partial record so the search for the erased space
+            // still finds the end of the data
+            dataFile.seekSet(dataEnd);
+            uint16_t maxLength = recordSize > 0 ? recordSize
+                                                : MS_JOURNAL_MAX_RECORD_LENGTH;
+            uint32_t blankEnd  = dataEnd;
+            while (blankEnd < fileSize && blankEnd - dataEnd < maxLength) {
+                int c = dataFile.read();
+                if (recordSize == 0 && (c == 0x00 || c == 0xFF)) break;
+                blankEnd++;
+            }
+            dataFile.seekSet(dataEnd);
+            for (uint32_t i = dataEnd; i < blankEnd; i++) {
+                dataFile.write(static_cast<uint8_t>(0));
+            }
+            MS_DBG(F("Cleared"), blankEnd - dataEnd, F("bytes after byte"),
+                   dataEnd, F("of"), entry.fileName);
+        } else {
+            dataFile.truncate(dataEnd);
+            MS_DBG(F("Cut"), entry.fileName, F("off at byte"), dataEnd);
+        }
+    }
+    dataFile.close();
+
+    // Carry on from the last whole record
+    _recordSequence = sequence;
+    if (strcmp(_fileName, entry.fileName) == 0) _fileDataEnd = dataEnd;
+    updateLogJournal(entry.fileName, dataEnd, sequence);
+    PRINTOUT(F("Log file"), entry.fileName, F("is good through record"),
+             sequence);
+    return true;
+}
+
+
+// Protected helper function - This writes the journal, alternating between
+// two blocks so an entry cut short never damages the previous one
+bool Logger::updateLogJournal(const char* fileName, uint32_t dataEnd,
+                              uint32_t sequence) {
+    logJournalEntry entry;
+    // Pick up the count and the slot of the newest entry on the card before
+    // writing over the older one
+    if (_journalWriteCount == 0) readLogJournal(entry);
+    memset(&entry, 0, sizeof(entry));
+    entry.magic      = MS_JOURNAL_MAGIC;
+    entry.writeCount = ++_journalWriteCount;
+    entry.sequence   = sequence;
+    entry.dataEnd    = dataEnd;
+    strncpy(entry.fileName, fileName, sizeof(entry.fileName) - 1);
+    entry.crc = updateCRC32(0, &entry, offsetof(logJournalEntry, crc));
+
+    File journal;
+    if (!journal.open(MS_JOURNAL_FILE_NAME, O_RDWR | O_CREAT)) {
+        MS_DBG(F("Unable to open the record journal"));
+        return false;
+    }
+    _journalSlot    = !_journalSlot;
+    uint32_t offset = _journalSlot * 512UL;
+    // A new journal has to be grown to reach the second block
+    journal.seekEnd();
+    while (journal.curPosition() < offset) {
+        journal.write(static_cast<uint8_t>(0));
+    }
+    journal.seekSet(offset);
+    journal.write(reinterpret_cast<const uint8_t*>(&entry), sizeof(entry));
+    journal.close();
+    return true;
+}
+
+
+// Protected helper function - This reads whichever journal entry is newer
+bool Logger::readLogJournal(logJournalEntry& entry) {
+    File journal;
+    if (!journal.open(MS_JOURNAL_FILE_NAME, O_READ)) return false;
+
+    bool found = false;
+    for (uint8_t slot = 0; slot < 2; slot++) {
+        logJournalEntry slotEntry;
+        journal.seekSet(slot * 512UL);
+        if (journal.read(&slotEntry, sizeof(slotEntry)) != sizeof(slotEntry) ||
+            slotEntry.magic != MS_JOURNAL_MAGIC ||
+            slotEntry.crc != updateCRC32(0, &slotEntry,
+                                         offsetof(logJournalEntry, crc))) {
+            continue;
+        }
+        // The record number does not change when a new file is started, so
+        // only the write count tells which entry came last
+        if (!found ||
+            static_cast<int32_t>(slotEntry.writeCount - entry.writeCount) >
+                0) {
+            entry              = slotEntry;
+            _journalSlot       = slot;
+            _journalWriteCount = slotEntry.writeCount;
+            found              = true;
+        }
+    }
+    journal.close();
+    // Make sure the name is terminated even if the entry was not written by
+    // this version of the library
+    entry.fileName[sizeof(entry.fileName) - 1] = '\0';
+    return found;
+}
+
+
+// Protected helper function - This checks the CRC of one record.  A text
+// record ends with ",<record number>,<CRC-32 in hex>" and the CRC covers
+// everything before the last comma.
+uint16_t Logger::checkJournalRecord(File& file, uint16_t recordSize,
+                                    uint32_t& sequence) {
+    uint32_t crc = 0;
+    if (recordSize > 0) {
+        uint32_t recordNumber = 0;
+        for (uint16_t i = 0; i + 4 < recordSize; i++) {
+            int c = file.read();
+            if (c < 0) return 0;
+            uint8_t byte = c;
+            crc          = updateCRC32(crc, &byte, 1);
+            // The record number follows the four bytes of the time
+            if (i >= 4 && i < 8) {
+                recordNumber |= static_cast<uint32_t>(byte) << (8 * (i - 4));
+            }
+        }
+        uint32_t storedCRC = 0;
+        if (file.read(&storedCRC, 4) != 4 || storedCRC != crc) return 0;
+        sequence = recordNumber;
+        return recordSize;
+    }
+
+    uint32_t crcBeforeComma = 0;
+    uint32_t fieldNumber    = 0;
+    uint32_t fieldHex       = 0;
+    uint32_t recordNumber   = 0;
+    uint8_t  commas         = 0;
+    for (uint16_t length = 1; length <= MS_JOURNAL_MAX_RECORD_LENGTH;
+         length++) {
+        int c = file.read();
+        if (c < 0 || c == 0x00 || c == 0xFF) return 0;
+        if (c == '\n') {
+            if (commas < 2 || fieldHex != crcBeforeComma) return 0;
+            sequence = recordNumber;
+            return length;
+        }
+        if (c == ',') {
+            crcBeforeComma = crc;
+            recordNumber   = fieldNumber;
+            fieldNumber    = 0;
+            fieldHex       = 0;
+            if (commas < 2) commas++;
+        } else if (c != '\r') {
+            // Each field is read as both a number and hex, since it isn't
+            // known which is the last until the end of the line
+            uint8_t digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+            fieldNumber   = fieldNumber * 10 + digit;
+            fieldHex      = (fieldHex << 4) | (digit & 0x0F);
+        }
+        uint8_t byte = c;
+        crc          = updateCRC32(crc, &byte, 1);
+    }
+    return 0;
+}
+
+
 // ===================================================================== //
 // Public functions for a "sensor testing" mode
 // ===================================================================== //
@@ -1453,7 +2978,11 @@ void Logger::begin() {
     watchDogTimer.resetWatchDog();
 
     // Begin the internal array
-    _internalArray->begin();
+    if (!_internalArray->begin()) {
+        PRINTOUT(F("The variable array could not be begun; no sensors will be "
+                   "measured!"));
+    }
+    if (_energyLedger != NULL) _internalArray->setEnergyLedger(_energyLedger);
     PRINTOUT(F("This logger has a variable array with"), getArrayVarCount(),
              F("variables, of which"),
              getArrayVarCount() - _internalArray->getCalculatedVariableCount(),
@@ -1465,6 +2994,20 @@ void Logger::begin() {
         PRINTOUT(F("Sampling feature UUID is:"), _samplingFeatureUUID);
     }
 
+    // Clean up the end of the last file if the logger was reset or lost
+    // power while writing to it
+    if (_journalEnabled) {
+        turnOnSDcard(true);
+        recoverLogFile();
+        turnOffSDcard(true);
+    }
+    // Pick up the clock's drift from before the reset
+    if (_clockDriftTracking) {
+        turnOnSDcard(true);
+        readClockDrift();
+        turnOffSDcard(true);
+    }
+
     PRINTOUT(F("Logger portion of setup finished.\n"));
 }
 
@@ -1486,10 +3029,13 @@ void Logger::logData(void) {
         PRINTOUT(F("------------------------------------------"));
         // Turn on the LED to show we're taking a reading
         alertOn();
-        // Power up the SD Card
+        // Add up what the last interval used, before this one adds to it
+        closeEnergyCycle();
+        // Power up the SD Card, unless the record will be held in RAM; a
+        // buffered batch powers the card itself when it is written
         // TODO(SRGDamia1):  Decide how much delay is needed between turning on
         // the card and writing to it.  Could we turn it on just before writing?
-        turnOnSDcard(false);
+        if (_recordsPerFlush == 0) turnOnSDcard(false);
 
         // Do a complete sensor update
         MS_DBG(F("    Running a complete sensor update..."));
@@ -1499,6 +3045,8 @@ void Logger::logData(void) {
 
         // Create a csv data record and save it to the log file
         logToSD();
+        // Take out the clock's drift while the card is still powered
+        compensateClockDrift();
         // Cut power from the SD card, waiting for housekeeping
         turnOffSDcard(true);
 
@@ -1534,10 +3082,33 @@ void Logger::logDataAndPublish(void) {
         PRINTOUT(F("------------------------------------------"));
         // Turn on the LED to show we're taking a reading
         alertOn();
-        // Power up the SD Card
+        // Add up what the last interval used, before this one adds to it
+        closeEnergyCycle();
+        // Power up the SD Card, unless the record will be held in RAM; a
+        // buffered batch powers the card itself when it is written
         // TODO(SRGDamia1):  Decide how much delay is needed between turning on
         // the card and writing to it.  Could we turn it on just before writing?
-        turnOnSDcard(false);
+        if (_recordsPerFlush == 0) turnOnSDcard(false);
+
+        // The clock is synchronized at noon when it's due, or whenever it's
+        // clearly wrong
+        bool syncDue = isClockSyncDue();
+        // The modem isn't needed while every publisher waits to send a batch
+        bool modemDue = _logModem != NULL && (syncDue || isPublishingDue());
+
+        // Wake the modem first, if asked, so it can register on the network
+        // while the sensors warm up and measure
+        bool     modemAwake      = false;
+        uint32_t modemWokeMillis = 0;
+        uint32_t modemIdleMillis = 0;
+        if (modemDue && _earlyModemWake) {
+            MS_DBG(F("Waking up"), _logModem->getModemName(),
+                   F("to register during the sensor update..."));
+            modemWokeMillis = millis();
+            modemIdleMillis = _logModem->getIdleTime();
+            modemAwake      = _logModem->modemWake();
+            watchDogTimer.resetWatchDog();
+        }
 
         // Do a complete update on the variable array.
         // This this includes powering all of the sensors, getting updated
@@ -1552,10 +3123,20 @@ void Logger::logDataAndPublish(void) {
         // Create a csv data record and save it to the log file
         logToSD();
 
-        if (_logModem != NULL) {
-            MS_DBG(F("Waking up"), _logModem->getModemName(), F("..."));
-            if (_logModem->modemWake()) {
-                // Connect to the network
+        if (_logModem != NULL && !modemDue) {
+            // Every publisher is waiting to send a batch later
+            MS_DBG(F("No publisher is due to send; the modem stays asleep"));
+            queueDataForRemotes();
+        } else if (_logModem != NULL) {
+            if (!_earlyModemWake) {
+                MS_DBG(F("Waking up"), _logModem->getModemName(), F("..."));
+                modemWokeMillis = millis();
+                modemIdleMillis = _logModem->getIdleTime();
+                modemAwake      = _logModem->modemWake();
+            }
+            if (modemAwake) {
+                // Connect to the network; with an early wake this only waits
+                // for whatever registration is left
                 watchDogTimer.resetWatchDog();
                 MS_DBG(F("Connecting to the Internet..."));
                 if (_logModem->connectInternet()) {
@@ -1564,12 +3145,10 @@ void Logger::logDataAndPublish(void) {
                     publishDataToRemotes();
                     watchDogTimer.resetWatchDog();
 
-                    if ((Logger::markedEpochTime != 0 &&
-                         Logger::markedEpochTime % 86400 == 43200) ||
-                        !isRTCSane(Logger::markedEpochTime)) {
+                    if (syncDue) {
                         // Sync the clock at noon
-                        MS_DBG(F("Running a daily clock sync..."));
-                        setRTClock(_logModem->getNISTTime());
+                        MS_DBG(F("Running a clock sync..."));
+                        setRTClock(_logModem->getUTCTime());
                         watchDogTimer.resetWatchDog();
                     }
 
@@ -1582,12 +3161,22 @@ void Logger::logDataAndPublish(void) {
                     _logModem->disconnectInternet();
                 } else {
                     MS_DBG(F("Could not connect to the internet!"));
+                    // Keep the record to send once there's a connection
+                    queueDataForRemotes();
                     watchDogTimer.resetWatchDog();
                 }
+            } else {
+                queueDataForRemotes();
             }
             // Turn the modem off
             _logModem->modemSleepPowerDown();
+            if (_energyLedger != NULL) {
+                _energyLedger->addModemTime(millis() - modemWokeMillis);
+                _energyLedger->addIdleTime(_logModem->getIdleTime() -
+                                           modemIdleMillis);
+            }
         }
+        compensateClockDrift();
 
 
         // TODO(SRGDamia1):  Do some sort of verification that minimum 1 sec has
@@ -26,6 +26,8 @@
 #undef MS_DEBUGGING_STD
 #include "VariableArray.h"
 #include "LoggerModem.h"
+#include "LogBuffer.h"
+#include "EnergyLedger.h"
 
 // Bring in the libraries to handle the processor sleep/standby modes
 // The SAMD library can also the built-in clock on those modules
@@ -51,6 +53,41 @@
  */
 #define EPOCH_TIME_OFF 946684800
 
+#ifndef MS_CLOCK_REFRESH_MS
+/**
+ * @brief The longest time, in milliseconds, the logger will count forward
+ * from one reading of the real time clock using millis() before reading the
+ * clock again.
+ *
+ * The clock is always read again after the processor wakes, since millis()
+ * does not count during sleep.  This only limits how far the processor's own
+ * oscillator is trusted during a long time awake.
+ */
+#define MS_CLOCK_REFRESH_MS 60000L
+#endif
+
+#ifndef MS_MAX_LOGGER_ID_LENGTH
+/**
+ * @brief The longest logger ID that is used whole in an automatic file name;
+ * longer IDs are cut to this length in the name.
+ */
+#define MS_MAX_LOGGER_ID_LENGTH 32
+#endif
+
+/**
+ * @brief The longest data file name the logger keeps; longer names given to
+ * Logger::setFileName() are cut to this length.
+ *
+ * The name is also saved in the record journal, so this can't be changed
+ * without changing #MS_JOURNAL_MAGIC.
+ */
+#define MS_MAX_FILE_NAME_LENGTH 63
+
+// An automatic name is the ID, '_', "YYYY-MM-DD_hhmmss" and ".csv"
+#if MS_MAX_LOGGER_ID_LENGTH + 22 > MS_MAX_FILE_NAME_LENGTH
+#error MS_MAX_LOGGER_ID_LENGTH is too long for an automatic file name
+#endif
+
 #include <SdFat.h>  // To communicate with the SD card
 
 /**
@@ -58,6 +95,212 @@
  */
 #define MAX_NUMBER_SENDERS 4
 
+/**
+ * @brief The size of a char buffer that can hold any date and time written by
+ * Logger::formatDateTime_ISO8601(), including the terminating null.
+ *
+ * The longest is of the form `2020-01-01T00:00:00-10:00`.
+ */
+#define ISO8601_BUFFER_SIZE 26
+
+/**
+ * @brief The four characters at the very start of every binary log file.
+ */
+#define MS_BINARY_LOG_MAGIC "MSLB"
+/**
+ * @brief The version of the binary log file layout written by
+ * Logger::printBinaryFileHeader() and Logger::writeBinaryRecord().
+ *
+ * This must be incremented whenever the layout changes so the converter in
+ * tools/binary_log_to_csv can refuse files it does not understand.
+ */
+#define MS_BINARY_LOG_VERSION 1
+/**
+ * @brief The version of the binary log file layout written while the record
+ * journal is on; each record carries a uint32_t record number after the time.
+ */
+#define MS_BINARY_LOG_VERSION_JOURNAL 2
+
+#ifndef MS_JOURNAL_FILE_NAME
+/**
+ * @brief The name of the file on the SD card that records how far each data
+ * file is known to be good.
+ */
+#define MS_JOURNAL_FILE_NAME "LOGJRNL.DAT"
+#endif
+
+#ifndef MS_JOURNAL_MAX_RECORD_LENGTH
+/**
+ * @brief The longest text record that will be checked when recovering a
+ * journaled file; anything longer is treated as damaged.
+ */
+#define MS_JOURNAL_MAX_RECORD_LENGTH 1024
+#endif
+
+/**
+ * @brief The value at the start of every valid journal entry.
+ */
+#define MS_JOURNAL_MAGIC 0x334E524AUL
+
+#ifndef MS_PUBLISH_QUEUE_FILE_NAME
+/**
+ * @brief The name of the file on the SD card holding records waiting to be
+ * published.
+ */
+#define MS_PUBLISH_QUEUE_FILE_NAME "PUBQUEUE.DAT"
+#endif
+#ifndef MS_PUBLISH_INDEX_FILE_NAME
+/**
+ * @brief The name of the file on the SD card holding each publisher's place
+ * in the publish queue.
+ */
+#define MS_PUBLISH_INDEX_FILE_NAME "PUBINDEX.DAT"
+#endif
+/**
+ * @brief The four characters at the very start of the publish queue file.
+ */
+#define MS_PUBLISH_QUEUE_MAGIC "MSPQ"
+/**
+ * @brief The size of the header of the publish queue file: the magic, the
+ * number of variables, the length of each value, and the record size.
+ */
+#define MS_PUBLISH_QUEUE_HEADER_SIZE 8
+/**
+ * @brief The value at the start of a valid publish queue index.
+ */
+#define MS_PUBLISH_INDEX_MAGIC 0x58444950UL
+#ifndef MS_PUBLISH_BATCH_SIZE
+/**
+ * @brief The most queued records offered to a publisher in one request.
+ *
+ * Publishers that can combine records (see dataPublisher::publishBatch())
+ * send up to this many at once; the time and byte budgets for emptying the
+ * publish queue are only checked between batches.
+ */
+#define MS_PUBLISH_BATCH_SIZE 24
+#endif
+
+#ifndef MS_CLOCK_DRIFT_FILE_NAME
+/**
+ * @brief The name of the file on the SD card holding the drift fitted to the
+ * real time clock.
+ */
+#define MS_CLOCK_DRIFT_FILE_NAME "RTCDRIFT.DAT"
+#endif
+/**
+ * @brief The value at the start of a valid clock drift record.
+ */
+#define MS_CLOCK_DRIFT_MAGIC 0x54465244UL
+#ifndef MS_CLOCK_SYNC_MAX_DAYS
+/**
+ * @brief The most days between clock syncs while the drift is tracked, no
+ * matter how small the predicted error.
+ */
+#define MS_CLOCK_SYNC_MAX_DAYS 14
+#endif
+#ifndef MS_CLOCK_DRIFT_MAX_SPAN
+/**
+ * @brief The most seconds of past syncs the drift fit remembers, so it can
+ * follow a crystal whose rate changes with the seasons.
+ */
+#define MS_CLOCK_DRIFT_MAX_SPAN 2592000UL
+#endif
+
+/**
+ * @brief The layouts the logger can use for the data files on the SD card.
+ */
+typedef enum logFileFormat {
+    /// A human readable comma separated text file with a multi-line header.
+    LOG_FILE_CSV = 0,
+    /// A compact binary file with a self-describing header and fixed-width
+    /// records of raw float values.
+    LOG_FILE_BINARY
+} logFileFormat;
+
+/**
+ * @brief When the logger finishes one data file on the SD card and starts
+ * another.
+ */
+typedef enum logRotation {
+    /// Keep writing to the same file forever.
+    LOG_ROTATE_NEVER = 0,
+    /// Start a new file, named with the date, every day.
+    LOG_ROTATE_DAILY,
+    /// Start a new file, named with the year and month, every month.
+    LOG_ROTATE_MONTHLY,
+    /// Start a new file, named with the date and time, whenever the next
+    /// write would take the file past the requested size.
+    LOG_ROTATE_BY_SIZE
+} logRotation;
+
+/**
+ * @brief One entry of the record journal: the point up to which a data file
+ * was known to be whole when it was last synced.
+ *
+ * The entry is written byte for byte to the journal file, so the layout must
+ * not change without changing #MS_JOURNAL_MAGIC.
+ */
+typedef struct logJournalEntry {
+    /// Always #MS_JOURNAL_MAGIC
+    uint32_t magic;
+    /// The number of times the journal had been written, counting this
+    /// entry; the entry with the higher count is the newer one
+    uint32_t writeCount;
+    /// The number of the last record in the file
+    uint32_t sequence;
+    /// The position just after the last byte of the last record
+    uint32_t dataEnd;
+    /// The null-terminated name of the data file
+    char fileName[MS_MAX_FILE_NAME_LENGTH + 1];
+    /// The CRC-32 of all of the fields above
+    uint32_t crc;
+} logJournalEntry;
+
+/**
+ * @brief The place of each data publisher in the publish queue, saved to
+ * #MS_PUBLISH_INDEX_FILE_NAME.
+ */
+typedef struct publishQueueIndex {
+    /// Always #MS_PUBLISH_INDEX_MAGIC
+    uint32_t magic;
+    /// The number of the next queued record to send to each publisher, in
+    /// the order they were registered with the logger
+    uint32_t cursor[MAX_NUMBER_SENDERS];
+    /// The CRC-32 of all of the fields above
+    uint32_t crc;
+} publishQueueIndex;
+
+/**
+ * @brief The drift fitted to the real time clock, saved to
+ * #MS_CLOCK_DRIFT_FILE_NAME after every sync and every drift correction.
+ */
+typedef struct clockDriftRecord {
+    /// Always #MS_CLOCK_DRIFT_MAGIC
+    uint32_t magic;
+    /// The time of the last sync, in seconds since 1970 in UTC, or 0 if the
+    /// clock has never been synced
+    uint32_t lastSync;
+    /// The milliseconds the clock was expected to be behind just after the
+    /// last sync
+    int32_t syncOffset;
+    /// The seconds the clock has been stepped to correct for drift since the
+    /// last sync
+    int32_t correction;
+    /// The fitted drift, in seconds a day the clock gains (or loses, if
+    /// negative)
+    float driftPerDay;
+    /// How far, in seconds a day, the drift between the last two syncs
+    /// strayed from the fit by more than the syncs' own error
+    float driftChange;
+    /// The seconds between syncs the drift was fitted over, or 0 if there
+    /// has only been one sync
+    uint32_t fitSpan;
+    /// The accuracy of the time used for the last sync, in milliseconds
+    uint32_t syncAccuracy;
+    /// The CRC-32 of all of the fields above
+    uint32_t crc;
+} clockDriftRecord;
+
 
 class dataPublisher;  // Forward declaration
 
@@ -138,7 +381,8 @@ class Logger {
      * @brief Set the Logger ID.
      *
      * Unless otherwise specified, files saved to the SD card will be named with
-     * the logger id and the date the file was started.
+     * the logger id and the date the file was started.  Only the first
+     * #MS_MAX_LOGGER_ID_LENGTH characters of the ID are used in the name.
      *
      * @param loggerID A pointer to the logger ID
      */
@@ -208,7 +452,8 @@ class Logger {
      *
      * Optionally waits for the card to do "housekeeping" before cutting the
      * power.  Has o effect if a pin has not been set to control power to the SD
-     * card.
+     * card or if the card is not on.  A log file held open between batches of
+     * buffered records is synced and closed before the power is cut.
      *
      * @param waitForHousekeeping True to add a 1 second delay between to allow
      * any on-chip writing to complete before cutting power.  Defaults to true.
@@ -322,6 +567,14 @@ class Logger {
      * @brief Digital pin number on the mcu controlling SD card power
      */
     int8_t _SDCardPowerPin;
+    /**
+     * @brief True while this library has the SD card power pin switched on
+     */
+    bool _SDCardPowered;
+    /**
+     * @brief The processor time the SD card was last powered on
+     */
+    uint32_t _millisSDCardOn;
     /**
      * @brief Digital pin number on the mcu receiving interrupts to wake from
      * deep-sleep.
@@ -377,6 +630,15 @@ class Logger {
      * applicable.
      */
     String getParentSensorNameAtI(uint8_t position_i);
+    /**
+     * @brief Get the name of the parent sensor of the variable at the given
+     * position in the internal variable array object without copying it into
+     * a String.
+     *
+     * @param position_i The position of the variable in the array.
+     * @return **const char\*** The name of the parent sensor of that variable
+     */
+    const char* getParentSensorNameCharsAtI(uint8_t position_i);
     /**
      * @brief Get the name and pin location of the parent sensor of the variable
      * at the given position in the internal variable array object.
@@ -397,6 +659,14 @@ class Logger {
      * @return **String** The variable name
      */
     String getVarNameAtI(uint8_t position_i);
+    /**
+     * @brief Get the name of the variable at the given position in the
+     * internal variable array object without copying it into a String.
+     *
+     * @param position_i The position of the variable in the array.
+     * @return **const char\*** The variable name
+     */
+    const char* getVarNameCharsAtI(uint8_t position_i);
     /**
      * @brief Get the unit of the variable at the given position in the
      * internal variable array object.
@@ -408,6 +678,14 @@ class Logger {
      * @return **String** The variable unit
      */
     String getVarUnitAtI(uint8_t position_i);
+    /**
+     * @brief Get the unit of the variable at the given position in the
+     * internal variable array object without copying it into a String.
+     *
+     * @param position_i The position of the variable in the array.
+     * @return **const char\*** The variable unit
+     */
+    const char* getVarUnitCharsAtI(uint8_t position_i);
     /**
      * @brief Get the customized code of the variable at the given position in
      * the internal variable array object.
@@ -416,6 +694,14 @@ class Logger {
      * @return **String** The variable code
      */
     String getVarCodeAtI(uint8_t position_i);
+    /**
+     * @brief Get the customized code of the variable at the given position in
+     * the internal variable array object without copying it into a String.
+     *
+     * @param position_i The position of the variable in the array.
+     * @return **const char\*** The variable code
+     */
+    const char* getVarCodeCharsAtI(uint8_t position_i);
     /**
      * @brief Get the UUID of the variable at the given position in the internal
      * variable array object.
@@ -424,6 +710,14 @@ class Logger {
      * @return **String** The variable UUID
      */
     String getVarUUIDAtI(uint8_t position_i);
+    /**
+     * @brief Get the UUID of the variable at the given position in the internal
+     * variable array object without copying it into a String.
+     *
+     * @param position_i The position of the variable in the array.
+     * @return **const char\*** The variable UUID
+     */
+    const char* getVarUUIDCharsAtI(uint8_t position_i);
     /**
      * @brief Get the most recent value of the variable at the given position in
      * the internal variable array object.
@@ -433,6 +727,16 @@ class Logger {
      * number of significant figures.
      */
     String getValueStringAtI(uint8_t position_i);
+    /**
+     * @brief Get the most recent value of the variable at the given position in
+     * the internal variable array object without creating a String.
+     *
+     * @param position_i The position of the variable in the array.
+     * @return **const char\*** The value of the variable with the correct
+     * number of significant figures, as formatted once by the variable array
+     * at the end of the last update.
+     */
+    const char* getValueCharsAtI(uint8_t position_i);
 
  protected:
     /**
@@ -460,11 +764,34 @@ class Logger {
     void attachModem(loggerModem& modem);
     /**
      * @brief Use the attahed loggerModem to synchronize the real-time clock
-     * with NIST time servers.
+     * with the time from the cellular network, an SNTP server, or NIST time
+     * servers.
+     *
+     * @see loggerModem::getUTCTime()
      *
      * @return **bool** True if clock synchronization was successful
      */
     bool syncRTC();
+    /**
+     * @brief Set whether the modem is woken at the start of each logging
+     * interval, before the sensors are updated, instead of after the record
+     * has been saved.
+     *
+     * Network registration (and, for modems that do it themselves, the data
+     * attach) then happens while the sensors warm up and measure, and
+     * publishing starts as soon as both are done.  This shortens the time
+     * the logger is awake on intervals that publish, but waking the modem
+     * takes a few seconds before the sensors are powered.  The modem is not
+     * woken early on intervals when no publisher is due and the clock
+     * doesn't need to be synchronized.
+     *
+     * @note Don't use this if the modem shares a power pin with any sensor,
+     * since the sensors are powered down while the modem is in use, or if
+     * any sensor's readings are disturbed by the modem transmitting.
+     *
+     * @param enable True to wake the modem before updating the sensors
+     */
+    void setEarlyModemWake(bool enable);
 
     /**
      * @brief Register a data publisher object to receive data from the logger.
@@ -474,6 +801,11 @@ class Logger {
     void registerDataPublisher(dataPublisher* publisher);
     /**
      * @brief Publish data to all registered data publishers.
+     *
+     * Connections are left open between requests while publishing, so
+     * publishers sending to the same host and port, and the records of a
+     * queued backlog, share one connection.  Every connection is closed
+     * before this returns.
      */
     void publishDataToRemotes(void);
     /**
@@ -483,6 +815,77 @@ class Logger {
      */
     void sendDataToRemotes(void);
 
+    /**
+     * @brief Keep records that could not be published in a queue on the SD
+     * card and send them once a connection succeeds.
+     *
+     * With the queue on, a record is added to #MS_PUBLISH_QUEUE_FILE_NAME
+     * whenever the internet connection fails or any publisher does not accept
+     * it (see dataPublisher::publishSucceeded()).  Each publisher's place in
+     * the queue is kept in #MS_PUBLISH_INDEX_FILE_NAME, so a record sent to
+     * one publisher but not another is only sent again to the one that
+     * missed it.  On the next successful connection, publishDataToRemotes()
+     * sends each publisher its waiting records oldest first, the publishers
+     * taking turns one record at a time, until the queue is empty or the
+     * time or byte budget for the whole connection is spent.  A publisher
+     * that fails is not tried again until the next connection.  Once every
+     * publisher has every record the queue file is emptied.
+     *
+     * Queued records hold the values exactly as they were first formatted,
+     * so they are published as they would have been at the time.  A queue
+     * written for a different set of variables is discarded.  Publishers
+     * that send in batches use the queue whether or not it is turned on here.
+     *
+     * @note The queued values are loaded back into the variable array's value
+     * slots, so the array must have one for every variable:  use a
+     * StaticVariableArray or give the array its slots with
+     * VariableArray::setValueStringBuffer().
+     *
+     * @param enable True to use the publish queue
+     * @param drainSeconds The longest to spend sending queued records on one
+     * connection; optional with a default of 60
+     * @param drainBytes The most bytes to send while emptying the queue on
+     * one connection, or 0 for no limit; optional with a default of 0
+     */
+    void setPublishQueue(bool enable, uint16_t drainSeconds = 60,
+                         uint32_t drainBytes = 0);
+    /**
+     * @brief Add the current record to the publish queue, for every
+     * publisher, without trying to send it.
+     *
+     * This is called by logDataAndPublish() when the modem cannot wake or
+     * connect, or when no publisher is due to send.  It does nothing if the
+     * publish queue is not in use.
+     */
+    void queueDataForRemotes(void);
+    /**
+     * @brief Check whether any publisher sends on the current logging
+     * interval.
+     *
+     * Publishers given a sendEveryX greater than one (see
+     * dataPublisher::setSendFrequency()) only send on some intervals; the
+     * records in between wait in the publish queue and are sent together.
+     * When no publisher is due, logDataAndPublish() leaves the modem asleep
+     * (unless the clock needs to be synchronized).
+     *
+     * @return **bool** True if any publisher is due, or if there are no
+     * publishers at all
+     */
+    bool isPublishingDue(void);
+    /**
+     * @brief Load one record of the batch being sent in place of the current
+     * time and values.
+     *
+     * This is only valid while the logger is calling
+     * dataPublisher::publishBatch().
+     *
+     * @param record The number of the record within the batch, starting from
+     * 0
+     * @return **bool** True if the record was whole and loaded; damaged
+     * records should be left out of the request
+     */
+    bool loadQueuedRecord(uint16_t record);
+
  protected:
     /**
      * @brief The internal modem instance
@@ -492,6 +895,26 @@ class Logger {
      * null).  It is not possible to have a null reference.
      */
     loggerModem* _logModem;
+    /**
+     * @brief True to wake the modem before updating the sensors
+     */
+    bool _earlyModemWake;
+    /**
+     * @brief True to fit the drift of the clock and schedule syncs with it
+     */
+    bool _clockDriftTracking;
+    /**
+     * @brief True to step the clock between syncs to correct for drift
+     */
+    bool _clockDriftCompensation;
+    /**
+     * @brief The most seconds the clock may be off before it is synced
+     */
+    uint16_t _maxClockError;
+    /**
+     * @brief The drift fitted to the clock, as saved to the SD card
+     */
+    clockDriftRecord _clockDrift;
     //
 
     /**
@@ -499,6 +922,125 @@ class Logger {
      */
     dataPublisher* dataPublishers[MAX_NUMBER_SENDERS];
 
+    /**
+     * @brief True to queue records that could not be published
+     */
+    bool _publishQueueEnabled;
+    /**
+     * @brief The longest to spend sending queued records on one connection
+     */
+    uint16_t _queueDrainSeconds;
+    /**
+     * @brief The most bytes to send from the queue on one connection, or 0
+     * for no limit
+     */
+    uint32_t _queueDrainBytes;
+    /**
+     * @brief The open publish queue while a batch is being published, or
+     * NULL
+     */
+    File* _batchQueue;
+    /**
+     * @brief The number of the first queued record of the batch being
+     * published
+     */
+    uint32_t _batchStart;
+
+    /**
+     * @brief Publish the current record and any queued records, adding to
+     * the queue whatever is not accepted.
+     *
+     * @return **bool** False if the queue could not be opened, in which case
+     * nothing was sent
+     */
+    bool publishThroughQueue(void);
+    /**
+     * @brief Open the publish queue, creating it (and discarding the index)
+     * if it does not exist or was written for other variables.
+     *
+     * @param queue The file to open
+     * @return **bool** True if the queue is open
+     */
+    bool openPublishQueue(File& queue);
+    /**
+     * @brief Remove records from the start of the publish queue, moving the
+     * rest up and each publisher's place with them.
+     *
+     * @param queue The open queue file
+     * @param index Each publisher's place in the queue, saved again here
+     * @param drop The number of records to remove, which every publisher
+     * must already have
+     * @param length The number of records in the queue
+     * @return **uint32_t** The number of records left in the queue
+     */
+    uint32_t compactPublishQueue(File& queue, publishQueueIndex& index,
+                                 uint32_t drop, uint32_t length);
+    /**
+     * @brief Get the size of each record in the publish queue: the time, a
+     * value string for each variable, and a CRC-32.
+     *
+     * @return **uint16_t** The record size in bytes
+     */
+    uint16_t getPublishQueueRecordSize(void);
+    /**
+     * @brief Get the number of whole records in the publish queue.
+     *
+     * @param queue The open queue file
+     * @return **uint32_t** The number of records
+     */
+    uint32_t getPublishQueueLength(File& queue);
+    /**
+     * @brief Write the current record into the publish queue.
+     *
+     * @param queue The open queue file
+     * @param position The record number to write, normally the queue length
+     */
+    void writePublishQueueRecord(File& queue, uint32_t position);
+    /**
+     * @brief Load a queued record in place of the current time and values.
+     *
+     * @param queue The open queue file
+     * @param position The record number to read
+     * @return **bool** True if the record was whole and loaded
+     */
+    bool readPublishQueueRecord(File& queue, uint32_t position);
+    /**
+     * @brief Read each publisher's place in the publish queue, or all zeros
+     * if there is no valid index.
+     *
+     * @param index The index to fill in
+     */
+    void readPublishQueueIndex(publishQueueIndex& index);
+    /**
+     * @brief Save each publisher's place in the publish queue.
+     *
+     * @param index The index to write
+     */
+    void writePublishQueueIndex(publishQueueIndex& index);
+    /**
+     * @brief Check whether the time or bytes allowed for emptying the queue
+     * on this connection have run out.
+     *
+     * @param startMillis The processor time when sending began
+     * @param startBytes The publishers' byte count when sending began
+     * @return **bool** True if no more queued records should be sent
+     */
+    bool isQueueBudgetSpent(uint32_t startMillis, uint32_t startBytes);
+    /**
+     * @brief Check whether records go through the publish queue, either
+     * because it was turned on or because some publisher sends in batches.
+     *
+     * @return **bool** True if the publish queue is used
+     */
+    bool usesPublishQueue(void);
+    /**
+     * @brief Get the number of the current logging interval, counted from
+     * the epoch, for deciding which publishers send on it.
+     *
+     * @return **uint32_t** The number of the marked logging interval
+     */
+    uint32_t getIntervalNumber(void);
+
     // ===================================================================== //
     // Public functions to access the clock in proper format and time zone
     // ===================================================================== //
@@ -593,6 +1135,20 @@ class Logger {
      * number of seconds from January 1, 1970 00:00:00) and correct it to the
      * logging time zone.
      *
+     * The real time clock is only read the first time this is called after
+     * waking (or after MS_CLOCK_REFRESH_MS); after that the time is counted
+     * forward from that reading with millis().  On boards with a DS3231 this
+     * saves an I2C transaction on every call.
+     *
+     * @note The clock only reports whole seconds, so the reading is counted
+     * from when it was taken rather than from when the second began.  The
+     * result can therefore lag the real time clock by up to (but not
+     * including) one second, plus however far millis() drifts from the clock
+     * in MS_CLOCK_REFRESH_MS.  It is never ahead of the clock unless millis()
+     * runs fast.  When the logger wakes on the clock's alarm the first
+     * reading is taken just after the second begins, so the lag is only the
+     * time spent between the alarm and that reading.
+     *
      * @return **uint32_t**  The number of seconds from January 1, 1970 in the
      * logging time zone.
      */
@@ -608,11 +1164,24 @@ class Logger {
      * @param ts The number of seconds since 1970.
      */
     static void setNowEpoch(uint32_t ts);
+    /**
+     * @brief Force the next call to getNowEpoch() to read the real time
+     * clock.
+     *
+     * This is done automatically when the logger wakes from systemSleep() and
+     * when the clock is set.  Call it after any other sleep that stops
+     * millis().
+     */
+    static void resetClockCache(void);
 
     /**
      * @brief Convert the number of seconds from January 1, 1970 to a DateTime
      * object instance.
      *
+     * The most recent conversion is kept, so asking for the same second again
+     * (as the file timestamps and the date columns do) does not repeat the
+     * calendar arithmetic.
+     *
      * @param epochTime The number of seconds since 1970.
      * @return **DateTime** The equivalent DateTime
      */
@@ -640,6 +1209,37 @@ class Logger {
      */
     static String formatDateTime_ISO8601(uint32_t epochTime);
 
+    /**
+     * @brief Write a date-time object into a char buffer as an ISO8601
+     * formatted string, without using a String.
+     *
+     * This assumes the supplied date/time is in the LOGGER's timezone and adds
+     * the LOGGER's offset as the time zone offset in the string.
+     *
+     * @param dt A DateTime object to convert
+     * @param buffer A buffer of at least #ISO8601_BUFFER_SIZE characters
+     */
+    static void formatDateTime_ISO8601(DateTime& dt, char* buffer);
+    /**
+     * @brief Write an epoch time (unix time) into a char buffer as an ISO8601
+     * formatted string, without using a String.
+     *
+     * @param epochTime The number of seconds since 1970.
+     * @param buffer A buffer of at least #ISO8601_BUFFER_SIZE characters
+     */
+    static void formatDateTime_ISO8601(uint32_t epochTime, char* buffer);
+    /**
+     * @brief Get Logger::markedEpochTime as an ISO8601 formatted string.
+     *
+     * The string is only written the first time it is asked for after the
+     * time is marked; every other request in the same logging cycle (ie, from
+     * each data publisher) gets the same characters back.
+     *
+     * @return **const char\*** The marked time, ISO8601 formatted.  This is
+     * overwritten when a new time is marked, so copy it if it must be kept.
+     */
+    static const char* getMarkedISO8601(void);
+
     /**
      * @brief Veify that the input value is sane and if so sets the real time
      * clock to the given time.
@@ -670,6 +1270,54 @@ class Logger {
      */
     static bool isRTCSane(uint32_t epochTime);
 
+    /**
+     * @brief Fit the drift of the real time clock and sync it only as often
+     * as that drift needs.
+     *
+     * With this on, every time the clock is synced the offset found is used
+     * to fit how fast the clock gains or loses time, and the clock is always
+     * set, however small the offset.  The fit is kept in
+     * #MS_CLOCK_DRIFT_FILE_NAME so it survives a reset.  The clock is then
+     * only synced (at noon) when the error predicted for the next noon would
+     * be more than the limit, or #MS_CLOCK_SYNC_MAX_DAYS have passed.  Until
+     * two syncs have been made, the clock is synced every day.
+     *
+     * With compensation on, the clock is also stepped by whole seconds
+     * between syncs, after logging, to take out the drift predicted by the
+     * fit.  A DS3231 drifting a few seconds a month can then go weeks between
+     * syncs.
+     *
+     * @param enable True to fit the drift and schedule the syncs with it
+     * @param compensate True to step the clock between syncs to correct for
+     * the fitted drift
+     * @param maxErrorSeconds The most error allowed before the clock is
+     * synced.  A sync itself is only good to a second plus the accuracy of
+     * the time from the modem, so this should be at least 3.
+     */
+    void setClockDriftTracking(bool enable, bool compensate = false,
+                               uint16_t maxErrorSeconds = 5);
+    /**
+     * @brief Get the drift fitted to the real time clock.
+     *
+     * @return **float** The seconds a day the clock gains (or loses, if
+     * negative), or 0 if there haven't been two syncs yet.
+     */
+    float getClockDrift(void);
+    /**
+     * @brief Get the error of the real time clock predicted for a given time
+     * by the drift fit.
+     *
+     * This counts the drift not corrected by compensation and what isn't
+     * known about the drift: the error of the two syncs it was fitted with
+     * spread over the time between them.
+     *
+     * @param epochTime The time to predict for, in seconds since 1970 in the
+     * logging time zone.
+     * @return **float** The possible error in seconds, or -9999 if the drift
+     * has not been fitted yet.
+     */
+    float getPredictedClockError(uint32_t epochTime);
+
     /**
      * @brief Set static variables for the date/time
      *
@@ -721,6 +1369,69 @@ class Logger {
      */
     static int8_t _loggerRTCOffset;
 
+    /**
+     * @brief The raw value of the real time clock (in the RTC's time zone)
+     * the last time it was read.
+     */
+    static uint32_t _clockEpoch;
+    /**
+     * @brief The value of millis() when the real time clock was last read.
+     */
+    static uint32_t _clockMillis;
+    /**
+     * @brief False if the clock must be read again before it can be counted
+     * forward.
+     */
+    static bool _clockValid;
+    /**
+     * @brief The epoch time of the most recent DateTime made by
+     * dtFromEpoch().
+     */
+    static uint32_t _cachedDateTimeEpoch;
+    /**
+     * @brief The most recent DateTime made by dtFromEpoch().
+     */
+    static DateTime _cachedDateTime;
+    /**
+     * @brief The marked time as last formatted by getMarkedISO8601().
+     */
+    static char _markedISO8601[ISO8601_BUFFER_SIZE];
+    /**
+     * @brief The marked time that _markedISO8601 was formatted from.
+     */
+    static uint32_t _markedISO8601Epoch;
+
+    /**
+     * @brief Read the real time clock itself, with no caching or time zone
+     * correction.
+     *
+     * @return **uint32_t** The number of seconds from January 1, 1970 in the
+     * RTC's time zone.
+     */
+    static uint32_t readRTCEpoch(void);
+
+    /**
+     * @brief Write the date and time as `YYYY-MM-DD hh:mm:ss` (with the given
+     * separator in place of the space) into a char buffer.
+     *
+     * @param dt A DateTime object to convert
+     * @param buffer A buffer of at least 20 characters
+     * @param separator The character between the date and the time
+     * @return **char\*** A pointer to the terminating null written, to
+     * continue writing from.
+     */
+    static char* writeDateTimeChars(DateTime& dt, char* buffer,
+                                    char separator);
+    /**
+     * @brief Write a number from 0 to 99 as exactly two digits, with no
+     * terminating null.
+     *
+     * @param buffer The place to write the two characters
+     * @param value The number to write
+     * @return **char\*** A pointer to the character after the digits.
+     */
+    static char* writeTwoDigits(char* buffer, uint8_t value);
+
     // ============================================================================
     //  Public Functions for sleeping the logger
     // ============================================================================
@@ -743,6 +1454,19 @@ class Logger {
      */
     void systemSleep(void);
 
+    /**
+     * @brief Attach an EnergyLedger to add up how long the processor, the SD
+     * card, the modem and the sensors are on.
+     *
+     * The cycle before each logging interval is closed in the ledger before
+     * the sensors are updated, so the ledger variables logged with a record
+     * describe the interval before it.  The charge used is printed as each
+     * cycle is closed.
+     *
+     * @param ledger An instance of the EnergyLedger class
+     */
+    void attachEnergyLedger(EnergyLedger& ledger);
+
 #if defined(ARDUINO_ARCH_SAMD)
     /**
      * @brief A watch-dog implementation to use to reboot the system in case of
@@ -757,6 +1481,22 @@ class Logger {
     extendedWatchDogAVR watchDogTimer;
 #endif
 
+ protected:
+    /**
+     * @brief The attached energy ledger, if any
+     */
+    EnergyLedger* _energyLedger;
+    /**
+     * @brief The processor time the logger last woke from sleep
+     */
+    uint32_t _millisWoke;
+
+    /**
+     * @brief Close the energy ledger's cycle at the start of a logging
+     * interval and print what it used.
+     */
+    void closeEnergyCycle(void);
+
     // ===================================================================== //
     // Public functions for logging data to an SD card
     // ===================================================================== //
@@ -791,9 +1531,169 @@ class Logger {
      * @return **String** The name of the file data is currently being saved to.
      */
     String getFileName(void) {
-        return _fileName;
+        return String(_fileName);
     }
 
+    /**
+     * @brief Set the layout of the data files written to the SD card.
+     *
+     * The default is #LOG_FILE_CSV.  With #LOG_FILE_BINARY each record is
+     * the logging time and the raw float value of every variable, with no
+     * text formatting at all, followed by a CRC-32 of the record.  Binary
+     * files are a fraction of the size of the equivalent CSV and are much
+     * faster to write; convert them back to the CSV layout with the
+     * program in tools/binary_log_to_csv.
+     *
+     * @note Set this before the first file is created.  A binary record
+     * appended to an existing CSV file (or vice versa) will make the file
+     * unreadable.
+     *
+     * @param format The file layout to use
+     */
+    void setLogFileFormat(logFileFormat format);
+    /**
+     * @brief Get the layout of the data files written to the SD card.
+     *
+     * @return **logFileFormat** The file layout in use
+     */
+    logFileFormat getLogFileFormat(void);
+
+    /**
+     * @brief Hold records in RAM and write them to the SD card in batches.
+     *
+     * By default every record is written by opening the file (re-starting
+     * the card), appending one line, and closing the file again.  With a log
+     * buffer, each record is printed into a ring in RAM instead and the ring
+     * is only written to the file when:
+     * - it holds the given number of records,
+     * - it holds at least flushBytes bytes, or it may not have room for
+     * another record,
+     * - the battery is low (see setLowBatteryFlush()), or
+     * - flushLogBuffer() is called by the program.
+     *
+     * Between batches the file is kept open; it is synced after every batch
+     * and synced and closed before the SD card power is cut.
+     *
+     * @warning Records still in RAM are lost if the logger resets or loses
+     * power before they are written.  Choose the number of records per batch
+     * with that in mind.
+     *
+     * @param buffer The memory to hold the records; this must stay allocated
+     * for as long as the logger runs and should hold several records
+     * @param bufferSize The number of bytes in the memory
+     * @param recordsPerFlush The number of records in each batch; use 0 to go
+     * back to writing every record immediately
+     * @param flushBytes Write the batch early once this many bytes are
+     * waiting; optional with a default of 0 to only flush early when the next
+     * record may not fit
+     */
+    void setLogBuffer(uint8_t* buffer, uint16_t bufferSize,
+                      uint8_t recordsPerFlush, uint16_t flushBytes = 0);
+    /**
+     * @brief Hold records in an array in RAM and write them to the SD card in
+     * batches.
+     *
+     * @copydetails setLogBuffer(uint8_t*, uint16_t, uint8_t, uint16_t)
+     */
+    template <size_t N>
+    void setLogBuffer(uint8_t (&buffer)[N], uint8_t recordsPerFlush,
+                      uint16_t flushBytes = 0) {
+        setLogBuffer(buffer, N, recordsPerFlush, flushBytes);
+    }
+    /**
+     * @brief Write the records waiting in the log buffer to the SD card now
+     * and sync the file.
+     *
+     * Call this from the program when the logger is about to lose power or
+     * be reset for any reason the logger cannot see itself.
+     *
+     * @return **bool** True if there was nothing to write or everything was
+     * written.
+     */
+    bool flushLogBuffer(void);
+    /**
+     * @brief Flush the log buffer after every record once a battery voltage
+     * variable drops below a level.
+     *
+     * @param batteryVar The variable measuring the battery; it must be
+     * updated with the other variables in the logger's variable array
+     * @param minimumLevel The value of the variable below which every record
+     * is written to the SD card immediately
+     */
+    void setLowBatteryFlush(Variable* batteryVar, float minimumLevel);
+
+    /**
+     * @brief Set when to start a new data file and how much space to reserve
+     * for each file when it is created.
+     *
+     * With a file size, every new data file is created with all of its
+     * clusters allocated in one contiguous run (and erased) before any data is
+     * written, so appending a record never has to search or extend the FAT.
+     * The space the data does not reach is given back when the logger moves
+     * on to the next file.  If the logger restarts part way through a file,
+     * the end of the data is found again by a binary search for the erased
+     * space.
+     *
+     * Rotated files are always named automatically, from the logger ID and
+     * the date (and time, for #LOG_ROTATE_BY_SIZE), ignoring any name given
+     * with setFileName().
+     *
+     * @note Only the logger's own data file is preallocated.  Do not write to
+     * it with logToSD(String&, String&), which appends to the end of the
+     * reserved space.
+     *
+     * @param rotation When to start a new file; one of #logRotation
+     * @param fileBytes The number of bytes to reserve for each new file, and
+     * for #LOG_ROTATE_BY_SIZE the largest each file may grow; optional with a
+     * default of 0 for files that are not preallocated
+     */
+    void setLogRotation(logRotation rotation, uint32_t fileBytes = 0);
+    /**
+     * @brief Get when the logger starts a new data file.
+     *
+     * @return **logRotation** The rotation policy
+     */
+    logRotation getLogRotation(void);
+
+    /**
+     * @brief Turn the crash-safe record journal on or off.
+     *
+     * With the journal on, every record carries a record number and a
+     * CRC-32.  Text records get two extra columns, the record number and the
+     * CRC-32 (8 hex digits) of everything on the line before that last
+     * comma; binary files are written as #MS_BINARY_LOG_VERSION_JOURNAL.
+     * After each sync of the data file, the file name, the position of the
+     * end of the data, and the last record number are saved to
+     * #MS_JOURNAL_FILE_NAME, alternating between two blocks so an entry cut
+     * short by a power loss never damages the one before it.
+     *
+     * When the logger begins, recoverLogFile() checks the records written
+     * after the last journal entry and removes any partial record at the end
+     * of the file.
+     *
+     * @warning Don't turn the journal off and back on while writing to the
+     * same file; records written without it would be cut off as damaged.
+     *
+     * @param enable True to turn the journal on
+     */
+    void setLogJournal(bool enable);
+    /**
+     * @brief Check the last journaled data file and cut off anything written
+     * after the last whole record.
+     *
+     * This is called by begin() when the journal is on.  It scans forward from
+     * the last journal entry, so it only reads the records of one batch.  A
+     * partial record is truncated away or, in a preallocated file, overwritten
+     * with zeros so the end of the data can still be found.  A file that
+     * was cut off while its header was written is deleted, to be created
+     * again.  The record numbers continue on from the last good record.
+     *
+     * The SD card must be powered before this is called.
+     *
+     * @return **bool** True if a journal was found and the file checked
+     */
+    bool recoverLogFile(void);
+
     /**
      * @brief Print a header out to a stream.
      *
@@ -814,6 +1714,40 @@ class Logger {
      */
     void printSensorDataCSV(Stream* stream);
 
+    /**
+     * @brief Write the self-describing header of a binary log file out to a
+     * stream.
+     *
+     * All numbers are little-endian.  The header is:
+     * - the four characters #MS_BINARY_LOG_MAGIC
+     * - uint8_t #MS_BINARY_LOG_VERSION, or #MS_BINARY_LOG_VERSION_JOURNAL
+     * with the record journal on
+     * - uint8_t the number of variables, N
+     * - int8_t the logger time zone
+     * - uint16_t the size of each record in bytes, 8 + 4 * N (12 + 4 * N
+     * with the record journal on)
+     * - the null-terminated logger ID, file name, and sampling feature UUID
+     * - for each variable, uint8_t the decimal resolution followed by the
+     * null-terminated sensor name, variable name, unit, UUID, and code
+     * - uint32_t the CRC-32 of all of the preceding header bytes
+     *
+     * @param stream An Arduino stream instance - expected to be an SdFat file.
+     */
+    void printBinaryFileHeader(Stream* stream);
+
+    /**
+     * @brief Write one fixed-width binary record of the most recent values of
+     * all variables out to a stream.
+     *
+     * The record is the uint32_t logging time (Logger::markedEpochTime, in
+     * the logging time zone), the uint32_t record number if the record journal
+     * is on, the float value of each variable in array order, and the
+     * uint32_t CRC-32 of those bytes.
+     *
+     * @param stream An Arduino stream instance - expected to be an SdFat file.
+     */
+    void writeBinaryRecord(Stream* stream);
+
     /**
      * @brief Create a file on the SD card and set the created, modified, and
      * accessed timestamps in that file.
@@ -828,6 +1762,10 @@ class Logger {
      * false
      * @return **bool** True if the file was successfully created.
      */
+    bool createLogFile(const char* filename, bool writeDefaultHeader = false);
+    /**
+     * @copydoc createLogFile(const char*, bool)
+     */
     bool createLogFile(String& filename, bool writeDefaultHeader = false);
     /**
      * @brief Create a file on the SD card and set the created, modified, and
@@ -857,6 +1795,10 @@ class Logger {
      * @return **bool** True if the file was successfully accessed or created
      * _and_ data appended to it.
      */
+    bool logToSD(const char* filename, String& rec);
+    /**
+     * @copydoc logToSD(const char*, String&)
+     */
     bool logToSD(String& filename, String& rec);
     /**
      * @brief Open a file named with the current internal filename value and
@@ -896,9 +1838,272 @@ class Logger {
      */
     File logFile;
     /**
-     * @brief An internal reference to the current filename
+     * @brief The current filename; empty until one is set or generated
+     */
+    char _fileName[MS_MAX_FILE_NAME_LENGTH + 1];
+    /**
+     * @brief The layout of the data files written to the SD card
+     */
+    logFileFormat _logFileFormat;
+    /**
+     * @brief The ring in RAM holding records that have not yet been written
+     * to the SD card
+     */
+    LogBuffer _logBuffer;
+    /**
+     * @brief The number of records to hold in the log buffer before writing
+     * them; 0 when records are written immediately
+     */
+    uint8_t _recordsPerFlush;
+    /**
+     * @brief The number of waiting bytes that will cause the log buffer to be
+     * written early; 0 to only use the room left for another record
+     */
+    uint16_t _flushBytes;
+    /**
+     * @brief The number of records waiting in the log buffer
+     */
+    uint8_t _bufferedRecords;
+    /**
+     * @brief The length of the longest record printed into the log buffer,
+     * used to decide whether the next one will fit
+     */
+    uint16_t _largestRecord;
+    /**
+     * @brief When to start a new data file
+     */
+    logRotation _logRotation;
+    /**
+     * @brief The number of bytes to preallocate for each data file (and the
+     * size limit when rotating by size), or 0 to not preallocate
+     */
+    uint32_t _fileBytes;
+    /**
+     * @brief The position just after the last byte of data in the current
+     * file, or 0 if it has not been found since the file was last opened
+     */
+    uint32_t _fileDataEnd;
+    /**
+     * @brief The number of bytes added by the most recent write to the file
+     */
+    uint32_t _lastAppendBytes;
+    /**
+     * @brief The day or month the current file was started in, as YYYYMMDD or
+     * YYYYMM
+     */
+    uint32_t _filePeriod;
+    /**
+     * @brief True to number each record and keep the record journal
+     */
+    bool _journalEnabled;
+    /**
+     * @brief The number of the most recent record
+     */
+    uint32_t _recordSequence;
+    /**
+     * @brief The journal block (0 or 1) that was written last
      */
-    String _fileName;
+    uint8_t _journalSlot;
+    /**
+     * @brief The write count of the newest journal entry, or 0 if the journal
+     * has not been read yet
+     */
+    uint32_t _journalWriteCount;
+    /**
+     * @brief The variable checked for a low battery, or NULL
+     */
+    Variable* _lowBatteryVar;
+    /**
+     * @brief The level of the battery variable below which the log buffer is
+     * flushed after every record
+     */
+    float _lowBatteryLevel;
+
+    /**
+     * @brief Write the most recent values to a stream in the chosen file
+     * layout.
+     *
+     * @param stream The stream to write to
+     */
+    void writeLogRecord(Stream* stream);
+    /**
+     * @brief Make sure the log file is open for appending, creating it with a
+     * header if needed, without re-starting the SD card when the file has
+     * been kept open.
+     *
+     * @return **bool** True if the file is open
+     */
+    bool openLogFile(void);
+    /**
+     * @brief Record where the data in the current file now ends, after
+     * writing to it.
+     */
+    void markLogFileEnd(void);
+    /**
+     * @brief Check whether a record from the given time belongs in a new file
+     * by a daily or monthly rotation policy.
+     *
+     * @param epochTime The time of the record, in the logging time zone.
+     * @return **bool** True if the current file is for an earlier day or
+     * month
+     */
+    bool isRotationPeriodOver(uint32_t epochTime);
+    /**
+     * @brief Check whether the next write would take the current file past
+     * its size by the LOG_ROTATE_BY_SIZE policy.
+     *
+     * @return **bool** True if the current file is full
+     */
+    bool isLogFileFull(void);
+    /**
+     * @brief Give back the unused space of the current file, close it, and
+     * name the next file.
+     *
+     * @param epochTime The time to name the next file for, in the logging
+     * time zone.
+     */
+    void rotateLogFile(uint32_t epochTime);
+    /**
+     * @brief Get the day (as YYYYMMDD) or month (as YYYYMM) of a time, by the
+     * current rotation policy.
+     *
+     * @param epochTime The number of seconds since 1970.
+     * @return **uint32_t** The rotation period
+     */
+    uint32_t getRotationPeriod(uint32_t epochTime);
+    /**
+     * @brief Create a file with all of its space allocated in one contiguous,
+     * erased, run of clusters and leave it open at the start.
+     *
+     * @param fileName The name of the file to create
+     * @param fileBytes The number of bytes to reserve
+     * @return **bool** True if the file was created
+     */
+    bool createPreallocatedFile(const char* fileName, uint32_t fileBytes);
+    /**
+     * @brief Find the end of the data in the current log file, which may be
+     * followed by erased, preallocated space.
+     *
+     * Text files are searched for the first erased (0x00 or 0xFF) byte and
+     * binary files for the first record with a bad CRC.
+     *
+     * @return **uint32_t** The position just after the last byte of data
+     */
+    uint32_t findLogFileDataEnd(void);
+    /**
+     * @brief Save the current file and the end of its data to the journal.
+     *
+     * @param fileName The name of the data file
+     * @param dataEnd The position just after the last whole record, or 0 for
+     * a file whose header has not been written yet
+     * @param sequence The number of the last record written
+     * @return **bool** True if the journal was written
+     */
+    bool updateLogJournal(const char* fileName, uint32_t dataEnd,
+                          uint32_t sequence);
+    /**
+     * @brief Read the newer of the two valid journal entries.
+     *
+     * @param entry The entry to fill in
+     * @return **bool** True if a valid entry was found
+     */
+    bool readLogJournal(logJournalEntry& entry);
+    /**
+     * @brief Check one record of a journaled file at the current position.
+     *
+     * @param file The open data file
+     * @param recordSize The size of each binary record, or 0 for a text file
+     * @param sequence Set to the number of the record if it is whole
+     * @return **uint16_t** The length of the record, or 0 if it is damaged
+     */
+    uint16_t checkJournalRecord(File& file, uint16_t recordSize,
+                                uint32_t& sequence);
+    /**
+     * @brief Check whether the battery variable is below the level set with
+     * setLowBatteryFlush().
+     *
+     * @return **bool** True if the battery is low
+     */
+    bool isBatteryLow(void);
+
+    /**
+     * @brief Check whether the clock should be synced on the marked logging
+     * interval.
+     *
+     * The clock is synced at noon, every day unless the drift is tracked, and
+     * whenever it's clearly wrong.
+     *
+     * @return **bool** True if the clock should be synced
+     */
+    bool isClockSyncDue(void);
+    /**
+     * @brief Add the offset found by a clock sync to the drift fit and save
+     * it.
+     *
+     * @param UTCEpochSeconds The time synced to, in seconds since 1970 in UTC
+     * @param offset The seconds the clock was behind that time (or ahead, if
+     * negative)
+     * @param accuracyMillis The accuracy of the time synced to, in
+     * milliseconds
+     */
+    void updateClockDrift(uint32_t UTCEpochSeconds, int32_t offset,
+                          uint32_t accuracyMillis);
+    /**
+     * @brief Step the clock by whole seconds to take out the drift predicted
+     * since the last sync.
+     *
+     * This is skipped within a few seconds of the top of the minute, so the
+     * step can never move the clock across the alarm that wakes the logger.
+     */
+    void compensateClockDrift(void);
+    /**
+     * @brief Read the saved drift fit into #_clockDrift.
+     *
+     * @return **bool** True if a valid fit was found
+     */
+    bool readClockDrift(void);
+    /**
+     * @brief Save #_clockDrift to #MS_CLOCK_DRIFT_FILE_NAME.
+     *
+     * @return **bool** True if the fit was written
+     */
+    bool writeClockDrift(void);
+
+    /**
+     * @brief Update a running CRC-32 (the zlib/IEEE 802.3 polynomial) with
+     * more bytes.
+     *
+     * Start with a crc of 0; the result of one call can be passed to the next
+     * to extend the checksum over data written in pieces.  This is computed
+     * bit by bit to avoid using RAM or flash for a lookup table.
+     *
+     * @param crc The CRC-32 of the data before this block
+     * @param data The bytes to add
+     * @param length The number of bytes to add
+     * @return **uint32_t** The CRC-32 of all of the data so far
+     */
+    static uint32_t updateCRC32(uint32_t crc, const void* data,
+                                size_t length);
+    /**
+     * @brief Write bytes to a stream and add them to a running CRC-32.
+     *
+     * @param stream The stream to write to
+     * @param data The bytes to write
+     * @param length The number of bytes to write
+     * @param crc The running CRC-32, updated in place
+     */
+    static void writeWithCRC32(Stream* stream, const void* data, size_t length,
+                               uint32_t& crc);
+    /**
+     * @brief Write a string including its terminating null to a stream and
+     * add it to a running CRC-32.  A NULL string is written as an empty one.
+     *
+     * @param stream The stream to write to
+     * @param text The string to write
+     * @param crc The running CRC-32, updated in place
+     */
+    static void writeStringWithCRC32(Stream* stream, const char* text,
+                                     uint32_t& crc);
 
     /**
      * @brief Check if the SD card is available and ready to write to.
@@ -914,8 +2119,11 @@ class Logger {
      * @brief Generate a file name from the logger id and the current date.
      *
      * @note This cannot be called until *after* the RTC is started
+     *
+     * @param epochTime The time to name the file for, in the logging time
+     * zone; optional with a default value of 0 for the current time.
      */
-    void generateAutoFileName(void);
+    void generateAutoFileName(uint32_t epochTime = 0);
 
     /**
      * @brief Set a timestamp on a file.
@@ -927,8 +2135,7 @@ class Logger {
     void setFileTimestamp(File fileToStamp, uint8_t stampFlag);
 
     /**
-     * @brief Open or creates a file, converting a string file name to a
-     * character file name.
+     * @brief Open or creates a file.
      *
      * @param filename The name of the file to open
      * @param createFile True to create the file if it did not already exist
@@ -936,7 +2143,8 @@ class Logger {
      * created
      * @return **bool** True if a file was successfully opened or created.
      */
-    bool openFile(String& filename, bool createFile, bool writeDefaultHeader);
+    bool openFile(const char* filename, bool createFile,
+                  bool writeDefaultHeader);
 
 
     // ===================================================================== //
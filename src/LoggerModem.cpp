@@ -8,6 +8,7 @@
  */
 
 #include "LoggerModem.h"
+#include "ProcessorIdle.h"
 
 // Initialize the static members
 int16_t loggerModem::_priorRSSI           = -9999;
@@ -18,6 +19,7 @@ float   loggerModem::_priorBatteryPercent = -9999;
 float   loggerModem::_priorBatteryVoltage = -9999;
 // float loggerModem::_priorActivationDuration = -9999;
 // float loggerModem::_priorPoweredDuration = -9999;
+void (*loggerModem::_idleHook)(void) = NULL;
 
 // Constructor
 loggerModem::loggerModem(int8_t powerPin, int8_t statusPin, bool statusLevel,
@@ -37,7 +39,14 @@ loggerModem::loggerModem(int8_t powerPin, int8_t statusPin, bool statusLevel,
       _wakeDelayTime_ms(wakeDelayTime_ms),
       _max_atresponse_time_ms(max_atresponse_time_ms), _modemLEDPin(-1),
       _millisPowerOn(0), _lastNISTrequest(0), _hasBeenSetup(false),
-      _pinModesSet(false), _modemName("unspecified modem") {}
+      _pinModesSet(false), _phase(MODEM_PHASE_NONE), _phaseStart(0),
+      _timeSource(MODEM_TIME_NONE), _modemName("unspecified modem") {
+    resetPhaseTimes();
+    for (uint8_t s = 0; s < MODEM_TIME_NONE; s++) {
+        _timeLatency[s]  = 0;
+        _timeAccuracy[s] = -9999;
+    }
+}
 
 
 // Destructor
@@ -103,6 +112,145 @@ void loggerModem::modemPowerDown(void) {
     }
 }
 
+
+// Sets the function to call whenever the processor wakes during a modem wait
+void loggerModem::setIdleHook(void (*idleHook)(void)) {
+    _idleHook = idleHook;
+}
+
+
+// Sleeps the processor until the given time, crediting the sleep to the
+// current step
+void loggerModem::idleUntil(uint32_t wakeMillis) {
+    idleProcessorUntil(wakeMillis, &loggerModem::onIdleWake, this);
+}
+void loggerModem::onIdleWake(uint32_t sleptMillis, void* context) {
+    loggerModem* modem = static_cast<loggerModem*>(context);
+    if (modem->_phase != MODEM_PHASE_NONE) {
+        modem->_phaseIdleTime[modem->_phase] += sleptMillis;
+    }
+    if (_idleHook != NULL) { _idleHook(); }
+}
+
+
+// Credits the time so far to the current step and starts timing another
+modemPhase loggerModem::beginPhase(modemPhase phase) {
+    modemPhase outerPhase = _phase;
+    uint32_t   now        = millis();
+    if (_phase != MODEM_PHASE_NONE) {
+        _phaseTime[_phase] += now - _phaseStart;
+        MS_DBG(F("Modem step"), _phase, F("has taken"), _phaseTime[_phase],
+               F("ms in total, with the processor active for"),
+               _phaseTime[_phase] - _phaseIdleTime[_phase], F("ms"));
+    }
+    _phase      = phase;
+    _phaseStart = now;
+    return outerPhase;
+}
+void loggerModem::endPhase(modemPhase outerPhase) {
+    beginPhase(outerPhase);
+}
+
+
+uint32_t loggerModem::getPhaseTime(modemPhase phase) {
+    if (phase >= MODEM_PHASE_NONE) return 0;
+    uint32_t total = _phaseTime[phase];
+    // Include the step that's still going
+    if (phase == _phase) total += millis() - _phaseStart;
+    return total;
+}
+uint32_t loggerModem::getPhaseActiveTime(modemPhase phase) {
+    if (phase >= MODEM_PHASE_NONE) return 0;
+    return getPhaseTime(phase) - _phaseIdleTime[phase];
+}
+uint32_t loggerModem::getIdleTime(void) {
+    uint32_t total = 0;
+    for (uint8_t p = 0; p < MODEM_PHASE_NONE; p++) {
+        total += _phaseIdleTime[p];
+    }
+    return total;
+}
+void loggerModem::resetPhaseTimes(void) {
+    for (uint8_t p = 0; p < MODEM_PHASE_NONE; p++) {
+        _phaseTime[p]     = 0;
+        _phaseIdleTime[p] = 0;
+    }
+    _phaseStart = millis();
+}
+
+
+uint32_t loggerModem::getUTCTime(void) {
+    modemPhase outerPhase = beginPhase(MODEM_PHASE_TIME_SYNC);
+    for (uint8_t s = 0; s < MODEM_TIME_NONE; s++) {
+        _timeLatency[s]  = 0;
+        _timeAccuracy[s] = -9999;
+    }
+
+    // The network's time costs one AT command once the module has registered
+    uint32_t start                   = millis();
+    uint32_t utcTime                 = getModemNetworkTime();
+    _timeLatency[MODEM_TIME_NETWORK] = millis() - start;
+    if (utcTime != 0) {
+        // The clock only has whole seconds, and we don't know when in the
+        // read it was stamped
+        _timeAccuracy[MODEM_TIME_NETWORK] =
+            1000L + _timeLatency[MODEM_TIME_NETWORK];
+        _timeSource = MODEM_TIME_NETWORK;
+        MS_DBG(F("Got the network time from the modem's clock in"),
+               _timeLatency[MODEM_TIME_NETWORK], F("ms"));
+        endPhase(outerPhase);
+        return utcTime;
+    }
+
+    // SNTP sets the module's clock, which is then read the same way; only the
+    // read adds to the error
+    start = millis();
+    if (syncModemClockSNTP()) {
+        uint32_t readStart            = millis();
+        utcTime                       = getModemNetworkTime();
+        _timeLatency[MODEM_TIME_SNTP] = millis() - start;
+        if (utcTime != 0) {
+            _timeAccuracy[MODEM_TIME_SNTP] = 1000L + millis() - readStart;
+            _timeSource                    = MODEM_TIME_SNTP;
+            MS_DBG(F("Got the time by SNTP in"), _timeLatency[MODEM_TIME_SNTP],
+                   F("ms"));
+            endPhase(outerPhase);
+            return utcTime;
+        }
+    } else {
+        _timeLatency[MODEM_TIME_SNTP] = millis() - start;
+    }
+
+    // Last, the TIME protocol over TCP; the whole exchange adds to the error
+    start                           = millis();
+    utcTime                         = getNISTTime();
+    _timeLatency[MODEM_TIME_RFC868] = millis() - start;
+    if (utcTime != 0) {
+        _timeAccuracy[MODEM_TIME_RFC868] =
+            1000L + _timeLatency[MODEM_TIME_RFC868];
+        _timeSource = MODEM_TIME_RFC868;
+        MS_DBG(F("Got the time from NIST in"), _timeLatency[MODEM_TIME_RFC868],
+               F("ms"));
+    } else {
+        _timeSource = MODEM_TIME_NONE;
+        MS_DBG(F("Could not get the time from any source!"));
+    }
+    endPhase(outerPhase);
+    return utcTime;
+}
+modemTimeSource loggerModem::getLastTimeSource(void) {
+    return _timeSource;
+}
+uint32_t loggerModem::getTimeSourceLatency(modemTimeSource source) {
+    if (source >= MODEM_TIME_NONE) return 0;
+    return _timeLatency[source];
+}
+int32_t loggerModem::getTimeSourceAccuracy(modemTimeSource source) {
+    if (source >= MODEM_TIME_NONE) return -9999;
+    return _timeAccuracy[source];
+}
+
+
 bool loggerModem::modemSetup(void) {
     // NOTE:  Set flag FIRST to stop infinite loop between modemSetup() and
     // modemWake()
@@ -121,7 +269,7 @@ bool loggerModem::modemSetup(void) {
     // Check if the modem was awake, wake it if not
     bool wasAwake = isModemAwake();
     if (!wasAwake) {
-        while (millis() - _millisPowerOn < _wakeDelayTime_ms) {}
+        idleUntil(_millisPowerOn + _wakeDelayTime_ms);
         MS_DBG(F("Waking up the modem for setup ..."));
         success &= modemWake();
     } else {
@@ -194,8 +342,9 @@ bool loggerModem::modemSleep(void) {
 
 // Nicely put the modem to sleep and power down
 bool loggerModem::modemSleepPowerDown(void) {
-    bool     success = true;
-    uint32_t start   = millis();
+    bool       success    = true;
+    uint32_t   start      = millis();
+    modemPhase outerPhase = beginPhase(MODEM_PHASE_SHUTDOWN);
     MS_DBG(F("Turning"), getModemName(), F("off."));
 
     modemSleep();
@@ -210,7 +359,9 @@ bool loggerModem::modemSleepPowerDown(void) {
                    _statusPin, F("going"), !_statusLevel ? F("HIGH") : F("LOW"),
                    F("..."));
             while (millis() - start < _disconnetTime_ms &&
-                   digitalRead(_statusPin) == static_cast<int>(_statusLevel)) {}
+                   digitalRead(_statusPin) == static_cast<int>(_statusLevel)) {
+                idleUntil(millis() + 1);
+            }
             if (digitalRead(_statusPin) == static_cast<int>(_statusLevel)) {
                 MS_DBG(F("... "), getModemName(),
                        F("did not successfully shut down!"));
@@ -221,7 +372,7 @@ bool loggerModem::modemSleepPowerDown(void) {
         } else if (_disconnetTime_ms > 0) {
             MS_DBG(F("Waiting"), _disconnetTime_ms,
                    F("ms for graceful shutdown."));
-            while (millis() - start < _disconnetTime_ms) {}
+            idleUntil(start + _disconnetTime_ms);
         }
 
         // loggerModem::_priorPoweredDuration =
@@ -247,6 +398,7 @@ bool loggerModem::modemSleepPowerDown(void) {
         // _millisPowerOn = 0;
     }
 
+    endPhase(outerPhase);
     return success;
 }
 
@@ -257,7 +409,7 @@ bool loggerModem::modemHardReset(void) {
                _modemResetPin, _resetLevel ? F("HIGH") : F("LOW"), F("for"),
                _resetPulse_ms, F("ms"));
         digitalWrite(_modemResetPin, _resetLevel);
-        delay(_resetPulse_ms);
+        idleUntil(millis() + _resetPulse_ms);
         digitalWrite(_modemResetPin, !_resetLevel);
         return true;
     } else {
@@ -337,7 +489,7 @@ bool loggerModem::updateModemMetadata(void) {
         loggerModem::_priorRSSI          = rssi;
         loggerModem::_priorSignalPercent = percent;
         if (rssi != 0 && rssi != -9999) break;
-        delay(250);
+        idleUntil(millis() + 250);
     } while ((rssi == 0 || rssi == -9999) && millis() - startMillis < 15000L &&
              success);
     MS_DBG(F("CURRENT RSSI:"), rssi);
@@ -478,6 +630,42 @@ uint32_t loggerModem::parseNISTBytes(byte nistBytes[4]) {
 }
 
 
+uint32_t loggerModem::parseNetworkTime(int year, int month, int day, int hour,
+                                       int minute, int second, float timeZone) {
+    MS_DBG(F("Modem clock:"), year, '-', month, '-', day, ' ', hour, ':',
+           minute, ':', second, F("at UTC offset"), timeZone);
+    // A clock that has never been set reads 1980 or 2000 on most modules
+    if (year < 2018 || year > 2030 || month < 1 || month > 12 || day < 1 ||
+        day > 31) {
+        return 0;
+    }
+
+    // Count days since Jan 1, 1970 with years starting in March, so the leap
+    // day is the last day of the year
+    uint32_t y         = year - (month <= 2 ? 1 : 0);
+    uint32_t yearOfEra = y % 400;
+    uint32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 +
+        day - 1;
+    uint32_t days = (y / 400) * 146097UL + yearOfEra * 365 + yearOfEra / 4 -
+        yearOfEra / 100 + dayOfYear - 719468UL;
+
+    // The clock keeps local time, so take the offset off to get UTC
+    uint32_t unixTimeStamp = days * 86400UL +
+        static_cast<uint32_t>(hour) * 3600UL +
+        static_cast<uint32_t>(minute) * 60UL + second -
+        static_cast<int32_t>(timeZone * 3600);
+    MS_DBG(F("Unix Timestamp from the modem clock (UTC):"), unixTimeStamp);
+    // If before Jan 1, 2019 or after Jan 1, 2030, most likely an error
+    if (unixTimeStamp < 1546300800) {
+        return 0;
+    } else if (unixTimeStamp > 1893456000) {
+        return 0;
+    } else {
+        return unixTimeStamp;
+    }
+}
+
+
 /***
 NOTE:  These times are for raw cellular chips they do no necessarily
 apply to assembled break-out boards or modules
@@ -71,6 +71,49 @@
 /// Decimals places in string representation; total powered time should have 3.
 #define MODEM_POWERED_RESOLUTION 3
 
+/**
+ * @brief The SNTP server the modem sets its clock from.
+ *
+ * Only used by modems with their own SNTP client.
+ */
+#ifndef MS_SNTP_SERVER
+#define MS_SNTP_SERVER "pool.ntp.org"
+#endif
+
+/**
+ * @brief Where a time given by loggerModem::getUTCTime() came from, in the
+ * order they are tried.
+ */
+typedef enum modemTimeSource {
+    /// The time the cellular network gave the module (NITZ).
+    MODEM_TIME_NETWORK = 0,
+    /// The module's clock, just set by its own SNTP client.
+    MODEM_TIME_SNTP,
+    /// NIST's TIME protocol (RFC 868) over TCP.
+    MODEM_TIME_RFC868,
+    /// No time was found; this is also the number of sources.
+    MODEM_TIME_NONE
+} modemTimeSource;
+
+/**
+ * @brief The steps in using a modem whose wall and processor active times are
+ * tracked.
+ *
+ * @see loggerModem::getPhaseTime(modemPhase)
+ */
+typedef enum modemPhase {
+    /// Warming up, waking, and getting AT responses from the module.
+    MODEM_PHASE_WAKE = 0,
+    /// Registering on the network and making a data connection.
+    MODEM_PHASE_CONNECT,
+    /// Getting the time from the network, an SNTP server, or NIST.
+    MODEM_PHASE_TIME_SYNC,
+    /// Disconnecting, sleeping, and waiting for the module to shut down.
+    MODEM_PHASE_SHUTDOWN,
+    /// Not in any tracked step; this is also the number of tracked steps.
+    MODEM_PHASE_NONE
+} modemPhase;
+
 /* ===========================================================================
  * Functions for the modem class
  * This is basically a wrapper for TinyGsm with power control added
@@ -306,6 +349,8 @@ class loggerModem {
     /**
      * @brief Get the time from NIST via TIME protocol (rfc868).
      *
+     * This is the last resort of getUTCTime().
+     *
      * This would be much more efficient if done over UDP, but I'm doing it over
      * TCP because I don't have a UDP library for all the modems.
      *
@@ -314,6 +359,71 @@ class loggerModem {
      * @return **uint32_t** The number of seconds since Jan 1, 1970 IN UTC
      */
     virtual uint32_t getNISTTime(void) = 0;
+    /**
+     * @brief Get the time the modem has been given by the cellular network.
+     *
+     * Most cellular networks send the time (NITZ) as a module registers, and
+     * the module keeps it in its own clock.  Reading that clock takes a single
+     * AT command, but how closely the network's time matches true time is up
+     * to the carrier, and some carriers never send it.  The module's clock
+     * only counts in whole seconds.
+     *
+     * @return **uint32_t** The number of seconds since Jan 1, 1970 IN UTC, or
+     * 0 if the modem can't report the network time or its clock is not set.
+     */
+    virtual uint32_t getModemNetworkTime(void) = 0;
+    /**
+     * @brief Ask the modem to set its own clock from an SNTP server.
+     *
+     * Modules with an SNTP client send the UDP request themselves and set
+     * their clock from the answer, which is then read with
+     * getModemNetworkTime().  The server is #MS_SNTP_SERVER.
+     *
+     * @return **bool** True if the modem's clock was set from the SNTP
+     * server.  False if it failed or the modem has no SNTP client.
+     */
+    virtual bool syncModemClockSNTP(void) = 0;
+    /**
+     * @brief Get the current time from the best source the modem has.
+     *
+     * The sources are tried in order: the time from the cellular network,
+     * then SNTP, then NIST's TIME protocol.  The first to give a sane time is
+     * used.  The latency and accuracy of each source that was tried are kept
+     * to be read with getTimeSourceLatency(modemTimeSource) and
+     * getTimeSourceAccuracy(modemTimeSource).
+     *
+     * @return **uint32_t** The number of seconds since Jan 1, 1970 IN UTC, or
+     * 0 if no source gave a time.
+     */
+    uint32_t getUTCTime(void);
+    /**
+     * @brief Get the source of the last time returned by getUTCTime().
+     *
+     * @return **modemTimeSource** The source used, or #MODEM_TIME_NONE if no
+     * source gave a time.
+     */
+    modemTimeSource getLastTimeSource(void);
+    /**
+     * @brief Get how long the last attempt to get the time from a source
+     * took.
+     *
+     * @param source The time source.
+     * @return **uint32_t** The milliseconds the last attempt took, whether or
+     * not it succeeded, or 0 if the source hasn't been tried.
+     */
+    uint32_t getTimeSourceLatency(modemTimeSource source);
+    /**
+     * @brief Get the worst case error of the last time given by a source.
+     *
+     * This is the whole second the time is truncated to plus the time taken
+     * to read it, since it isn't known when during the exchange the time was
+     * stamped.
+     *
+     * @param source The time source.
+     * @return **int32_t** The possible error in milliseconds, or -9999 if the
+     * last attempt with the source failed or it hasn't been tried.
+     */
+    int32_t getTimeSourceAccuracy(modemTimeSource source);
     /**@}*/
 
 
@@ -377,6 +487,56 @@ class loggerModem {
     virtual bool updateModemMetadata(void);
     /**@}*/
 
+    /**
+     * @anchor modem_idle_functions
+     * @name Functions for waiting on the modem
+     * While the modem is warming up, searching for a network, waiting on a
+     * server, or shutting down, the processor sleeps between timer ticks
+     * instead of spinning.
+     */
+    /**@{*/
+    /**
+     * @brief Set a function to be called every time the processor wakes
+     * while waiting on the modem.
+     *
+     * The function is called about once a millisecond, for as long as the
+     * wait lasts, and can be used to keep other work (like checking on
+     * sensors or feeding a watchdog) moving along.  It must return quickly.
+     * Pass NULL to stop calling it.
+     *
+     * @param idleHook A function to call while waiting on the modem.
+     */
+    static void setIdleHook(void (*idleHook)(void));
+    /**
+     * @brief Get the total time spent in one step of using the modem.
+     *
+     * @param phase The step to get the time for.
+     * @return **uint32_t** The number of milliseconds spent in that step since
+     * the times were last reset.
+     */
+    uint32_t getPhaseTime(modemPhase phase);
+    /**
+     * @brief Get the time the processor was active, rather than sleeping,
+     * during one step of using the modem.
+     *
+     * @param phase The step to get the time for.
+     * @return **uint32_t** The number of milliseconds the processor was active
+     * in that step since the times were last reset.
+     */
+    uint32_t getPhaseActiveTime(modemPhase phase);
+    /**
+     * @brief Get the time the processor slept in all of the steps together.
+     *
+     * @return **uint32_t** The number of milliseconds the processor slept
+     * while waiting on the modem since the times were last reset.
+     */
+    uint32_t getIdleTime(void);
+    /**
+     * @brief Set the wall and active times of all of the steps back to zero.
+     */
+    void resetPhaseTimes(void);
+    /**@}*/
+
     /**
      * @anchor modem_static_functions
      * @name Functions to return the current value of static member variables
@@ -498,6 +658,43 @@ class loggerModem {
      * pullup) for all pins connected between the modem module and the mcu.
      */
     virtual void setModemPinModes(void);
+    /**
+     * @brief Let the processor sleep until the given time.
+     *
+     * This sleeps with idleProcessorUntil(), so serial interrupts still wake
+     * the processor.  The time slept is credited to the step being timed, and
+     * the idle hook, if any, is called after every wake.  Returns immediately
+     * if the time has passed.
+     *
+     * @param wakeMillis The processor time (millis()) to wait for.
+     */
+    void idleUntil(uint32_t wakeMillis);
+    /**
+     * @brief Credit a sleep to the step being timed and call the idle hook;
+     * called by idleProcessorUntil() after every wake in idleUntil().
+     *
+     * @param sleptMillis The milliseconds the processor slept.
+     * @param context The modem that is waiting.
+     */
+    static void onIdleWake(uint32_t sleptMillis, void* context);
+    /**
+     * @brief Start timing one step of using the modem.
+     *
+     * The time so far is credited to the step already being timed, which
+     * picks up again when this one ends.
+     *
+     * @param phase The step being started.
+     * @return **modemPhase** The step that was being timed before, to give to
+     * endPhase(modemPhase).
+     */
+    modemPhase beginPhase(modemPhase phase);
+    /**
+     * @brief Stop timing the current step of using the modem.
+     *
+     * @param outerPhase The step returned by beginPhase(modemPhase), which is
+     * timed again from now.
+     */
+    void endPhase(modemPhase outerPhase);
     /**@}*/
 
     /**
@@ -579,6 +776,22 @@ class loggerModem {
      * UTC
      */
     static uint32_t parseNISTBytes(byte nistBytes[4]);
+    /**
+     * @brief Convert a date and time read from the modem's clock to the number
+     * of seconds since January 1, 1970 in UTC.
+     *
+     * @param year The full year, ie 2021
+     * @param month The month, 1-12
+     * @param day The day of the month, 1-31
+     * @param hour The hour, 0-23
+     * @param minute The minute, 0-59
+     * @param second The second, 0-59
+     * @param timeZone The offset of the clock from UTC in hours
+     * @return **uint32_t** the number of seconds since January 1, 1970 00:00:00
+     * UTC, or 0 if the clock hasn't been set (ie, it's before 2019).
+     */
+    static uint32_t parseNetworkTime(int year, int month, int day, int hour,
+                                     int minute, int second, float timeZone);
 
     /**
      * @anchor modem_ctor_variables
@@ -722,6 +935,42 @@ class loggerModem {
     bool _pinModesSet;
     /**@}*/
 
+    /**
+     * @brief The step of using the modem being timed now.
+     */
+    modemPhase _phase;
+    /**
+     * @brief The processor time when the time of the current step was last
+     * credited.
+     */
+    uint32_t _phaseStart;
+    /**
+     * @brief The total milliseconds spent in each step.
+     */
+    uint32_t _phaseTime[MODEM_PHASE_NONE];
+    /**
+     * @brief The milliseconds the processor slept during each step.
+     */
+    uint32_t _phaseIdleTime[MODEM_PHASE_NONE];
+    /**
+     * @brief The function called whenever the processor wakes while waiting on
+     * the modem.
+     */
+    static void (*_idleHook)(void);
+
+    /**
+     * @brief The source of the last time given by getUTCTime().
+     */
+    modemTimeSource _timeSource;
+    /**
+     * @brief How long the last attempt with each time source took.
+     */
+    uint32_t _timeLatency[MODEM_TIME_NONE];
+    /**
+     * @brief The possible error of the last time from each source.
+     */
+    int32_t _timeAccuracy[MODEM_TIME_NONE];
+
     // NOTE:  These must be static so that the modem variables can call the
     // member functions that return them.  (Non-static member functions cannot
     // be called without an object.)
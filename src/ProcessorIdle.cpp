@@ -0,0 +1,37 @@
+/**
+ * @file ProcessorIdle.cpp
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Implements idleProcessorUntil().
+ */
+
+#include "ProcessorIdle.h"
+#if defined(ARDUINO_ARCH_AVR) || defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+
+// Sleeps the processor between timer ticks until the given time
+// NOTE:  Both sleep modes used here are woken by the 1ms system timer tick and
+// by serial interrupts, so millis() keeps counting and this returns at most
+// ~1ms late.
+void idleProcessorUntil(uint32_t wakeMillis, idleWakeCallback onWake,
+                        void* context) {
+    while (static_cast<int32_t>(wakeMillis - millis()) > 0) {
+        uint32_t sleepStart = millis();
+#if defined ARDUINO_ARCH_SAMD
+        // Make sure a previous standby sleep didn't leave deep sleep selected
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+        __DSB();
+        __WFI();
+#elif defined(ARDUINO_ARCH_AVR) || defined(__AVR__)
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_mode();
+#else
+        yield();
+#endif
+        if (onWake != NULL) { onWake(millis() - sleepStart, context); }
+    }
+}
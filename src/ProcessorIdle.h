@@ -0,0 +1,44 @@
+/**
+ * @file ProcessorIdle.h
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Contains idleProcessorUntil(), the light sleep used for short waits.
+ */
+
+// Header Guards
+#ifndef SRC_PROCESSORIDLE_H_
+#define SRC_PROCESSORIDLE_H_
+
+// Included Dependencies
+#include <Arduino.h>
+
+/**
+ * @brief A function called each time the processor wakes during
+ * idleProcessorUntil().
+ *
+ * @param sleptMillis The milliseconds the processor slept before this wake.
+ * @param context The pointer given to idleProcessorUntil().
+ */
+typedef void (*idleWakeCallback)(uint32_t sleptMillis, void* context);
+
+/**
+ * @brief Let the processor sleep until the given time.
+ *
+ * On AVR boards this puts the processor in "idle" sleep between timer ticks,
+ * on SAMD boards it waits for the next interrupt (WFI) with deep sleep
+ * disabled.  All peripherals, timers, and serial interrupts keep running in
+ * both cases, so characters are still received and the processor wakes
+ * within a millisecond of the time.  Returns immediately if the time has
+ * passed.
+ *
+ * @param wakeMillis The processor time (millis()) to wait for.
+ * @param onWake A function to call after every wake, to count the time slept
+ * or to do other work; may be NULL.
+ * @param context A pointer passed on to onWake.
+ */
+void idleProcessorUntil(uint32_t wakeMillis, idleWakeCallback onWake = NULL,
+                        void* context = NULL);
+
+#endif  // SRC_PROCESSORIDLE_H_
@@ -9,6 +9,7 @@
 
 #include "SensorBase.h"
 #include "VariableBase.h"
+#include "StatisticVariable.h"
 
 // ============================================================================
 //  The class and functions for interfacing with a sensor
@@ -56,6 +57,10 @@ Sensor::Sensor(const char* sensorName, const uint8_t numReturnedVars,
         sensorValues[i]               = -9999;
         numberGoodMeasurementsMade[i] = 0;
     }
+    _statistics = NULL;
+
+    // Use a plain mean until a robust mode and buffer are given
+    _averaging = NULL;
 
     // Reset the sensor status
     _sensorStatus = 0;
@@ -78,6 +83,9 @@ String Sensor::getSensorLocation(void) {
 String Sensor::getSensorName(void) {
     return _sensorName;
 }
+const char* Sensor::getSensorNameChars(void) {
+    return _sensorName;
+}
 
 
 // This concatentates and returns the name and location.
@@ -102,6 +110,35 @@ uint8_t Sensor::getNumberMeasurementsToAverage(void) {
 }
 
 
+bool Sensor::setAveragingMode(averagingMode mode, float modeParameter) {
+    if (_averaging == NULL) {
+        // The mean needs nothing kept, so it's the only mode that works here
+        if (mode == AVERAGE_MEAN) return true;
+        PRINTOUT(F("No averaging buffer has been given to"),
+                 getSensorNameAndLocation(),
+                 F("; call setAveragingBuffer() first.  The mean will be "
+                   "used."));
+        return false;
+    }
+    _averaging->mode      = mode;
+    _averaging->parameter = modeParameter;
+    return true;
+}
+averagingMode Sensor::getAveragingMode(void) {
+    if (_averaging == NULL) return AVERAGE_MEAN;
+    return _averaging->mode;
+}
+void Sensor::setAveragingBuffer(averagingState* state) {
+    _averaging = state;
+    if (state == NULL) return;
+    // Split the buffer evenly between the returned values
+    uint16_t perResult = state->samples == NULL
+        ? 0
+        : state->sampleCount / _numReturnedValues;
+    state->samplesPerResult = perResult > 255 ? 255 : perResult;
+}
+
+
 // This returns the 8-bit code for the current status of the sensor.
 // Bit 0 - 0=Has NOT been set up, 1=Has been setup
 // Bit 1 - 0=No attempt made to power sensor, 1=Attempt made to power sensor
@@ -117,6 +154,18 @@ uint8_t Sensor::getStatus(void) {
 }
 
 
+// These return when each step of the current update began
+uint32_t Sensor::getMillisPowerOn(void) {
+    return _millisPowerOn;
+}
+uint32_t Sensor::getMillisSensorActivated(void) {
+    return _millisSensorActivated;
+}
+uint32_t Sensor::getMillisMeasurementRequested(void) {
+    return _millisMeasurementRequested;
+}
+
+
 // This turns on sensor power
 void Sensor::powerUp(void) {
     if (_powerPin >= 0) {
@@ -281,6 +330,17 @@ void Sensor::registerVariable(int sensorVarNum, Variable* var) {
 }
 
 
+// This adds an accumulator to the list of statistics to accumulate
+void Sensor::registerAccumulator(StatisticAccumulator* accumulator) {
+    for (StatisticAccumulator* a = _statistics; a != NULL;
+         a = a->nextAccumulator) {
+        if (a == accumulator) return;
+    }
+    accumulator->nextAccumulator = _statistics;
+    _statistics                  = accumulator;
+}
+
+
 /*String Sensor::getStringValueArray(void)
 {
     String retVal = "[";
@@ -313,6 +373,12 @@ void Sensor::notifyVariables(void) {
                    F("!  No update sent!"));
         }
     }
+
+    // Notify statistics of update
+    for (StatisticAccumulator* a = _statistics; a != NULL;
+         a = a->nextAccumulator) {
+        a->notifyStatistics();
+    }
 }
 
 
@@ -323,6 +389,10 @@ void Sensor::clearValues(void) {
         sensorValues[i]               = -9999;
         numberGoodMeasurementsMade[i] = 0;
     }
+    for (StatisticAccumulator* a = _statistics; a != NULL;
+         a = a->nextAccumulator) {
+        a->resetStatistics();
+    }
 }
 
 
@@ -330,6 +400,14 @@ void Sensor::clearValues(void) {
 // averaged
 void Sensor::verifyAndAddMeasurementResult(uint8_t resultNumber,
                                            float   resultValue) {
+    // Feed any good result to the accumulator watching this result number
+    StatisticAccumulator* accumulator = _statistics;
+    while (resultValue != -9999 && accumulator != NULL) {
+        if (accumulator->getSensorVarNum() == resultNumber) {
+            accumulator->addSample(resultValue);
+        }
+        accumulator = accumulator->nextAccumulator;
+    }
     // If the new result is good and there was were only bad results, set the
     // result value as the new result and add 1 to the good result total
     if (sensorValues[resultNumber] == -9999 && resultValue != -9999) {
@@ -356,6 +434,16 @@ void Sensor::verifyAndAddMeasurementResult(uint8_t resultNumber,
                getSensorNameAndLocation(),
                F("; good results already in array."));
     }
+
+    // Keep a copy of each good result for the robust averaging modes, as
+    // long as there is room for it
+    if (resultValue != -9999 && _averaging != NULL &&
+        numberGoodMeasurementsMade[resultNumber] <=
+            _averaging->samplesPerResult) {
+        _averaging->samples[resultNumber * _averaging->samplesPerResult +
+                            numberGoodMeasurementsMade[resultNumber] - 1] =
+            resultValue;
+    }
 }
 void Sensor::verifyAndAddMeasurementResult(uint8_t resultNumber,
                                            int16_t resultValue) {
@@ -368,13 +456,73 @@ void Sensor::averageMeasurements(void) {
     MS_DBG(F("Averaging results from"), getSensorNameAndLocation(), F("over"),
            _measurementsToAverage, F("reading[s]"));
     for (uint8_t i = 0; i < _numReturnedValues; i++) {
-        if (numberGoodMeasurementsMade[i] > 0)
+        // Only as many samples as fit in the buffer were kept
+        uint8_t nBuffered = _averaging == NULL
+            ? 0
+            : min(numberGoodMeasurementsMade[i], _averaging->samplesPerResult);
+        if (nBuffered > 0 && _averaging->mode != AVERAGE_MEAN) {
+            sensorValues[i] = combineSamples(
+                &_averaging->samples[i * _averaging->samplesPerResult],
+                nBuffered);
+        } else if (numberGoodMeasurementsMade[i] > 0) {
             sensorValues[i] /= numberGoodMeasurementsMade[i];
+        }
         MS_DBG(F("    ->Result #"), i, ':', sensorValues[i]);
     }
 }
 
 
+float Sensor::combineSamples(float samples[], uint8_t sampleCount) {
+    // Insertion sort - the sample count is small and the buffer is scratch
+    for (uint8_t i = 1; i < sampleCount; i++) {
+        float   value = samples[i];
+        uint8_t j     = i;
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+
+    // For an even count, the median is the mean of the middle pair
+    float median = (samples[(sampleCount - 1) / 2] + samples[sampleCount / 2]) /
+        2;
+
+    // Only called with a state attached
+    switch (_averaging->mode) {
+        case AVERAGE_TRIMMED_MEAN: {
+            // Drop the requested percent from each end, but always keep at
+            // least the middle value
+            float   trimPercent = constrain(_averaging->parameter, 0, 50);
+            uint8_t nTrim       = sampleCount * trimPercent / 100;
+            if (2 * nTrim >= sampleCount) nTrim = (sampleCount - 1) / 2;
+            float sum = 0;
+            for (uint8_t i = nTrim; i < sampleCount - nTrim; i++) {
+                sum += samples[i];
+            }
+            return sum / (sampleCount - 2 * nTrim);
+        }
+        case AVERAGE_REJECT_OUTLIERS: {
+            float   sum   = 0;
+            uint8_t nKept = 0;
+            for (uint8_t i = 0; i < sampleCount; i++) {
+                if (fabs(samples[i] - median) <= _averaging->parameter) {
+                    sum += samples[i];
+                    nKept++;
+                }
+            }
+            MS_DBG(F("Rejected"), sampleCount - nKept, F("outlier[s] from"),
+                   getSensorNameAndLocation());
+            // If even the middle pair is too far apart, fall back to the
+            // median
+            return nKept > 0 ? sum / nKept : median;
+        }
+        case AVERAGE_MEDIAN:
+        default: return median;
+    }
+}
+
+
 // This updates a sensor value by checking it's power, waking it, taking as many
 // readings as requested, then putting the sensor to sleep and powering down.
 bool Sensor::update(void) {
@@ -572,3 +720,53 @@ bool Sensor::isMeasurementComplete(bool debug) {
 void Sensor::waitForMeasurementCompletion(void) {
     while (!isMeasurementComplete()) {}
 }
+
+
+// The default cooperative poll for sensors that only implement the blocking
+// interface - the result is "ready" once the measurement time has passed.
+measurementState Sensor::pollMeasurement(bool debug) {
+    if (!isMeasurementComplete(debug)) { return MEASUREMENT_PENDING; }
+    // NOTE:  isMeasurementComplete() is immediately true if the measurement
+    // failed to start (bit 6 not set)
+    if (!bitRead(_sensorStatus, 6)) { return MEASUREMENT_FAILED; }
+    return MEASUREMENT_DONE;
+}
+
+
+// The default collection just runs the blocking result function
+bool Sensor::collectResult(void) {
+    return addSingleMeasurementResult();
+}
+
+
+// This returns the time until the next status change that a VariableArray
+// would act on.  It mirrors the checks in isWarmedUp(), isStable() and
+// isMeasurementComplete() - failed steps are always immediately "due".
+uint32_t Sensor::getMillisUntilNextStep(void) {
+    // No wake attempt yet - waiting for warm up (if powered)
+    if (!bitRead(_sensorStatus, 3)) {
+        if (!bitRead(_sensorStatus, 2)) { return 0; }
+        return millisRemaining(_millisPowerOn, _warmUpTime_ms);
+    }
+    // Wake attempted but failed - nothing to wait for
+    if (!bitRead(_sensorStatus, 4)) { return 0; }
+    uint32_t stabilizationRemaining = millisRemaining(_millisSensorActivated,
+                                                      _stabilizationTime_ms);
+    // Awake, no measurement requested yet - waiting for stability
+    if (!bitRead(_sensorStatus, 5)) { return stabilizationRemaining; }
+    // Measurement request failed - the result is "ready" now
+    if (!bitRead(_sensorStatus, 6)) { return 0; }
+    // Measuring - waiting for the measurement to finish
+    uint32_t measurementRemaining =
+        millisRemaining(_millisMeasurementRequested, _measurementTime_ms);
+    return max(stabilizationRemaining, measurementRemaining);
+}
+
+
+// The ready checks use "elapsed > wait", so a wait is over 1ms after the
+// elapsed time equals the wait time
+uint32_t Sensor::millisRemaining(uint32_t startMillis, uint32_t waitTime_ms) {
+    uint32_t elapsed = millis() - startMillis;
+    if (elapsed > waitTime_ms) { return 0; }
+    return waitTime_ms - elapsed + 1;
+}
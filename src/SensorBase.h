@@ -39,7 +39,97 @@
 #define MAX_NUMBER_VARS 8
 
 
-class Variable;  // Forward declaration
+class Variable;           // Forward declaration
+class StatisticAccumulator;  // Forward declaration
+
+/**
+ * @brief The possible states of a measurement, as returned by
+ * Sensor::pollMeasurement().
+ */
+typedef enum measurementState {
+    /// The measurement is still in progress; poll again later.
+    MEASUREMENT_PENDING = 0,
+    /// The measurement is finished and a result is ready to be collected.
+    MEASUREMENT_DONE,
+    /// The measurement failed; collecting it will add a failed (-9999) result.
+    MEASUREMENT_FAILED
+} measurementState;
+
+/**
+ * @brief The ways the individual measurements a sensor takes in one update can
+ * be combined into its result, as set with Sensor::setAveragingMode().
+ *
+ * All modes other than #AVERAGE_MEAN need the sensor to keep every good
+ * measurement until the end of the update, so they only take effect once an
+ * #averagingState has been given with Sensor::setAveragingBuffer().  Combining
+ * the samples sorts them in place with an insertion sort, which is quick for
+ * the few dozen measurements a sensor is normally asked to average.
+ */
+typedef enum averagingMode {
+    /// The arithmetic mean of all good measurements; the default.
+    AVERAGE_MEAN = 0,
+    /// The median of the good measurements.
+    AVERAGE_MEDIAN,
+    /// The mean after dropping the given percent (0-50) of the good
+    /// measurements from each end.
+    AVERAGE_TRIMMED_MEAN,
+    /// The mean of the good measurements within the given distance (in the
+    /// units of the result) of their median.
+    AVERAGE_REJECT_OUTLIERS
+} averagingMode;
+
+/**
+ * @brief The state a sensor needs for the robust averaging modes.
+ *
+ * The state is owned by the caller and only attached to a sensor with
+ * Sensor::setAveragingBuffer(), so a sensor that keeps the default mean
+ * spends nothing on it but one pointer.  Use a StaticAveragingState to
+ * declare one together with its sample buffer.  Each sensor needs its own.
+ */
+typedef struct averagingState {
+    /// The way measurements are combined into a result.
+    averagingMode mode;
+    /// The trim percent or outlier distance for #mode.
+    float parameter;
+    /// The buffer for the individual measurements of an update.
+    float* samples;
+    /// The number of floats #samples holds.
+    uint16_t sampleCount;
+    /// The number of measurements of each returned value that fit in
+    /// #samples; set when the state is attached to a sensor.
+    uint8_t samplesPerResult;
+} averagingState;
+
+/**
+ * @brief An #averagingState that holds its own sample buffer, whose size is
+ * fixed at compile time.
+ *
+ * The buffer should hold the number of measurements to average times the
+ * number of values the sensor returns.
+ *
+ * @tparam SAMPLE_COUNT The number of floats in the sample buffer
+ */
+template <uint16_t SAMPLE_COUNT>
+struct StaticAveragingState : public averagingState {
+    /**
+     * @brief Construct a new StaticAveragingState.
+     *
+     * @param initialMode The #averagingMode to use; defaults to
+     * #AVERAGE_MEDIAN.
+     * @param modeParameter The trim percent or outlier distance for the mode.
+     */
+    explicit StaticAveragingState(averagingMode initialMode = AVERAGE_MEDIAN,
+                                  float         modeParameter = 0) {
+        mode             = initialMode;
+        parameter        = modeParameter;
+        samples          = _sampleStorage;
+        sampleCount      = SAMPLE_COUNT;
+        samplesPerResult = 0;
+    }
+
+ private:
+    float _sampleStorage[SAMPLE_COUNT];
+};
 
 /**
  * @brief The "Sensor" class is used for all sensor-level operations - waking,
@@ -104,6 +194,14 @@ class Sensor {
      * @return **String** The sensor name as given in the constructor.
      */
     virtual String getSensorName(void);
+    /**
+     * @brief Get the name of the sensor without copying it into a String.
+     *
+     * Sensors that override getSensorName() should override this too.
+     *
+     * @return **const char\*** The sensor name as given in the constructor.
+     */
+    virtual const char* getSensorNameChars(void);
     /**
      * @brief Concatentate and returns the name and location of the sensor.
      *
@@ -137,6 +235,42 @@ class Sensor {
      */
     uint8_t getNumberMeasurementsToAverage(void);
 
+    /**
+     * @brief Set how the measurements taken in one update are combined into
+     * the sensor result.
+     *
+     * The mode is kept in the #averagingState given to setAveragingBuffer(),
+     * so this must be called after it.  Without a state only #AVERAGE_MEAN
+     * can be used; any other mode is refused with a printed warning.
+     *
+     * @param mode The #averagingMode to use.
+     * @param modeParameter The percent to trim from each end for
+     * #AVERAGE_TRIMMED_MEAN or the largest allowed distance from the median
+     * for #AVERAGE_REJECT_OUTLIERS; ignored by the other modes.
+     * @return **bool** True if the mode will be used.
+     */
+    bool setAveragingMode(averagingMode mode, float modeParameter = 0);
+    /**
+     * @brief Get the current averaging mode.
+     *
+     * @return **averagingMode** The mode used to combine measurements;
+     * #AVERAGE_MEAN if no #averagingState is attached.
+     */
+    averagingMode getAveragingMode(void);
+    /**
+     * @brief Give the sensor somewhere to keep the individual measurements of
+     * an update in for the robust averaging modes.
+     *
+     * The sample buffer is shared evenly between all of the values the sensor
+     * returns.  If more measurements are taken than fit, only the first ones
+     * are used by the robust modes.  The state must stay in scope for as long
+     * as the sensor is used and must not be shared with another sensor.
+     *
+     * @param state The averaging state, usually a StaticAveragingState; NULL
+     * to go back to the plain mean
+     */
+    void setAveragingBuffer(averagingState* state);
+
     /**
      * @brief Get the 8-bit code for the current status of the sensor.
      *
@@ -188,6 +322,35 @@ class Sensor {
      */
     uint8_t getStatus(void);
 
+    /**
+     * @anchor sensor_step_times
+     * @name Functions to return when each step of an update began
+     *
+     * Each returns the processor time (millis()) the step began, or 0 if the
+     * step has not begun since the sensor was last powered down.  These are
+     * used by an EnergyLedger to add up how long each sensor is on.
+     */
+    /**@{*/
+    /**
+     * @brief Get the time the power to the sensor was turned on.
+     *
+     * @return **uint32_t** The value of #_millisPowerOn
+     */
+    uint32_t getMillisPowerOn(void);
+    /**
+     * @brief Get the time the sensor was woken.
+     *
+     * @return **uint32_t** The value of #_millisSensorActivated
+     */
+    uint32_t getMillisSensorActivated(void);
+    /**
+     * @brief Get the time the current measurement was started.
+     *
+     * @return **uint32_t** The value of #_millisMeasurementRequested
+     */
+    uint32_t getMillisMeasurementRequested(void);
+    /**@}*/
+
     /**
      * @brief Do any one-time preparations needed before the sensor will be able
      * to take readings.
@@ -290,6 +453,42 @@ class Sensor {
      */
     virtual bool addSingleMeasurementResult(void) = 0;
 
+    /**
+     * @brief Advance a measurement started by startSingleMeasurement() without
+     * blocking and report whether the result is ready.
+     *
+     * Together with startSingleMeasurement() and collectResult() this forms
+     * the cooperative measurement interface used by the VariableArray.  A
+     * sensor that has to talk to the device for some time to get a result
+     * (ie, waiting on a serial response) can override this to do that work a
+     * little at a time, returning #MEASUREMENT_PENDING until it is done, so
+     * that other sensors in the array can be serviced in the meantime.  Such
+     * sensors should also override getMillisUntilNextStep() to say when they
+     * next want to be polled.
+     *
+     * The default adapts the blocking interface:  the measurement is pending
+     * until isMeasurementComplete() is true and all of the work of getting
+     * the result is left to addSingleMeasurementResult().
+     *
+     * @param debug True to output the result to the debugging Serial
+     * @return **measurementState** The state of the current measurement.
+     */
+    virtual measurementState pollMeasurement(bool debug = false);
+    /**
+     * @brief Add the result of a finished (or failed) measurement to the
+     * result array.
+     *
+     * This should only be called once pollMeasurement() no longer returns
+     * #MEASUREMENT_PENDING.  Like addSingleMeasurementResult(), this un-sets
+     * the #_millisMeasurementRequested timestamp and updates the
+     * #_sensorStatus.
+     *
+     * The default calls addSingleMeasurementResult().
+     *
+     * @return **bool** True if a valid result was added.
+     */
+    virtual bool collectResult(void);
+
     /**
      * @brief The array of result values for each sensor.
      */
@@ -299,7 +498,8 @@ class Sensor {
     // String getStringValueArray(void);
 
     /**
-     * @brief Clear the values array - that is, sets all values to -9999.
+     * @brief Clear the values array - that is, sets all values to -9999 - and
+     * reset the accumulators of any registered statistic variables.
      */
     void clearValues();
     /**
@@ -336,7 +536,17 @@ class Sensor {
      */
     void registerVariable(int sensorVarNum, Variable* var);
     /**
-     * @brief Notify attached variables of new values.
+     * @brief Register a statistic accumulator to a sensor.
+     *
+     * Every good result later passed to verifyAndAddMeasurementResult() for
+     * the accumulator's result number is added to it.  Unlike
+     * registerVariable(), this does not take the result's variable slot.
+     *
+     * @param accumulator A pointer to the StatisticAccumulator object.
+     */
+    void registerAccumulator(StatisticAccumulator* accumulator);
+    /**
+     * @brief Notify attached variables and statistic variables of new values.
      */
     void notifyVariables(void);
 
@@ -405,6 +615,27 @@ class Sensor {
      */
     void waitForMeasurementCompletion(void);
 
+    /**
+     * @brief Get the time until the next step in the power/wake/measure cycle
+     * of this sensor is due.
+     *
+     * The step is chosen from the current #_sensorStatus: before a wake
+     * attempt the sensor is waiting on #_warmUpTime_ms; once awake and before
+     * a measurement is started it is waiting on #_stabilizationTime_ms; and
+     * while a measurement is running it is waiting on #_measurementTime_ms.
+     * This is used by the VariableArray to idle the processor until the
+     * earliest sensor deadline instead of repeatedly polling isWarmedUp(),
+     * isStable() and isMeasurementComplete().
+     *
+     * @note Sensors that override any of those three functions should also
+     * override this one so that the deadline is never later than the time at
+     * which the overridden check would return true.
+     *
+     * @return **uint32_t** The number of milliseconds until the next step is
+     * due; 0 if it is due now.
+     */
+    virtual uint32_t getMillisUntilNextStep(void);
+
 
  protected:
     /**
@@ -443,6 +674,23 @@ class Sensor {
      */
     uint8_t numberGoodMeasurementsMade[MAX_NUMBER_VARS];
 
+    /**
+     * @brief The caller-owned state for the robust averaging modes; NULL
+     * unless set with setAveragingBuffer().
+     */
+    averagingState* _averaging;
+    /**
+     * @brief Combine a set of good measurements with the current robust
+     * averaging mode.
+     *
+     * @note The samples are sorted in place.
+     *
+     * @param samples The measurements to combine
+     * @param sampleCount The number of measurements; must be at least 1
+     * @return **float** The combined result
+     */
+    float combineSamples(float samples[], uint8_t sampleCount);
+
     /**
      * @brief The time needed from the when a sensor has power until it's ready
      * to talk.
@@ -487,6 +735,18 @@ class Sensor {
      */
     uint32_t _millisMeasurementRequested;
 
+    /**
+     * @brief Get the time remaining in a wait period, matching the strict
+     * "greater than" comparison used by isWarmedUp(), isStable() and
+     * isMeasurementComplete().
+     *
+     * @param startMillis The processor time stamp the wait began at.
+     * @param waitTime_ms The length of the wait.
+     * @return **uint32_t** The number of milliseconds remaining; 0 if the
+     * wait is over.
+     */
+    static uint32_t millisRemaining(uint32_t startMillis, uint32_t waitTime_ms);
+
     /**
      * @brief An 8-bit code for the sensor status
      */
@@ -499,6 +759,15 @@ class Sensor {
      * defined once for the whole class.
      */
     Variable* variables[MAX_NUMBER_VARS];
+    /**
+     * @brief The first of the statistic accumulators registered to the
+     * sensor, linked through StatisticAccumulator::nextAccumulator; NULL if
+     * none have been registered.
+     *
+     * A list is used instead of another array so that sensors without any
+     * statistics only spend a single pointer on them.
+     */
+    StatisticAccumulator* _statistics;
 };
 
 #endif  // SRC_SENSORBASE_H_
@@ -0,0 +1,150 @@
+/**
+ * @file StatisticVariable.cpp
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Implements the StatisticAccumulator and StatisticVariable classes.
+ */
+
+#include "StatisticVariable.h"
+#include "SensorBase.h"
+
+
+// The constructor for an accumulator, which registers it with its sensor
+StatisticAccumulator::StatisticAccumulator(Sensor*       parentSense,
+                                           const uint8_t sensorVarNum) {
+    _parentSensor   = parentSense;
+    _sensorVarNum   = sensorVarNum;
+    _statistics     = NULL;
+    nextAccumulator = NULL;
+    resetStatistics();
+    _parentSensor->registerAccumulator(this);
+}
+// Destructor
+StatisticAccumulator::~StatisticAccumulator() {}
+
+
+Sensor* StatisticAccumulator::getParentSensor(void) {
+    return _parentSensor;
+}
+uint8_t StatisticAccumulator::getSensorVarNum(void) {
+    return _sensorVarNum;
+}
+
+
+void StatisticAccumulator::resetStatistics(void) {
+    _count = 0;
+    _mean  = 0;
+    _m2    = 0;
+    _min   = -9999;
+    _max   = -9999;
+}
+
+
+// Welford's online algorithm - the mean and the sum of squared differences
+// are updated in place so no individual measurements need to be kept
+void StatisticAccumulator::addSample(float resultValue) {
+    _count++;
+    float delta = resultValue - _mean;
+    _mean += delta / _count;
+    _m2 += delta * (resultValue - _mean);
+    if (_count == 1 || resultValue < _min) _min = resultValue;
+    if (_count == 1 || resultValue > _max) _max = resultValue;
+}
+
+
+void StatisticAccumulator::registerStatistic(StatisticVariable* stat) {
+    // Don't add the same statistic twice if begin is called more than once
+    for (StatisticVariable* s = _statistics; s != NULL; s = s->nextStatistic) {
+        if (s == stat) return;
+    }
+    stat->nextStatistic = _statistics;
+    _statistics         = stat;
+}
+void StatisticAccumulator::notifyStatistics(void) {
+    for (StatisticVariable* s = _statistics; s != NULL; s = s->nextStatistic) {
+        s->onAccumulatorUpdate();
+    }
+}
+
+
+float StatisticAccumulator::getStatistic(statisticType statistic) {
+    switch (statistic) {
+        case STATISTIC_MIN: return _count > 0 ? _min : -9999;
+        case STATISTIC_MAX: return _count > 0 ? _max : -9999;
+        case STATISTIC_STDDEV:
+            return _count > 1 ? sqrt(_m2 / (_count - 1)) : -9999;
+        case STATISTIC_COUNT:
+        default: return _count;
+    }
+}
+
+
+// The constructor for a statistic variable tied to its accumulator
+StatisticVariable::StatisticVariable(StatisticAccumulator* accumulator,
+                                     statisticType         statistic,
+                                     uint8_t               decimalResolution,
+                                     const char* varName, const char* varUnit,
+                                     const char* varCode, const char* uuid)
+    : Variable(accumulator->getSensorVarNum(), decimalResolution, varName,
+               varUnit, varCode) {
+    setVarUUID(uuid);
+    _statistic    = statistic;
+    _accumulator  = NULL;
+    nextStatistic = NULL;
+    attachAccumulator(accumulator);
+}
+// The constructor for a statistic variable without an accumulator
+StatisticVariable::StatisticVariable(statisticType statistic,
+                                     uint8_t       decimalResolution,
+                                     const char* varName, const char* varUnit,
+                                     const char* varCode)
+    : Variable(static_cast<uint8_t>(0), decimalResolution, varName, varUnit,
+               varCode) {
+    _statistic    = statistic;
+    _accumulator  = NULL;
+    nextStatistic = NULL;
+}
+
+
+// Destructor
+StatisticVariable::~StatisticVariable() {}
+
+
+StatisticVariable* StatisticVariable::begin(StatisticAccumulator* accumulator,
+                                            const char*           uuid,
+                                            const char* customVarCode) {
+    setVarCode(customVarCode);
+    return begin(accumulator, uuid);
+}
+StatisticVariable* StatisticVariable::begin(StatisticAccumulator* accumulator,
+                                            const char*           uuid) {
+    setVarUUID(uuid);
+    return begin(accumulator);
+}
+StatisticVariable* StatisticVariable::begin(StatisticAccumulator* accumulator) {
+    attachAccumulator(accumulator);
+    return this;
+}
+
+
+// This adds the statistic to the accumulator's list rather than registering
+// it in the sensor's variable array
+void StatisticVariable::attachAccumulator(StatisticAccumulator* accumulator) {
+    _accumulator = accumulator;
+    parentSensor = accumulator->getParentSensor();
+    accumulator->registerStatistic(this);
+}
+
+
+// This is called by the accumulator's notifyStatistics() function
+void StatisticVariable::onAccumulatorUpdate(void) {
+    _currentValue = _accumulator->getStatistic(_statistic);
+    MS_DBG(F("... calculated statistic"), _currentValue);
+}
+
+
+statisticType StatisticVariable::getStatisticType(void) {
+    return _statistic;
+}
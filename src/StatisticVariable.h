@@ -0,0 +1,296 @@
+/**
+ * @file StatisticVariable.h
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ * @author Sara Geleskie Damiano <sdamiano@stroudcenter.org>
+ *
+ * @brief Contains the StatisticAccumulator and StatisticVariable classes.
+ *
+ * @copydetails StatisticVariable
+ */
+
+// Header Guards
+#ifndef SRC_STATISTICVARIABLE_H_
+#define SRC_STATISTICVARIABLE_H_
+
+// Debugging Statement
+// #define MS_STATISTICVARIABLE_DEBUG
+
+#ifdef MS_STATISTICVARIABLE_DEBUG
+#define MS_DEBUGGING_STD "StatisticVariable"
+#endif
+
+// Included Dependencies
+#include "ModSensorDebugger.h"
+#undef MS_DEBUGGING_STD
+#include "VariableBase.h"
+
+/**
+ * @brief The statistics a StatisticVariable can report about the individual
+ * measurements that were averaged into a sensor result.
+ */
+typedef enum statisticType {
+    /// The smallest good measurement in the update cycle.
+    STATISTIC_MIN = 0,
+    /// The largest good measurement in the update cycle.
+    STATISTIC_MAX,
+    /// The sample standard deviation of the good measurements in the cycle.
+    STATISTIC_STDDEV,
+    /// The number of good measurements averaged in the cycle.
+    STATISTIC_COUNT
+} statisticType;
+
+class StatisticVariable;  // Forward declaration
+
+/**
+ * @brief The running statistics of the individual measurements a sensor
+ * averages into one of its results.
+ *
+ * An accumulator watches one result (one position in the value array) of its
+ * parent sensor.  As the sensor verifies each new measurement with
+ * Sensor::verifyAndAddMeasurementResult(), every good value is added using
+ * Welford's online algorithm, so the memory needed does not depend on how
+ * many measurements are averaged.  Bad (-9999) measurements are skipped,
+ * exactly as they are for the average.
+ *
+ * There should be one accumulator for each sensor result whose statistics
+ * are wanted.  Any number of StatisticVariable objects can then report from
+ * it, so logging the minimum, maximum, standard deviation and count of a
+ * result still only adds each measurement once.
+ */
+class StatisticAccumulator {
+ public:
+    /**
+     * @brief Construct a new StatisticAccumulator object and register it
+     * with a sensor.
+     *
+     * @param parentSense The Sensor object supplying values
+     * @param sensorVarNum The position in the sensor's value array of the
+     * result to accumulate the statistics of
+     */
+    StatisticAccumulator(Sensor* parentSense, const uint8_t sensorVarNum);
+    /**
+     * @brief Destroy the StatisticAccumulator object - no action taken.
+     */
+    ~StatisticAccumulator();
+
+    /**
+     * @brief Get the sensor whose measurements are accumulated.
+     *
+     * @return **Sensor\*** The parent sensor
+     */
+    Sensor* getParentSensor(void);
+    /**
+     * @brief Get the position in the parent sensor's value array of the
+     * result the statistics describe.
+     *
+     * @return **uint8_t** The result number
+     */
+    uint8_t getSensorVarNum(void);
+
+    /**
+     * @brief Clear the accumulator before a new update cycle.
+     *
+     * This is called by the parent sensor's clearValues() function.
+     */
+    void resetStatistics(void);
+    /**
+     * @brief Add a single good measurement to the accumulator.
+     *
+     * This is called by the parent sensor's verifyAndAddMeasurementResult()
+     * function for values that are not -9999.
+     *
+     * @param resultValue The measured value
+     */
+    void addSample(float resultValue);
+    /**
+     * @brief Add a statistic variable to those reporting from this
+     * accumulator.
+     *
+     * @param stat A pointer to the StatisticVariable object.
+     */
+    void registerStatistic(StatisticVariable* stat);
+    /**
+     * @brief Tell every statistic variable reporting from this accumulator
+     * to take its new value.
+     *
+     * This is called by the parent sensor's notifyVariables() function.
+     */
+    void notifyStatistics(void);
+
+    /**
+     * @brief Get a statistic of the measurements accumulated since the last
+     * reset.
+     *
+     * If there are no good measurements the minimum, maximum and standard
+     * deviation are -9999 and the count is 0; the standard deviation also
+     * needs at least two good measurements.
+     *
+     * @param statistic The statistic to get; one of #statisticType
+     * @return **float** The statistic
+     */
+    float getStatistic(statisticType statistic);
+
+    /**
+     * @brief The next accumulator registered to the same sensor, or NULL if
+     * this is the last one.
+     */
+    StatisticAccumulator* nextAccumulator;
+
+ private:
+    /**
+     * @brief The sensor whose measurements are accumulated.
+     */
+    Sensor* _parentSensor;
+    /**
+     * @brief The first of the statistic variables reporting from this
+     * accumulator, linked through StatisticVariable::nextStatistic.
+     */
+    StatisticVariable* _statistics;
+    /**
+     * @brief The position in the sensor's value array of the result.
+     */
+    uint8_t _sensorVarNum;
+    /**
+     * @brief The number of good measurements accumulated.
+     */
+    uint16_t _count;
+    /**
+     * @brief The running mean of the accumulated measurements.
+     */
+    float _mean;
+    /**
+     * @brief The running sum of squared differences from the mean.
+     */
+    float _m2;
+    /**
+     * @brief The smallest accumulated measurement.
+     */
+    float _min;
+    /**
+     * @brief The largest accumulated measurement.
+     */
+    float _max;
+};
+
+/**
+ * @brief A variable reporting the spread or extremes of the individual
+ * measurements a sensor averaged to create one of its results.
+ *
+ * Each statistic variable reports one statistic from a StatisticAccumulator.
+ * When the sensor notifies its variables of new values, the requested
+ * statistic becomes the current value of this variable, which can then be
+ * placed in a VariableArray and logged or published like any other.
+ *
+ * This is opt-in:  a sensor only keeps the accumulators created for it.
+ *
+ * The statistic variable does NOT replace the variable for the averaged
+ * result itself; both can be attached to the same sensor result.
+ */
+class StatisticVariable : public Variable {
+ public:
+    /**
+     * @brief Construct a new StatisticVariable object and attach it to an
+     * accumulator.
+     *
+     * @param accumulator The StatisticAccumulator of the sensor result
+     * @param statistic The statistic to report; one of #statisticType
+     * @param decimalResolution The resolution (in decimal places) of the value
+     * @param varName The name of the variable per the variable name
+     * controlled vocabulary
+     * @param varUnit The unit of the variable per the unit controlled
+     * vocabulary
+     * @param varCode A custom code of the variable
+     * @param uuid A universally unique identifier for the variable; optional
+     * with the default value of an empty string.
+     */
+    StatisticVariable(StatisticAccumulator* accumulator,
+                      statisticType statistic, uint8_t decimalResolution,
+                      const char* varName, const char* varUnit,
+                      const char* varCode, const char* uuid = "");
+    /**
+     * @brief Construct a new StatisticVariable object, but do not tie it to
+     * an accumulator.
+     *
+     * @note This must be tied with an accumulator using begin() before it
+     * can be used.
+     *
+     * @param statistic The statistic to report; one of #statisticType
+     * @param decimalResolution The resolution (in decimal places) of the value
+     * @param varName The name of the variable per the variable name
+     * controlled vocabulary
+     * @param varUnit The unit of the variable per the unit controlled
+     * vocabulary
+     * @param varCode A custom code of the variable
+     */
+    StatisticVariable(statisticType statistic, uint8_t decimalResolution,
+                      const char* varName, const char* varUnit,
+                      const char* varCode);
+    /**
+     * @brief Destroy the StatisticVariable object - no action taken.
+     */
+    ~StatisticVariable();
+
+    /**
+     * @brief Begin for the StatisticVariable object
+     *
+     * @param accumulator The StatisticAccumulator of the sensor result
+     * @param uuid A universally unique identifier for the variable
+     * @param customVarCode A custom code for the variable
+     * @return **StatisticVariable\*** A pointer to the variable object
+     */
+    StatisticVariable* begin(StatisticAccumulator* accumulator,
+                             const char* uuid, const char* customVarCode);
+    /**
+     * @copydoc begin(StatisticAccumulator*, const char*, const char*)
+     */
+    StatisticVariable* begin(StatisticAccumulator* accumulator,
+                             const char*           uuid);
+    /**
+     * @copydoc begin(StatisticAccumulator*, const char*, const char*)
+     */
+    StatisticVariable* begin(StatisticAccumulator* accumulator);
+
+    /**
+     * @brief Report from the given accumulator.
+     *
+     * Unlike Variable::attachSensor(), this does not take the sensor's
+     * variable slot for the result, so the averaged result variable keeps
+     * working.
+     *
+     * @param accumulator The StatisticAccumulator of the sensor result
+     */
+    void attachAccumulator(StatisticAccumulator* accumulator);
+    /**
+     * @brief Set the current value to the statistic of the measurements
+     * accumulated since the last reset.
+     *
+     * This is called by the accumulator's notifyStatistics() function.
+     */
+    void onAccumulatorUpdate(void);
+
+    /**
+     * @brief Get the statistic this variable reports.
+     *
+     * @return **statisticType** The statistic
+     */
+    statisticType getStatisticType(void);
+
+    /**
+     * @brief The next statistic variable reporting from the same accumulator,
+     * or NULL if this is the last one.
+     */
+    StatisticVariable* nextStatistic;
+
+ private:
+    /**
+     * @brief The accumulator the statistic is read from.
+     */
+    StatisticAccumulator* _accumulator;
+    /**
+     * @brief The statistic reported by this variable.
+     */
+    statisticType _statistic;
+};
+
+#endif  // SRC_STATISTICVARIABLE_H_
@@ -8,48 +8,57 @@
  */
 
 #include "VariableArray.h"
+#include "EnergyLedger.h"
+#include "ProcessorIdle.h"
 
 
 // Constructors
-VariableArray::VariableArray() {}
+VariableArray::VariableArray()
+    : _valueStrings(NULL), _valueStringSlots(0), _valueStringsCurrent(false),
+      _energyLedger(NULL) {}
 VariableArray::VariableArray(uint8_t variableCount, Variable* variableList[])
-    : arrayOfVars(variableList), _variableCount(variableCount) {
+    : arrayOfVars(variableList), _variableCount(variableCount),
+      _valueStrings(NULL), _valueStringSlots(0), _energyLedger(NULL) {
+    buildSensorTopology();
     _maxSamplestoAverage = countMaxToAverage();
-    _sensorCount         = getSensorCount();
 }
 VariableArray::VariableArray(uint8_t variableCount, Variable* variableList[],
                              const char* uuids[])
-    : arrayOfVars(variableList), _variableCount(variableCount) {
+    : arrayOfVars(variableList), _variableCount(variableCount),
+      _valueStrings(NULL), _valueStringSlots(0), _energyLedger(NULL) {
+    buildSensorTopology();
     _maxSamplestoAverage = countMaxToAverage();
-    _sensorCount         = getSensorCount();
     matchUUIDs(uuids);
 }
 
 // Destructor
 VariableArray::~VariableArray() {}
 
-void VariableArray::begin(uint8_t variableCount, Variable* variableList[],
+bool VariableArray::begin(uint8_t variableCount, Variable* variableList[],
                           const char* uuids[]) {
     _variableCount = variableCount;
     arrayOfVars    = variableList;
 
+    bool success         = buildSensorTopology();
     _maxSamplestoAverage = countMaxToAverage();
-    _sensorCount         = getSensorCount();
     matchUUIDs(uuids);
     checkVariableUUIDs();
+    return success;
 }
-void VariableArray::begin(uint8_t variableCount, Variable* variableList[]) {
+bool VariableArray::begin(uint8_t variableCount, Variable* variableList[]) {
     _variableCount = variableCount;
     arrayOfVars    = variableList;
 
+    bool success         = buildSensorTopology();
     _maxSamplestoAverage = countMaxToAverage();
-    _sensorCount         = getSensorCount();
     checkVariableUUIDs();
+    return success;
 }
-void VariableArray::begin() {
+bool VariableArray::begin() {
+    bool success         = buildSensorTopology();
     _maxSamplestoAverage = countMaxToAverage();
-    _sensorCount         = getSensorCount();
     checkVariableUUIDs();
+    return success;
 }
 
 // This counts and returns the number of calculated variables
@@ -87,8 +96,7 @@ void VariableArray::matchUUIDs(const char* uuids[]) {
 // Public functions for interfacing with a list of sensors
 // This sets up all of the sensors in the list
 // NOTE:  Calculated variables will always be skipped in this process because
-// a calculated variable will never be marked as the last variable from a
-// sensor.
+// a calculated variable will never be in the sensor topology table.
 bool VariableArray::setupSensors(void) {
     bool success = true;
 
@@ -127,16 +135,14 @@ bool VariableArray::setupSensors(void) {
     // Check for any sensors that have been set up outside of this (ie, the
     // modem)
     uint8_t nSensorsSetup = 0;
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-            if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 0) ==
-                1) {  // already set up
-                MS_DBG(F("   "),
-                       arrayOfVars[i]->getParentSensorNameAndLocation(),
-                       F("was already set up!"));
-
-                nSensorsSetup++;
-            }
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i = _sensorVarIndex[s];
+        if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 0) ==
+            1) {  // already set up
+            MS_DBG(F("   "), arrayOfVars[i]->getParentSensorNameAndLocation(),
+                   F("was already set up!"));
+
+            nSensorsSetup++;
         }
     }
 
@@ -145,32 +151,30 @@ bool VariableArray::setupSensors(void) {
     // up and increment the counter marking that's been done.
     // We keep looping until they've all been done.
     while (nSensorsSetup < _sensorCount) {
-        for (uint8_t i = 0; i < _variableCount; i++) {
-            bool sensorSuccess = false;
-            if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-                // only set up if it has not yet been set up
-                if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 0) ==
-                    0) {
-                    // and if it is already warmed up
-                    // if
-                    // (arrayOfVars[i]->parentSensor->isWarmedUp(deepDebugTiming))
-                    // {
-                    MS_DBG(F("    Set up of"),
-                           arrayOfVars[i]->getParentSensorNameAndLocation(),
-                           F("..."));
+        for (uint8_t s = 0; s < _sensorCount; s++) {
+            uint8_t i             = _sensorVarIndex[s];
+            bool    sensorSuccess = false;
+            // only set up if it has not yet been set up
+            if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 0) == 0) {
+                // and if it is already warmed up
+                // if
+                // (arrayOfVars[i]->parentSensor->isWarmedUp(deepDebugTiming))
+                // {
+                MS_DBG(F("    Set up of"),
+                       arrayOfVars[i]->getParentSensorNameAndLocation(),
+                       F("..."));
 
-                    sensorSuccess =
-                        arrayOfVars[i]->parentSensor->setup();  // set it up
-                    success &= sensorSuccess;
-                    nSensorsSetup++;
+                sensorSuccess =
+                    arrayOfVars[i]->parentSensor->setup();  // set it up
+                success &= sensorSuccess;
+                nSensorsSetup++;
 
-                    if (!sensorSuccess) {
-                        MS_DBG(F("        ... setup failed!"));
-                    } else {
-                        MS_DBG(F("        ... setup succeeded."));
-                    }
-                    // }
+                if (!sensorSuccess) {
+                    MS_DBG(F("        ... setup failed!"));
+                } else {
+                    MS_DBG(F("        ... setup succeeded."));
                 }
+                // }
             }
         }
     }
@@ -187,17 +191,15 @@ bool VariableArray::setupSensors(void) {
 // This powers up the sensors
 // There's no checking or waiting here, just turning on pins
 // NOTE:  Calculated variables will always be skipped in this process because
-// a calculated variable will never be marked as the last variable from a
-// sensor.
+// a calculated variable will never be in the sensor topology table.
 void VariableArray::sensorsPowerUp(void) {
     MS_DBG(F("Powering up sensors..."));
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-            MS_DBG(F("    Powering up"),
-                   arrayOfVars[i]->getParentSensorNameAndLocation());
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i = _sensorVarIndex[s];
+        MS_DBG(F("    Powering up"),
+               arrayOfVars[i]->getParentSensorNameAndLocation());
 
-            arrayOfVars[i]->parentSensor->powerUp();
-        }
+        arrayOfVars[i]->parentSensor->powerUp();
     }
 }
 
@@ -205,8 +207,7 @@ void VariableArray::sensorsPowerUp(void) {
 // This wakes/activates the sensors
 // Before a sensor is "awoken" we have to make sure it's had time to warm up
 // NOTE:  Calculated variables will always be skipped in this process because
-// a calculated variable will never be marked as the last variable from a
-// sensor.
+// a calculated variable will never be in the sensor topology table.
 bool VariableArray::sensorsWake(void) {
     MS_DBG(F("Waking sensors..."));
     bool    success       = true;
@@ -220,15 +221,14 @@ bool VariableArray::sensorsWake(void) {
 
     // Check for any sensors that are awake outside of being sent a "wake"
     // command
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-            if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) ==
-                1) {  // already attempted to wake
-                MS_DBG(F("    Wake up of"),
-                       arrayOfVars[i]->getParentSensorNameAndLocation(),
-                       F("has already been attempted."));
-                nSensorsAwake++;
-            }
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i = _sensorVarIndex[s];
+        if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) ==
+            1) {  // already attempted to wake
+            MS_DBG(F("    Wake up of"),
+                   arrayOfVars[i]->getParentSensorNameAndLocation(),
+                   F("has already been attempted."));
+            nSensorsAwake++;
         }
     }
 
@@ -237,32 +237,29 @@ bool VariableArray::sensorsWake(void) {
     // up and increment the counter marking that's been done.
     // We keep looping until they've all been done.
     while (nSensorsAwake < _sensorCount) {
-        for (uint8_t i = 0; i < _variableCount; i++) {
-            if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-                // If no attempts yet made to wake the sensor up
-                if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) ==
-                    0) {
-                    // and if it is already warmed up
-                    if (arrayOfVars[i]->parentSensor->isWarmedUp(
-                            deepDebugTiming)) {
-                        MS_DBG(F("    Wake up of"),
-                               arrayOfVars[i]->getParentSensorNameAndLocation(),
-                               F("..."));
-
-                        // Make a single attempt to wake the sensor after it is
-                        // warmed up
-                        bool sensorSuccess =
-                            arrayOfVars[i]->parentSensor->wake();
-                        success &= sensorSuccess;
-                        // We increment up the number of sensors awake/active,
-                        // even if the wake up command failed!
-                        nSensorsAwake++;
-
-                        if (sensorSuccess) {
-                            MS_DBG(F("        ... wake up succeeded."));
-                        } else {
-                            MS_DBG(F("        ... wake up failed!"));
-                        }
+        for (uint8_t s = 0; s < _sensorCount; s++) {
+            uint8_t i = _sensorVarIndex[s];
+            // If no attempts yet made to wake the sensor up
+            if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) == 0) {
+                // and if it is already warmed up
+                if (arrayOfVars[i]->parentSensor->isWarmedUp(
+                        deepDebugTiming)) {
+                    MS_DBG(F("    Wake up of"),
+                           arrayOfVars[i]->getParentSensorNameAndLocation(),
+                           F("..."));
+
+                    // Make a single attempt to wake the sensor after it is
+                    // warmed up
+                    bool sensorSuccess = arrayOfVars[i]->parentSensor->wake();
+                    success &= sensorSuccess;
+                    // We increment up the number of sensors awake/active,
+                    // even if the wake up command failed!
+                    nSensorsAwake++;
+
+                    if (sensorSuccess) {
+                        MS_DBG(F("        ... wake up succeeded."));
+                    } else {
+                        MS_DBG(F("        ... wake up failed!"));
                     }
                 }
             }
@@ -276,24 +273,22 @@ bool VariableArray::sensorsWake(void) {
 // We're not waiting for anything to be ready, we're just sending the command
 // to put it to sleep no matter what its current state is.
 // NOTE:  Calculated variables will always be skipped in this process because
-// a calculated variable will never be marked as the last variable from a
-// sensor.
+// a calculated variable will never be in the sensor topology table.
 bool VariableArray::sensorsSleep(void) {
     MS_DBG(F("Putting sensors to sleep..."));
     bool success = true;
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-            MS_DBG(F("    "), arrayOfVars[i]->getParentSensorNameAndLocation(),
-                   F("..."));
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i = _sensorVarIndex[s];
+        MS_DBG(F("    "), arrayOfVars[i]->getParentSensorNameAndLocation(),
+               F("..."));
 
-            bool sensorSuccess = arrayOfVars[i]->parentSensor->sleep();
-            success &= sensorSuccess;
+        bool sensorSuccess = arrayOfVars[i]->parentSensor->sleep();
+        success &= sensorSuccess;
 
-            if (sensorSuccess) {
-                MS_DBG(F("        ... successfully put to sleep."));
-            } else {
-                MS_DBG(F("        ... failed to sleep!"));
-            }
+        if (sensorSuccess) {
+            MS_DBG(F("        ... successfully put to sleep."));
+        } else {
+            MS_DBG(F("        ... failed to sleep!"));
         }
     }
     return success;
@@ -303,17 +298,15 @@ bool VariableArray::sensorsSleep(void) {
 // This cuts power to the sensors
 // We're not waiting for anything to be ready, we're just cutting power.
 // NOTE:  Calculated variables will always be skipped in this process because
-// a calculated variable will never be marked as the last variable from a
-// sensor.
+// a calculated variable will never be in the sensor topology table.
 void VariableArray::sensorsPowerDown(void) {
     MS_DBG(F("Powering down sensors..."));
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-            MS_DBG(F("    Powering down"),
-                   arrayOfVars[i]->getParentSensorNameAndLocation());
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i = _sensorVarIndex[s];
+        MS_DBG(F("    Powering down"),
+               arrayOfVars[i]->getParentSensorNameAndLocation());
 
-            arrayOfVars[i]->parentSensor->powerDown();
-        }
+        arrayOfVars[i]->parentSensor->powerDown();
     }
 }
 
@@ -323,8 +316,7 @@ void VariableArray::sensorsPowerDown(void) {
 // the startSingleMeasurement and addSingleMeasurementResult functions to
 // take advantage of the ability of sensors to be measuring concurrently.
 // NOTE:  Calculated variables will always be skipped in this process because
-// a calculated variable will never be marked as the last variable from a
-// sensor.
+// a calculated variable will never be in the sensor topology table.
 bool VariableArray::updateAllSensors(void) {
     bool    success           = true;
     uint8_t nSensorsCompleted = 0;
@@ -335,188 +327,160 @@ bool VariableArray::updateAllSensors(void) {
     bool deepDebugTiming = false;
 #endif
 
-    // Create an array with the unique-ness value (so we can skip the function
-    // calls later)
-    MS_DBG(F("Creating a mask array with the uniqueness for each sensor.."));
-    bool lastSensorVariable[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        lastSensorVariable[i] = isLastVarFromSensor(i);
-    }
-
     // Create an array for the number of measurements already completed and set
     // all to zero
     MS_DBG(F("Creating an array for the number of completed measurements.."));
-    uint8_t nMeasurementsCompleted[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        nMeasurementsCompleted[i] = 0;
+    uint8_t nMeasurementsCompleted[MAX_NUMBER_SENSORS];
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        nMeasurementsCompleted[s] = 0;
     }
 
     // Create an array for the number of measurements to average (another short
     // cut)
     MS_DBG(F("Creating an array with the number of measurements to average.."));
-    uint8_t nMeasurementsToAverage[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {
-            nMeasurementsToAverage[i] =
-                arrayOfVars[i]->parentSensor->getNumberMeasurementsToAverage();
-        } else {
-            nMeasurementsToAverage[i] = 0;
-        }
+    uint8_t nMeasurementsToAverage[MAX_NUMBER_SENSORS];
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        nMeasurementsToAverage[s] = arrayOfVars[_sensorVarIndex[s]]
+                                        ->parentSensor
+                                        ->getNumberMeasurementsToAverage();
     }
 
     // Clear the initial variable arrays
     MS_DBG(F("----->> Clearing all results arrays before taking new "
              "measurements. ..."));
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {
-            arrayOfVars[i]->parentSensor->clearValues();
-        }
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        arrayOfVars[_sensorVarIndex[s]]->parentSensor->clearValues();
     }
     MS_DBG(F("    ... Complete. <<-----"));
 
     // Check for any sensors that didn't wake up and mark them as "complete" so
     // they will be skipped in further looping.
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {  // Skip non-unique sensors
-            if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) ==
-                    0 ||  // No attempt made to wake the sensor up
-                bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4) ==
-                    0) {  // OR Wake up failed
-                MS_DBG(i, F("--->>"),
-                       arrayOfVars[i]->getParentSensorNameAndLocation(),
-                       F("isn't awake/active!  No measurements will be taken! "
-                         "<<---"),
-                       i);
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i = _sensorVarIndex[s];
+        if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) ==
+                0 ||  // No attempt made to wake the sensor up
+            bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4) ==
+                0) {  // OR Wake up failed
+            MS_DBG(i, F("--->>"),
+                   arrayOfVars[i]->getParentSensorNameAndLocation(),
+                   F("isn't awake/active!  No measurements will be taken! "
+                     "<<---"),
+                   i);
+
+            // Set the number of measurements already equal to whatever
+            // total number requested to ensure the sensor is skipped in
+            // further loops.
+            nMeasurementsCompleted[s] = nMeasurementsToAverage[s];
+            // Bump up the finished count.
+            nSensorsCompleted++;
+        }
+    }
 
-                // Set the number of measurements already equal to whatever
-                // total number requested to ensure the sensor is skipped in
-                // further loops.
-                nMeasurementsCompleted[i] = nMeasurementsToAverage[i];
-                // Bump up the finished count.
-                nSensorsCompleted++;
-            }
+    // Queue up every sensor that still has measurements to take, keyed on the
+    // time its next step (stability or measurement completion) is due.
+    sensorDeadline deadlineQueue[MAX_NUMBER_SENSORS];
+    uint8_t        nQueued = 0;
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        if (nMeasurementsToAverage[s] > nMeasurementsCompleted[s]) {
+            pushSensorDeadline(deadlineQueue, nQueued, s);
         }
     }
 
-    while (nSensorsCompleted < _sensorCount) {
-        for (uint8_t i = 0; i < _variableCount; i++) {
-            /***
-            // THIS IS PURELY FOR DEEP DEBUGGING OF THE TIMING!
-            // Leave this whole section commented out unless you want excessive
-            // printouts (ie, thousands of lines) of the timing information!!
-            if (lastSensorVariable[i] and
-                nMeasurementsToAverage[i] > nMeasurementsCompleted[i])
-            {
-                MS_DEEP_DBG(i), '-',
-            arrayOfVars[i]->getParentSensorNameAndLocation(), F("- millis:"),
-            millis(), F("- status: 0b"),
-                           bitRead(arrayOfVars[i]->parentSensor->getStatus(),
-            7), bitRead(arrayOfVars[i]->parentSensor->getStatus(), 6),
-                           bitRead(arrayOfVars[i]->parentSensor->getStatus(),
-            5), bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4),
-                           bitRead(arrayOfVars[i]->parentSensor->getStatus(),
-            3), bitRead(arrayOfVars[i]->parentSensor->getStatus(), 2),
-                           bitRead(arrayOfVars[i]->parentSensor->getStatus(),
-            1), bitRead(arrayOfVars[i]->parentSensor->getStatus(), 0), F("-
-            measurement #"), (nMeasurementsCompleted[i] + 1);
+    // Rather than continuously polling every sensor, idle until the earliest
+    // deadline and then act only on the sensor that is due.  Sensors that
+    // still have work to do are put back in the queue with their new deadline.
+    while (nQueued > 0) {
+        idleUntil(deadlineQueue[0].dueMillis);
+        uint8_t s = popSensorDeadline(deadlineQueue, nQueued);
+        uint8_t i = _sensorVarIndex[s];
+
+        // first, make sure the sensor is stable
+        if (arrayOfVars[i]->parentSensor->isStable(deepDebugTiming)) {
+            // now, if the sensor is not currently measuring...
+            if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 5) ==
+                0) {  // NO attempt yet to start a measurement
+                // Start a reading
+                MS_DBG(i, '.', nMeasurementsCompleted[s] + 1,
+                       F("--->> Starting reading"),
+                       nMeasurementsCompleted[s] + 1, F("on"),
+                       arrayOfVars[i]->getParentSensorNameAndLocation(), '-');
+
+                bool sensorSuccess_start =
+                    arrayOfVars[i]->parentSensor->startSingleMeasurement();
+                success &= sensorSuccess_start;
+
+                if (sensorSuccess_start) {
+                    MS_DBG(F("   ... reading started! <<---"), i, '.',
+                           nMeasurementsCompleted[s] + 1);
+                } else {
+                    MS_DBG(F("   ... failed to start reading! <<---"), i, '.',
+                           nMeasurementsCompleted[s] + 1);
+                }
             }
-            // END CHUNK FOR DEBUGGING!
-            ***/
-
-            // Only do checks on sensors that still have measurements to finish
-            if (lastSensorVariable[i] &&
-                nMeasurementsToAverage[i] > nMeasurementsCompleted[i]) {
-                // first, make sure the sensor is stable
-                if (arrayOfVars[i]->parentSensor->isStable(deepDebugTiming)) {
-                    // now, if the sensor is not currently measuring...
-                    if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 5) ==
-                        0) {  // NO attempt yet to start a measurement
-                        // Start a reading
-                        MS_DBG(i, '.', nMeasurementsCompleted[i] + 1,
-                               F("--->> Starting reading"),
-                               nMeasurementsCompleted[i] + 1, F("on"),
-                               arrayOfVars[i]->getParentSensorNameAndLocation(),
-                               '-');
-
-                        bool sensorSuccess_start =
-                            arrayOfVars[i]
-                                ->parentSensor->startSingleMeasurement();
-                        success &= sensorSuccess_start;
-
-                        if (sensorSuccess_start) {
-                            MS_DBG(F("   ... reading started! <<---"), i, '.',
-                                   nMeasurementsCompleted[i] + 1);
-                        } else {
-                            MS_DBG(F("   ... failed to start reading! <<---"),
-                                   i, '.', nMeasurementsCompleted[i] + 1);
-                        }
-                    }
 
-                    // otherwise, it is currently measuring so...
-                    // if a measurement is finished, get the result and tick up
-                    // the number of finished measurements
-                    // NOTE:  isMeasurementComplete(deepDebugTiming) will
-                    // immediately return true if the attempt to start a
-                    // measurement failed (bit 6 not set).  In that case, the
-                    // addSingleMeasurementResult() will be "adding" -9999
-                    // values.
-                    if (arrayOfVars[i]->parentSensor->isMeasurementComplete(
-                            deepDebugTiming)) {
-                        // Get the value
-                        MS_DBG(i, '.', nMeasurementsCompleted[i] + 1,
-                               F("--->> Collected result of reading"),
-                               nMeasurementsCompleted[i] + 1, F("from"),
-                               arrayOfVars[i]->getParentSensorNameAndLocation(),
-                               F("..."));
-
-                        bool sensorSuccess_result =
-                            arrayOfVars[i]
-                                ->parentSensor->addSingleMeasurementResult();
-                        success &= sensorSuccess_result;
-                        nMeasurementsCompleted[i] +=
-                            1;  // increment the number of measurements that
-                                // sensor has completed
-
-                        if (sensorSuccess_result) {
-                            MS_DBG(F("   ... got measurement result. <<---"), i,
-                                   '.', nMeasurementsCompleted[i]);
-                        } else {
-                            MS_DBG(F("   ... failed to get measurement result! "
-                                     "<<---"),
-                                   i, '.', nMeasurementsCompleted[i]);
-                        }
-                    }
+            // otherwise, it is currently measuring so...
+            // if a measurement is finished, get the result and tick up
+            // the number of finished measurements
+            // NOTE:  pollMeasurement(deepDebugTiming) will immediately
+            // report a failure if the attempt to start a measurement failed
+            // (bit 6 not set).  In that case, the collectResult() will be
+            // "adding" -9999 values.
+            if (arrayOfVars[i]->parentSensor->pollMeasurement(
+                    deepDebugTiming) != MEASUREMENT_PENDING) {
+                // Get the value
+                MS_DBG(i, '.', nMeasurementsCompleted[s] + 1,
+                       F("--->> Collected result of reading"),
+                       nMeasurementsCompleted[s] + 1, F("from"),
+                       arrayOfVars[i]->getParentSensorNameAndLocation(),
+                       F("..."));
+
+                bool sensorSuccess_result =
+                    arrayOfVars[i]->parentSensor->collectResult();
+                success &= sensorSuccess_result;
+                nMeasurementsCompleted[s] +=
+                    1;  // increment the number of measurements that
+                        // sensor has completed
+
+                if (sensorSuccess_result) {
+                    MS_DBG(F("   ... got measurement result. <<---"), i, '.',
+                           nMeasurementsCompleted[s]);
+                } else {
+                    MS_DBG(F("   ... failed to get measurement result! "
+                             "<<---"),
+                           i, '.', nMeasurementsCompleted[s]);
                 }
+            }
+        }
 
-                // if all the measurements are done, mark the whole sensor as
-                // done
-                if (nMeasurementsCompleted[i] == nMeasurementsToAverage[i]) {
-                    MS_DBG(F("--- Finished all measurements from"),
-                           arrayOfVars[i]->getParentSensorNameAndLocation(),
-                           F("---"));
+        // if all the measurements are done, mark the whole sensor as
+        // done, otherwise put it back in the queue
+        if (nMeasurementsCompleted[s] == nMeasurementsToAverage[s]) {
+            MS_DBG(F("--- Finished all measurements from"),
+                   arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
 
-                    nSensorsCompleted++;
-                    MS_DBG(F("*****---"), nSensorsCompleted,
-                           F("sensors now complete ---*****"));
-                }
-            }
+            nSensorsCompleted++;
+            MS_DBG(F("*****---"), nSensorsCompleted,
+                   F("sensors now complete ---*****"));
+        } else {
+            pushSensorDeadline(deadlineQueue, nQueued, s);
         }
     }
 
     // Average measurements and notify varibles of the updates
     MS_DBG(F("----->> Averaging results and notifying all variables. ..."));
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {
-            // MS_DBG(F("--- Averaging results from"),
-            // arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
-            arrayOfVars[i]->parentSensor->averageMeasurements();
-            // MS_DBG(F("--- Notifying variables from"),
-            // arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
-            arrayOfVars[i]->parentSensor->notifyVariables();
-        }
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        // MS_DBG(F("--- Averaging results from"),
+        // arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
+        arrayOfVars[_sensorVarIndex[s]]->parentSensor->averageMeasurements();
+        // MS_DBG(F("--- Notifying variables from"),
+        // arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
+        arrayOfVars[_sensorVarIndex[s]]->parentSensor->notifyVariables();
     }
     MS_DBG(F("... Complete. <<-----"));
 
+    evaluateCalculatedVariables();
+    formatValueStrings();
+
     return success;
 }
 
@@ -533,129 +497,57 @@ bool VariableArray::completeUpdate(void) {
     bool deepDebugTiming = false;
 #endif
 
-    // Create an array with the unique-ness value (so we can skip the function
-    // calls later)
-    MS_DBG(F("Creating a mask array with the uniqueness for each sensor.."));
-    bool lastSensorVariable[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        lastSensorVariable[i] = isLastVarFromSensor(i);
-    }
-
     // Create an array for the number of measurements already completed and set
     // all to zero
     MS_DBG(F("Creating an array for the number of completed measurements.."));
-    uint8_t nMeasurementsCompleted[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        nMeasurementsCompleted[i] = 0;
+    uint8_t nMeasurementsCompleted[MAX_NUMBER_SENSORS];
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        nMeasurementsCompleted[s] = 0;
     }
 
     // Create an array for the number of measurements to average (another short
     // cut)
     MS_DBG(F("Creating an array with the number of measurements to average.."));
-    uint8_t nMeasurementsToAverage[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {
-            nMeasurementsToAverage[i] =
-                arrayOfVars[i]->parentSensor->getNumberMeasurementsToAverage();
-        } else {
-            nMeasurementsToAverage[i] = 0;
-        }
+    uint8_t nMeasurementsToAverage[MAX_NUMBER_SENSORS];
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        nMeasurementsToAverage[s] = arrayOfVars[_sensorVarIndex[s]]
+                                        ->parentSensor
+                                        ->getNumberMeasurementsToAverage();
     }
 
-    // Create an array of the power pins
-    MS_DBG(F("Creating an array of the power pins.."));
-    int8_t powerPins[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {
-            powerPins[i] = arrayOfVars[i]->parentSensor->getPowerPin();
-        } else {
-            powerPins[i] = 0;
-        }
-    }
-
-    // Create an array of the last variable on each power pin
-    MS_DBG(F("Creating arrays of the power pin locations.."));
-    bool lastPinVariable[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) { lastPinVariable[i] = 1; }
-    // Create an array containing the index of the power pin in the powerPins
-    // array
-    int8_t powerPinIndex[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) { powerPinIndex[i] = 0; }
-    // Create an array to tell us how many measurements must be taken
-    // before all the sensors attached to a power pin are done
-    uint8_t nMeasurementsOnPin[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        nMeasurementsOnPin[i] = nMeasurementsToAverage[i];
-    }
-    // Now correctly populate the previous three arrays
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        for (uint8_t j = i + 1; j < _variableCount; j++) {
-            if (!lastSensorVariable[i]) {
-                lastPinVariable[i] = 0;
-                // MS_DBG(i, F("isn't the last variable on power pin because not
-                // last on sensor."));
-            } else if (powerPins[i] == powerPins[j]) {
-                lastPinVariable[i] = 0;
-                // MS_DBG(i, F("isn't the last variable on power pin, matches"),
-                // j);
-            }
-            i++;
-        }
-    }
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastPinVariable[i]) {
-            powerPinIndex[i]      = i;
-            nMeasurementsOnPin[i] = nMeasurementsToAverage[i];
-            for (uint8_t j = 0; j < _variableCount; j++) {
-                if (powerPins[j] == powerPins[i] && i != j) {
-                    powerPinIndex[j] = i;
-                    nMeasurementsOnPin[i] += nMeasurementsToAverage[j];
-                    nMeasurementsOnPin[j] = 0;
-                }
-            }
-        }
+    // Another array for the number of sensors on each power pin that have
+    // finished all of their measurements.  Once all of the sensors on a pin
+    // are finished, the pin can be turned off.
+    uint8_t nFinishedInPowerGroup[MAX_NUMBER_SENSORS];
+    for (uint8_t g = 0; g < _powerGroupCount; g++) {
+        nFinishedInPowerGroup[g] = 0;
     }
 
 // This is just for debugging
 #ifdef MS_VARIABLEARRAY_DEBUG_DEEP
-    uint8_t arrayPositions[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) { arrayPositions[i] = i; }
-    String nameLocation[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        // nameLocation[i] = arrayOfVars[i]->getParentSensorNameAndLocation();
-        nameLocation[i] = arrayOfVars[i]->getParentSensorName();
+    String nameLocation[MAX_NUMBER_SENSORS];
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i       = _sensorVarIndex[s];
+        nameLocation[s] = arrayOfVars[i]->getParentSensorName();
     }
     MS_DEEP_DBG(F("----------------------------------"));
-    MS_DEEP_DBG(F("arrayPositions:\t\t\t"));
-    prettyPrintArray(arrayPositions);
     MS_DEEP_DBG(F("sensor:\t\t\t"));
-    prettyPrintArray(nameLocation);
-    MS_DEEP_DBG(F("lastSensorVariable:\t\t"));
-    prettyPrintArray(lastSensorVariable);
+    prettyPrintArray(nameLocation, _sensorCount);
+    MS_DEEP_DBG(F("sensorVarIndex:\t\t"));
+    prettyPrintArray(_sensorVarIndex, _sensorCount);
     MS_DEEP_DBG(F("nMeasurementsToAverage:\t\t"));
-    prettyPrintArray(nMeasurementsToAverage);
-    MS_DEEP_DBG(F("powerPins:\t\t\t"));
-    prettyPrintArray(powerPins);
-    MS_DEEP_DBG(F("lastPinVariable:\t\t"));
-    prettyPrintArray(lastPinVariable);
-    MS_DEEP_DBG(F("nMeasurementsOnPin:\t\t"));
-    prettyPrintArray(nMeasurementsOnPin);
-    MS_DEEP_DBG(F("powerPinIndex:\t\t\t"));
-    prettyPrintArray(powerPinIndex);
+    prettyPrintArray(nMeasurementsToAverage, _sensorCount);
+    MS_DEEP_DBG(F("sensorPowerGroup:\t\t"));
+    prettyPrintArray(_sensorPowerGroup, _sensorCount);
+    MS_DEEP_DBG(F("sensorsInPowerGroup:\t\t"));
+    prettyPrintArray(_sensorsInPowerGroup, _powerGroupCount);
 #endif
 
-    // Another array for the number of measurements already completed per power
-    // pin
-    uint8_t nCompletedOnPin[_variableCount];
-    for (uint8_t i = 0; i < _variableCount; i++) { nCompletedOnPin[i] = 0; }
-
     // Clear the initial variable arrays
     MS_DBG(F("----->> Clearing all results arrays before taking new "
              "measurements. ..."));
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {
-            arrayOfVars[i]->parentSensor->clearValues();
-        }
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        arrayOfVars[_sensorVarIndex[s]]->parentSensor->clearValues();
     }
     MS_DBG(F("   ... Complete. <<-----"));
 
@@ -664,207 +556,259 @@ bool VariableArray::completeUpdate(void) {
     sensorsPowerUp();
     MS_DBG(F("   ... Complete. <<-----"));
 
-    while (nSensorsCompleted < _sensorCount) {
-        for (uint8_t i = 0; i < _variableCount; i++) {
-            /***
-            // THIS IS PURELY FOR DEEP DEBUGGING OF THE TIMING!
-            // Leave this whole section commented out unless you want excessive
-            // printouts (ie, thousands of lines) of the timing information!!
-            if (lastSensorVariable[i] and
-                nMeasurementsToAverage[i] > nMeasurementsCompleted[i]) {
-                MS_DEEP_DBG(
-                    i, '-', arrayOfVars[i]->getParentSensorNameAndLocation(),
-                    F("- millis:"), millis(), F("- status: 0b"),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 7),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 6),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 5),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 2),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 1),
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 0),
-                    F("- measurement #"), (nMeasurementsCompleted[i] + 1));
-            }
-            // END CHUNK FOR DEBUGGING!
-            ***/
-
-            // Only do checks on sensors that still have measurements to finish
-            if (lastSensorVariable[i] &&
-                nMeasurementsToAverage[i] > nMeasurementsCompleted[i]) {
-                // If no attempts yet made to wake the sensor up
-                if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) ==
-                    0) {
-                    // and if it is already warmed up
-                    if (arrayOfVars[i]->parentSensor->isWarmedUp(
-                            deepDebugTiming)) {
-                        MS_DBG(i, F("--->> Waking"),
-                               arrayOfVars[i]->getParentSensorNameAndLocation(),
-                               F("..."));
-
-                        // Make a single attempt to wake the sensor after it is
-                        // warmed up
-                        bool sensorSuccess_wake =
-                            arrayOfVars[i]->parentSensor->wake();
-                        success &= sensorSuccess_wake;
-
-                        if (sensorSuccess_wake) {
-                            MS_DBG(F("   ... wake up uccess. <<---"), i);
-                        } else {
-                            MS_DBG(F("   ... wake up failed! <<---"), i);
-                        }
-                    }
-                }
+    // Queue up every sensor that has measurements to take, keyed on the time
+    // its next step (warm up, stability, or measurement completion) is due.
+    sensorDeadline deadlineQueue[MAX_NUMBER_SENSORS];
+    uint8_t        nQueued = 0;
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        if (nMeasurementsToAverage[s] > nMeasurementsCompleted[s]) {
+            pushSensorDeadline(deadlineQueue, nQueued, s);
+        } else {
+            // A sensor with nothing to measure is finished already, but it
+            // must still count toward turning off the pin it shares
+            finishInPowerGroup(s, nFinishedInPowerGroup);
+            nSensorsCompleted++;
+        }
+    }
 
-                // If attempts were made to wake the sensor, but they failed
-                // then we're just bumping up the number of measurements to
-                // completion
-                if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) ==
-                        1 &&
-                    bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4) ==
-                        0) {
-                    MS_DBG(i, F("--->>"),
-                           arrayOfVars[i]->getParentSensorNameAndLocation(),
-                           F("did not wake up! No measurements will be taken! "
-                             "<<---"),
-                           i);
-                    // Set the number of measurements already equal to whatever
-                    // total number requested to ensure the sensor is skipped in
-                    // further loops.
-                    nMeasurementsCompleted[i] = nMeasurementsToAverage[i];
-                    // increment the number of measurements that the power pin
-                    // has completed
-                    nCompletedOnPin[powerPinIndex[i]] +=
-                        nMeasurementsToAverage[i];
-                }
+    // Rather than continuously polling every sensor, idle until the earliest
+    // deadline and then act only on the sensor that is due.  Sensors that
+    // still have work to do are put back in the queue with their new deadline.
+    while (nQueued > 0) {
+        idleUntil(deadlineQueue[0].dueMillis);
+        uint8_t s = popSensorDeadline(deadlineQueue, nQueued);
+        uint8_t i = _sensorVarIndex[s];
+
+        // If no attempts yet made to wake the sensor up
+        if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) == 0) {
+            // and if it is already warmed up
+            if (arrayOfVars[i]->parentSensor->isWarmedUp(deepDebugTiming)) {
+                MS_DBG(i, F("--->> Waking"),
+                       arrayOfVars[i]->getParentSensorNameAndLocation(),
+                       F("..."));
 
-                // If the sensor was successfully awoken/activated...
-                // .. make sure the sensor is stable
-                if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4) ==
-                        1 &&
-                    arrayOfVars[i]->parentSensor->isStable(deepDebugTiming)) {
-                    // If no attempt has yet been made to start a measurement,
-                    // start one
-                    if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 5) ==
-                        0) {
-                        // Start a reading
-                        MS_DBG(i, '.', nMeasurementsCompleted[i] + 1,
-                               F("--->> Starting reading"),
-                               nMeasurementsCompleted[i] + 1, F("on"),
-                               arrayOfVars[i]->getParentSensorNameAndLocation(),
-                               F("..."));
-
-                        bool sensorSuccess_start =
-                            arrayOfVars[i]
-                                ->parentSensor->startSingleMeasurement();
-                        success &= sensorSuccess_start;
-
-                        if (sensorSuccess_start) {
-                            MS_DBG(F("   ... set up succeeded. <<---"), i, '.',
-                                   nMeasurementsCompleted[i] + 1);
-                        } else {
-                            MS_DBG(F("   ... set up failed! <<---"), i, '.',
-                                   nMeasurementsCompleted[i] + 1);
-                        }
-                    }
+                // Make a single attempt to wake the sensor after it is
+                // warmed up
+                bool sensorSuccess_wake = arrayOfVars[i]->parentSensor->wake();
+                success &= sensorSuccess_wake;
 
-                    // If a measurement is finished, get the result and tick up
-                    // the number of finished measurements.  We aren't bothering
-                    // to check if the measurement start was successful,
-                    // isMeasurementComplete(deepDebugTiming) will do that and
-                    // we stil want the addSingleMeasurementResult() function to
-                    // fill in the -9999 results for a failed measurement.
-                    if (arrayOfVars[i]->parentSensor->isMeasurementComplete(
-                            deepDebugTiming)) {
-                        // Get the value
-                        MS_DBG(i, '.', nMeasurementsCompleted[i] + 1,
-                               F("--->> Collected result of reading"),
-                               nMeasurementsCompleted[i] + 1, F("from"),
-                               arrayOfVars[i]->getParentSensorNameAndLocation(),
-                               F("..."));
-
-                        bool sensorSuccess_result =
-                            arrayOfVars[i]
-                                ->parentSensor->addSingleMeasurementResult();
-                        success &= sensorSuccess_result;
-                        nMeasurementsCompleted[i] +=
-                            1;  // increment the number of measurements that
-                                // sensor has completed
-                        nCompletedOnPin[powerPinIndex[i]] +=
-                            1;  // increment the number of measurements that the
-                                // power pin has completed
-
-                        if (sensorSuccess_result) {
-                            MS_DBG(F("   ... got measurement result. <<---"), i,
-                                   '.', nMeasurementsCompleted[i]);
-                        } else {
-                            MS_DBG(F("   ... failed to get measurement result! "
-                                     "<<---"),
-                                   i, '.', nMeasurementsCompleted[i]);
-                        }
-                    }
+                if (sensorSuccess_wake) {
+                    MS_DBG(F("   ... wake up uccess. <<---"), i);
+                } else {
+                    MS_DBG(F("   ... wake up failed! <<---"), i);
                 }
+            }
+        }
 
-                // If all the measurements are done
-                if (nMeasurementsCompleted[i] == nMeasurementsToAverage[i]) {
-                    MS_DBG(i, F("--->> Finished all measurements from"),
-                           arrayOfVars[i]->getParentSensorNameAndLocation(),
-                           F(", putting it to sleep. ..."));
+        // If attempts were made to wake the sensor, but they failed
+        // then we're just bumping up the number of measurements to
+        // completion
+        if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 3) == 1 &&
+            bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4) == 0) {
+            MS_DBG(i, F("--->>"),
+                   arrayOfVars[i]->getParentSensorNameAndLocation(),
+                   F("did not wake up! No measurements will be taken! "
+                     "<<---"),
+                   i);
+            // Set the number of measurements already equal to whatever
+            // total number requested to ensure the sensor is skipped in
+            // further loops.
+            nMeasurementsCompleted[s] = nMeasurementsToAverage[s];
+        }
 
-                    // Put the completed sensor to sleep
-                    bool sensorSuccess_sleep =
-                        arrayOfVars[i]->parentSensor->sleep();
-                    success &= sensorSuccess_sleep;
+        // If the sensor was successfully awoken/activated...
+        // .. make sure the sensor is stable
+        if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 4) == 1 &&
+            arrayOfVars[i]->parentSensor->isStable(deepDebugTiming)) {
+            // If no attempt has yet been made to start a measurement,
+            // start one
+            if (bitRead(arrayOfVars[i]->parentSensor->getStatus(), 5) == 0) {
+                // Start a reading
+                MS_DBG(i, '.', nMeasurementsCompleted[s] + 1,
+                       F("--->> Starting reading"),
+                       nMeasurementsCompleted[s] + 1, F("on"),
+                       arrayOfVars[i]->getParentSensorNameAndLocation(),
+                       F("..."));
+
+                bool sensorSuccess_start =
+                    arrayOfVars[i]->parentSensor->startSingleMeasurement();
+                success &= sensorSuccess_start;
+
+                if (sensorSuccess_start) {
+                    MS_DBG(F("   ... set up succeeded. <<---"), i, '.',
+                           nMeasurementsCompleted[s] + 1);
+                } else {
+                    MS_DBG(F("   ... set up failed! <<---"), i, '.',
+                           nMeasurementsCompleted[s] + 1);
+                }
+            }
 
-                    if (sensorSuccess_sleep) {
-                        MS_DBG(F("   ... succeeded in putting sensor to sleep. "
-                                 "<<---"),
-                               i);
-                    } else {
-                        MS_DBG(F("   ... sleep failed! <<---"), i);
-                    }
+            // If a measurement is finished, get the result and tick up
+            // the number of finished measurements.  We aren't bothering
+            // to check if the measurement start was successful,
+            // pollMeasurement(deepDebugTiming) will do that and we stil
+            // want the collectResult() function to fill in the -9999
+            // results for a failed measurement.  Sensors using the
+            // cooperative interface do their communication a little at a
+            // time inside pollMeasurement(), so other sensors are still
+            // serviced while they wait on a response.
+            if (arrayOfVars[i]->parentSensor->pollMeasurement(
+                    deepDebugTiming) != MEASUREMENT_PENDING) {
+                // Get the value
+                MS_DBG(i, '.', nMeasurementsCompleted[s] + 1,
+                       F("--->> Collected result of reading"),
+                       nMeasurementsCompleted[s] + 1, F("from"),
+                       arrayOfVars[i]->getParentSensorNameAndLocation(),
+                       F("..."));
+
+                // The measurement ends when its result is collected
+                uint32_t requested = arrayOfVars[i]
+                                         ->parentSensor
+                                         ->getMillisMeasurementRequested();
+                if (_energyLedger != NULL && requested != 0) {
+                    _energyLedger->addSensorTime(arrayOfVars[i]->parentSensor,
+                                                 SENSOR_STATE_MEASURING,
+                                                 millis() - requested);
+                }
+                bool sensorSuccess_result =
+                    arrayOfVars[i]->parentSensor->collectResult();
+                success &= sensorSuccess_result;
+                nMeasurementsCompleted[s] +=
+                    1;  // increment the number of measurements that
+                        // sensor has completed
+
+                if (sensorSuccess_result) {
+                    MS_DBG(F("   ... got measurement result. <<---"), i, '.',
+                           nMeasurementsCompleted[s]);
+                } else {
+                    MS_DBG(F("   ... failed to get measurement result! "
+                             "<<---"),
+                           i, '.', nMeasurementsCompleted[s]);
+                }
+            }
+        }
 
-                    // Now cut the power, if ready, to this sensors and all that
-                    // share the pin
-                    if (nCompletedOnPin[powerPinIndex[i]] ==
-                        nMeasurementsOnPin[powerPinIndex[i]]) {
-                        for (uint8_t k = 0; k < _variableCount; k++) {
-                            if (powerPinIndex[k] == powerPinIndex[i] &&
-                                lastSensorVariable[k]) {
-                                arrayOfVars[k]->parentSensor->powerDown();
-                                MS_DBG(k, F("--->>"),
-                                       arrayOfVars[k]
-                                           ->getParentSensorNameAndLocation(),
-                                       F("powered down. <<---"), k);
-                            }
-                        }
-                    }
+        // If all the measurements are done
+        if (nMeasurementsCompleted[s] == nMeasurementsToAverage[s]) {
+            MS_DBG(i, F("--->> Finished all measurements from"),
+                   arrayOfVars[i]->getParentSensorNameAndLocation(),
+                   F(", putting it to sleep. ..."));
+
+            // Put the completed sensor to sleep
+            uint32_t activated =
+                arrayOfVars[i]->parentSensor->getMillisSensorActivated();
+            if (_energyLedger != NULL && activated != 0) {
+                _energyLedger->addSensorTime(arrayOfVars[i]->parentSensor,
+                                             SENSOR_STATE_ACTIVE,
+                                             millis() - activated);
+            }
+            bool sensorSuccess_sleep = arrayOfVars[i]->parentSensor->sleep();
+            success &= sensorSuccess_sleep;
 
-                    nSensorsCompleted++;  // mark the whole sensor as done
-                    MS_DBG(F("*****---"), nSensorsCompleted,
-                           F("sensors now complete ---*****"));
-                }
+            if (sensorSuccess_sleep) {
+                MS_DBG(F("   ... succeeded in putting sensor to sleep. "
+                         "<<---"),
+                       i);
+            } else {
+                MS_DBG(F("   ... sleep failed! <<---"), i);
             }
+
+            // Now cut the power, if ready, to this sensors and all that
+            // share the pin
+            finishInPowerGroup(s, nFinishedInPowerGroup);
+
+            nSensorsCompleted++;  // mark the whole sensor as done
+            MS_DBG(F("*****---"), nSensorsCompleted,
+                   F("sensors now complete ---*****"));
+        } else {
+            // Otherwise, put it back in the queue with its next deadline
+            pushSensorDeadline(deadlineQueue, nQueued, s);
         }
     }
 
     // Average measurements and notify varibles of the updates
     MS_DBG(F("----->> Averaging results and notifying all variables. ..."));
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (lastSensorVariable[i]) {
-            MS_DBG(F("--- Averaging results from"),
-                   arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
-            arrayOfVars[i]->parentSensor->averageMeasurements();
-            MS_DBG(F("--- Notifying variables from"),
-                   arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
-            arrayOfVars[i]->parentSensor->notifyVariables();
-        }
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        uint8_t i = _sensorVarIndex[s];
+        MS_DBG(F("--- Averaging results from"),
+               arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
+        arrayOfVars[i]->parentSensor->averageMeasurements();
+        MS_DBG(F("--- Notifying variables from"),
+               arrayOfVars[i]->getParentSensorNameAndLocation(), F("---"));
+        arrayOfVars[i]->parentSensor->notifyVariables();
     }
     MS_DBG(F("... Complete. <<-----"));
 
+    evaluateCalculatedVariables();
+    formatValueStrings();
+
     return success;
 }
 
 
+// Run each calculation once now that all of the sensor values are new.  The
+// results are cached so later reads by the logger and publishers are free.
+void VariableArray::evaluateCalculatedVariables(void) {
+    MS_DBG(F("----->> Evaluating calculated variables. ..."));
+    // Clear everything first so no calculation sees an input from last cycle
+    for (uint8_t i = 0; i < _variableCount; i++) {
+        arrayOfVars[i]->clearCachedValue();
+    }
+    for (uint8_t i = 0; i < _variableCount; i++) {
+        arrayOfVars[i]->evaluateCalculation();
+    }
+    MS_DBG(F("... Complete. <<-----"));
+}
+
+
+// Format every value once so the logger and publishers can share the text
+void VariableArray::formatValueStrings(void) {
+    for (uint8_t i = 0; i < _variableCount && i < _valueStringSlots; i++) {
+        arrayOfVars[i]->formatValue(_valueStrings[i], MS_VALUE_STRING_LENGTH);
+    }
+    _valueStringsCurrent = true;
+}
+
+
+// This returns the value formatted at the end of the last update, formatting
+// it on the spot if there is no slot for it
+const char* VariableArray::getValueChars(uint8_t arrayIndex) {
+    if (_valueStringsCurrent && arrayIndex < _valueStringSlots) {
+        return _valueStrings[arrayIndex];
+    }
+    arrayOfVars[arrayIndex]->formatValue(_scratchValueString,
+                                         MS_VALUE_STRING_LENGTH);
+    return _scratchValueString;
+}
+
+
+// This sets where the formatted values are kept
+void VariableArray::setValueStringBuffer(char (*buffer)[MS_VALUE_STRING_LENGTH],
+                                         uint8_t slotCount) {
+    _valueStrings        = buffer;
+    _valueStringSlots    = buffer == NULL ? 0 : slotCount;
+    _valueStringsCurrent = false;
+}
+
+
+// This swaps in values formatted earlier, such as those of a queued record
+bool VariableArray::readValueStrings(Stream* stream) {
+    if (_variableCount > _valueStringSlots) return false;
+    for (uint8_t i = 0; i < _variableCount; i++) {
+        if (stream->readBytes(_valueStrings[i], MS_VALUE_STRING_LENGTH) !=
+            MS_VALUE_STRING_LENGTH) {
+            return false;
+        }
+        _valueStrings[i][MS_VALUE_STRING_LENGTH - 1] = '\0';
+    }
+    _valueStringsCurrent = true;
+    return true;
+}
+void VariableArray::restoreValueStrings(void) {
+    formatValueStrings();
+}
+
+
 // This function prints out the results for any connected sensors to a stream
 //  Calculated Variable results will be included
 void VariableArray::printSensorData(Stream* stream) {
@@ -872,7 +816,7 @@ void VariableArray::printSensorData(Stream* stream) {
         if (arrayOfVars[i]->isCalculated) {
             stream->print(arrayOfVars[i]->getVarName());
             stream->print(F(" is calculated to be "));
-            stream->print(arrayOfVars[i]->getValueString());
+            stream->print(getValueChars(i));
             stream->print(F(" "));
             stream->print(arrayOfVars[i]->getVarUnit());
             stream->println();
@@ -898,7 +842,7 @@ void VariableArray::printSensorData(Stream* stream) {
             stream->print(F(" reports "));
             stream->print(arrayOfVars[i]->getVarName());
             stream->print(F(" is "));
-            stream->print(arrayOfVars[i]->getValueString());
+            stream->print(getValueChars(i));
             stream->print(F(" "));
             stream->print(arrayOfVars[i]->getVarUnit());
             stream->println();
@@ -907,6 +851,103 @@ void VariableArray::printSensorData(Stream* stream) {
 }
 
 
+// Add a sensor to the deadline queue (a binary min-heap on the due time)
+void VariableArray::pushSensorDeadline(sensorDeadline queue[],
+                                       uint8_t& queueSize,
+                                       uint8_t sensorIndex) {
+    uint32_t due = millis() + arrayOfVars[_sensorVarIndex[sensorIndex]]
+                                  ->parentSensor->getMillisUntilNextStep();
+
+    // Sift the new entry up from the bottom of the heap.  Times are compared
+    // by their signed difference so the order survives a millis() rollover.
+    uint8_t pos = queueSize++;
+    while (pos > 0) {
+        uint8_t parent = (pos - 1) / 2;
+        if (static_cast<int32_t>(due - queue[parent].dueMillis) >= 0) break;
+        queue[pos] = queue[parent];
+        pos        = parent;
+    }
+    queue[pos].dueMillis   = due;
+    queue[pos].sensorIndex = sensorIndex;
+}
+
+
+// Remove the sensor with the earliest deadline from the queue
+uint8_t VariableArray::popSensorDeadline(sensorDeadline queue[],
+                                         uint8_t& queueSize) {
+    uint8_t        earliest = queue[0].sensorIndex;
+    sensorDeadline last     = queue[--queueSize];
+
+    // Sift the last entry down from the top of the heap
+    uint8_t pos = 0;
+    while (true) {
+        uint8_t child = 2 * pos + 1;
+        if (child >= queueSize) break;
+        if (child + 1 < queueSize &&
+            static_cast<int32_t>(queue[child + 1].dueMillis -
+                                 queue[child].dueMillis) < 0) {
+            child++;
+        }
+        if (static_cast<int32_t>(queue[child].dueMillis - last.dueMillis) >=
+            0) {
+            break;
+        }
+        queue[pos] = queue[child];
+        pos        = child;
+    }
+    queue[pos] = last;
+    return earliest;
+}
+
+
+// Count a finished sensor and cut the power to its group once every sensor
+// sharing the pin is finished
+void VariableArray::finishInPowerGroup(uint8_t sensorIndex,
+                                       uint8_t nFinishedInPowerGroup[]) {
+    uint8_t group = _sensorPowerGroup[sensorIndex];
+    nFinishedInPowerGroup[group]++;
+    if (nFinishedInPowerGroup[group] != _sensorsInPowerGroup[group]) return;
+    for (uint8_t t = 0; t < _sensorCount; t++) {
+        if (_sensorPowerGroup[t] == group) {
+            uint8_t  k = _sensorVarIndex[t];
+            uint32_t poweredOn =
+                arrayOfVars[k]->parentSensor->getMillisPowerOn();
+            // A sensor without a power pin stays on; the ledger counts it as
+            // powered for the whole cycle
+            if (_energyLedger != NULL && poweredOn != 0 &&
+                arrayOfVars[k]->parentSensor->getPowerPin() >= 0) {
+                _energyLedger->addSensorTime(arrayOfVars[k]->parentSensor,
+                                             SENSOR_STATE_POWERED,
+                                             millis() - poweredOn);
+            }
+            arrayOfVars[k]->parentSensor->powerDown();
+            MS_DBG(k, F("--->>"),
+                   arrayOfVars[k]->getParentSensorNameAndLocation(),
+                   F("powered down. <<---"), k);
+        }
+    }
+}
+
+
+// Idle the processor until the next sensor deadline
+void VariableArray::idleUntil(uint32_t wakeMillis) {
+    if (_energyLedger != NULL) {
+        idleProcessorUntil(wakeMillis, &VariableArray::onIdleWake,
+                           _energyLedger);
+    } else {
+        idleProcessorUntil(wakeMillis);
+    }
+}
+void VariableArray::onIdleWake(uint32_t sleptMillis, void* context) {
+    static_cast<EnergyLedger*>(context)->addIdleTime(sleptMillis);
+}
+
+
+void VariableArray::setEnergyLedger(EnergyLedger* ledger) {
+    _energyLedger = ledger;
+}
+
+
 // Check for unique sensors
 bool VariableArray::isLastVarFromSensor(int arrayIndex) {
     /*MS_DEEP_DBG(F("Checking if"), arrayOfVars[arrayIndex]->getVarName(), '(',
@@ -935,16 +976,63 @@ bool VariableArray::isLastVarFromSensor(int arrayIndex) {
 }
 
 
+// Build the table of unique sensors and the groups of sensors sharing a power
+// pin.  This is the only place the (slow) uniqueness check is run.
+bool VariableArray::buildSensorTopology(void) {
+    int8_t  groupPowerPin[MAX_NUMBER_SENSORS];
+    uint8_t nSensors = 0;
+    _sensorCount     = 0;
+    _powerGroupCount = 0;
+    // The formatted values are indexed by variable, so are stale if the list
+    // has changed
+    _valueStringsCurrent = false;
+
+    for (uint8_t i = 0; i < _variableCount; i++) {
+        if (!isLastVarFromSensor(i)) continue;  // Skip non-unique sensors
+        // Keep counting past the end of the table to say how big it must be
+        if (nSensors++ >= MAX_NUMBER_SENSORS) continue;
+
+        // Find the group for this sensor's power pin, or start a new one
+        int8_t  powerPin = arrayOfVars[i]->parentSensor->getPowerPin();
+        uint8_t group    = 0;
+        while (group < _powerGroupCount && groupPowerPin[group] != powerPin) {
+            group++;
+        }
+        if (group == _powerGroupCount) {
+            groupPowerPin[group]        = powerPin;
+            _sensorsInPowerGroup[group] = 0;
+            _powerGroupCount++;
+        }
+
+        _sensorVarIndex[_sensorCount]   = i;
+        _sensorPowerGroup[_sensorCount] = group;
+        _sensorsInPowerGroup[group]++;
+        _sensorCount++;
+    }
+    // Updating only some of the sensors would silently leave the rest out of
+    // the data, so update none of them
+    if (nSensors > MAX_NUMBER_SENSORS) {
+        PRINTOUT(F("Too many sensors!  The variables come from"), nSensors,
+                 F("sensors; increase MAX_NUMBER_SENSORS to at least that."),
+                 F("No sensors will be updated!"));
+        _sensorCount     = 0;
+        _powerGroupCount = 0;
+        return false;
+    }
+    MS_DBG(F("There are"), _sensorCount, F("unique sensors on"),
+           _powerGroupCount, F("power pins in the group."));
+    return true;
+}
+
+
 // Count the maximum number of measurements needed from a single sensor for the
 // requested averaging
 uint8_t VariableArray::countMaxToAverage(void) {
     uint8_t numReps = 0;
-    for (uint8_t i = 0; i < _variableCount; i++) {
-        if (isLastVarFromSensor(i)) {  // Skip non-unique sensors
-            numReps = max(
-                numReps,
-                arrayOfVars[i]->parentSensor->getNumberMeasurementsToAverage());
-        }
+    for (uint8_t s = 0; s < _sensorCount; s++) {
+        numReps = max(numReps, arrayOfVars[_sensorVarIndex[s]]
+                                   ->parentSensor
+                                   ->getNumberMeasurementsToAverage());
     }
     // MS_DBG(F("The largest number of measurements to average will be"),
     // numReps);
@@ -32,6 +32,29 @@
 #include "VariableBase.h"
 #include "SensorBase.h"
 
+class EnergyLedger;  // Forward declaration
+
+/**
+ * @brief The largest number of unique sensors that can be attached to the
+ * variables in a single VariableArray.
+ *
+ * This sizes the sensor and power pin topology tables built when the array is
+ * begun.  Each sensor costs 3 bytes of RAM.
+ */
+#ifndef MAX_NUMBER_SENSORS
+#define MAX_NUMBER_SENSORS 20
+#endif
+
+/**
+ * @brief The size of the char slot holding each formatted value, including
+ * the terminating null.
+ *
+ * A value that does not fit is replaced by -9999.
+ */
+#ifndef MS_VALUE_STRING_LENGTH
+#define MS_VALUE_STRING_LENGTH 14
+#endif
+
 
 /**
  * @brief The variable array class defines the logic for iterating through many
@@ -95,8 +118,11 @@ class VariableArray {
      * @param variableList An array of pointers to variable objects.  The
      * pointers may be to calculated or measured variable objects.  Supercedes
      * any value given in the constructor.
+     *
+     * @return **bool** False if the variables come from more than
+     * #MAX_NUMBER_SENSORS sensors; no sensors are then updated at all.
      */
-    void begin(uint8_t variableCount, Variable* variableList[]);
+    bool begin(uint8_t variableCount, Variable* variableList[]);
     /**
      * @brief Begins the VariableArray.  Suppiles a variable array and UUIDs,
      * checks the validity of all UUID and outputs the results.
@@ -108,14 +134,20 @@ class VariableArray {
      * any value given in the constructor.
      * @param uuids An array of UUID's.  These are linked 1-to-1 with the
      * variables by array position.
+     *
+     * @return **bool** False if the variables come from more than
+     * #MAX_NUMBER_SENSORS sensors; no sensors are then updated at all.
      */
-    void begin(uint8_t variableCount, Variable* variableList[],
+    bool begin(uint8_t variableCount, Variable* variableList[],
                const char* uuids[]);
     /**
      * @brief Begins the VariableArray.  Checks the validity of all UUID and
      * outputs the results.
+     *
+     * @return **bool** False if the variables come from more than
+     * #MAX_NUMBER_SENSORS sensors; no sensors are then updated at all.
      */
-    void begin();
+    bool begin();
 
     /**
      * @brief Pointer to the array of variable pointers.
@@ -214,8 +246,10 @@ class VariableArray {
      * @brief Update the values for all connected sensors.
      *
      * Does not power or wake/sleep sensors.  Returns a boolean indication the
-     * overall success.  Does NOT return any values.  Repeatedly checks each
-     * sensor's readiness state to optimize timing.
+     * overall success.  Does NOT return any values.  Acts on each sensor as
+     * soon as its next step is due, idling the processor between deadlines.
+     * Once all sensors are done, each calculated variable is evaluated once
+     * and its value cached until the next update.
      *
      * @return **bool** True if all steps of the update succeeded.
      */
@@ -228,13 +262,54 @@ class VariableArray {
      * them and waking and putting them to sleep.
      *
      * Returns a boolean indication the overall success.  Does NOT return any
-     * values.  Repeatedly checks each sensor's readiness state to optimize
-     * timing.
+     * values.  The next deadline of each sensor (from its warm-up,
+     * stabilization, and measurement times) is kept in a small priority queue
+     * and the processor idles until the earliest one rather than continuously
+     * polling every sensor.  Calculated variables are then evaluated once,
+     * inputs first, and cached until the next update.
      *
      * @return **bool** True if all steps of the update succeeded.
      */
     bool completeUpdate(void);
 
+    /**
+     * @brief Give the array a ledger to add the time each sensor is powered,
+     * active, and measuring to, and the time the processor idles.
+     *
+     * Only completeUpdate() adds sensor times.  This is done by
+     * Logger::attachEnergyLedger().
+     *
+     * @param ledger The ledger, or NULL to stop adding to one
+     */
+    void setEnergyLedger(EnergyLedger* ledger);
+
+    /**
+     * @brief Give the array somewhere to keep the formatted value of each
+     * variable between updates.
+     *
+     * Without this the values are formatted each time they are read.  A
+     * StaticVariableArray supplies its own slots, one per variable.  The
+     * logger's publish queue needs a slot for every variable.
+     *
+     * @code{cpp}
+     * char valueSlots[variableCount][MS_VALUE_STRING_LENGTH];
+     * varArray.setValueStringBuffer(valueSlots, variableCount);
+     * @endcode
+     *
+     * @param buffer The slots; must stay in place as long as the array is used
+     * @param slotCount The number of slots in the buffer
+     */
+    void setValueStringBuffer(char (*buffer)[MS_VALUE_STRING_LENGTH],
+                              uint8_t slotCount);
+    /**
+     * @brief Get the number of variables whose formatted values are kept.
+     *
+     * @return **uint8_t** The number of value slots
+     */
+    uint8_t getValueStringSlotCount(void) {
+        return _valueStringSlots;
+    }
+
     /**
      * @brief Print out the results for all connected sensors to a stream
      *
@@ -248,6 +323,45 @@ class VariableArray {
      */
     void printSensorData(Stream* stream = &Serial);
 
+    /**
+     * @brief Get the value of the variable at the given position in the
+     * array as text with the correct number of decimal places.
+     *
+     * After an update each value is formatted once, by
+     * updateAllSensors() or completeUpdate(), into a slot owned by the array,
+     * so this returns a pointer to that text without copying or converting
+     * anything.  Before the first update, or for variables without a slot
+     * (see setValueStringBuffer()), the value is formatted into a single
+     * scratch slot instead.
+     *
+     * @warning Only one pointer to the scratch slot is good at a time.  Copy
+     * or print the text before reading another value that might also be
+     * formatted on demand.
+     *
+     * @param arrayIndex The position of the variable in the array.
+     * @return **const char\*** The formatted value; valid until the next
+     * update, or for the scratch slot until the next value formatted on
+     * demand.
+     */
+    const char* getValueChars(uint8_t arrayIndex);
+    /**
+     * @brief Replace the formatted values with ones saved earlier, so a
+     * stored record can be published again exactly as it was first sent.
+     *
+     * The saved text stays in place of the current values until the next
+     * update or a call to restoreValueStrings().
+     *
+     * @param stream The stream to read #MS_VALUE_STRING_LENGTH characters
+     * for each variable from.
+     * @return **bool** True if there was a saved value for every variable;
+     * false if the array doesn't have a slot for every variable.
+     */
+    bool readValueStrings(Stream* stream);
+    /**
+     * @brief Format the current values again, undoing readValueStrings().
+     */
+    void restoreValueStrings(void);
+
  protected:
     /**
      * @brief The count of variables in the array
@@ -262,10 +376,151 @@ class VariableArray {
      */
     uint8_t _maxSamplestoAverage;
 
+    /**
+     * @brief The position in the variable array of the last variable tied to
+     * each unique sensor.
+     *
+     * This, #_sensorPowerGroup, #_sensorsInPowerGroup, and
+     * #_powerGroupCount make up the sensor/power pin topology table.  The
+     * table is built once when the array is begun and is what the sensor
+     * loops iterate over, rather than re-checking the uniqueness of every
+     * variable and matching power pins on every update.
+     */
+    uint8_t _sensorVarIndex[MAX_NUMBER_SENSORS];
+    /**
+     * @brief The power pin group of each unique sensor.  All sensors sharing
+     * a power pin are in the same group.
+     */
+    uint8_t _sensorPowerGroup[MAX_NUMBER_SENSORS];
+    /**
+     * @brief The number of unique sensors in each power pin group.
+     */
+    uint8_t _sensorsInPowerGroup[MAX_NUMBER_SENSORS];
+    /**
+     * @brief The number of distinct power pins used by the sensors.
+     */
+    uint8_t _powerGroupCount;
+
+    /**
+     * @brief The value of each variable as formatted at the end of the last
+     * update, or NULL if the values are not kept.
+     */
+    char (*_valueStrings)[MS_VALUE_STRING_LENGTH];
+    /**
+     * @brief The number of slots in #_valueStrings.
+     */
+    uint8_t _valueStringSlots;
+    /**
+     * @brief A slot for values formatted on demand by getValueChars().
+     */
+    char _scratchValueString[MS_VALUE_STRING_LENGTH];
+    /**
+     * @brief Whether #_valueStrings holds the values from the last update.
+     */
+    bool _valueStringsCurrent;
+
+    /**
+     * @brief The ledger the sensor on-times are added to, if any.
+     */
+    EnergyLedger* _energyLedger;
+
+    /**
+     * @brief An entry in the queue of upcoming sensor deadlines used by
+     * updateAllSensors() and completeUpdate().
+     */
+    typedef struct {
+        /**
+         * @brief The processor time (millis()) at which the sensor's next
+         * step is due.
+         */
+        uint32_t dueMillis;
+        /**
+         * @brief The position of the sensor in the topology table.
+         */
+        uint8_t sensorIndex;
+    } sensorDeadline;
+
  private:
     bool    isLastVarFromSensor(int arrayIndex);
     uint8_t countMaxToAverage(void);
     bool    checkVariableUUIDs(void);
+    /**
+     * @brief Build the sensor/power pin topology table from the current
+     * variable list and set #_sensorCount.
+     *
+     * This is run by every constructor and begin() and must be re-run if the
+     * variable list changes.  If there are more than #MAX_NUMBER_SENSORS
+     * sensors the table is left empty, so a sensor is never silently left out
+     * of the updates.
+     *
+     * @return **bool** True if every sensor fit in the table
+     */
+    bool buildSensorTopology(void);
+    /**
+     * @brief Clear the cached values of all calculated variables and then
+     * evaluate each once, inputs first.
+     *
+     * This is run at the end of updateAllSensors() and completeUpdate().
+     */
+    void evaluateCalculatedVariables(void);
+    /**
+     * @brief Format the current value of every variable into
+     * #_valueStrings.
+     *
+     * This is run after evaluateCalculatedVariables() at the end of each
+     * update.
+     */
+    void formatValueStrings(void);
+
+    /**
+     * @brief Add a sensor to a binary min-heap of deadlines, keyed on the
+     * time its next step is due.
+     *
+     * @param queue The heap storage; must have room for one entry per sensor.
+     * @param queueSize The number of entries in the heap; incremented.
+     * @param sensorIndex The position of the sensor in the topology table.
+     */
+    void pushSensorDeadline(sensorDeadline queue[], uint8_t& queueSize,
+                            uint8_t sensorIndex);
+    /**
+     * @brief Remove the sensor with the earliest deadline from a binary
+     * min-heap of deadlines.
+     *
+     * @param queue The heap storage.
+     * @param queueSize The number of entries in the heap; decremented.  Must
+     * not be 0.
+     * @return **uint8_t** The position in the topology table of the sensor
+     * that was removed.
+     */
+    uint8_t popSensorDeadline(sensorDeadline queue[], uint8_t& queueSize);
+    /**
+     * @brief Count a sensor as finished in its power group and, if it was the
+     * last sensor of the group still measuring, power down the whole group.
+     *
+     * @param sensorIndex The position of the sensor in the topology table.
+     * @param nFinishedInPowerGroup The number of finished sensors in each
+     * power group; incremented for the sensor's group.
+     */
+    void finishInPowerGroup(uint8_t sensorIndex,
+                            uint8_t nFinishedInPowerGroup[]);
+    /**
+     * @brief Idle the processor until the given time.
+     *
+     * This sleeps with idleProcessorUntil(), adding the time slept to the
+     * energy ledger if there is one.  Returns immediately if the time has
+     * passed.
+     *
+     * @param wakeMillis The processor time (millis()) to wait for.
+     */
+    void idleUntil(uint32_t wakeMillis);
+    /**
+     * @brief Add a sleep to an energy ledger; called by idleProcessorUntil()
+     * after every wake in idleUntil().
+     *
+     * @param sleptMillis The milliseconds the processor slept.
+     * @param context The EnergyLedger to add the time to.
+     */
+    static void onIdleWake(uint32_t sleptMillis, void* context);
 
 #ifdef MS_VARIABLEARRAY_DEBUG_DEEP
     /**
@@ -274,11 +529,12 @@ class VariableArray {
      *
      * @tparam T Any printable type
      * @param arrayToPrint The array of values to print.
+     * @param count The number of values in the array.
      */
     template <typename T>
-    void prettyPrintArray(T arrayToPrint[]) {
+    void prettyPrintArray(T arrayToPrint[], uint8_t count) {
         DEEP_DEBUGGING_SERIAL_OUTPUT.print("[,\t");
-        for (uint8_t i = 0; i < _variableCount; i++) {
+        for (uint8_t i = 0; i < count; i++) {
             DEEP_DEBUGGING_SERIAL_OUTPUT.print(arrayToPrint[i]);
             DEEP_DEBUGGING_SERIAL_OUTPUT.print(",\t");
         }
@@ -293,4 +549,104 @@ class VariableArray {
 #endif  // DEEP_DEBUGGING_SERIAL_OUTPUT
 };
 
+
+/**
+ * @brief A VariableArray whose number of variables is fixed at compile time.
+ *
+ * The count is taken from the type of the variable list, so a list and count
+ * that disagree are a compile error rather than a read past the end of the
+ * list.  Only the count is fixed at compile time; no tables are built then.
+ * The sensor and power pin tables depend on which sensor object each variable
+ * points to, which is only known once the objects exist, so they are built at
+ * run time when the array is begun, exactly as for a VariableArray.  This
+ * class is a thin wrapper for the count.  The array also holds a slot
+ * for the formatted value of each of its variables (see
+ * VariableArray::setValueStringBuffer()).  In every other way this is a
+ * VariableArray, and can be given to Logger::setVariableArray() or a Logger
+ * constructor directly.
+ *
+ * @code{cpp}
+ * Variable* variableList[] = {...};
+ * StaticVariableArray<sizeof(variableList) / sizeof(variableList[0])>
+ *     varArray(variableList);
+ * @endcode
+ *
+ * @tparam VARIABLE_COUNT The number of variables in the array
+ */
+template <uint8_t VARIABLE_COUNT>
+class StaticVariableArray : public VariableArray {
+    static_assert(VARIABLE_COUNT > 0,
+                  "A StaticVariableArray must hold at least one variable");
+
+ public:
+    /**
+     * @brief Construct a new Static Variable Array object
+     *
+     * @param variableList An array of exactly VARIABLE_COUNT pointers to
+     * variable objects.
+     */
+    explicit StaticVariableArray(Variable* (&variableList)[VARIABLE_COUNT])
+        : VariableArray(VARIABLE_COUNT, variableList) {
+        setValueStringBuffer(_valueStringStorage, VARIABLE_COUNT);
+    }
+    /**
+     * @brief Construct a new Static Variable Array object
+     *
+     * @param variableList An array of exactly VARIABLE_COUNT pointers to
+     * variable objects.
+     * @param uuids An array of exactly VARIABLE_COUNT UUID's.  These are
+     * linked 1-to-1 with the variables by array position.
+     */
+    StaticVariableArray(Variable* (&variableList)[VARIABLE_COUNT],
+                        const char* (&uuids)[VARIABLE_COUNT])
+        : VariableArray(VARIABLE_COUNT, variableList, uuids) {
+        setValueStringBuffer(_valueStringStorage, VARIABLE_COUNT);
+    }
+
+    /**
+     * @brief Begins the array with a new list of variables of the same
+     * length.
+     *
+     * @param variableList An array of exactly VARIABLE_COUNT pointers to
+     * variable objects.
+     */
+    bool begin(Variable* (&variableList)[VARIABLE_COUNT]) {
+        return VariableArray::begin(VARIABLE_COUNT, variableList);
+    }
+    /**
+     * @brief Begins the array with a new list of variables of the same
+     * length and their UUIDs.
+     *
+     * @param variableList An array of exactly VARIABLE_COUNT pointers to
+     * variable objects.
+     * @param uuids An array of exactly VARIABLE_COUNT UUID's.
+     */
+    bool begin(Variable* (&variableList)[VARIABLE_COUNT],
+               const char* (&uuids)[VARIABLE_COUNT]) {
+        return VariableArray::begin(VARIABLE_COUNT, variableList, uuids);
+    }
+    /**
+     * @brief Begins the array with the variables given in the constructor.
+     */
+    bool begin() {
+        return VariableArray::begin();
+    }
+
+    /**
+     * @brief Get the number of variables in the array, as a constant
+     * expression.
+     *
+     * @return **uint8_t** The number of variables in the array
+     */
+    static constexpr uint8_t getStaticVariableCount(void) {
+        return VARIABLE_COUNT;
+    }
+
+ private:
+    /**
+     * @brief The formatted value of each variable.
+     */
+    char _valueStringStorage[VARIABLE_COUNT][MS_VALUE_STRING_LENGTH];
+};
+
 #endif  // SRC_VARIABLEARRAY_H_
@@ -33,6 +33,10 @@ Variable::Variable(Sensor* parentSense, const uint8_t sensorVarNum,
     // When we create the variable, we also want to initialize it with a current
     // value of -9999 (ie, a bad result).
     _currentValue = -9999;
+    _inputVars    = NULL;
+    _inputCount   = 0;
+    _valueCached  = false;
+    _evaluating   = false;
 
     // MS_DBG(F("Measured Variable object created"));
 }
@@ -53,6 +57,10 @@ Variable::Variable(const uint8_t sensorVarNum, uint8_t decimalResolution,
     // When we create the variable, we also want to initialize it with a current
     // value of -9999 (ie, a bad result).
     _currentValue = -9999;
+    _inputVars    = NULL;
+    _inputCount   = 0;
+    _valueCached  = false;
+    _evaluating   = false;
 
     // MS_DBG(F("Measured Variable object created"));
 }
@@ -77,6 +85,10 @@ Variable::Variable(float (*calcFxn)(), uint8_t decimalResolution,
     // When we create the variable, we also want to initialize it with a current
     // value of -9999 (ie, a bad result).
     _currentValue = -9999;
+    _inputVars    = NULL;
+    _inputCount   = 0;
+    _valueCached  = false;
+    _evaluating   = false;
 
     // MS_DBG(F("Calculated Variable object created"));
 }
@@ -97,6 +109,10 @@ Variable::Variable(float (*calcFxn)(), uint8_t decimalResolution,
     // When we create the variable, we also want to initialize it with a current
     // value of -9999 (ie, a bad result).
     _currentValue = -9999;
+    _inputVars    = NULL;
+    _inputCount   = 0;
+    _valueCached  = false;
+    _evaluating   = false;
 
     // MS_DBG(F("Calculated Variable object created"));
 }
@@ -113,6 +129,10 @@ Variable::Variable() : _sensorVarNum(0), _decimalResolution(0) {
     // When we create the variable, we also want to initialize it with a current
     // value of -9999 (ie, a bad result).
     _currentValue = -9999;
+    _inputVars    = NULL;
+    _inputCount   = 0;
+    _valueCached  = false;
+    _evaluating   = false;
 
     // MS_DBG(F("Calculated Variable object created"));
 }
@@ -200,6 +220,15 @@ String Variable::getParentSensorName(void) {
         return parentSensor->getSensorName();
     }
 }
+const char* Variable::getParentSensorNameChars(void) {
+    if (isCalculated) {
+        return "Calculated";
+    } else if (parentSensor == NULL) {
+        return "";
+    } else {
+        return parentSensor->getSensorNameChars();
+    }
+}
 
 
 // This is a helper - it returns the name and location of the parent sensor, if
@@ -230,6 +259,44 @@ void Variable::setCalculation(float (*calcFxn)()) {
 }
 
 
+// This sets the list of input variables for a calculated variable
+void Variable::setDependencies(Variable* inputVars[], uint8_t inputCount) {
+    _inputVars  = inputVars;
+    _inputCount = inputCount;
+}
+
+
+// This evaluates the calculated inputs first (depth first) and then the
+// calculation itself, so every calculation runs once per cycle
+void Variable::evaluateCalculation(void) {
+    if (!isCalculated || _valueCached || _calcFxn == NULL) return;
+    if (_evaluating) {
+        MS_DBG(F("Circular dependency found at"), getVarCode(),
+               F("- using its last value"));
+        return;
+    }
+    _evaluating = true;
+    for (uint8_t i = 0; i < _inputCount; i++) {
+        if (_inputVars[i] != NULL) _inputVars[i]->evaluateCalculation();
+    }
+    _currentValue = _calcFxn();
+    _valueCached  = true;
+    _evaluating   = false;
+    MS_DBG(F("Calculated"), getVarCode(), F("as"), _currentValue);
+}
+
+
+// This clears the cache for this variable and any calculated inputs
+void Variable::clearCachedValue(void) {
+    // Only recurse from a cached value, so circular dependencies end
+    if (!_valueCached) return;
+    _valueCached = false;
+    for (uint8_t i = 0; i < _inputCount; i++) {
+        if (_inputVars[i] != NULL) _inputVars[i]->clearCachedValue();
+    }
+}
+
+
 // This sets up the variable (generally attaching it to its parent)
 // bool Variable::setup(void)
 // {
@@ -253,6 +320,9 @@ void Variable::setResolution(uint8_t decimalResolution) {
 String Variable::getVarName(void) {
     return _varName;
 }
+const char* Variable::getVarNameChars(void) {
+    return _varName == NULL ? "" : _varName;
+}
 void Variable::setVarName(const char* varName) {
     _varName = varName;
     // MS_DBG(F("Variable name is"), _varName);
@@ -262,6 +332,9 @@ void Variable::setVarName(const char* varName) {
 String Variable::getVarUnit(void) {
     return _varUnit;
 }
+const char* Variable::getVarUnitChars(void) {
+    return _varUnit == NULL ? "" : _varUnit;
+}
 void Variable::setVarUnit(const char* varUnit) {
     _varUnit = varUnit;
     // MS_DBG(F("Variable unit is"), _varUnit);
@@ -271,6 +344,9 @@ void Variable::setVarUnit(const char* varUnit) {
 String Variable::getVarCode(void) {
     return _varCode;
 }
+const char* Variable::getVarCodeChars(void) {
+    return _varCode == NULL ? "" : _varCode;
+}
 // This sets the variable code to a new custom value
 void Variable::setVarCode(const char* varCode) {
     _varCode = varCode;
@@ -281,6 +357,9 @@ void Variable::setVarCode(const char* varCode) {
 String Variable::getVarUUID(void) {
     return _uuid;
 }
+const char* Variable::getVarUUIDChars(void) {
+    return _uuid == NULL ? "" : _uuid;
+}
 // This sets the UUID
 void Variable::setVarUUID(const char* uuid) {
     _uuid = uuid;
@@ -343,6 +422,7 @@ float Variable::getValue(bool updateValue) {
         // the calculation because we don't know which sensors those are.
         // Make sure you update the parent sensors manually for a calculated
         // variable!!
+        if (_valueCached && !updateValue) return _currentValue;
         return _calcFxn();
     } else {
         if (updateValue) parentSensor->update();
@@ -362,3 +442,28 @@ String Variable::getValueString(bool updateValue) {
         return String(getValue(updateValue), _decimalResolution);
     }
 }
+
+
+// This writes the current value into a char buffer with the same formatting as
+// getValueString, but without allocating a String
+bool Variable::formatValue(char* buffer, uint8_t bufferSize,
+                           bool updateValue) {
+    // dtostrf doesn't know the size of its output, so format into a buffer as
+    // large as the one String uses before checking the length
+    char  formatted[33];
+    float value = getValue(updateValue);
+    if (_decimalResolution == 0) {
+        itoa(static_cast<int16_t>(value), formatted, 10);
+    } else {
+        dtostrf(value, _decimalResolution + 2, _decimalResolution, formatted);
+    }
+    if (strlen(formatted) >= bufferSize) {
+        MS_DBG(F("Value"), formatted, F("for"), getVarCode(),
+               F("is too long for its buffer!"));
+        strncpy(buffer, "-9999", bufferSize - 1);
+        buffer[bufferSize - 1] = '\0';
+        return false;
+    }
+    strcpy(buffer, formatted);
+    return true;
+}
@@ -235,6 +235,13 @@ class Variable {
      * @return **String** The parent sensor name
      */
     String getParentSensorName(void);
+    /**
+     * @brief Get the parent sensor name without copying it into a String.
+     *
+     * @return **const char\*** The parent sensor name; "Calculated" for a
+     * calculated variable.
+     */
+    const char* getParentSensorNameChars(void);
     /**
      * @brief Get the parent sensor name and location, if applicable.
      *
@@ -250,6 +257,33 @@ class Variable {
      * @param calcFxn Any function returning a float value.
      */
     void setCalculation(float (*calcFxn)());
+    /**
+     * @brief Declare the variables a calculated variable's function reads.
+     *
+     * When a VariableArray evaluates its calculated variables after an update,
+     * any calculated inputs are evaluated first, so that each calculation runs
+     * exactly once per cycle no matter how many times its value is read or how
+     * many other calculations use it.  Inputs measured by a sensor need not be
+     * listed, but listing them does no harm.
+     *
+     * @param inputVars An array of pointers to the input variables.  The
+     * array must stay in scope for as long as this variable is used.
+     * @param inputCount The number of variables in the array
+     */
+    void setDependencies(Variable* inputVars[], uint8_t inputCount);
+    /**
+     * @brief Run the calculation for a calculated variable, after first
+     * evaluating any calculated inputs, and cache the result until
+     * clearCachedValue() is called.
+     *
+     * Does nothing for a measured variable or if the value is already cached.
+     */
+    void evaluateCalculation(void);
+    /**
+     * @brief Forget the cached value of a calculated variable and of its
+     * calculated inputs so the next evaluation runs the calculation again.
+     */
+    void clearCachedValue(void);
 
     // This gets/sets the variable's resolution for value strings
     /**
@@ -270,6 +304,12 @@ class Variable {
      * @return **String** The variable name
      */
     String getVarName(void);
+    /**
+     * @brief Get the variable name without copying it into a String.
+     *
+     * @return **const char\*** The variable name
+     */
+    const char* getVarNameChars(void);
     /**
      * @brief Set the variable name.
      *
@@ -286,6 +326,12 @@ class Variable {
      * @return **String** The variable unit
      */
     String getVarUnit(void);
+    /**
+     * @brief Get the variable unit without copying it into a String.
+     *
+     * @return **const char\*** The variable unit
+     */
+    const char* getVarUnitChars(void);
     /**
      * @brief Set the variable unit.
      *
@@ -310,6 +356,14 @@ class Variable {
      * @param varCode A custom code for the variable.
      */
     void setVarCode(const char* varCode);
+    /**
+     * @brief Get the customized code for the variable without copying it into
+     * a String.
+     *
+     * @return **const char\*** The variable code; an empty string if none
+     * has been set.
+     */
+    const char* getVarCodeChars(void);
     // This gets/sets the variable UUID, if one has been assigned
     /**
      * @brief Get the customized code for the variable
@@ -323,6 +377,13 @@ class Variable {
      * @param uuid A universally unique identifier for the variable.
      */
     void setVarUUID(const char* uuid);
+    /**
+     * @brief Get the variable UUID without copying it into a String.
+     *
+     * @return **const char\*** The variable UUID; an empty string if none
+     * has been assigned.
+     */
+    const char* getVarUUIDChars(void);
     /**
      * @brief Verify the the UUID is correctly formatted
      *
@@ -336,8 +397,13 @@ class Variable {
     /**
      * @brief Get current value of the variable as a float
      *
+     * For a calculated variable this returns the value cached by
+     * evaluateCalculation() if there is one; otherwise the calculation
+     * function is run.
+     *
      * @param updateValue True to ask the parent sensor to measure and return a
-     * new value.  Default is false.
+     * new value, or to re-run the calculation of a calculated variable even if
+     * a value is cached.  Default is false.
      * @return **float** The current value of the variable
      */
     float getValue(bool updateValue = false);
@@ -350,6 +416,22 @@ class Variable {
      * @return **String** The current value of the variable
      */
     String getValueString(bool updateValue = false);
+    /**
+     * @brief Write the current value of the variable into a char buffer
+     * with the correct decimal resolution, without using a String.
+     *
+     * The text is the same as that of getValueString().  If it does not fit
+     * in the buffer, -9999 is written instead.
+     *
+     * @param buffer The buffer to write to
+     * @param bufferSize The size of the buffer, including room for the
+     * terminating null
+     * @param updateValue True to ask the parent sensor to measure and return a
+     * new value.  Default is false.
+     * @return **bool** True if the value fit in the buffer.
+     */
+    bool formatValue(char* buffer, uint8_t bufferSize,
+                     bool updateValue = false);
 
     /**
      * @brief Pointer to the parent sensor
@@ -372,6 +454,25 @@ class Variable {
     const uint8_t _sensorVarNum;
     uint8_t       _decimalResolution;
 
+    /**
+     * @brief The input variables of a calculated variable, if declared.
+     */
+    Variable** _inputVars;
+    /**
+     * @brief The number of declared input variables
+     */
+    uint8_t _inputCount;
+    /**
+     * @brief Whether #_currentValue holds the result of the calculation for
+     * the current cycle
+     */
+    bool _valueCached;
+    /**
+     * @brief Whether the calculation is being evaluated, to stop a circular
+     * dependency from recursing forever
+     */
+    bool _evaluating;
+
     const char* _varName;
     const char* _varUnit;
     const char* _varCode;
@@ -10,7 +10,14 @@
  */
 #include "dataPublisherBase.h"
 
-char dataPublisher::txBuffer[MS_SEND_BUFFER_SIZE] = {'\0'};
+char     dataPublisher::txBuffer[MS_SEND_BUFFER_SIZE] = {'\0'};
+size_t   dataPublisher::txBufferLength                = 0;
+uint32_t dataPublisher::txByteCount                   = 0;
+
+dataPublisher::keptConnection
+        dataPublisher::keptConnections[MS_MAX_KEPT_CONNECTIONS];
+uint8_t dataPublisher::keptConnectionCount = 0;
+bool    dataPublisher::keepingConnections  = false;
 
 // Basic chunks of HTTP
 const char* dataPublisher::getHeader  = "GET ";
@@ -62,13 +69,25 @@ void dataPublisher::attachToLogger(Logger& baseLogger) {
 
 
 // Sets the parameters for frequency of sending and any offset, if needed
-// NOTE:  These parameters are not currently used!!
 void dataPublisher::setSendFrequency(uint8_t sendEveryX, uint8_t sendOffset) {
     _sendEveryX = sendEveryX;
     _sendOffset = sendOffset;
 }
 
 
+// Checks if this is one of the intervals to send on
+bool dataPublisher::isSendDue(uint32_t intervalNumber) {
+    if (!sendsInBatches()) return true;
+    return intervalNumber % _sendEveryX == _sendOffset % _sendEveryX;
+}
+
+
+// Checks if records are held back to send together
+bool dataPublisher::sendsInBatches(void) {
+    return _sendEveryX > 1;
+}
+
+
 // "Begins" the publisher - attaches client and logger
 void dataPublisher::begin(Logger& baseLogger, Client* inClient) {
     setClient(inClient);
@@ -80,16 +99,18 @@ void dataPublisher::begin(Logger& baseLogger) {
 
 
 // Empties the outgoing buffer
+// Only the write position needs to go back; everything past it is unused
 void dataPublisher::emptyTxBuffer(void) {
     MS_DBG(F("Dumping the TX Buffer"));
-    for (int i = 0; i < MS_SEND_BUFFER_SIZE; i++) { txBuffer[i] = '\0'; }
+    txBufferLength = 0;
+    txBuffer[0]    = '\0';
 }
 
 
 // Returns how much space is left in the buffer
 int dataPublisher::bufferFree(void) {
-    MS_DBG(F("Current TX Buffer Size:"), strlen(txBuffer));
-    return MS_SEND_BUFFER_SIZE - strlen(txBuffer);
+    MS_DBG(F("Current TX Buffer Size:"), txBufferLength);
+    return MS_SEND_BUFFER_SIZE - txBufferLength;
 }
 
 
@@ -97,12 +118,12 @@ int dataPublisher::bufferFree(void) {
 void dataPublisher::printTxBuffer(Stream* stream, bool addNewLine) {
 // Send the out buffer so far to the serial for debugging
 #if defined(STANDARD_SERIAL_OUTPUT)
-    STANDARD_SERIAL_OUTPUT.write(txBuffer, strlen(txBuffer));
+    STANDARD_SERIAL_OUTPUT.write(txBuffer, txBufferLength);
     if (addNewLine) { PRINTOUT('\n'); }
     STANDARD_SERIAL_OUTPUT.flush();
 #endif
-    stream->write(txBuffer, strlen(txBuffer));
-    if (addNewLine) { stream->print("\r\n"); }
+    txByteCount += stream->write(txBuffer, txBufferLength);
+    if (addNewLine) { txByteCount += stream->print("\r\n"); }
     stream->flush();
 
     // empty the buffer after printing it
@@ -110,6 +131,179 @@ void dataPublisher::printTxBuffer(Stream* stream, bool addNewLine) {
 }
 
 
+// Adds text at the write position, sending the buffer out each time it fills
+void dataPublisher::writeTxBuffer(Stream* stream, const char* text,
+                                  size_t length) {
+    while (length > 0) {
+        // The last spot is kept for the terminating null
+        size_t room = MS_SEND_BUFFER_SIZE - 1 - txBufferLength;
+        if (room == 0) {
+            // Without a stream to send to, whatever does not fit is lost
+            if (stream == NULL) break;
+            printTxBuffer(stream);
+            continue;
+        }
+        size_t n = length < room ? length : room;
+        memcpy(txBuffer + txBufferLength, text, n);
+        txBufferLength += n;
+        text += n;
+        length -= n;
+    }
+    txBuffer[txBufferLength] = '\0';
+}
+void dataPublisher::writeTxBuffer(Stream* stream, const char* text) {
+    writeTxBuffer(stream, text, strlen(text));
+}
+void dataPublisher::writeTxBuffer(Stream* stream, char c) {
+    writeTxBuffer(stream, &c, 1);
+}
+
+
+// Reads through the status line, the headers, and the body of a response
+int16_t dataPublisher::readHTTPResponse(Client* outClient) {
+    // Wait 10 seconds for a response from the server
+    uint32_t start = millis();
+    // A server closing the connection won't be sending anything
+    while ((millis() - start) < 10000L && outClient->available() < 12 &&
+           outClient->connected()) {
+        delay(10);
+    }
+
+    // Only the start of each line matters; the rest is read and dropped
+    char    line[37];
+    int16_t responseCode  = 504;
+    int32_t contentLength = -1;
+    bool    keepAlive     = true;
+    bool    headersEnded  = false;
+    for (bool statusLine = true; !headersEnded; statusLine = false) {
+        size_t len = outClient->readBytesUntil('\n', line, sizeof(line) - 1);
+        if (len == 0) break;  // timed out
+        line[len] = '\0';
+        if (statusLine) {
+            // Like "HTTP/1.1 201 Created"
+            if (len >= 12) responseCode = atoi(line + 9);
+        } else if (len == 1) {
+            headersEnded = true;  // the blank line, with only its '\r'
+        } else if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            contentLength = atol(line + 15);
+        } else if (strncasecmp(line, "Connection: close", 17) == 0 ||
+                   strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            // Chunked bodies aren't followed, so the connection can't be
+            // reused after one
+            keepAlive = false;
+        }
+        while (len == sizeof(line) - 1) {
+            len = outClient->readBytesUntil('\n', line, sizeof(line) - 1);
+        }
+    }
+
+    // Skip the body, so the next response starts at its status line
+    while (headersEnded && contentLength > 0) {
+        size_t len = outClient->readBytes(
+            line, contentLength < static_cast<int32_t>(sizeof(line))
+                ? contentLength
+                : sizeof(line));
+        if (len == 0) break;
+        contentLength -= len;
+    }
+    if (!headersEnded || contentLength != 0 || !keepAlive) {
+        MS_DBG(F("Closing the connection after the response"));
+        outClient->stop();
+    }
+    return responseCode;
+}
+
+
+// Turns on or off leaving connections open between requests
+void dataPublisher::keepConnectionsOpen(bool keepOpen) {
+    keepingConnections = keepOpen;
+}
+
+
+// Closes every connection that was left open
+void dataPublisher::closeConnections(void) {
+    while (keptConnectionCount > 0) {
+        closeConnection(keptConnections[0].client);
+    }
+    keepingConnections = false;
+}
+
+
+// Finds a connection to the host that was left open, or makes a new one
+Client* dataPublisher::openConnection(Client* outClient, const char* host,
+                                      uint16_t port) {
+    for (uint8_t i = 0; i < keptConnectionCount; i++) {
+        keptConnection kept = keptConnections[i];
+        if (kept.port != port || strcmp(kept.host, host) != 0) continue;
+        forgetConnection(i);
+        // The server may have closed it since the last request
+        if (!kept.client->connected()) break;
+        MS_DBG(F("Reusing the open connection to"), host);
+        // Move it to the end, as the one used most recently
+        keptConnections[keptConnectionCount++] = kept;
+        return kept.client;
+    }
+
+    prepareConnection(outClient);
+    MS_DBG(F("Connecting client to"), host);
+    MS_START_DEBUG_TIMER;
+    if (!outClient->connect(host, port)) return NULL;
+    MS_DBG(F("Client connected after"), MS_PRINT_DEBUG_TIMER, F("ms"));
+
+    if (keepingConnections) {
+        keptConnections[keptConnectionCount].client = outClient;
+        keptConnections[keptConnectionCount].host   = host;
+        keptConnections[keptConnectionCount].port   = port;
+        keptConnectionCount++;
+    }
+    return outClient;
+}
+
+
+// Leaves a connection open for the next request, or closes it
+void dataPublisher::releaseConnection(Client* outClient) {
+    if (keepingConnections && outClient->connected()) return;
+    closeConnection(outClient);
+}
+
+
+// Closes whatever is in the way of a new connection on a client
+void dataPublisher::prepareConnection(Client* outClient) {
+    // A client can only hold one connection, and the modem may only have
+    // sockets for so many
+    closeConnection(outClient);
+    if (keptConnectionCount >= MS_MAX_KEPT_CONNECTIONS) {
+        closeConnection(keptConnections[0].client);
+    }
+}
+
+
+// Closes a client's connection and takes it out of those kept open
+void dataPublisher::closeConnection(Client* outClient) {
+    for (uint8_t i = 0; i < keptConnectionCount; i++) {
+        if (keptConnections[i].client != outClient) continue;
+        MS_DBG(F("Closing the connection to"), keptConnections[i].host);
+        forgetConnection(i);
+        break;
+    }
+    if (outClient->connected()) {
+        MS_DBG(F("Stopping client"));
+        MS_START_DEBUG_TIMER;
+        outClient->stop();
+        MS_DBG(F("Client stopped after"), MS_PRINT_DEBUG_TIMER, F("ms"));
+    }
+}
+
+
+// Private helper function - This removes a connection from those kept open
+void dataPublisher::forgetConnection(uint8_t i) {
+    keptConnectionCount--;
+    for (; i < keptConnectionCount; i++) {
+        keptConnections[i] = keptConnections[i + 1];
+    }
+}
+
+
 // This sends data on the "default" client of the modem
 int16_t dataPublisher::publishData() {
     if (_inClient == NULL) {
@@ -119,6 +313,24 @@ int16_t dataPublisher::publishData() {
         return publishData(_inClient);
     }
 }
+// Publishers that can't combine records send only the first of a batch
+uint16_t dataPublisher::publishBatch(Client* outClient, uint16_t count) {
+    if (count == 0) return 0;
+    // A damaged record is passed over rather than sent
+    if (!_baseLogger->loadQueuedRecord(0)) return 1;
+    return publishSucceeded(publishData(outClient)) ? 1 : 0;
+}
+// This sends a batch on the "default" client of the modem
+uint16_t dataPublisher::publishBatch(uint16_t count) {
+    if (_inClient == NULL) {
+        PRINTOUT(F("ERROR! No web client assigned to publish data!"));
+        return 0;
+    } else {
+        return publishBatch(_inClient, count);
+    }
+}
+
+
 // Duplicates for backwards compatibility
 int16_t dataPublisher::sendData(Client* outClient) {
     return publishData(outClient);
@@ -128,6 +340,18 @@ int16_t dataPublisher::sendData() {
 }
 
 
+// Any 2xx http response means the data was accepted
+bool dataPublisher::publishSucceeded(int16_t result) {
+    return result >= 200 && result < 300;
+}
+
+
+// Returns the number of bytes sent by all publishers
+uint32_t dataPublisher::getTxByteCount(void) {
+    return txByteCount;
+}
+
+
 // This spits out a string description of the PubSubClient codes
 String dataPublisher::parseMQTTState(int state) {
     // // Possible values for client.state()
@@ -39,6 +39,42 @@
 #define MS_SEND_BUFFER_SIZE 750
 #endif
 
+/**
+ * @def MS_MAX_KEPT_CONNECTIONS
+ * @brief The number of connections that can be left open between requests
+ * while the logger is publishing.
+ *
+ * Some modems, like the XBee's in transparent mode, can only have one socket
+ * open at a time, so by default only one connection is kept.  With more,
+ * publishers sending to different hosts in turn can each keep their own.
+ * Increase this only if the modem supports that many sockets at once.
+ *
+ * This can be changed by setting the build flag MS_MAX_KEPT_CONNECTIONS when
+ * compiling.
+ */
+#ifndef MS_MAX_KEPT_CONNECTIONS
+#define MS_MAX_KEPT_CONNECTIONS 1
+#endif
+
+/**
+ * @def MS_HTTP_PIPELINE_DEPTH
+ * @brief The most requests that can be sent on a connection before waiting
+ * for the answers.
+ *
+ * Requests are only pipelined once the server has kept a connection open
+ * after answering, and only by publishers whose requests can safely be sent
+ * twice.  Every answer waiting to be read has to fit in the modem's receive
+ * buffer.  If the server refuses one request but accepts those pipelined
+ * behind it, the refused record is sent again after them, so records may
+ * arrive out of order.  Set this to 1 to turn pipelining off.
+ *
+ * This can be changed by setting the build flag MS_HTTP_PIPELINE_DEPTH when
+ * compiling.
+ */
+#ifndef MS_HTTP_PIPELINE_DEPTH
+#define MS_HTTP_PIPELINE_DEPTH 4
+#endif
+
 // Included Dependencies
 #include "ModSensorDebugger.h"
 #undef MS_DEBUGGING_STD
@@ -76,11 +112,11 @@ class dataPublisher {
      * logger.
      *
      * @param baseLogger The logger supplying the data to be published
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -97,11 +133,11 @@ class dataPublisher {
      * @param inClient An Arduino client instance to use to print data to.
      * Allows the use of any type of client and multiple clients tied to a
      * single TinyGSM modem instance
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -138,15 +174,33 @@ class dataPublisher {
      * @brief Set the parameters for frequency of sending and any offset, if
      * needed.
      *
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; 1 to send
+     * every record as it is taken
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on
      *
-     * @note These parameters are not currently used!
+     * @note Intervals are counted from the epoch, so with a 5 minute logging
+     * interval, a sendEveryX of 12 and a sendOffset of 0 send at the top of
+     * each hour.  The records waiting for a publisher's turn are kept in the
+     * logger's publish queue (see Logger::setPublishQueue()) on the SD card.
      */
     void setSendFrequency(uint8_t sendEveryX, uint8_t sendOffset);
+    /**
+     * @brief Check whether this publisher sends on a logging interval.
+     *
+     * @param intervalNumber The number of the logging interval, counted from
+     * the epoch
+     * @return **bool** True if data should be sent on this interval
+     */
+    bool isSendDue(uint32_t intervalNumber);
+    /**
+     * @brief Check whether this publisher holds records to send several at a
+     * time.
+     *
+     * @return **bool** True if sendEveryX is more than one
+     */
+    bool sendsInBatches(void);
 
     /**
      * @brief Begin the publisher - linking it to the client and logger.
@@ -193,9 +247,9 @@ class dataPublisher {
      * @brief Get the destination for published data - generally the host name
      * of the data receiver.
      *
-     * @return **String** The URL or HOST to receive published data
+     * @return **const char\*** The URL or HOST to receive published data
      */
-    virtual String getEndpoint(void) = 0;
+    virtual const char* getEndpoint(void) = 0;
 
 
     /**
@@ -225,6 +279,34 @@ class dataPublisher {
      */
     virtual int16_t publishData();
 
+    /**
+     * @brief Open a socket to the correct receiver and send out a batch of
+     * queued records, in as few requests as the receiver allows.
+     *
+     * Each record is loaded in turn with Logger::loadQueuedRecord().  The
+     * default implementation can't combine records, so it sends only the
+     * first one with publishData(); publishers that can combine them
+     * override this.
+     *
+     * @param outClient An Arduino client instance to use to print data to.
+     * Allows the use of any type of client and multiple clients tied to a
+     * single TinyGSM modem instance
+     * @param count The number of records in the batch
+     * @return **uint16_t** The number of records, from the start of the
+     * batch, that were accepted or skipped as damaged; 0 if nothing could be
+     * sent
+     */
+    virtual uint16_t publishBatch(Client* outClient, uint16_t count);
+    /**
+     * @brief Send out a batch of queued records on the client linked to the
+     * publisher.
+     *
+     * @param count The number of records in the batch
+     * @return **uint16_t** The number of records, from the start of the
+     * batch, that were accepted or skipped as damaged
+     */
+    virtual uint16_t publishBatch(uint16_t count);
+
     /**
      * @brief Retained for backwards compatibility.
      *
@@ -247,6 +329,45 @@ class dataPublisher {
      */
     virtual int16_t sendData();
 
+    /**
+     * @brief Check whether the result of publishData() means the receiver
+     * accepted the data.
+     *
+     * This is used by the logger's publish queue to decide whether a record
+     * must be kept to send again.
+     *
+     * @param result The value returned by publishData()
+     * @return **bool** True for any 2xx http response code
+     */
+    virtual bool publishSucceeded(int16_t result);
+
+    /**
+     * @brief Get the number of bytes written to the network through the TX
+     * buffer by all publishers since the logger started.
+     *
+     * @return **uint32_t** The number of bytes sent
+     */
+    static uint32_t getTxByteCount(void);
+
+    /**
+     * @brief Set whether connections should be left open after each request,
+     * so the next request to the same host and port can use them.
+     *
+     * The logger turns this on while it is publishing and closes all of the
+     * connections with closeConnections() when it is done.  When it is off,
+     * each connection is closed as soon as its response has been read.
+     *
+     * @param keepOpen True to leave connections open between requests
+     */
+    static void keepConnectionsOpen(bool keepOpen);
+    /**
+     * @brief Close every connection that was left open and stop keeping them
+     * open.
+     *
+     * This must be called before the modem disconnects from the internet.
+     */
+    static void closeConnections(void);
+
     /**
      * @brief Translate a PubSubClient code into a String with the code
      * explanation.
@@ -271,6 +392,18 @@ class dataPublisher {
      * @brief A buffer for outgoing data.
      */
     static char txBuffer[MS_SEND_BUFFER_SIZE];
+    /**
+     * @brief The number of characters in the TX buffer; the position the next
+     * call to writeTxBuffer() will write at.
+     *
+     * Anything put in the buffer other than through writeTxBuffer() will not
+     * be counted and will not be sent.
+     */
+    static size_t txBufferLength;
+    /**
+     * @brief The running count of bytes sent out of the TX buffer.
+     */
+    static uint32_t txByteCount;
     /**
      * @brief Get the number of empty spots in the buffer.
      *
@@ -278,7 +411,8 @@ class dataPublisher {
      */
     static int bufferFree(void);
     /**
-     * @brief Fill the TX buffer with nulls ('\0').
+     * @brief Empty the TX buffer, moving the write position back to the
+     * start.
      */
     static void emptyTxBuffer(void);
     /**
@@ -291,15 +425,99 @@ class dataPublisher {
      * the print
      */
     static void printTxBuffer(Stream* stream, bool addNewLine = false);
+    /**
+     * @brief Add characters to the end of the TX buffer, sending the buffer
+     * out to a stream whenever it fills.
+     *
+     * The position to write at is tracked, so nothing already in the buffer
+     * is searched or copied again, and text can be split across sends
+     * without any space being reserved ahead of time.
+     *
+     * @param stream A pointer to an Arduino Stream instance to send full
+     * buffers to.  If this is NULL, the buffer is never sent and any text
+     * that does not fit is cut off.
+     * @param text The characters to add
+     * @param length The number of characters to add
+     */
+    static void writeTxBuffer(Stream* stream, const char* text, size_t length);
+    /**
+     * @brief Add a null-terminated string to the end of the TX buffer.
+     *
+     * @param stream A pointer to an Arduino Stream instance to send full
+     * buffers to
+     * @param text The string to add
+     */
+    static void writeTxBuffer(Stream* stream, const char* text);
+    /**
+     * @brief Add a single character to the end of the TX buffer.
+     *
+     * @param stream A pointer to an Arduino Stream instance to send full
+     * buffers to
+     * @param c The character to add
+     */
+    static void writeTxBuffer(Stream* stream, char c);
+    /**
+     * @brief Wait for and read the whole of an HTTP response, so that
+     * another request can follow on the same connection.
+     *
+     * If the server will close the connection, or the end of the response
+     * can't be found, the client is stopped.
+     *
+     * @param outClient The client the request was sent on
+     * @return **int16_t** The http response code, or 504 if there was no
+     * response
+     */
+    static int16_t readHTTPResponse(Client* outClient);
 
     /**
-     * @brief Unimplemented; intended for future use to enable caching and bulk
-     * publishing.
+     * @brief Get a client connected to a host, reusing a connection that was
+     * left open to it if there is one.
+     *
+     * The client returned may not be the one given, if another publisher's
+     * client is already connected to the same host and port.  If a new
+     * connection is needed and no more can be kept, the one used longest ago
+     * is closed first.
+     *
+     * @param outClient The client to connect if there is no open connection
+     * @param host The host name to connect to
+     * @param port The port to connect to
+     * @return **Client\*** The connected client to send the request on, or
+     * NULL if the connection could not be made
+     */
+    static Client* openConnection(Client* outClient, const char* host,
+                                  uint16_t port);
+    /**
+     * @brief Finish with a connection after reading a response, either
+     * leaving it open for the next request or closing it.
+     *
+     * @param outClient The client returned by openConnection()
+     */
+    static void releaseConnection(Client* outClient);
+    /**
+     * @brief Make way for a new connection on a client.
+     *
+     * This closes the client's own connection, if it has one, and the kept
+     * connection used longest ago if no more can be kept.  Anything that
+     * connects a client other than through openConnection() must call this
+     * first.
+     *
+     * @param outClient The client about to be connected
+     */
+    static void prepareConnection(Client* outClient);
+    /**
+     * @brief Close a client's connection and forget it, whether or not it
+     * was being kept open.
+     *
+     * @param outClient The client to close
+     */
+    static void closeConnection(Client* outClient);
+
+    /**
+     * @brief The number of logging intervals between sends.
      */
     uint8_t _sendEveryX;
     /**
-     * @brief Unimplemented; intended for future use to enable publishing data
-     * at a time slightly delayed from when it is collected.
+     * @brief Which logging interval, out of each #_sendEveryX, to send on.
      */
     uint8_t _sendOffset;
 
@@ -320,6 +538,38 @@ class dataPublisher {
      * @brief the text "\r\nHost: "
      */
     static const char* hostHeader;
+
+ private:
+    /**
+     * @brief A connection left open between requests
+     */
+    typedef struct keptConnection {
+        /// The client holding the connection
+        Client* client;
+        /// The host the client is connected to
+        const char* host;
+        /// The port the client is connected to
+        uint16_t port;
+    } keptConnection;
+    /**
+     * @brief The connections left open, with the one used longest ago first
+     */
+    static keptConnection keptConnections[MS_MAX_KEPT_CONNECTIONS];
+    /**
+     * @brief The number of connections in #keptConnections
+     */
+    static uint8_t keptConnectionCount;
+    /**
+     * @brief True if connections are left open between requests
+     */
+    static bool keepingConnections;
+    /**
+     * @brief Forget the kept connection at a place in #keptConnections,
+     * without closing it
+     *
+     * @param i The place of the connection
+     */
+    static void forgetConnection(uint8_t i);
 };
 
 #endif  // SRC_DATAPUBLISHERBASE_H_
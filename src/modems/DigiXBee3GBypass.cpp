@@ -39,6 +39,8 @@ MS_MODEM_DISCONNECT_INTERNET(DigiXBee3GBypass);
 MS_MODEM_IS_INTERNET_AVAILABLE(DigiXBee3GBypass);
 
 MS_MODEM_GET_NIST_TIME(DigiXBee3GBypass);
+MS_MODEM_GET_NETWORK_TIME(DigiXBee3GBypass);
+MS_MODEM_SYNC_CLOCK_SNTP(DigiXBee3GBypass);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(DigiXBee3GBypass);
 MS_MODEM_GET_MODEM_BATTERY_DATA(DigiXBee3GBypass);
@@ -51,7 +53,7 @@ bool DigiXBee3GBypass::extraModemSetup(void) {
     MS_DBG(F("Putting XBee into command mode..."));
     for (uint8_t i = 0; i < 5; i++) {
         /** First, wait the required guard time before entering command mode. */
-        delay(1010);
+        idleUntil(millis() + 1010);
         /** Now, enter command mode to set all pin I/O functionality. */
         gsmModem.streamWrite(GF("+++"));
         success = gsmModem.waitResponse(2000, GF("OK\r")) == 1;
@@ -125,7 +127,7 @@ bool DigiXBee3GBypass::extraModemSetup(void) {
         gsmModem.sendAT(GF("FR"));
         success &= gsmModem.waitResponse(5000L, GF("OK\r")) == 1;
         /** Allow 5s for the unit to reset. */
-        delay(5000L);
+        idleUntil(millis() + 5000L);
         /** Re-initialize the TinyGSM u-blox instance. */
         MS_DBG(F("Attempting to reconnect to the u-blox SARA U201 module..."));
         success &= gsmModem.testAT(15000L);
@@ -151,7 +153,7 @@ bool DigiXBee3GBypass::modemHardReset(void) {
     MS_DBG(F("Returning XBee to command mode..."));
     for (uint8_t i = 0; i < 5; i++) {
         // Wait the required guard time before entering command mode
-        delay(1010);
+        idleUntil(millis() + 1010);
         gsmModem.streamWrite(GF("+++"));  // enter command mode
         success = gsmModem.waitResponse(2000, GF("OK\r")) == 1;
         if (success) break;
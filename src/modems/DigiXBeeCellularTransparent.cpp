@@ -37,6 +37,9 @@ MS_MODEM_CONNECT_INTERNET(DigiXBeeCellularTransparent);
 MS_MODEM_DISCONNECT_INTERNET(DigiXBeeCellularTransparent);
 MS_MODEM_IS_INTERNET_AVAILABLE(DigiXBeeCellularTransparent);
 
+MS_MODEM_GET_NETWORK_TIME(DigiXBeeCellularTransparent);
+MS_MODEM_SYNC_CLOCK_SNTP(DigiXBeeCellularTransparent);
+
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(DigiXBeeCellularTransparent);
 MS_MODEM_GET_MODEM_BATTERY_DATA(DigiXBeeCellularTransparent);
 MS_MODEM_GET_MODEM_TEMPERATURE_DATA(DigiXBeeCellularTransparent);
@@ -243,6 +246,7 @@ uint32_t DigiXBeeCellularTransparent::getNISTTime(void) {
         MS_DBG(F("No internet connection, cannot connect to NIST."));
         return 0;
     }
+    modemPhase outerPhase = beginPhase(MODEM_PHASE_TIME_SYNC);
 
     /* Try up to 12 times to get a timestamp from NIST */
     for (uint8_t i = 0; i < 12; i++) {
@@ -250,7 +254,7 @@ uint32_t DigiXBeeCellularTransparent::getNISTTime(void) {
         // seconds.  NIST clearly specifies here that this is a requirement for
         // all software that accesses its servers:
         // https://tf.nist.gov/tf-cgi/servers.cgi
-        while (millis() < _lastNISTrequest + 4000) {}
+        if (_lastNISTrequest != 0) { idleUntil(_lastNISTrequest + 4000); }
 
         /* Make TCP connection */
         MS_DBG(F("\nConnecting to NIST daytime Server"));
@@ -261,21 +265,25 @@ uint32_t DigiXBeeCellularTransparent::getNISTTime(void) {
         IPAddress ip(132, 163, 97, 6);
         connectionMade = gsmClient.connect(ip, 37, 15);
         /* Wait again so NIST doesn't refuse us! */
-        delay(4000L);
+        idleUntil(millis() + 4000L);
         /* Try sending something to ensure connection */
         gsmClient.println('!');
+        _lastNISTrequest = millis();
 
         /* Wait up to 5 seconds for a response */
         if (connectionMade) {
             uint32_t start = millis();
             while (gsmClient && gsmClient.available() < 4 &&
-                   millis() - start < 5000L) {}
+                   millis() - start < 5000L) {
+                idleUntil(millis() + 1);
+            }
 
             if (gsmClient.available() >= 4) {
                 MS_DBG(F("NIST responded after"), millis() - start, F("ms"));
                 byte response[4] = {0};
                 gsmClient.read(response, 4);
                 gsmClient.stop();
+                endPhase(outerPhase);
                 return parseNISTBytes(response);
             } else {
                 MS_DBG(F("NIST Time server did not respond!"));
@@ -285,6 +293,7 @@ uint32_t DigiXBeeCellularTransparent::getNISTTime(void) {
             MS_DBG(F("Unable to open TCP to NIST!"));
         }
     }
+    endPhase(outerPhase);
     return 0;
 }
 
@@ -318,7 +327,7 @@ bool DigiXBeeCellularTransparent::updateModemMetadata(void) {
         signalQual = gsmModem.getSignalQuality();
         MS_DBG(F("Raw signal quality:"), signalQual);
         if (signalQual != 0 && signalQual != -9999) break;
-        delay(250);
+        idleUntil(millis() + 250);
     } while ((signalQual == 0 || signalQual == -9999) &&
              millis() - startMillis < 15000L && success);
 
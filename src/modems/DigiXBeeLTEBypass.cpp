@@ -39,6 +39,8 @@ MS_MODEM_DISCONNECT_INTERNET(DigiXBeeLTEBypass);
 MS_MODEM_IS_INTERNET_AVAILABLE(DigiXBeeLTEBypass);
 
 MS_MODEM_GET_NIST_TIME(DigiXBeeLTEBypass);
+MS_MODEM_GET_NETWORK_TIME(DigiXBeeLTEBypass);
+MS_MODEM_SYNC_CLOCK_SNTP(DigiXBeeLTEBypass);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(DigiXBeeLTEBypass);
 MS_MODEM_GET_MODEM_BATTERY_DATA(DigiXBeeLTEBypass);
@@ -49,7 +51,7 @@ bool DigiXBeeLTEBypass::extraModemSetup(void) {
     MS_DBG(F("Putting XBee into command mode..."));
     for (uint8_t i = 0; i < 5; i++) {
         /** First, wait the required guard time before entering command mode. */
-        delay(1010);
+        idleUntil(millis() + 1010);
         /** Now, enter command mode to set all pin I/O functionality. */
         gsmModem.streamWrite(GF("+++"));
         success = gsmModem.waitResponse(2000, GF("OK\r")) == 1;
@@ -135,7 +137,7 @@ bool DigiXBeeLTEBypass::extraModemSetup(void) {
         gsmModem.sendAT(GF("FR"));
         success &= gsmModem.waitResponse(5000L, GF("OK\r")) == 1;
         /** Allow 5s for the unit to reset. */
-        delay(500);
+        idleUntil(millis() + 500);
         /** Re-initialize the TinyGSM SARA R4 instance. */
         MS_DBG(F("Attempting to reconnect to the u-blox SARA R410M module..."));
         success &= gsmModem.init();
@@ -160,7 +162,7 @@ bool DigiXBeeLTEBypass::modemHardReset(void) {
     MS_DBG(F("Returning XBee to command mode..."));
     for (uint8_t i = 0; i < 5; i++) {
         // Wait the required guard time before entering command mode
-        delay(1010);
+        idleUntil(millis() + 1010);
         gsmModem.streamWrite(GF("+++"));  // enter command mode
         success = gsmModem.waitResponse(2000, GF("OK\r")) == 1;
         if (success) break;
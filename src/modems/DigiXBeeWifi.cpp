@@ -38,6 +38,9 @@ MS_MODEM_WAKE(DigiXBeeWifi);
 MS_MODEM_CONNECT_INTERNET(DigiXBeeWifi);
 MS_MODEM_IS_INTERNET_AVAILABLE(DigiXBeeWifi);
 
+MS_MODEM_GET_NETWORK_TIME(DigiXBeeWifi);
+MS_MODEM_SYNC_CLOCK_SNTP(DigiXBeeWifi);
+
 MS_MODEM_GET_MODEM_BATTERY_DATA(DigiXBeeWifi);
 MS_MODEM_GET_MODEM_TEMPERATURE_DATA(DigiXBeeWifi);
 
@@ -142,6 +145,7 @@ uint32_t DigiXBeeWifi::getNISTTime(void) {
     }
 
     gsmClient.stop();
+    modemPhase outerPhase = beginPhase(MODEM_PHASE_TIME_SYNC);
 
     // Try up to 12 times to get a timestamp from NIST
     for (uint8_t i = 0; i < 12; i++) {
@@ -149,7 +153,7 @@ uint32_t DigiXBeeWifi::getNISTTime(void) {
         // seconds.  NIST clearly specifies here that this is a requirement for
         // all software that accesses its servers:
         // https://tf.nist.gov/tf-cgi/servers.cgi
-        while (millis() < _lastNISTrequest + 4000) {}
+        if (_lastNISTrequest != 0) { idleUntil(_lastNISTrequest + 4000); }
 
         // Make TCP connection
         MS_DBG(F("\nConnecting to NIST daytime Server"));
@@ -163,6 +167,7 @@ uint32_t DigiXBeeWifi::getNISTTime(void) {
         connectionMade = gsmClient.connect(ip, 37);
         // Need to send something before connection is made
         gsmClient.println('!');
+        _lastNISTrequest = millis();
         // Need this delay!  Can get away with 50, but 100 is safer.
         // delay(100);
 
@@ -170,13 +175,16 @@ uint32_t DigiXBeeWifi::getNISTTime(void) {
         if (connectionMade) {
             uint32_t start = millis();
             while (gsmClient && gsmClient.available() < 4 &&
-                   millis() - start < 5000L) {}
+                   millis() - start < 5000L) {
+                idleUntil(millis() + 1);
+            }
 
             if (gsmClient.available() >= 4) {
                 MS_DBG(F("NIST responded after"), millis() - start, F("ms"));
                 byte response[4] = {0};
                 gsmClient.read(response, 4);
                 gsmClient.stop();
+                endPhase(outerPhase);
                 return parseNISTBytes(response);
             } else {
                 MS_DBG(F("NIST Time server did not respond!"));
@@ -186,6 +194,7 @@ uint32_t DigiXBeeWifi::getNISTTime(void) {
             MS_DBG(F("Unable to open TCP to NIST!"));
         }
     }
+    endPhase(outerPhase);
     return 0;
 }
 
@@ -207,12 +216,15 @@ bool DigiXBeeWifi::getModemSignalQuality(int16_t& rssi, int16_t& percent) {
     IPAddress ip(132, 163, 97, 6);
     gsmClient.connect(ip, 37);
     // Wait so NIST doesn't refuse us!
-    while (millis() < _lastNISTrequest + 4000) {}
+    if (_lastNISTrequest != 0) { idleUntil(_lastNISTrequest + 4000); }
     // Need to send something before connection is made
     gsmClient.println('!');
-    uint32_t start = millis();
-    delay(100);  // Need this delay!  Can get away with 50, but 100 is safer.
+    _lastNISTrequest = millis();
+    uint32_t start   = millis();
+    // Need this delay!  Can get away with 50, but 100 is safer.
+    idleUntil(start + 100);
     while (gsmClient && gsmClient.available() < 4 && millis() - start < 5000L) {
+        idleUntil(millis() + 1);
     }
 
     // Get signal quality
@@ -88,6 +88,8 @@ class DigiXBeeWifi : public DigiXBee {
     void disconnectInternet(void) override;
 
     uint32_t getNISTTime(void) override;
+    uint32_t getModemNetworkTime(void) override;
+    bool     syncModemClockSNTP(void) override;
 
     bool  getModemSignalQuality(int16_t& rssi, int16_t& percent) override;
     bool  getModemBatteryStats(uint8_t& chargeState, int8_t& percent,
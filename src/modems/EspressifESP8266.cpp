@@ -49,6 +49,8 @@ MS_MODEM_DISCONNECT_INTERNET(EspressifESP8266);
 MS_MODEM_IS_INTERNET_AVAILABLE(EspressifESP8266);
 
 MS_MODEM_GET_NIST_TIME(EspressifESP8266);
+MS_MODEM_GET_NETWORK_TIME(EspressifESP8266);
+MS_MODEM_SYNC_CLOCK_SNTP(EspressifESP8266);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(EspressifESP8266);
 MS_MODEM_GET_MODEM_BATTERY_DATA(EspressifESP8266);
@@ -63,10 +65,12 @@ bool EspressifESP8266::ESPwaitForBoot(void) {
     // going to worry about the odd baud rate since we're simply throwing the
     // characters away.
     MS_DBG(F("Waiting for boot-up message from ESP8266"));
-    delay(200);  // It will take at least this long
+    idleUntil(millis() + 200);  // It will take at least this long
     uint32_t start   = millis();
     bool     success = false;
-    while (!_modemStream->available() && millis() - start < 1000) {}
+    while (!_modemStream->available() && millis() - start < 1000) {
+        idleUntil(millis() + 1);
+    }
     if (_modemStream->available()) {
         success = true;
         // Read the boot log to empty it from the serial buffer
@@ -94,7 +98,7 @@ bool EspressifESP8266::modemWakeFxn(void) {
         MS_DBG(F("Sending a reset pulse to pin"), _modemResetPin,
                F("to wake ESP8266 from deep sleep"));
         digitalWrite(_modemResetPin, LOW);
-        delay(_resetPulse_ms);
+        idleUntil(millis() + _resetPulse_ms);
         digitalWrite(_modemResetPin, HIGH);
         digitalWrite(_modemSleepRqPin, !_wakeLevel);
         success &= ESPwaitForBoot();
@@ -103,6 +103,7 @@
  */
 #define MS_MODEM_WAKE(specificModem)                                           \
     bool specificModem::modemWake(void) {                                      \
+        modemPhase outerPhase = beginPhase(MODEM_PHASE_WAKE);                  \
         /* Power up */                                                         \
         if (_millisPowerOn == 0) { modemPowerUp(); }                           \
                                                                                \
@@ -113,7 +114,7 @@
                                                                                \
         MS_DBG(F("Wait"), _wakeDelayTime_ms - (millis() - _millisPowerOn),     \
                F("ms longer for warm-up"));                                    \
-        while (millis() - _millisPowerOn < _wakeDelayTime_ms) {}               \
+        idleUntil(_millisPowerOn + _wakeDelayTime_ms);                         \
                                                                                \
         if (isModemAwake()) {                                                  \
             MS_DBG(getModemName(),                                             \
@@ -174,6 +175,7 @@
             MS_DBG(getModemName(), F("failed to wake!"));                      \
         }                                                                      \
                                                                                \
+        endPhase(outerPhase);                                                  \
         return success;                                                        \
     }
 
@@ -251,7 +253,8 @@
  */
 #define MS_MODEM_CONNECT_INTERNET(specificModem)                             \
     bool specificModem::connectInternet(uint32_t maxConnectionTime) {        \
-        bool success = true;                                                 \
+        bool       success    = true;                                        \
+        modemPhase outerPhase = beginPhase(MODEM_PHASE_CONNECT);             \
                                                                              \
         /** Power up, if necessary */                                        \
         bool wasPowered = true;                                              \
@@ -263,7 +266,7 @@
         /** Check if the modem was awake, wake it if not */                  \
         bool wasAwake = isModemAwake();                                      \
         if (!wasAwake) {                                                     \
-            while (millis() - _millisPowerOn < _wakeDelayTime_ms) {}         \
+            idleUntil(_millisPowerOn + _wakeDelayTime_ms);                   \
             MS_DBG(F("Waking up the modem to connect to the internet ...")); \
             success &= modemWake();                                          \
         } else {                                                             \
@@ -274,7 +277,14 @@
             MS_START_DEBUG_TIMER                                             \
             MS_DBG(F("\nWaiting up to"), maxConnectionTime / 1000,           \
                    F("seconds for cellular network registration..."));       \
-            if (gsmModem.waitForNetwork(maxConnectionTime)) {                \
+            /** Poll like waitForNetwork(), sleeping in between */           \
+            uint32_t start      = millis();                                  \
+            bool     registered = gsmModem.isNetworkConnected();             \
+            while (!registered && millis() - start < maxConnectionTime) {    \
+                idleUntil(millis() + 250);                                   \
+                registered = gsmModem.isNetworkConnected();                  \
+            }                                                                \
+            if (registered) {                                                \
                 MS_MODEM_SET_APN                                             \
                 MS_DBG(F("... Connected after"), MS_PRINT_DEBUG_TIMER,       \
                        F("milliseconds."));                                  \
@@ -291,6 +301,7 @@
             MS_DBG(F("Modem was woken up to connect to the internet!   "     \
                      "Remember to put it to sleep when you're done."));      \
         }                                                                    \
+        endPhase(outerPhase);                                                \
         return success;                                                      \
     }
 
@@ -308,12 +319,14 @@
  * @return The text of a disconnectInternet() function specific to a single
  * modem subclass.
  */
-#define MS_MODEM_DISCONNECT_INTERNET(specificModem)           \
-    void specificModem::disconnectInternet(void) {            \
-        MS_START_DEBUG_TIMER;                                 \
-        gsmModem.gprsDisconnect();                            \
-        MS_DBG(F("Disconnected from cellular network after"), \
-               MS_PRINT_DEBUG_TIMER, F("milliseconds."));     \
+#define MS_MODEM_DISCONNECT_INTERNET(specificModem)               \
+    void specificModem::disconnectInternet(void) {                \
+        modemPhase outerPhase = beginPhase(MODEM_PHASE_SHUTDOWN); \
+        MS_START_DEBUG_TIMER;                                     \
+        gsmModem.gprsDisconnect();                                \
+        MS_DBG(F("Disconnected from cellular network after"),     \
+               MS_PRINT_DEBUG_TIMER, F("milliseconds."));         \
+        endPhase(outerPhase);                                     \
     }
 
 #else  // from #if defined TINY_GSM_MODEM_HAS_GPRS (ie, this is wifi)
@@ -360,23 +373,33 @@
  * @return The text of a connectInternet(uint32_t maxConnectionTime) function
  * specific to a single modem subclass.
  */
-#define MS_MODEM_CONNECT_INTERNET(specificModem)                      \
-    bool specificModem::connectInternet(uint32_t maxConnectionTime) { \
-        MS_START_DEBUG_TIMER                                          \
-        MS_DBG(F("\nAttempting to connect to WiFi network..."));      \
-        if (!(gsmModem.isNetworkConnected())) {                       \
-            MS_DBG(F("Sending credentials..."));                      \
-            while (!gsmModem.networkConnect(_ssid, _pwd)) {}          \
-            MS_DBG(F("Waiting up to"), maxConnectionTime / 1000,      \
-                   F("seconds for connection"));                      \
-            if (!gsmModem.waitForNetwork(maxConnectionTime)) {        \
-                MS_DBG(F("... WiFi connection failed"));              \
-                return false;                                         \
-            }                                                         \
-        }                                                             \
-        MS_DBG(F("... WiFi connected after"), MS_PRINT_DEBUG_TIMER,   \
-               F("milliseconds!"));                                   \
-        return true;                                                  \
+#define MS_MODEM_CONNECT_INTERNET(specificModem)                         \
+    bool specificModem::connectInternet(uint32_t maxConnectionTime) {    \
+        MS_START_DEBUG_TIMER                                             \
+        modemPhase outerPhase = beginPhase(MODEM_PHASE_CONNECT);         \
+        MS_DBG(F("\nAttempting to connect to WiFi network..."));         \
+        if (!(gsmModem.isNetworkConnected())) {                          \
+            MS_DBG(F("Sending credentials..."));                         \
+            while (!gsmModem.networkConnect(_ssid, _pwd)) {}             \
+            MS_DBG(F("Waiting up to"), maxConnectionTime / 1000,         \
+                   F("seconds for connection"));                         \
+            /** Poll like waitForNetwork(), sleeping in between */       \
+            uint32_t start     = millis();                               \
+            bool     connected = gsmModem.isNetworkConnected();          \
+            while (!connected && millis() - start < maxConnectionTime) { \
+                idleUntil(millis() + 250);                               \
+                connected = gsmModem.isNetworkConnected();               \
+            }                                                            \
+            if (!connected) {                                            \
+                MS_DBG(F("... WiFi connection failed"));                 \
+                endPhase(outerPhase);                                    \
+                return false;                                            \
+            }                                                            \
+        }                                                                \
+        MS_DBG(F("... WiFi connected after"), MS_PRINT_DEBUG_TIMER,      \
+               F("milliseconds!"));                                      \
+        endPhase(outerPhase);                                            \
+        return true;                                                     \
     }
 
 /**
@@ -393,12 +416,14 @@
  * @return The text of a disconnectInternet() function specific to a single
  * modem subclass.
  */
-#define MS_MODEM_DISCONNECT_INTERNET(specificModem)       \
-    void specificModem::disconnectInternet(void) {        \
-        MS_START_DEBUG_TIMER;                             \
-        gsmModem.networkDisconnect();                     \
-        MS_DBG(F("Disconnected from WiFi network after"), \
-               MS_PRINT_DEBUG_TIMER, F("milliseconds.")); \
+#define MS_MODEM_DISCONNECT_INTERNET(specificModem)               \
+    void specificModem::disconnectInternet(void) {                \
+        modemPhase outerPhase = beginPhase(MODEM_PHASE_SHUTDOWN); \
+        MS_START_DEBUG_TIMER;                                     \
+        gsmModem.networkDisconnect();                             \
+        MS_DBG(F("Disconnected from WiFi network after"),         \
+               MS_PRINT_DEBUG_TIMER, F("milliseconds."));         \
+        endPhase(outerPhase);                                     \
     }
 #endif  // #if defined TINY_GSM_MODEM_HAS_GPRS
 
@@ -429,20 +454,26 @@
             MS_DBG(F("No internet connection, cannot connect to NIST."));     \
             return 0;                                                         \
         }                                                                     \
+        modemPhase outerPhase = beginPhase(MODEM_PHASE_TIME_SYNC);            \
                                                                               \
         /** Try up to 12 times to get a timestamp from NIST. */               \
         for (uint8_t i = 0; i < 12; i++) {                                    \
-            while (millis() < _lastNISTrequest + 4000) {}                     \
+            if (_lastNISTrequest != 0) {                                      \
+                idleUntil(_lastNISTrequest + 4000);                           \
+            }                                                                 \
                                                                               \
             /** Make TCP connection. */                                       \
             MS_DBG(F("\nConnecting to NIST daytime Server"));                 \
             bool connectionMade = gsmClient.connect("time.nist.gov", 37, 15); \
+            _lastNISTrequest    = millis();                                   \
                                                                               \
             /** Wait up to 5 seconds for a response. */                       \
             if (connectionMade) {                                             \
                 uint32_t start = millis();                                    \
                 while (gsmClient && gsmClient.available() < 4 &&              \
-                       millis() - start < 5000L) {}                           \
+                       millis() - start < 5000L) {                            \
+                    idleUntil(millis() + 1);                                  \
+                }                                                             \
                                                                               \
                 if (gsmClient.available() >= 4) {                             \
                     MS_DBG(F("NIST responded after"), millis() - start,       \
@@ -450,6 +481,7 @@
                     byte response[4] = {0};                                   \
                     gsmClient.read(response, 4);                              \
                     if (gsmClient.connected()) gsmClient.stop();              \
+                    endPhase(outerPhase);                                     \
                     return parseNISTBytes(response);                          \
                 } else {                                                      \
                     MS_DBG(F("NIST Time server did not respond!"));           \
@@ -459,9 +491,121 @@
                 MS_DBG(F("Unable to open TCP to NIST!"));                     \
             }                                                                 \
         }                                                                     \
+        endPhase(outerPhase);                                                 \
         return 0;                                                             \
     }
 
+#ifdef TINY_GSM_MODEM_HAS_TIME
+/**
+ * @brief Creates a getModemNetworkTime() function for a specific modem
+ * subclass.
+ *
+ * This reads the module's clock with the specific modem's getNetworkTime() for
+ * modems where it is available.  The clock is set by the cellular network
+ * (NITZ) or by the module's own SNTP client and is kept in local time with an
+ * offset, which is taken off to give UTC.
+ *
+ * This returns 0 for modems that don't have a readable clock.
+ *
+ * @param specificModem The modem subclass
+ *
+ * @return The text of a getModemNetworkTime() function specific to a single
+ * modem subclass.
+ *
+ */
+#define MS_MODEM_GET_NETWORK_TIME(specificModem)                          \
+    uint32_t specificModem::getModemNetworkTime(void) {                   \
+        int   year = 0, month = 0, day = 0;                               \
+        int   hour = 0, minute = 0, second = 0;                           \
+        float timeZone = 0;                                               \
+        MS_DBG(F("Reading the modem's clock:"));                          \
+        if (!gsmModem.getNetworkTime(&year, &month, &day, &hour, &minute, \
+                                     &second, &timeZone)) {               \
+            MS_DBG(F("The modem did not report its clock!"));             \
+            return 0;                                                     \
+        }                                                                 \
+        return parseNetworkTime(year, month, day, hour, minute, second,   \
+                                timeZone);                                \
+    }
+
+#else
+/**
+ * @brief Creates a getModemNetworkTime() function for a specific modem
+ * subclass.
+ *
+ * This reads the module's clock with the specific modem's getNetworkTime() for
+ * modems where it is available.  The clock is set by the cellular network
+ * (NITZ) or by the module's own SNTP client and is kept in local time with an
+ * offset, which is taken off to give UTC.
+ *
+ * This returns 0 for modems that don't have a readable clock.
+ *
+ * @param specificModem The modem subclass
+ *
+ * @return The text of a getModemNetworkTime() function specific to a single
+ * modem subclass.
+ *
+ */
+#define MS_MODEM_GET_NETWORK_TIME(specificModem)                  \
+    uint32_t specificModem::getModemNetworkTime(void) {           \
+        MS_DBG(F("This modem doesn't report the network time!")); \
+        return 0;                                                 \
+    }
+#endif
+
+#ifdef TINY_GSM_MODEM_HAS_NTP
+/**
+ * @brief Creates a syncModemClockSNTP() function for a specific modem
+ * subclass.
+ *
+ * This is a passthrough to the specific modem's NTPServerSync() for modems
+ * with their own SNTP client.  The clock is set to UTC.
+ *
+ * This returns false for modems without an SNTP client.
+ *
+ * @param specificModem The modem subclass
+ *
+ * @return The text of a syncModemClockSNTP() function specific to a single
+ * modem subclass.
+ *
+ */
+#define MS_MODEM_SYNC_CLOCK_SNTP(specificModem)                              \
+    bool specificModem::syncModemClockSNTP(void) {                           \
+        /** Check for and bail if not connected to the internet. */          \
+        if (!isInternetAvailable()) {                                        \
+            MS_DBG(F("No internet connection, cannot reach SNTP server."));  \
+            return false;                                                    \
+        }                                                                    \
+        MS_DBG(F("Asking the modem to set its clock from"), MS_SNTP_SERVER); \
+        /** Ask for UTC, so the clock's offset is 0. */                      \
+        byte result = gsmModem.NTPServerSync(MS_SNTP_SERVER, 0);             \
+        MS_DBG(F("SNTP sync result:"), result);                              \
+        return result == 1;                                                  \
+    }
+
+#else
+/**
+ * @brief Creates a syncModemClockSNTP() function for a specific modem
+ * subclass.
+ *
+ * This is a passthrough to the specific modem's NTPServerSync() for modems
+ * with their own SNTP client.  The clock is set to UTC.
+ *
+ * This returns false for modems without an SNTP client.
+ *
+ * @param specificModem The modem subclass
+ *
+ * @return The text of a syncModemClockSNTP() function specific to a single
+ * modem subclass.
+ *
+ */
+#define MS_MODEM_SYNC_CLOCK_SNTP(specificModem)               \
+    bool specificModem::syncModemClockSNTP(void) {            \
+        MS_DBG(F("This modem doesn't have an SNTP client!")); \
+        return false;                                         \
+    }
+#endif
+
 #if defined TINY_GSM_MODEM_XBEE || defined TINY_GSM_MODEM_ESP8266
 /**
  * @brief Creates a text string of the functions to convert the signal quality
@@ -42,6 +42,8 @@ MS_MODEM_DISCONNECT_INTERNET(QuectelBG96);
 MS_MODEM_IS_INTERNET_AVAILABLE(QuectelBG96);
 
 MS_MODEM_GET_NIST_TIME(QuectelBG96);
+MS_MODEM_GET_NETWORK_TIME(QuectelBG96);
+MS_MODEM_SYNC_CLOCK_SNTP(QuectelBG96);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(QuectelBG96);
 MS_MODEM_GET_MODEM_BATTERY_DATA(QuectelBG96);
@@ -56,7 +58,7 @@ bool QuectelBG96::modemWakeFxn(void) {
                _wakeLevel ? F("HIGH") : F("LOW"), F("wake-up pulse on pin"),
                _modemSleepRqPin, F("for"), _modemName);
         digitalWrite(_modemSleepRqPin, _wakeLevel);
-        delay(_wakePulse_ms);  // ≥100ms
+        idleUntil(millis() + _wakePulse_ms);  // ≥100ms
         digitalWrite(_modemSleepRqPin, !_wakeLevel);
         return gsmModem.waitResponse(10000L, GF("RDY")) == 1;
     }
@@ -42,6 +42,8 @@ MS_MODEM_DISCONNECT_INTERNET(SIMComSIM7000);
 MS_MODEM_IS_INTERNET_AVAILABLE(SIMComSIM7000);
 
 MS_MODEM_GET_NIST_TIME(SIMComSIM7000);
+MS_MODEM_GET_NETWORK_TIME(SIMComSIM7000);
+MS_MODEM_SYNC_CLOCK_SNTP(SIMComSIM7000);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(SIMComSIM7000);
 MS_MODEM_GET_MODEM_BATTERY_DATA(SIMComSIM7000);
@@ -56,7 +58,7 @@ bool SIMComSIM7000::modemWakeFxn(void) {
                _wakeLevel ? F("HIGH") : F("LOW"), F("wake-up pulse on pin"),
                _modemSleepRqPin, F("for"), _modemName);
         digitalWrite(_modemSleepRqPin, _wakeLevel);
-        delay(_wakePulse_ms);  // >1s
+        idleUntil(millis() + _wakePulse_ms);  // >1s
         digitalWrite(_modemSleepRqPin, !_wakeLevel);
     }
     return true;
@@ -41,6 +41,8 @@ MS_MODEM_DISCONNECT_INTERNET(SequansMonarch);
 MS_MODEM_IS_INTERNET_AVAILABLE(SequansMonarch);
 
 MS_MODEM_GET_NIST_TIME(SequansMonarch);
+MS_MODEM_GET_NETWORK_TIME(SequansMonarch);
+MS_MODEM_SYNC_CLOCK_SNTP(SequansMonarch);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(SequansMonarch);
 MS_MODEM_GET_MODEM_BATTERY_DATA(SequansMonarch);
@@ -62,6 +62,8 @@ MS_MODEM_DISCONNECT_INTERNET(SodaqUBeeR410M);
 MS_MODEM_IS_INTERNET_AVAILABLE(SodaqUBeeR410M);
 
 MS_MODEM_GET_NIST_TIME(SodaqUBeeR410M);
+MS_MODEM_GET_NETWORK_TIME(SodaqUBeeR410M);
+MS_MODEM_SYNC_CLOCK_SNTP(SodaqUBeeR410M);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(SodaqUBeeR410M);
 MS_MODEM_GET_MODEM_BATTERY_DATA(SodaqUBeeR410M);
@@ -84,7 +86,9 @@ bool SodaqUBeeR410M::modemWakeFxn(void) {
             // 0.15-3.2s pulse for wake on SARA R4/N4 (ie, max is 3.2s)
             // Wait no more than 3.2s
             while (digitalRead(_statusPin) != static_cast<int>(_statusLevel) &&
-                   millis() - startTimer < 3200L) {}
+                   millis() - startTimer < 3200L) {
+                idleUntil(millis() + 1);
+            }
             if (digitalRead(_statusPin) == static_cast<int>(_statusLevel)) {
                 // Print when the pin lit up, if it lights up before end of 3.2s
                 MS_DBG(F("Status pin came on after"), millis() - startTimer,
@@ -92,7 +96,7 @@ bool SodaqUBeeR410M::modemWakeFxn(void) {
             }
 
             // But at least 0.15s
-            while (millis() - startTimer < 150) {}
+            idleUntil(startTimer + 150);
             // Say how long we pulsed for
             MS_DBG(F("Pulsed for"), millis() - startTimer, F("ms"));
 
@@ -101,7 +105,8 @@ bool SodaqUBeeR410M::modemWakeFxn(void) {
                 MS_DBG(F("Status pin never turned on!"));
             }
         } else {
-            delay(_wakePulse_ms);  // 0.15-3.2s pulse for wake on SARA R4/N4
+            // 0.15-3.2s pulse for wake on SARA R4/N4
+            idleUntil(millis() + _wakePulse_ms);
         }
 
         digitalWrite(_modemSleepRqPin, HIGH);
@@ -112,8 +117,8 @@ bool SodaqUBeeR410M::modemWakeFxn(void) {
         if (_powerPin >= 0) {
             MS_DBG(F("Waiting for UART to become active and requesting a "
                      "slower baud rate."));
-            delay(_max_atresponse_time_ms +
-                  250);  // Must wait for UART port to become active
+            // Must wait for UART port to become active
+            idleUntil(millis() + _max_atresponse_time_ms + 250);
             _modemSerial->begin(115200);
             gsmModem.setBaud(9600);
             _modemSerial->end();
@@ -149,13 +154,13 @@ bool SodaqUBeeR410M::modemHardReset(void) {
                _resetPulse_ms, F("ms"));
         MS_DBG(F("Please be patient"));
         digitalWrite(_modemResetPin, _resetLevel);
-        delay(_resetPulse_ms);
+        idleUntil(millis() + _resetPulse_ms);
         digitalWrite(_modemResetPin, !_resetLevel);
 #if F_CPU == 8000000L
         MS_DBG(F("Waiting for UART to become active and requesting a slower "
                  "baud rate."));
-        delay(_max_atresponse_time_ms +
-              250);  // Must wait for UART port to become active
+        // Must wait for UART port to become active
+        idleUntil(millis() + _max_atresponse_time_ms + 250);
         _modemSerial->begin(115200);
         gsmModem.setBaud(9600);
         _modemSerial->end();
@@ -41,6 +41,8 @@ MS_MODEM_DISCONNECT_INTERNET(SodaqUBeeU201);
 MS_MODEM_IS_INTERNET_AVAILABLE(SodaqUBeeU201);
 
 MS_MODEM_GET_NIST_TIME(SodaqUBeeU201);
+MS_MODEM_GET_NETWORK_TIME(SodaqUBeeU201);
+MS_MODEM_SYNC_CLOCK_SNTP(SodaqUBeeU201);
 
 MS_MODEM_GET_MODEM_SIGNAL_QUALITY(SodaqUBeeU201);
 MS_MODEM_GET_MODEM_BATTERY_DATA(SodaqUBeeU201);
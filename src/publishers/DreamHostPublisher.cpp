@@ -66,14 +66,14 @@ void DreamHostPublisher::printSensorDataDreamHost(Stream* stream) {
     stream->print(loggerTag);
     stream->print(_baseLogger->getLoggerID());
     stream->print(timestampTagDH);
-    stream->print(String(Logger::markedEpochTime -
-                         946684800));  // Correct time from epoch to y2k
+    stream->print(Logger::markedEpochTime -
+                  946684800);  // Correct time from epoch to y2k
 
     for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
         stream->print('&');
-        stream->print(_baseLogger->getVarCodeAtI(i));
+        stream->print(_baseLogger->getVarCodeCharsAtI(i));
         stream->print('=');
-        stream->print(_baseLogger->getValueStringAtI(i));
+        stream->print(_baseLogger->getValueCharsAtI(i));
     }
 }
 
@@ -110,91 +110,133 @@ void DreamHostPublisher::begin(Logger& baseLogger, const char* dhUrl) {
 // Post the data to dream host.
 // int16_t DreamHostPublisher::postDataDreamHost(void)
 int16_t DreamHostPublisher::publishData(Client* outClient) {
-    // Create a buffer for the portions of the request and response
-    char     tempBuffer[37] = "";
-    uint16_t did_respond    = 0;
-
-    // Open a TCP/IP connection to DreamHost
-    MS_DBG(F("Connecting client"));
-    MS_START_DEBUG_TIMER;
-    if (outClient->connect(dreamhostHost, dreamhostPort)) {
-        MS_DBG(F("Client connected after"), MS_PRINT_DEBUG_TIMER, F("ms\n"));
-
-        // copy the initial post header into the tx buffer
-        strcpy(txBuffer, getHeader);
-
-        // add in the dreamhost receiver URL
-        strcat(txBuffer, _DreamHostPortalRX);
-
-        // start the URL parameters
-        if (bufferFree() < 16) printTxBuffer(outClient);
-        strcat(txBuffer, loggerTag);
-        strcat(txBuffer, _baseLogger->getLoggerID());
-
-        if (bufferFree() < 22) printTxBuffer(outClient);
-        strcat(txBuffer, timestampTagDH);
-        ltoa((Logger::markedEpochTime - 946684800), tempBuffer, 10);  // BASE 10
-        strcat(txBuffer, tempBuffer);
-
-        for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
-            // Once the buffer fills, send it out
-            if (bufferFree() < 47) printTxBuffer(outClient);
-
-            txBuffer[strlen(txBuffer)] = '&';
-            _baseLogger->getVarCodeAtI(i).toCharArray(tempBuffer, 37);
-            strcat(txBuffer, tempBuffer);
-            txBuffer[strlen(txBuffer)] = '=';
-            _baseLogger->getValueStringAtI(i).toCharArray(tempBuffer, 37);
-            strcat(txBuffer, tempBuffer);
-        }
-
-        // add the rest of the HTTP GET headers to the outgoing buffer
-        if (bufferFree() < 52) printTxBuffer(outClient);
-        strcat(txBuffer, HTTPtag);
-        strcat(txBuffer, hostHeader);
-        strcat(txBuffer, dreamhostHost);
-        txBuffer[strlen(txBuffer)] = '\r';
-        txBuffer[strlen(txBuffer)] = '\n';
-        txBuffer[strlen(txBuffer)] = '\r';
-        txBuffer[strlen(txBuffer)] = '\n';
-
-        // Send out the finished request (or the last unsent section of it)
-        printTxBuffer(outClient);
-
-        // Wait 10 seconds for a response from the server
-        uint32_t start = millis();
-        while ((millis() - start) < 10000L && outClient->available() < 12) {
-            delay(10);
-        }
-
-        // Read only the first 12 characters of the response
-        // We're only reading as far as the http code, anything beyond that
-        // we don't care about.
-        did_respond = outClient->readBytes(tempBuffer, 12);
-
-        // Close the TCP/IP connection
-        MS_DBG(F("Stopping client"));
-        MS_RESET_DEBUG_TIMER;
-        outClient->stop();
-        MS_DBG(F("Client stopped after"), MS_PRINT_DEBUG_TIMER, F("ms"));
+    // Open a TCP/IP connection to DreamHost, or use one that was left open
+    Client* client = openConnection(outClient, dreamhostHost, dreamhostPort);
+    int16_t responseCode = 504;
+    if (client != NULL) {
+        writeDreamHostRequest(client);
+
+        // The whole response is read, so the connection can be used again
+        responseCode = readHTTPResponse(client);
+        releaseConnection(client);
     } else {
         PRINTOUT(F("\n -- Unable to Establish Connection to DreamHost --"));
     }
 
-    // Process the HTTP response
-    int16_t responseCode = 0;
-    if (did_respond > 0) {
-        char responseCode_char[4];
-        for (uint8_t i = 0; i < 3; i++) {
-            responseCode_char[i] = tempBuffer[i + 9];
-        }
-        responseCode = atoi(responseCode_char);
-    } else {
-        responseCode = 504;
-    }
-
     PRINTOUT(F("-- Response Code --"));
     PRINTOUT(responseCode);
 
     return responseCode;
 }
+
+
+// This writes the GET request for the current record to a connected client
+void DreamHostPublisher::writeDreamHostRequest(Client* outClient) {
+    // Create a buffer for the time stamp
+    char tempBuffer[37] = "";
+
+    // start a fresh request with the initial get header
+    emptyTxBuffer();
+    writeTxBuffer(outClient, getHeader);
+
+    // add in the dreamhost receiver URL
+    writeTxBuffer(outClient, _DreamHostPortalRX);
+
+    // start the URL parameters
+    writeTxBuffer(outClient, loggerTag);
+    writeTxBuffer(outClient, _baseLogger->getLoggerID());
+
+    writeTxBuffer(outClient, timestampTagDH);
+    ltoa((Logger::markedEpochTime - 946684800), tempBuffer, 10);  // BASE 10
+    writeTxBuffer(outClient, tempBuffer);
+
+    for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
+        writeTxBuffer(outClient, '&');
+        writeTxBuffer(outClient, _baseLogger->getVarCodeCharsAtI(i));
+        writeTxBuffer(outClient, '=');
+        writeTxBuffer(outClient, _baseLogger->getValueCharsAtI(i));
+    }
+
+    // add the rest of the HTTP GET headers to the outgoing buffer
+    writeTxBuffer(outClient, HTTPtag);
+    writeTxBuffer(outClient, hostHeader);
+    writeTxBuffer(outClient, dreamhostHost);
+    writeTxBuffer(outClient, "\r\n\r\n");
+
+    // Send out the finished request (or the last unsent section of it)
+    printTxBuffer(outClient);
+}
+
+
+// Sends each record as its own request on as few connections as possible,
+// pipelining the requests once the server shows it keeps connections open
+uint16_t DreamHostPublisher::publishBatch(Client* outClient, uint16_t count) {
+    Client*  client  = NULL;
+    uint16_t done    = 0;  // records answered or skipped, from the start
+    uint16_t next    = 0;  // the next record to send
+    uint8_t  depth   = 1;  // the most requests to have waiting for answers
+    uint8_t  waiting = 0;  // the requests waiting for answers
+    uint8_t  oldest  = 0;  // the place in ends of the oldest waiting request
+    uint16_t ends[MS_HTTP_PIPELINE_DEPTH];  // done, once each is answered
+
+    while (true) {
+        while (next < count && waiting < depth) {
+            // A damaged record is passed over rather than sent
+            if (!_baseLogger->loadQueuedRecord(next)) {
+                next++;
+                if (waiting > 0) {
+                    ends[(oldest + waiting - 1) % MS_HTTP_PIPELINE_DEPTH] =
+                        next;
+                } else {
+                    done = next;
+                }
+                continue;
+            }
+            // DreamHost may close the connection after any response
+            if (client == NULL || !client->connected()) {
+                if (waiting > 0) break;
+                client = openConnection(outClient, dreamhostHost,
+                                        dreamhostPort);
+                if (client == NULL) {
+                    PRINTOUT(F("\n -- Unable to Establish Connection to "
+                               "DreamHost --"));
+                    break;
+                }
+            }
+            writeDreamHostRequest(client);
+            next++;
+            ends[(oldest + waiting) % MS_HTTP_PIPELINE_DEPTH] = next;
+            waiting++;
+        }
+        if (waiting == 0) break;
+
+        int16_t responseCode = readHTTPResponse(client);
+        PRINTOUT(F("-- Response Code --"));
+        PRINTOUT(responseCode);
+        // Any requests sent after a failure are sent again later
+        if (!publishSucceeded(responseCode)) break;
+        done   = ends[oldest];
+        oldest = (oldest + 1) % MS_HTTP_PIPELINE_DEPTH;
+        waiting--;
+
+        if (client->connected()) {
+            // Send more at once the longer the server keeps up, so fewer
+            // are wasted if it fails part way
+            if (depth < MS_HTTP_PIPELINE_DEPTH) depth++;
+        } else {
+            // Requests sent after the last one the server answered before
+            // closing are lost, so they go again on a new connection
+            next    = done;
+            waiting = 0;
+            depth   = 1;
+        }
+    }
+
+    // Answers still on their way would be read as those to the next requests
+    if (waiting > 0) {
+        closeConnection(client);
+    } else if (client != NULL) {
+        releaseConnection(client);
+    }
+    return done;
+}
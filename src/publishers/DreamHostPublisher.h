@@ -49,11 +49,11 @@ class DreamHostPublisher : public dataPublisher {
      * logger.
      *
      * @param baseLogger The logger supplying the data to be published
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -70,11 +70,11 @@ class DreamHostPublisher : public dataPublisher {
      * @param inClient An Arduino client instance to use to print data to.
      * Allows the use of any type of client and multiple clients tied to a
      * single TinyGSM modem instance
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -89,11 +89,11 @@ class DreamHostPublisher : public dataPublisher {
      *
      * @param baseLogger The logger supplying the data to be published
      * @param dhUrl The URL for sending data to DreamHost
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      */
     DreamHostPublisher(Logger& baseLogger, const char* dhUrl,
                        uint8_t sendEveryX = 1, uint8_t sendOffset = 0);
@@ -105,11 +105,11 @@ class DreamHostPublisher : public dataPublisher {
      * Allows the use of any type of client and multiple clients tied to a
      * single TinyGSM modem instance
      * @param dhUrl The URL for sending data to DreamHost
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      */
     DreamHostPublisher(Logger& baseLogger, Client* inClient, const char* dhUrl,
                        uint8_t sendEveryX = 1, uint8_t sendOffset = 0);
@@ -119,8 +119,8 @@ class DreamHostPublisher : public dataPublisher {
     virtual ~DreamHostPublisher();
 
     // Returns the data destination
-    String getEndpoint(void) override {
-        return String(dreamhostHost);
+    const char* getEndpoint(void) override {
+        return dreamhostHost;
     }
 
     // Functions for private SWRC server
@@ -178,8 +178,35 @@ class DreamHostPublisher : public dataPublisher {
      * @return **int16_t** The http status code of the response.
      */
     int16_t publishData(Client* outClient) override;
+    /**
+     * @brief Send each record of a batch as its own GET request, one after
+     * another on a single kept-alive connection.
+     *
+     * The connection is only reopened if DreamHost closes it.  Once a
+     * response has come back with the connection still open, the requests
+     * are pipelined: up to #MS_HTTP_PIPELINE_DEPTH are sent before waiting
+     * for their answers, starting with two and adding one more for each
+     * answer.  GET requests can safely be sent twice, so any that were sent
+     * after a failure are simply sent again later.
+     *
+     * @param outClient An Arduino client instance to use to print data to.
+     * Allows the use of any type of client and multiple clients tied to a
+     * single TinyGSM modem instance
+     * @param count The number of records in the batch
+     * @return **uint16_t** The number of records, from the start of the
+     * batch, that were accepted or skipped as damaged
+     */
+    uint16_t publishBatch(Client* outClient, uint16_t count) override;
 
  protected:
+    /**
+     * @brief Write the GET request for the current record to an open
+     * connection, through the TX buffer.
+     *
+     * @param outClient The connected client to send the request on
+     */
+    void writeDreamHostRequest(Client* outClient);
+
     // portions of the GET request
     /**
      * @anchor dreamhost_protected_vars
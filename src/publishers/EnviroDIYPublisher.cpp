@@ -34,18 +34,21 @@ const char* EnviroDIYPublisher::timestampTag       = "\",\"timestamp\":\"";
 
 // Constructors
 EnviroDIYPublisher::EnviroDIYPublisher() : dataPublisher() {
+    _fixedJsonSize = 0;
     // MS_DBG(F("dataPublisher object created"));
     _registrationToken = NULL;
 }
 EnviroDIYPublisher::EnviroDIYPublisher(Logger& baseLogger, uint8_t sendEveryX,
                                        uint8_t sendOffset)
     : dataPublisher(baseLogger, sendEveryX, sendOffset) {
+    _fixedJsonSize = 0;
     // MS_DBG(F("dataPublisher object created"));
     _registrationToken = NULL;
 }
 EnviroDIYPublisher::EnviroDIYPublisher(Logger& baseLogger, Client* inClient,
                                        uint8_t sendEveryX, uint8_t sendOffset)
     : dataPublisher(baseLogger, inClient, sendEveryX, sendOffset) {
+    _fixedJsonSize = 0;
     // MS_DBG(F("dataPublisher object created"));
 }
 EnviroDIYPublisher::EnviroDIYPublisher(Logger&     baseLogger,
@@ -55,6 +58,7 @@ EnviroDIYPublisher::EnviroDIYPublisher(Logger&     baseLogger,
     : dataPublisher(baseLogger, sendEveryX, sendOffset) {
     setToken(registrationToken);
     _baseLogger->setSamplingFeatureUUID(samplingFeatureUUID);
+    _fixedJsonSize = 0;
     // MS_DBG(F("dataPublisher object created"));
 }
 EnviroDIYPublisher::EnviroDIYPublisher(Logger& baseLogger, Client* inClient,
@@ -64,6 +68,7 @@ EnviroDIYPublisher::EnviroDIYPublisher(Logger& baseLogger, Client* inClient,
     : dataPublisher(baseLogger, inClient, sendEveryX, sendOffset) {
     setToken(registrationToken);
     _baseLogger->setSamplingFeatureUUID(samplingFeatureUUID);
+    _fixedJsonSize = 0;
     // MS_DBG(F("dataPublisher object created"));
 }
 // Destructor
@@ -76,22 +81,68 @@ void EnviroDIYPublisher::setToken(const char* registrationToken) {
 }
 
 
-// Calculates how long the JSON will be
+// Works out how long everything in the JSON but the time and values will be
+void EnviroDIYPublisher::calculateFixedJsonSize(void) {
+    _fixedSizeFeatureUUID = _baseLogger->getSamplingFeatureUUID();
+    _fixedSizeVarCount    = _baseLogger->getArrayVarCount();
+
+    _fixedJsonSize = 21;  // {"sampling_feature":"
+    _fixedJsonSize += strlen(_fixedSizeFeatureUUID);
+    _fixedJsonSize += 15;  // ","timestamp":"
+    _fixedJsonSize += 2;   //  ",
+    for (uint8_t i = 0; i < _fixedSizeVarCount; i++) {
+        if (i > 0) _fixedJsonSize += 1;  // ,
+        _fixedJsonSize += 1;             //  "
+        _fixedJsonSize += strlen(_baseLogger->getVarUUIDCharsAtI(i));
+        _fixedJsonSize += 2;  // ":
+    }
+    _fixedJsonSize += 1;  // }
+    MS_DBG(F("Fixed JSON length:"), _fixedJsonSize);
+}
+
+
+// Calculates how long the JSON will be: only the time and the values differ
+// from one record to the next
 uint16_t EnviroDIYPublisher::calculateJsonSize() {
+    if (_fixedJsonSize == 0 ||
+        _fixedSizeFeatureUUID != _baseLogger->getSamplingFeatureUUID() ||
+        _fixedSizeVarCount != _baseLogger->getArrayVarCount()) {
+        calculateFixedJsonSize();
+    }
+    uint16_t jsonLength = _fixedJsonSize;
+    jsonLength += strlen(Logger::getMarkedISO8601());
+    for (uint8_t i = 0; i < _fixedSizeVarCount; i++) {
+        jsonLength += strlen(_baseLogger->getValueCharsAtI(i));
+    }
+    return jsonLength;
+}
+
+
+// Calculates how long the JSON for a batch of records will be
+uint16_t EnviroDIYPublisher::calculateBatchJsonSize(uint16_t count) {
+    uint16_t records    = 0;
     uint16_t jsonLength = 21;  // {"sampling_feature":"
-    jsonLength += 36;          // sampling feature UUID
-    jsonLength += 15;          // ","timestamp":"
-    jsonLength += 25;          // markedISO8601Time
-    jsonLength += 2;           //  ",
-    for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
-        jsonLength += 1;   //  "
-        jsonLength += 36;  // variable UUID
-        jsonLength += 2;   //  ":
-        jsonLength += _baseLogger->getValueStringAtI(i).length();
-        if (i + 1 != _baseLogger->getArrayVarCount()) {
-            jsonLength += 1;  // ,
+    jsonLength += strlen(_baseLogger->getSamplingFeatureUUID());
+    jsonLength += 15;  // ","timestamp":[
+    for (uint16_t j = 0; j < count; j++) {
+        if (!_baseLogger->loadQueuedRecord(j)) continue;
+        records++;
+        jsonLength += 2;  // the quotes around the time
+        jsonLength += strlen(Logger::getMarkedISO8601());
+        for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
+            jsonLength += strlen(_baseLogger->getValueCharsAtI(i));
         }
     }
+    if (records == 0) return 0;
+    jsonLength += records - 1;  // , between times
+    jsonLength += 1;            // ]
+    for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
+        jsonLength += 2;  // ,"
+        jsonLength += strlen(_baseLogger->getVarUUIDCharsAtI(i));
+        jsonLength += 3;            //  ":[
+        jsonLength += records - 1;  // , between values
+        jsonLength += 1;            // ]
+    }
     jsonLength += 1;  // }
 
     return jsonLength;
@@ -122,14 +173,14 @@ void EnviroDIYPublisher::printSensorDataJSON(Stream* stream) {
     stream->print(samplingFeatureTag);
     stream->print(_baseLogger->getSamplingFeatureUUID());
     stream->print(timestampTag);
-    stream->print(_baseLogger->formatDateTime_ISO8601(Logger::markedEpochTime));
+    stream->print(Logger::getMarkedISO8601());
     stream->print(F("\","));
 
     for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
         stream->print('"');
-        stream->print(_baseLogger->getVarUUIDAtI(i));
+        stream->print(_baseLogger->getVarUUIDCharsAtI(i));
         stream->print(F("\":"));
-        stream->print(_baseLogger->getValueStringAtI(i));
+        stream->print(_baseLogger->getValueCharsAtI(i));
         if (i + 1 != _baseLogger->getArrayVarCount()) { stream->print(','); }
     }
 
@@ -182,119 +233,138 @@ void EnviroDIYPublisher::begin(Logger&     baseLogger,
 // The return is the http status code of the response.
 // int16_t EnviroDIYPublisher::postDataEnviroDIY(void)
 int16_t EnviroDIYPublisher::publishData(Client* outClient) {
-    // Create a buffer for the portions of the request and response
-    char     tempBuffer[37] = "";
-    uint16_t did_respond    = 0;
-
-    MS_DBG(F("Outgoing JSON size:"), calculateJsonSize());
-
-    // Open a TCP/IP connection to the Enviro DIY Data Portal (WebSDL)
-    MS_DBG(F("Connecting client"));
-    MS_START_DEBUG_TIMER;
-    if (outClient->connect(enviroDIYHost, enviroDIYPort)) {
-        MS_DBG(F("Client connected after"), MS_PRINT_DEBUG_TIMER, F("ms\n"));
-
-        // copy the initial post header into the tx buffer
-        strcpy(txBuffer, postHeader);
-        strcat(txBuffer, postEndpoint);
-        strcat(txBuffer, HTTPtag);
-
-        // add the rest of the HTTP POST headers to the outgoing buffer
-        // before adding each line/chunk to the outgoing buffer, we make sure
-        // there is space for that line, sending out buffer if not
-        if (bufferFree() < 28) printTxBuffer(outClient);
-        strcat(txBuffer, hostHeader);
-        strcat(txBuffer, enviroDIYHost);
-
-        if (bufferFree() < 47) printTxBuffer(outClient);
-        strcat(txBuffer, tokenHeader);
-        strcat(txBuffer, _registrationToken);
-
-        // if (bufferFree() < 27) printTxBuffer(outClient);
-        // strcat(txBuffer, cacheHeader);
-
-        // if (bufferFree() < 21) printTxBuffer(outClient);
-        // strcat(txBuffer, connectionHeader);
-
-        if (bufferFree() < 26) printTxBuffer(outClient);
-        strcat(txBuffer, contentLengthHeader);
-        itoa(calculateJsonSize(), tempBuffer, 10);  // BASE 10
-        strcat(txBuffer, tempBuffer);
-
-        if (bufferFree() < 42) printTxBuffer(outClient);
-        strcat(txBuffer, contentTypeHeader);
-
-        // put the start of the JSON into the outgoing response_buffer
-        if (bufferFree() < 21) printTxBuffer(outClient);
-        strcat(txBuffer, samplingFeatureTag);
-
-        if (bufferFree() < 36) printTxBuffer(outClient);
-        strcat(txBuffer, _baseLogger->getSamplingFeatureUUID());
-
-        if (bufferFree() < 42) printTxBuffer(outClient);
-        strcat(txBuffer, timestampTag);
-        _baseLogger->formatDateTime_ISO8601(Logger::markedEpochTime)
-            .toCharArray(tempBuffer, 37);
-        strcat(txBuffer, tempBuffer);
-        txBuffer[strlen(txBuffer)] = '"';
-        txBuffer[strlen(txBuffer)] = ',';
+    uint16_t jsonLength = calculateJsonSize();
+    MS_DBG(F("Outgoing JSON size:"), jsonLength);
 
-        for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
-            // Once the buffer fills, send it out
-            if (bufferFree() < 47) printTxBuffer(outClient);
-
-            txBuffer[strlen(txBuffer)] = '"';
-            _baseLogger->getVarUUIDAtI(i).toCharArray(tempBuffer, 37);
-            strcat(txBuffer, tempBuffer);
-            txBuffer[strlen(txBuffer)] = '"';
-            txBuffer[strlen(txBuffer)] = ':';
-            _baseLogger->getValueStringAtI(i).toCharArray(tempBuffer, 37);
-            strcat(txBuffer, tempBuffer);
-            if (i + 1 != _baseLogger->getArrayVarCount()) {
-                txBuffer[strlen(txBuffer)] = ',';
-            } else {
-                txBuffer[strlen(txBuffer)] = '}';
-            }
-        }
+    // Open a TCP/IP connection to the Enviro DIY Data Portal (WebSDL), or
+    // use one that was left open
+    Client* client = openConnection(outClient, enviroDIYHost, enviroDIYPort);
+    int16_t responseCode = 504;
+    if (client != NULL) {
+        writeEnviroDIYHeaders(client, jsonLength);
+        writeSensorDataJSON(client);
 
         // Send out the finished request (or the last unsent section of it)
-        printTxBuffer(outClient, true);
+        printTxBuffer(client, true);
 
-        // Wait 10 seconds for a response from the server
-        uint32_t start = millis();
-        while ((millis() - start) < 10000L && outClient->available() < 12) {
-            delay(10);
-        }
+        // The whole response is read, so the connection can be used again
+        responseCode = readHTTPResponse(client);
+        releaseConnection(client);
+    } else {
+        PRINTOUT(F("\n -- Unable to Establish Connection to EnviroDIY Data "
+                   "Portal --"));
+    }
 
-        // Read only the first 12 characters of the response
-        // We're only reading as far as the http code, anything beyond that
-        // we don't care about.
-        did_respond = outClient->readBytes(tempBuffer, 12);
+    PRINTOUT(F("-- Response Code --"));
+    PRINTOUT(responseCode);
 
-        // Close the TCP/IP connection
-        MS_DBG(F("Stopping client"));
-        MS_RESET_DEBUG_TIMER;
-        outClient->stop();
-        MS_DBG(F("Client stopped after"), MS_PRINT_DEBUG_TIMER, F("ms"));
-    } else {
+    return responseCode;
+}
+
+
+// This writes the headers of the post request to a connected client
+void EnviroDIYPublisher::writeEnviroDIYHeaders(Client*  outClient,
+                                               uint16_t jsonLength) {
+    // Create a buffer for the content length
+    char tempBuffer[6] = "";
+
+    emptyTxBuffer();
+    writeTxBuffer(outClient, postHeader);
+    writeTxBuffer(outClient, postEndpoint);
+    writeTxBuffer(outClient, HTTPtag);
+    writeTxBuffer(outClient, hostHeader);
+    writeTxBuffer(outClient, enviroDIYHost);
+    writeTxBuffer(outClient, tokenHeader);
+    writeTxBuffer(outClient, _registrationToken);
+    // writeTxBuffer(outClient, cacheHeader);
+    // writeTxBuffer(outClient, connectionHeader);
+    writeTxBuffer(outClient, contentLengthHeader);
+    itoa(jsonLength, tempBuffer, 10);  // BASE 10
+    writeTxBuffer(outClient, tempBuffer);
+    writeTxBuffer(outClient, contentTypeHeader);
+}
+
+
+// This writes the JSON for the current record to a connected client
+void EnviroDIYPublisher::writeSensorDataJSON(Client* outClient) {
+    writeTxBuffer(outClient, samplingFeatureTag);
+    writeTxBuffer(outClient, _baseLogger->getSamplingFeatureUUID());
+    writeTxBuffer(outClient, timestampTag);
+    writeTxBuffer(outClient, Logger::getMarkedISO8601());
+    writeTxBuffer(outClient, '"');
+    writeTxBuffer(outClient, ',');
+
+    for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
+        if (i > 0) writeTxBuffer(outClient, ',');
+        writeTxBuffer(outClient, '"');
+        writeTxBuffer(outClient, _baseLogger->getVarUUIDCharsAtI(i));
+        writeTxBuffer(outClient, '"');
+        writeTxBuffer(outClient, ':');
+        writeTxBuffer(outClient, _baseLogger->getValueCharsAtI(i));
+    }
+    writeTxBuffer(outClient, '}');
+}
+
+
+// Sends a whole batch in one post, with a list of values for each variable
+uint16_t EnviroDIYPublisher::publishBatch(Client* outClient, uint16_t count) {
+    // A single record goes in the usual JSON
+    if (count <= 1) return dataPublisher::publishBatch(outClient, count);
+
+    uint16_t jsonLength = calculateBatchJsonSize(count);
+    // With every record damaged there's nothing to send, or to keep
+    if (jsonLength == 0) return count;
+    MS_DBG(F("Outgoing JSON size for"), count, F("records:"), jsonLength);
+
+    // Open a TCP/IP connection to the Enviro DIY Data Portal (WebSDL), or
+    // use one that was left open
+    Client* client = openConnection(outClient, enviroDIYHost, enviroDIYPort);
+    if (client == NULL) {
         PRINTOUT(F("\n -- Unable to Establish Connection to EnviroDIY Data "
                    "Portal --"));
+        return 0;
+    }
+    writeEnviroDIYHeaders(client, jsonLength);
+
+    writeTxBuffer(client, samplingFeatureTag);
+    writeTxBuffer(client, _baseLogger->getSamplingFeatureUUID());
+    writeTxBuffer(client, "\",\"timestamp\":[");
+    bool first = true;
+    for (uint16_t j = 0; j < count; j++) {
+        if (!_baseLogger->loadQueuedRecord(j)) continue;
+        if (!first) writeTxBuffer(client, ',');
+        writeTxBuffer(client, '"');
+        writeTxBuffer(client, Logger::getMarkedISO8601());
+        writeTxBuffer(client, '"');
+        first = false;
     }
+    writeTxBuffer(client, ']');
 
-    // Process the HTTP response
-    int16_t responseCode = 0;
-    if (did_respond > 0) {
-        char responseCode_char[4];
-        for (uint8_t i = 0; i < 3; i++) {
-            responseCode_char[i] = tempBuffer[i + 9];
+    // The records are read again for each variable's list
+    for (uint8_t i = 0; i < _baseLogger->getArrayVarCount(); i++) {
+        writeTxBuffer(client, ',');
+        writeTxBuffer(client, '"');
+        writeTxBuffer(client, _baseLogger->getVarUUIDCharsAtI(i));
+        writeTxBuffer(client, "\":[");
+        first = true;
+        for (uint16_t j = 0; j < count; j++) {
+            if (!_baseLogger->loadQueuedRecord(j)) continue;
+            if (!first) writeTxBuffer(client, ',');
+            writeTxBuffer(client, _baseLogger->getValueCharsAtI(i));
+            first = false;
         }
-        responseCode = atoi(responseCode_char);
-    } else {
-        responseCode = 504;
+        writeTxBuffer(client, ']');
     }
+    writeTxBuffer(client, '}');
+
+    // Send out the finished request (or the last unsent section of it)
+    printTxBuffer(client, true);
+
+    int16_t responseCode = readHTTPResponse(client);
+    releaseConnection(client);
 
     PRINTOUT(F("-- Response Code --"));
     PRINTOUT(responseCode);
 
-    return responseCode;
+    return publishSucceeded(responseCode) ? count : 0;
 }
@@ -49,11 +49,11 @@ class EnviroDIYPublisher : public dataPublisher {
      * logger.
      *
      * @param baseLogger The logger supplying the data to be published
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -70,11 +70,11 @@ class EnviroDIYPublisher : public dataPublisher {
      * @param inClient An Arduino client instance to use to print data to.
      * Allows the use of any type of client and multiple clients tied to a
      * single TinyGSM modem instance
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -92,11 +92,11 @@ class EnviroDIYPublisher : public dataPublisher {
      * Monitor My Watershed data portal.
      * @param samplingFeatureUUID The sampling feature UUID for the site on the
      * Monitor My Watershed data portal.
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      */
     EnviroDIYPublisher(Logger& baseLogger, const char* registrationToken,
                        const char* samplingFeatureUUID, uint8_t sendEveryX = 1,
@@ -112,11 +112,11 @@ class EnviroDIYPublisher : public dataPublisher {
      * Monitor My Watershed data portal.
      * @param samplingFeatureUUID The sampling feature UUID for the site on the
      * Monitor My Watershed data portal.
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      */
     EnviroDIYPublisher(Logger& baseLogger, Client* inClient,
                        const char* registrationToken,
@@ -128,8 +128,8 @@ class EnviroDIYPublisher : public dataPublisher {
     virtual ~EnviroDIYPublisher();
 
     // Returns the data destination
-    String getEndpoint(void) override {
-        return String(enviroDIYHost);
+    const char* getEndpoint(void) override {
+        return enviroDIYHost;
     }
 
     // Adds the site registration token
@@ -144,9 +144,24 @@ class EnviroDIYPublisher : public dataPublisher {
     /**
      * @brief Calculates how long the outgoing JSON will be
      *
+     * The fixed part of the length is worked out once by
+     * calculateFixedJsonSize() and reused until the sampling feature or the
+     * variables change.
+     *
      * @return uint16_t The number of characters in the JSON object.
      */
     uint16_t calculateJsonSize();
+    /**
+     * @brief Calculates how long the outgoing JSON for a batch of queued
+     * records will be
+     *
+     * Damaged records are left out, as they are when the batch is sent.
+     *
+     * @param count The number of records in the batch
+     * @return uint16_t The number of characters in the JSON object, or 0 if
+     * none of the records could be read.
+     */
+    uint16_t calculateBatchJsonSize(uint16_t count);
     // /**
     //  * @brief Calculates how long the full post request will be, including
     //  * headers
@@ -207,8 +222,55 @@ class EnviroDIYPublisher : public dataPublisher {
      * @return **int16_t** The http status code of the response.
      */
     int16_t publishData(Client* outClient) override;
+    /**
+     * @brief Send a batch of queued records to the
+     * EnviroDIY/ODM2DataSharingPortal in a single post request.
+     *
+     * The JSON for a batch has a list of timestamps, and for each variable a
+     * list of values in the same order, like
+     * `{"sampling_feature":"...","timestamp":["...","..."],"...":[1.0,2.0]}`.
+     *
+     * @param outClient An Arduino client instance to use to print data to.
+     * Allows the use of any type of client and multiple clients tied to a
+     * single TinyGSM modem instance
+     * @param count The number of records in the batch
+     * @return **uint16_t** The number of records sent, either all of them or
+     * none
+     */
+    uint16_t publishBatch(Client* outClient, uint16_t count) override;
 
  protected:
+    /**
+     * @brief Write the headers of the post request to an open connection,
+     * through the TX buffer.
+     *
+     * The headers are left in the TX buffer to be followed by the JSON.
+     *
+     * @param outClient The connected client to send the request on
+     * @param jsonLength The exact number of characters in the JSON that will
+     * follow
+     */
+    void writeEnviroDIYHeaders(Client* outClient, uint16_t jsonLength);
+    /**
+     * @brief Write the JSON for the current values to an open connection,
+     * through the TX buffer.
+     *
+     * This builds the same JSON as printSensorDataJSON(), but in a single pass
+     * over the buffer instead of a string of separate prints.
+     *
+     * @param outClient The connected client to send the JSON on
+     */
+    void writeSensorDataJSON(Client* outClient);
+    /**
+     * @brief Work out the length of the parts of the JSON that only change
+     * when the sampling feature or the variables do.
+     *
+     * That is the tags, the quotes and commas, and all of the UUIDs.  The
+     * result is kept in #_fixedJsonSize so that calculateJsonSize() only
+     * has to add the timestamp and the values for each post.
+     */
+    void calculateFixedJsonSize(void);
+
     /**
      * @anchor envirodiy_post_vars
      * @name Portions of the POST request to EnviroDIY
@@ -238,6 +300,20 @@ class EnviroDIYPublisher : public dataPublisher {
  private:
     // Tokens and UUID's for EnviroDIY
     const char* _registrationToken;
+    /**
+     * @brief The number of characters in the JSON that are not the timestamp
+     * or a value, or 0 if it has not been worked out yet.
+     */
+    uint16_t _fixedJsonSize;
+    /**
+     * @brief The sampling feature UUID that #_fixedJsonSize was worked out
+     * for
+     */
+    const char* _fixedSizeFeatureUUID;
+    /**
+     * @brief The number of variables #_fixedJsonSize was worked out for
+     */
+    uint8_t _fixedSizeVarCount;
 };
 
 #endif  // SRC_PUBLISHERS_ENVIRODIYPUBLISHER_H_
@@ -144,24 +144,23 @@ int16_t ThingSpeakPublisher::publishData(Client* outClient) {
     strcat(topicBuffer, _thingSpeakChannelKey);
     MS_DBG(F("Topic ["), strlen(topicBuffer), F("]:"), String(topicBuffer));
 
+    // The message has to go out in one piece, so the buffer is never sent
+    // part way through
     emptyTxBuffer();
 
-    _baseLogger->formatDateTime_ISO8601(Logger::markedEpochTime)
-        .toCharArray(tempBuffer, 26);
-    strcat(txBuffer, "created_at=");
-    strcat(txBuffer, tempBuffer);
-    txBuffer[strlen(txBuffer)] = '&';
+    writeTxBuffer(NULL, "created_at=");
+    writeTxBuffer(NULL, Logger::getMarkedISO8601());
+    writeTxBuffer(NULL, '&');
 
     for (uint8_t i = 0; i < numChannels; i++) {
-        strcat(txBuffer, "field");
+        writeTxBuffer(NULL, "field");
         itoa(i + 1, tempBuffer, 10);  // BASE 10
-        strcat(txBuffer, tempBuffer);
-        txBuffer[strlen(txBuffer)] = '=';
-        _baseLogger->getValueStringAtI(i).toCharArray(tempBuffer, 26);
-        strcat(txBuffer, tempBuffer);
-        if (i + 1 != numChannels) { txBuffer[strlen(txBuffer)] = '&'; }
+        writeTxBuffer(NULL, tempBuffer);
+        writeTxBuffer(NULL, '=');
+        writeTxBuffer(NULL, _baseLogger->getValueCharsAtI(i));
+        if (i + 1 != numChannels) { writeTxBuffer(NULL, '&'); }
     }
-    MS_DBG(F("Message ["), strlen(txBuffer), F("]:"), String(txBuffer));
+    MS_DBG(F("Message ["), txBufferLength, F("]:"), String(txBuffer));
 
     // Set the client connection parameters
     _mqttClient.setClient(*outClient);
@@ -173,7 +172,7 @@ int16_t ThingSpeakPublisher::publishData(Client* outClient) {
     // Closing any stray client sockets here ensures that a new client socket
     // is opened to the right place.
     // client is connected when a different socket is open
-    if (outClient->connected()) { outClient->stop(); }
+    prepareConnection(outClient);
 
     // Make the MQTT connection
     // Note:  the client id and the user name do not mean anything for
@@ -184,6 +183,7 @@ int16_t ThingSpeakPublisher::publishData(Client* outClient) {
         MS_DBG(F("MQTT connected after"), MS_PRINT_DEBUG_TIMER, F("ms"));
 
         if (_mqttClient.publish(topicBuffer, txBuffer)) {
+            txByteCount += strlen(topicBuffer) + txBufferLength;
             PRINTOUT(F("ThingSpeak topic published!  Current state:"),
                      parseMQTTState(_mqttClient.state()));
             retVal = true;
@@ -206,3 +206,9 @@ int16_t ThingSpeakPublisher::publishData(Client* outClient) {
     MS_DBG(F("Disconnected after"), MS_PRINT_DEBUG_TIMER, F("ms"));
     return retVal;
 }
+
+
+// The MQTT publish returns true or false rather than an http response
+bool ThingSpeakPublisher::publishSucceeded(int16_t result) {
+    return result == 1;
+}
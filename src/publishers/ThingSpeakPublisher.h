@@ -63,11 +63,11 @@ class ThingSpeakPublisher : public dataPublisher {
      * logger.
      *
      * @param baseLogger The logger supplying the data to be published
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -84,11 +84,11 @@ class ThingSpeakPublisher : public dataPublisher {
      * @param inClient An Arduino client instance to use to print data to.
      * Allows the use of any type of client and multiple clients tied to a
      * single TinyGSM modem instance
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      *
      * @note It is possible (though very unlikey) that using this constructor
      * could cause errors if the compiler attempts to initialize the publisher
@@ -105,10 +105,11 @@ class ThingSpeakPublisher : public dataPublisher {
      * @param thingSpeakMQTTKey Your MQTT API Key from Account > MyProfile.
      * @param thingSpeakChannelID The numeric channel id for your channel
      * @param thingSpeakChannelKey The write API key for your channel
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      */
     ThingSpeakPublisher(Logger& baseLogger, const char* thingSpeakMQTTKey,
                         const char* thingSpeakChannelID,
@@ -124,11 +125,11 @@ class ThingSpeakPublisher : public dataPublisher {
      * @param thingSpeakMQTTKey Your MQTT API Key from Account > MyProfile.
      * @param thingSpeakChannelID The numeric channel id for your channel
      * @param thingSpeakChannelKey The write API key for your channel
-     * @param sendEveryX Currently unimplemented, intended for future use to
-     * enable caching and bulk publishing
-     * @param sendOffset Currently unimplemented, intended for future use to
-     * enable publishing data at a time slightly delayed from when it is
-     * collected
+     * @param sendEveryX Send only on every Xth logging interval, keeping the
+     * records in between in the publish queue to send together; optional
+     * with a default value of 1
+     * @param sendOffset Which logging interval out of each sendEveryX to send
+     * on; optional with a default value of 0
      */
     ThingSpeakPublisher(Logger& baseLogger, Client* inClient,
                         const char* thingSpeakMQTTKey,
@@ -141,8 +142,8 @@ class ThingSpeakPublisher : public dataPublisher {
     virtual ~ThingSpeakPublisher();
 
     // Returns the data destination
-    String getEndpoint(void) override {
-        return String(mqttServer);
+    const char* getEndpoint(void) override {
+        return mqttServer;
     }
 
     /**
@@ -199,6 +200,14 @@ class ThingSpeakPublisher : public dataPublisher {
     // This sends the data to ThingSpeak
     // bool mqttThingSpeak(void);
     int16_t publishData(Client* outClient) override;
+    /**
+     * @brief Check whether the result of publishData() means the topic was
+     * published.
+     *
+     * @param result The value returned by publishData()
+     * @return **bool** True if the MQTT publish succeeded
+     */
+    bool publishSucceeded(int16_t result) override;
 
  protected:
     /**
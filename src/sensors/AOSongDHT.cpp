@@ -31,6 +31,9 @@ bool AOSongDHT::setup(void) {
 
 
 String AOSongDHT::getSensorName(void) {
+    return getSensorNameChars();
+}
+const char* AOSongDHT::getSensorNameChars(void) {
     switch (_dhtType) {
         case 11: return "AOSongDHT11";
         case 21: return "AOSongDHT21";
@@ -192,6 +192,10 @@ class AOSongDHT : public Sensor {
      * @copydoc Sensor::getSensorName()
      */
     String getSensorName(void) override;
+    /**
+     * @copydoc Sensor::getSensorNameChars()
+     */
+    const char* getSensorNameChars(void) override;
 
     /**
      * @copydoc Sensor::addSingleMeasurementResult()
@@ -17,6 +17,12 @@ MaxBotixSonar::MaxBotixSonar(Stream* stream, int8_t powerPin, int8_t triggerPin,
              measurementsToAverage) {
     _triggerPin = triggerPin;
     _stream     = stream;
+    _rangeState           = MEASUREMENT_PENDING;
+    _rangeAttempts        = 0;
+    _rangeResult          = -9999;
+    _partialRange         = 0;
+    _rangeDigitsRead      = false;
+    _millisRangeRequested = 0;
 }
 MaxBotixSonar::MaxBotixSonar(Stream& stream, int8_t powerPin, int8_t triggerPin,
                              uint8_t measurementsToAverage)
@@ -25,6 +31,12 @@ MaxBotixSonar::MaxBotixSonar(Stream& stream, int8_t powerPin, int8_t triggerPin,
              measurementsToAverage) {
     _triggerPin = triggerPin;
     _stream     = &stream;
+    _rangeState           = MEASUREMENT_PENDING;
+    _rangeAttempts        = 0;
+    _rangeResult          = -9999;
+    _partialRange         = 0;
+    _rangeDigitsRead      = false;
+    _millisRangeRequested = 0;
 }
 // Destructor
 MaxBotixSonar::~MaxBotixSonar() {}
@@ -47,7 +59,7 @@ bool MaxBotixSonar::setup(void) {
 
     // Set the stream timeout;
     // Even the slowest sensors should respond at a rate of 6Hz (166ms).
-    _stream->setTimeout(180);
+    _stream->setTimeout(HRXL_RANGE_TIMEOUT_MS);
 
     return Sensor::setup();  // this will set pin modes and the setup status bit
 }
@@ -95,84 +107,163 @@ bool MaxBotixSonar::wake(void) {
 }
 
 
+bool MaxBotixSonar::startSingleMeasurement(void) {
+    // Reset the range reading state before the new measurement
+    _rangeState           = MEASUREMENT_PENDING;
+    _rangeAttempts        = 0;
+    _rangeResult          = -9999;
+    _partialRange         = 0;
+    _rangeDigitsRead      = false;
+    _millisRangeRequested = 0;
+
+    return Sensor::startSingleMeasurement();
+}
+
+
 bool MaxBotixSonar::addSingleMeasurementResult(void) {
-    // Initialize values
-    bool    success       = false;
-    uint8_t rangeAttempts = 0;
-    int16_t result        = -9999;
+    // Run the cooperative reading until it's finished
+    while (pollMeasurement() == MEASUREMENT_PENDING) {}
+    return collectResult();
+}
 
-    // Clear anything out of the stream buffer
-    uint8_t junkChars = _stream->available();
-    if (junkChars) {
-        MS_DBG(F("Dumping"), junkChars,
-               F("characters from MaxBotix stream buffer:"));
-        for (uint8_t i = 0; i < junkChars; i++) {
+
+measurementState MaxBotixSonar::pollMeasurement(bool debug) {
+    // Check a measurement was *successfully* started (status bit 6 set)
+    // Only go on to get a result if it was
+    if (!bitRead(_sensorStatus, 6)) {
+        MS_DBG(getSensorNameAndLocation(), F("is not currently measuring!"));
+        return MEASUREMENT_FAILED;
+    }
+    if (_rangeState != MEASUREMENT_PENDING) return _rangeState;
+
+    // If we haven't started listening for a range yet, start now
+    if (_millisRangeRequested == 0) {
+        // Don't start reading until the measurement time has passed
+        if (!isMeasurementComplete(debug)) return MEASUREMENT_PENDING;
+
+        // Clear anything out of the stream buffer
+        uint8_t junkChars = _stream->available();
+        if (junkChars) {
+            MS_DBG(F("Dumping"), junkChars,
+                   F("characters from MaxBotix stream buffer:"));
+            for (uint8_t i = 0; i < junkChars; i++) {
 #ifdef MS_MAXBOTIXSONAR_DEBUG
-            DEBUGGING_SERIAL_OUTPUT.print(_stream->read());
+                DEBUGGING_SERIAL_OUTPUT.print(_stream->read());
 #else
-            _stream->read();
+                _stream->read();
 #endif
-        }
+            }
 #ifdef MS_MAXBOTIXSONAR_DEBUG
-        DEBUGGING_SERIAL_OUTPUT.println();
+            DEBUGGING_SERIAL_OUTPUT.println();
 #endif
-    }
+        }
 
-    // Check a measurement was *successfully* started (status bit 6 set)
-    // Only go on to get a result if it was
-    if (bitRead(_sensorStatus, 6)) {
         MS_DBG(getSensorNameAndLocation(), F("is reporting:"));
+        startRangeAttempt();
+        return MEASUREMENT_PENDING;
+    }
 
-        while (success == false && rangeAttempts < 25) {
-            // If the sonar is running on a trigger, activating the trigger
-            // should in theory happen within the startSingleMeasurement
-            // function.  Because we're really taking up to 25 measurements
-            // for each "single measurement" until a valid value is returned
-            // and the measurement time is <166ms, we'll actually activate
-            // the trigger here.
-            if (_triggerPin >= 0) {
-                MS_DBG(F("  Triggering Sonar with"), _triggerPin);
-                digitalWrite(_triggerPin, HIGH);
-                delayMicroseconds(30);  // Trigger must be held high for >20 µs
-                digitalWrite(_triggerPin, LOW);
+    // Read whatever has arrived without waiting for more.  The sonar sends
+    // "R" followed by the range digits and a carriage return; like
+    // Stream::parseInt(), skip anything before the first digit and stop at
+    // the first non-digit after it.
+    while (_stream->available() && _rangeState == MEASUREMENT_PENDING) {
+        int c = _stream->read();
+        if (c >= '0' && c <= '9') {
+            // NOTE:  Stop adding digits before overflowing; anything that
+            // long is garbage and will be rejected anyway
+            if (_partialRange < 3276) {
+                _partialRange = _partialRange * 10 + (c - '0');
             }
+            _rangeDigitsRead = true;
+        } else if (_rangeDigitsRead) {
+            finishRangeAttempt(_partialRange);
+        }
+    }
 
-            // Immediately ask for a result and let the stream timeout be our
-            // "wait" for the measurement.
-            result = _stream->parseInt();
-            _stream->read();  // To throw away the carriage return
-            MS_DBG(F("  Sonar Range:"), result);
-            rangeAttempts++;
-
-            // If it cannot obtain a result , the sonar is supposed to send a
-            // value just above it's max range.  For 10m models, this is 9999,
-            // for 5m models it's 4999.  The sonar might also send readings of
-            // 300 or 500 (the blanking distance) if there are too many acoustic
-            // echos. If the result becomes garbled or the sonar is
-            // disconnected, the parseInt function returns 0.  Luckily, these
-            // sensors are not capable of reading 0, so we also know the 0 value
-            // is bad.
-            if (result <= 300 || result == 500 || result == 4999 ||
-                result == 9999 || result == 0) {
-                MS_DBG(F("  Bad or Suspicious Result, Retry Attempt #"),
-                       rangeAttempts);
-                result = -9999;
-            } else {
-                MS_DBG(F("  Good result found"));
-                success = true;
-            }
+    // If nothing came within the stream timeout, count this attempt as bad
+    if (_rangeState == MEASUREMENT_PENDING &&
+        millis() - _millisRangeRequested > HRXL_RANGE_TIMEOUT_MS) {
+        finishRangeAttempt(_rangeDigitsRead ? _partialRange : 0);
+    }
+
+    return _rangeState;
+}
+
+
+void MaxBotixSonar::finishRangeAttempt(int16_t range) {
+    MS_DBG(F("  Sonar Range:"), range);
+    _rangeAttempts++;
+
+    // If it cannot obtain a result , the sonar is supposed to send a value
+    // just above it's max range.  For 10m models, this is 9999, for 5m models
+    // it's 4999.  The sonar might also send readings of 300 or 500 (the
+    // blanking distance) if there are too many acoustic echos. If the result
+    // becomes garbled or the sonar is disconnected, nothing is read and the
+    // range is 0.  Luckily, these sensors are not capable of reading 0, so we
+    // also know the 0 value is bad.
+    if (range <= 300 || range == 500 || range == 4999 || range == 9999) {
+        MS_DBG(F("  Bad or Suspicious Result, Retry Attempt #"),
+               _rangeAttempts);
+        if (_rangeAttempts >= HRXL_MAX_RANGE_ATTEMPTS) {
+            _rangeResult = -9999;
+            _rangeState  = MEASUREMENT_FAILED;
+        } else {
+            startRangeAttempt();
         }
     } else {
-        MS_DBG(getSensorNameAndLocation(), F("is not currently measuring!"));
+        MS_DBG(F("  Good result found"));
+        _rangeResult = range;
+        _rangeState  = MEASUREMENT_DONE;
     }
+}
 
-    verifyAndAddMeasurementResult(HRXL_VAR_NUM, result);
+
+void MaxBotixSonar::startRangeAttempt(void) {
+    // If the sonar is running on a trigger, activating the trigger should in
+    // theory happen within the startSingleMeasurement function.  Because we're
+    // really taking up to 25 measurements for each "single measurement" until
+    // a valid value is returned and the measurement time is <166ms, we'll
+    // actually activate the trigger here.
+    if (_triggerPin >= 0) {
+        MS_DBG(F("  Triggering Sonar with"), _triggerPin);
+        digitalWrite(_triggerPin, HIGH);
+        delayMicroseconds(30);  // Trigger must be held high for >20 µs
+        digitalWrite(_triggerPin, LOW);
+    }
+
+    // Start listening for the next range
+    _partialRange         = 0;
+    _rangeDigitsRead      = false;
+    _millisRangeRequested = millis();
+}
+
+
+bool MaxBotixSonar::collectResult(void) {
+    bool success = _rangeState == MEASUREMENT_DONE;
+
+    verifyAndAddMeasurementResult(HRXL_VAR_NUM, _rangeResult);
 
     // Unset the time stamp for the beginning of this measurement
     _millisMeasurementRequested = 0;
     // Unset the status bits for a measurement request (bits 5 & 6)
     _sensorStatus &= 0b10011111;
+    // Reset the range reading state
+    _rangeState           = MEASUREMENT_PENDING;
+    _rangeAttempts        = 0;
+    _rangeResult          = -9999;
+    _millisRangeRequested = 0;
 
     // Return values shows if we got a not-obviously-bad reading
     return success;
 }
+
+
+uint32_t MaxBotixSonar::getMillisUntilNextStep(void) {
+    // While waiting on characters, check back on the next tick
+    if (bitRead(_sensorStatus, 6) && _rangeState == MEASUREMENT_PENDING &&
+        _millisRangeRequested != 0 && !_stream->available()) {
+        return 1;
+    }
+    return Sensor::getMillisUntilNextStep();
+}
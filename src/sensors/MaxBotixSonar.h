@@ -137,6 +137,11 @@
 #define HRXL_RESOLUTION 0
 /// Variable number; range is stored in sensorValues[0].
 #define HRXL_VAR_NUM 0
+/// The longest to wait for a range to arrive from the sonar; slightly more
+/// than the 166ms between readings from even the slowest sensors.
+#define HRXL_RANGE_TIMEOUT_MS 180
+/// The number of ranges to read while looking for one that isn't obviously bad
+#define HRXL_MAX_RANGE_ATTEMPTS 25
 
 /* clang-format off */
 /**
@@ -207,14 +212,75 @@ class MaxBotixSonar : public Sensor {
      */
     bool wake(void) override;
 
+    /**
+     * @copydoc Sensor::startSingleMeasurement()
+     */
+    bool startSingleMeasurement(void) override;
     /**
      * @copydoc Sensor::addSingleMeasurementResult()
+     *
+     * For the MaxSonar, this blocks on pollMeasurement() until a range has
+     * been read and then runs collectResult().
      */
     bool addSingleMeasurementResult(void) override;
 
+    /**
+     * @brief Read any range characters the sonar has sent without blocking.
+     *
+     * Up to 25 ranges are read, (re-)triggering the sonar if it has a trigger
+     * pin, until one is not obviously bad.  Each range must arrive within the
+     * stream timeout (#HRXL_RANGE_TIMEOUT_MS) or it is counted as bad.
+     *
+     * @param debug True to output the result to the debugging Serial
+     * @return **measurementState** #MEASUREMENT_PENDING while waiting on the
+     * sonar, #MEASUREMENT_DONE once a good range is read, or
+     * #MEASUREMENT_FAILED if no measurement was started or all attempts were
+     * bad.
+     */
+    measurementState pollMeasurement(bool debug = false) override;
+    /**
+     * @brief Add the range read by pollMeasurement() to the result array.
+     *
+     * @return **bool** True if the range was not obviously bad.
+     */
+    bool collectResult(void) override;
+    /**
+     * @copydoc Sensor::getMillisUntilNextStep()
+     *
+     * While waiting on characters from the sonar this asks to be polled again
+     * on the next millisecond tick.
+     */
+    uint32_t getMillisUntilNextStep(void) override;
+
  private:
+    /**
+     * @brief Start a range attempt - trigger the sonar, if it has a trigger,
+     * and start listening for a range.
+     */
+    void startRangeAttempt(void);
+    /**
+     * @brief Finish one range attempt, either starting another attempt or
+     * marking the measurement done.
+     *
+     * @param range The range read from the sonar; 0 if nothing was read.
+     */
+    void finishRangeAttempt(int16_t range);
+
     int8_t  _triggerPin;
     Stream* _stream;
+
+    /// The state of the range reading in progress
+    measurementState _rangeState;
+    /// The number of ranges read so far for this measurement
+    uint8_t _rangeAttempts;
+    /// The range result for this measurement
+    int16_t _rangeResult;
+    /// The digits received so far for the range being read
+    int16_t _partialRange;
+    /// True if any digits have been received for the range being read
+    bool _rangeDigitsRead;
+    /// The processor time the current range attempt began
+    uint32_t _millisRangeRequested;
 };
 
 
@@ -0,0 +1,337 @@
+/**
+ * @file binary_log_to_csv.cpp
+ * @copyright 2020 Stroud Water Research Center
+ * Part of the EnviroDIY ModularSensors library for Arduino
+ *
+ * @brief A desktop program to convert a binary log file written by a logger
+ * using Logger::setLogFileFormat(LOG_FILE_BINARY) into the same CSV layout the
+ * logger writes by default.
+ *
+ * This is NOT an Arduino sketch.  Build it with any C++11 compiler:
+ *
+ *     g++ -std=c++11 -O2 -o binary_log_to_csv binary_log_to_csv.cpp
+ *
+ * and run it with:
+ *
+ *     binary_log_to_csv LOGGER_2020-01-01.bin [LOGGER_2020-01-01.csv]
+ *
+ * If no output file is given, the CSV is written to standard output.  The file
+ * is converted one record at a time, so files of any size can be converted.
+ * Records with a bad CRC are skipped and counted; a partial record at the end
+ * of the file (from a power loss mid-write) is ignored.  Conversion stops at
+ * the first erased (all 0x00 or all 0xFF) record, which is space the logger
+ * reserved for the file but never reached.
+ *
+ * Files written with the record journal on also carry a record number in each
+ * record.  These are converted with the same two extra columns the logger
+ * writes to a journaled text file: the record number and the CRC-32 of the
+ * text of the row before the final comma.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+// These must match LoggerBase.h
+#define MS_BINARY_LOG_MAGIC "MSLB"
+#define MS_BINARY_LOG_VERSION 1
+#define MS_BINARY_LOG_VERSION_JOURNAL 2
+// This must match the size of the value strings in VariableArray.h
+#define MS_VALUE_STRING_LENGTH 14
+
+
+struct variableInfo {
+    uint8_t     resolution;
+    std::string sensorName;
+    std::string varName;
+    std::string varUnit;
+    std::string uuid;
+    std::string code;
+};
+
+struct fileHeader {
+    uint8_t                   version;
+    int8_t                    timeZone;
+    uint16_t                  recordSize;
+    std::string               loggerID;
+    std::string               fileName;
+    std::string               samplingFeatureUUID;
+    std::vector<variableInfo> variables;
+};
+
+
+// The same reflected CRC-32 as Logger::updateCRC32()
+static uint32_t updateCRC32(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Preallocated files are erased to one of these before data is written
+static bool isErased(const uint8_t* bytes, size_t length) {
+    if (bytes[0] != 0x00 && bytes[0] != 0xFF) return false;
+    for (size_t i = 1; i < length; i++) {
+        if (bytes[i] != bytes[0]) return false;
+    }
+    return true;
+}
+
+// The file is little-endian regardless of the machine doing the conversion
+static uint32_t readLE32(const uint8_t* bytes) {
+    return static_cast<uint32_t>(bytes[0]) |
+        (static_cast<uint32_t>(bytes[1]) << 8) |
+        (static_cast<uint32_t>(bytes[2]) << 16) |
+        (static_cast<uint32_t>(bytes[3]) << 24);
+}
+static float readFloat(const uint8_t* bytes) {
+    uint32_t raw = readLE32(bytes);
+    float    value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+
+static bool readBytes(FILE* in, uint8_t* buffer, size_t length,
+                      uint32_t& crc) {
+    if (fread(buffer, 1, length, in) != length) return false;
+    crc = updateCRC32(crc, buffer, length);
+    return true;
+}
+static bool readString(FILE* in, std::string& text, uint32_t& crc) {
+    text.clear();
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        uint8_t byte = static_cast<uint8_t>(c);
+        crc          = updateCRC32(crc, &byte, 1);
+        if (byte == '\0') return true;
+        text += static_cast<char>(byte);
+    }
+    return false;
+}
+
+
+static bool readHeader(FILE* in, fileHeader& header) {
+    uint32_t crc = 0;
+    uint8_t  fixed[9];
+    if (!readBytes(in, fixed, sizeof(fixed), crc)) return false;
+    if (memcmp(fixed, MS_BINARY_LOG_MAGIC, 4) != 0) {
+        fprintf(stderr, "Not a ModularSensors binary log file\n");
+        return false;
+    }
+    header.version = fixed[4];
+    if (header.version != MS_BINARY_LOG_VERSION &&
+        header.version != MS_BINARY_LOG_VERSION_JOURNAL) {
+        fprintf(stderr, "Unsupported binary log version %u\n", header.version);
+        return false;
+    }
+    uint8_t variableCount = fixed[5];
+    header.timeZone       = static_cast<int8_t>(fixed[6]);
+    header.recordSize     = static_cast<uint16_t>(fixed[7] | (fixed[8] << 8));
+    // Journaled records add a record number after the time
+    uint16_t fixedSize = 8;
+    if (header.version == MS_BINARY_LOG_VERSION_JOURNAL) fixedSize += 4;
+    if (header.recordSize != fixedSize + 4 * variableCount) {
+        fprintf(stderr, "Record size %u does not match %u variables\n",
+                header.recordSize, variableCount);
+        return false;
+    }
+
+    if (!readString(in, header.loggerID, crc) ||
+        !readString(in, header.fileName, crc) ||
+        !readString(in, header.samplingFeatureUUID, crc)) {
+        return false;
+    }
+    header.variables.resize(variableCount);
+    for (uint8_t i = 0; i < variableCount; i++) {
+        variableInfo& var = header.variables[i];
+        if (!readBytes(in, &var.resolution, 1, crc) ||
+            !readString(in, var.sensorName, crc) ||
+            !readString(in, var.varName, crc) ||
+            !readString(in, var.varUnit, crc) ||
+            !readString(in, var.uuid, crc) || !readString(in, var.code, crc)) {
+            return false;
+        }
+    }
+
+    uint8_t storedCRC[4];
+    if (fread(storedCRC, 1, 4, in) != 4) return false;
+    if (readLE32(storedCRC) != crc) {
+        fprintf(stderr, "The file header is corrupt (bad CRC)\n");
+        return false;
+    }
+    return true;
+}
+
+
+// Arduino's println() ends lines with a carriage return and a line feed
+#define CSV_EOL "\r\n"
+
+// The same rows as Logger::printFileHeader()
+static void writeCSVRow(FILE* out, const char* firstCol,
+                        const fileHeader&  header,
+                        std::string variableInfo::*field,
+                        const char*                 journalCols) {
+    fprintf(out, "\"%s\",", firstCol);
+    for (size_t i = 0; i < header.variables.size(); i++) {
+        fprintf(out, "\"%s\"", (header.variables[i].*field).c_str());
+        if (i + 1 != header.variables.size()) fputc(',', out);
+    }
+    if (header.version == MS_BINARY_LOG_VERSION_JOURNAL) {
+        fputs(journalCols, out);
+    }
+    fputs(CSV_EOL, out);
+}
+static void writeCSVHeader(FILE* out, const fileHeader& header) {
+    fprintf(out, "Data Logger: %s" CSV_EOL, header.loggerID.c_str());
+    fprintf(out, "Data Logger File: %s" CSV_EOL, header.fileName.c_str());
+    if (header.samplingFeatureUUID.length() > 1) {
+        fprintf(out, "Sampling Feature UUID: %s," CSV_EOL,
+                header.samplingFeatureUUID.c_str());
+    }
+    writeCSVRow(out, "Sensor Name:", header, &variableInfo::sensorName,
+                ",\"Logger\",\"Logger\"");
+    writeCSVRow(out, "Variable Name:", header, &variableInfo::varName,
+                ",\"Record Number\",\"Record CRC32\"");
+    writeCSVRow(out, "Result Unit:", header, &variableInfo::varUnit,
+                ",\"count\",\"dimensionless\"");
+    if (!header.variables.empty() && header.variables[0].uuid.length() > 1) {
+        writeCSVRow(out, "Result UUID:", header, &variableInfo::uuid,
+                    ",\"\",\"\"");
+    }
+    char dtRowHeader[32];
+    if (header.timeZone > 0) {
+        snprintf(dtRowHeader, sizeof(dtRowHeader), "Date and Time in UTC+%d",
+                 header.timeZone);
+    } else if (header.timeZone < 0) {
+        snprintf(dtRowHeader, sizeof(dtRowHeader), "Date and Time in UTC%d",
+                 header.timeZone);
+    } else {
+        snprintf(dtRowHeader, sizeof(dtRowHeader), "Date and Time in UTC");
+    }
+    writeCSVRow(out, dtRowHeader, header, &variableInfo::code,
+                ",\"RecordNumber\",\"RecordCRC32\"");
+}
+
+
+// The same text as Variable::formatValue()
+static void formatValue(char* buffer, float value, uint8_t resolution) {
+    char formatted[64];
+    if (resolution == 0) {
+        snprintf(formatted, sizeof(formatted), "%d",
+                 static_cast<int16_t>(value));
+    } else {
+        snprintf(formatted, sizeof(formatted), "%.*f", resolution, value);
+    }
+    if (strlen(formatted) >= MS_VALUE_STRING_LENGTH) {
+        strcpy(buffer, "-9999");
+    } else {
+        strcpy(buffer, formatted);
+    }
+}
+
+// The same row as Logger::printSensorDataCSV()
+static void writeCSVRecord(FILE* out, const fileHeader& header,
+                           const uint8_t* record) {
+    // The time is already in the logger's time zone, so print it as UTC
+    time_t    epoch = static_cast<time_t>(readLE32(record));
+    struct tm dt;
+    gmtime_r(&epoch, &dt);
+    char dateTime[24];
+    strftime(dateTime, sizeof(dateTime), "%Y-%m-%d %H:%M:%S", &dt);
+    std::string row = dateTime;
+
+    bool           journaled = header.version == MS_BINARY_LOG_VERSION_JOURNAL;
+    const uint8_t* values    = record + (journaled ? 8 : 4);
+    char           value[MS_VALUE_STRING_LENGTH];
+    for (size_t i = 0; i < header.variables.size(); i++) {
+        formatValue(value, readFloat(values + 4 * i),
+                    header.variables[i].resolution);
+        row += ',';
+        row += value;
+    }
+    if (journaled) {
+        char number[12];
+        snprintf(number, sizeof(number), ",%lu",
+                 static_cast<unsigned long>(readLE32(record + 4)));
+        row += number;
+        uint32_t crc = updateCRC32(
+            0, reinterpret_cast<const uint8_t*>(row.data()), row.size());
+        snprintf(number, sizeof(number), ",%08lX",
+                 static_cast<unsigned long>(crc));
+        row += number;
+    }
+    fputs(row.c_str(), out);
+    fputs(CSV_EOL, out);
+}
+
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s input.bin [output.csv]\n", argv[0]);
+        return 2;
+    }
+    FILE* in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        fprintf(stderr, "Unable to open %s\n", argv[1]);
+        return 1;
+    }
+    FILE* out = stdout;
+    if (argc == 3) {
+        out = fopen(argv[2], "wb");
+        if (out == NULL) {
+            fprintf(stderr, "Unable to create %s\n", argv[2]);
+            fclose(in);
+            return 1;
+        }
+    }
+
+    fileHeader header;
+    if (!readHeader(in, header)) {
+        fprintf(stderr, "Unable to read the header of %s\n", argv[1]);
+        fclose(in);
+        if (out != stdout) fclose(out);
+        return 1;
+    }
+    writeCSVHeader(out, header);
+
+    std::vector<uint8_t> record(header.recordSize);
+    size_t               dataSize  = header.recordSize - 4;
+    unsigned long        converted = 0;
+    unsigned long        corrupt   = 0;
+    size_t               bytesRead;
+    while ((bytesRead = fread(record.data(), 1, record.size(), in)) ==
+           record.size()) {
+        if (isErased(record.data(), record.size())) {
+            bytesRead = 0;
+            break;
+        }
+        if (updateCRC32(0, record.data(), dataSize) !=
+            readLE32(record.data() + dataSize)) {
+            corrupt++;
+            continue;
+        }
+        writeCSVRecord(out, header, record.data());
+        converted++;
+    }
+
+    fprintf(stderr, "Converted %lu records", converted);
+    if (corrupt > 0) fprintf(stderr, ", skipped %lu with a bad CRC", corrupt);
+    if (bytesRead > 0) {
+        fprintf(stderr, ", ignored a partial record of %u bytes",
+                static_cast<unsigned>(bytesRead));
+    }
+    fprintf(stderr, "\n");
+
+    fclose(in);
+    if (out != stdout) fclose(out);
+    return 0;
+}
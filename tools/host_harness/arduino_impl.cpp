@@ -0,0 +1,111 @@
+// Host versions of the Arduino core functions the library uses.  String is
+// built on a std::string kept in a side table, so the stand-in String class in
+// stubs/Arduino.h has no members of its own.  millis() advances one
+// millisecond for every 100 calls, so busy-wait loops finish, and delay()
+// advances it by the full time at once.  g_millis counts on past 32 bits, but
+// millis() and micros() wrap as they do on a board.
+#include <cstdio>
+#include <map>
+#include <string>
+#include <Arduino.h>
+#undef min
+#undef max
+
+static std::map<const String*, std::string> g_map;
+static std::string& S(const String* s) { return g_map[s]; }
+String::String(const char* s) { S(this) = s ? s : ""; }
+String::String(const String& o) { S(this) = S(&o); }
+String::String(char c) { S(this) = std::string(1, c); }
+String::String(int v, unsigned char b) { char buf[40]; snprintf(buf, 40, b==16?"%x":"%d", v); S(this)=buf; }
+String::String(unsigned int v, unsigned char b) { char buf[40]; snprintf(buf, 40, b==16?"%x":"%u", v); S(this)=buf; }
+String::String(long v, unsigned char b) { char buf[40]; snprintf(buf, 40, b==16?"%lx":"%ld", v); S(this)=buf; }
+String::String(unsigned long v, unsigned char b) { char buf[40]; snprintf(buf, 40, b==16?"%lx":"%lu", v); S(this)=buf; }
+String::String(float v, unsigned char d) { char buf[60]; snprintf(buf, 60, "%.*f", d, v); S(this)=buf; }
+String::String(double v, unsigned char d) { char buf[60]; snprintf(buf, 60, "%.*f", d, v); S(this)=buf; }
+String::~String() { g_map.erase(this); }
+String& String::operator=(const String& o) { S(this) = std::string(S(&o)); return *this; }
+String& String::operator=(const char* o) { S(this) = o; return *this; }
+unsigned int String::length() const { return S(this).size(); }
+const char* String::c_str() const { return S(this).c_str(); }
+String String::substring(unsigned int a, unsigned int b) const { if (b > length()) b = length(); if (a > b) a = b; return String(S(this).substr(a, b - a).c_str()); }
+String String::substring(unsigned int a) const { return substring(a, length()); }
+int String::indexOf(char c) const { auto p = S(this).find(c); return p == std::string::npos ? -1 : (int)p; }
+int String::indexOf(const String& c) const { auto p = S(this).find(S(&c)); return p == std::string::npos ? -1 : (int)p; }
+long String::toInt() const { return atol(c_str()); }
+float String::toFloat() const { return atof(c_str()); }
+void String::trim() {}
+bool String::reserve(unsigned int) { return true; }
+bool String::concat(const String& o) { S(this) += S(&o); return true; }
+char String::charAt(unsigned int i) const { return S(this)[i]; }
+char String::operator[](unsigned int i) const { return S(this)[i]; }
+char& String::operator[](unsigned int i) { return S(this)[i]; }
+bool String::equals(const String& o) const { return S(this) == S(&o); }
+bool String::operator==(const String& o) const { return S(this) == S(&o); }
+bool String::operator!=(const String& o) const { return S(this) != S(&o); }
+bool String::operator==(const char* o) const { return S(this) == o; }
+bool String::operator!=(const char* o) const { return S(this) != o; }
+String& String::operator+=(const String& o) { S(this) += std::string(S(&o)); return *this; }
+String& String::operator+=(const char* o) { S(this) += o; return *this; }
+String& String::operator+=(char o) { S(this) += o; return *this; }
+String& String::operator+=(int o) { S(this) += String(o).c_str(); return *this; }
+String& String::operator+=(long o) { S(this) += String(o).c_str(); return *this; }
+String& String::operator+=(unsigned long o) { S(this) += String(o).c_str(); return *this; }
+String& String::operator+=(unsigned int o) { S(this) += String(o).c_str(); return *this; }
+void String::toCharArray(char* b, unsigned int n, unsigned int idx) const { strncpy(b, c_str() + idx, n - 1); b[n-1] = 0; }
+String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+String operator+(const String& a, char b) { String r(a); r += b; return r; }
+String operator+(const String& a, int b) { String r(a); r += b; return r; }
+String operator+(const String& a, long b) { String r(a); r += b; return r; }
+String operator+(const String& a, unsigned long b) { String r(a); r += b; return r; }
+String operator+(const String& a, unsigned int b) { String r(a); r += b; return r; }
+String operator+(const String& a, float b) { String r(a); r += String(b); return r; }
+String operator+(const String& a, double b) { String r(a); r += String(b); return r; }
+size_t Print::write(const uint8_t* b, size_t n) { size_t c = 0; while (n--) c += write(*b++); return c; }
+size_t Print::write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+size_t Print::print(const String& s) { return write(s.c_str()); }
+size_t Print::print(const char* s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+// Numbers are formatted on the stack, as the real Print does, so they don't
+// show up as heap use in heap_check
+size_t Print::print(unsigned char v, int b) { return print((unsigned int)v, b); }
+size_t Print::print(int v, int b) { char buf[40]; snprintf(buf, 40, b==16?"%x":"%d", v); return write(buf); }
+size_t Print::print(unsigned int v, int b) { char buf[40]; snprintf(buf, 40, b==16?"%x":"%u", v); return write(buf); }
+size_t Print::print(long v, int b) { char buf[40]; snprintf(buf, 40, b==16?"%lx":"%ld", v); return write(buf); }
+size_t Print::print(unsigned long v, int b) { char buf[40]; snprintf(buf, 40, b==16?"%lx":"%lu", v); return write(buf); }
+size_t Print::print(double v, int d) { char buf[60]; snprintf(buf, 60, "%.*f", d, v); return write(buf); }
+size_t Print::println() { return write("\n"); }
+size_t Print::println(const String& s) { return print(s) + println(); }
+size_t Print::println(const char* s) { return print(s) + println(); }
+size_t Print::println(char s) { return print(s) + println(); }
+size_t Print::println(unsigned char v, int b) { return print(v, b) + println(); }
+size_t Print::println(int v, int b) { return print(v, b) + println(); }
+size_t Print::println(unsigned int v, int b) { return print(v, b) + println(); }
+size_t Print::println(long v, int b) { return print(v, b) + println(); }
+size_t Print::println(unsigned long v, int b) { return print(v, b) + println(); }
+size_t Print::println(double v, int b) { return print(v, b) + println(); }
+void HardwareSerial::begin(unsigned long) {}
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+size_t HardwareSerial::write(uint8_t c) { fputc(c, stdout); return 1; }
+HardwareSerial::operator bool() { return true; }
+HardwareSerial Serial;
+unsigned long g_millis = 0;
+unsigned long g_active = 0;
+unsigned long g_calls = 0;
+unsigned long millis() { g_calls++; if (g_calls % 100 == 0) g_millis++; return (uint32_t)g_millis; }
+unsigned long micros() { return (uint32_t)(g_millis * 1000); }
+void delay(unsigned long ms) { g_millis += ms; }
+void delayMicroseconds(unsigned int) {}
+void yield() { g_millis += 1; }
+uint8_t g_pins[256];
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t p, uint8_t v) { g_pins[p] = v; }
+int digitalRead(uint8_t p) { return g_pins[p]; }
+volatile uint8_t g_port;
+volatile uint8_t* portInputRegister(int) { return &g_port; }
+char* dtostrf(double v, signed char w, unsigned char p, char* b) { sprintf(b, "%*.*f", w, p, v); return b; }
+char* itoa(int v, char* b, int) { sprintf(b, "%d", v); return b; }
+char* ltoa(long v, char* b, int) { sprintf(b, "%ld", v); return b; }
@@ -0,0 +1,131 @@
+// Host driver for the robust averaging modes of Sensor.
+//
+// Feeds a stand-in sensor synthetic noisy streams: a true value with Gaussian
+// noise, a share of large one-sided spikes, and a share of failed (-9999)
+// readings.  For each averaging mode it prints the RMS error of the result
+// against the true value over many updates, the host time to combine one
+// update's measurements, and the RAM the mode needs.  It fails if a robust
+// mode does worse than the mean on a spiky stream, if the modes differ on a
+// clean stream, or if setting a robust mode without a buffer is not refused.
+//
+// usage: averaging_modes [updates]
+// Run it with run_averaging_modes.sh rather than by hand.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+class StreamSensor : public Sensor {
+ public:
+    StreamSensor() : Sensor("Stream", 1) {}
+    bool addSingleMeasurementResult() override { return true; }
+};
+
+struct Stream_ {
+    const char* name;
+    double      noise;       // standard deviation of the noise
+    double      spikeShare;  // share of readings that are spikes
+    double      spikeSize;   // how far above the true value a spike reads
+    double      failShare;   // share of readings that fail (-9999)
+};
+
+int main(int argc, char** argv) {
+    int updates = argc > 1 ? atoi(argv[1]) : 2000;
+    const double trueValue = 100;
+    const int    counts[] = {10, 25, 50};
+    const Stream_ streams[] = {{"clean", 0, 0, 0, 0},
+                               {"noisy", 1, 0, 0, 0.05},
+                               {"spiky", 1, 0.1, 50, 0.05}};
+    const averagingMode modes[] = {AVERAGE_MEAN, AVERAGE_MEDIAN,
+                                   AVERAGE_TRIMMED_MEAN,
+                                   AVERAGE_REJECT_OUTLIERS};
+    const char*  modeNames[]  = {"mean", "median", "trimmed 20%",
+                                 "reject > 5"};
+    const float  parameters[] = {0, 0, 20, 5};
+    bool         ok           = true;
+
+    // Setting a robust mode before attaching a buffer must be refused
+    StreamSensor early;
+    if (early.setAveragingMode(AVERAGE_MEDIAN) ||
+        early.getAveragingMode() != AVERAGE_MEAN) {
+        fprintf(stderr, "FAIL a robust mode was accepted without a buffer\n");
+        ok = false;
+    }
+
+    fprintf(stderr, "RAM on this computer: Sensor %u bytes; averagingState %u "
+                    "bytes plus 4 per kept measurement, only when attached\n",
+            (unsigned)sizeof(Sensor), (unsigned)sizeof(averagingState));
+    for (int n : counts) {
+        StaticAveragingState<50> state;
+        fprintf(stderr, "\n%d measurements per update (buffer %u bytes)\n", n,
+                (unsigned)(sizeof(averagingState) + n * sizeof(float)));
+        for (const Stream_& st : streams) {
+            double rms[4];
+            for (int m = 0; m < 4; m++) {
+                std::mt19937                     gen(1234);
+                std::normal_distribution<double> noise(0, st.noise);
+                std::uniform_real_distribution<double> u(0, 1);
+                StreamSensor s;
+                s.setAveragingBuffer(&state);
+                s.setAveragingMode(modes[m], parameters[m]);
+                double sumSq = 0, nanos = 0;
+                for (int k = 0; k < updates; k++) {
+                    s.clearValues();
+                    for (int i = 0; i < n; i++) {
+                        double v = trueValue + noise(gen);
+                        if (u(gen) < st.spikeShare) v += st.spikeSize;
+                        if (u(gen) < st.failShare) v = -9999;
+                        s.verifyAndAddMeasurementResult((uint8_t)0, (float)v);
+                    }
+                    auto t0 = std::chrono::steady_clock::now();
+                    s.averageMeasurements();
+                    auto t1 = std::chrono::steady_clock::now();
+                    nanos += std::chrono::duration<double, std::nano>(t1 - t0)
+                                 .count();
+                    double e = s.sensorValues[0] - trueValue;
+                    sumSq += e * e;
+                }
+                rms[m] = sqrt(sumSq / updates);
+                fprintf(stderr,
+                        "  %-6s %-12s RMS error %8.4f | %6.0f ns to combine\n",
+                        st.name, modeNames[m], rms[m], nanos / updates);
+            }
+            if (st.spikeShare > 0) {
+                for (int m = 1; m < 4; m++) {
+                    if (rms[m] >= rms[0]) {
+                        fprintf(stderr, "FAIL %s is no better than the mean\n",
+                                modeNames[m]);
+                        ok = false;
+                    }
+                }
+            }
+            if (st.noise == 0 && st.spikeShare == 0) {
+                for (int m = 0; m < 4; m++) {
+                    if (rms[m] > 1e-4) {
+                        fprintf(stderr, "FAIL %s is off on a clean stream\n",
+                                modeNames[m]);
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    fprintf(stderr, "\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+// Host versions of the AVR sleep calls.  Each sleep_mode() stands for one
+// timer tick asleep and is counted in g_slept.
+#include <avr/sleep.h>
+extern unsigned long g_millis;
+void set_sleep_mode(int) {}
+unsigned long g_slept = 0;
+void sleep_mode() { g_millis += 1; g_slept += 1; }
+volatile uint8_t ADCSRA, MCUCR;
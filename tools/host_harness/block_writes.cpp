@@ -0,0 +1,108 @@
+// Host driver for the card writes made by each logged record, with and
+// without the RAM log buffer.
+//
+// Logs the same records with Logger::logToSD() to the in-memory card, first
+// straight to the file and then through log buffers flushed every few
+// records.  The card counts the 512 byte blocks written through its model of
+// SdFat's block cache, including directory entry updates, and each card
+// start.  It prints both per record and fails if a buffered file differs from
+// the unbuffered one or if buffering doesn't save writes.
+//
+// usage: block_writes [records]
+// Run it with run_block_writes.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+float g_a = 0, g_b = 0, g_c = 0;
+float fa() { return g_a; }
+float fb() { return g_b; }
+float fc() { return g_c; }
+
+// Logs the records and returns the file; recordsPerFlush 0 is unbuffered
+std::vector<uint8_t> logRecords(int records, uint8_t recordsPerFlush,
+                                double& writesPerRecord,
+                                double& startsPerRecord,
+                                size_t& headerBytes) {
+    clearCard();
+    srand(1234);
+    g_rtc = 1600000000UL - 1600000000UL % 900;
+
+    Variable* vars[] = {new Variable(fa, 2, "a", "u", "A", ""),
+                        new Variable(fb, 1, "b", "u", "B", ""),
+                        new Variable(fc, 3, "c", "u", "C", "")};
+    StaticVariableArray<3> va(vars);
+    Logger                 lg("BLOCKS", 15, &va);
+    lg.setSDCardSS(1);
+    lg.setLoggerTimeZone(0);
+    lg.setFileName("blocks.csv");
+    lg.setSamplingFeatureUUID("12345678-abcd-1234-ef00-1234567890ab");
+    static uint8_t logBuffer[2048];
+    if (recordsPerFlush > 0) {
+        lg.setLogBuffer(logBuffer, sizeof(logBuffer), recordsPerFlush);
+    }
+    lg.begin();
+    // Leave the header out of the counts
+    lg.createLogFile(true);
+    unsigned long writes0 = g_blockWrites, starts0 = g_cardStarts;
+    headerBytes           = disk["blocks.csv"].size();
+
+    for (int r = 0; r < records; r++) {
+        g_rtc += 900;
+        Logger::resetClockCache();
+        lg.markTime();
+        g_a = (rand() % 10000) / 100.0f;
+        g_b = (rand() % 1000) / 10.0f;
+        g_c = (rand() % 10000) / 1000.0f;
+        va.completeUpdate();
+        lg.logToSD();
+    }
+    lg.flushLogBuffer();
+    writesPerRecord = (double)(g_blockWrites - writes0) / records;
+    startsPerRecord = (double)(g_cardStarts - starts0) / records;
+    for (int i = 0; i < 3; i++) delete vars[i];
+    return disk["blocks.csv"];
+}
+
+int main(int argc, char** argv) {
+    int  records = argc > 1 ? atoi(argv[1]) : 96;
+    bool ok      = true;
+
+    double               writes, starts;
+    size_t               header;
+    std::vector<uint8_t> straight = logRecords(records, 0, writes, starts,
+                                               header);
+    fprintf(stderr, "%d records of %u bytes after a %u byte header\n",
+            records, (unsigned)((straight.size() - header) / records),
+            (unsigned)header);
+    fprintf(stderr, "  unbuffered        %5.2f block writes, %5.2f card starts "
+                    "per record\n",
+            writes, starts);
+    double unbuffered = writes;
+    const uint8_t batches[] = {4, 12, 24};
+    for (uint8_t n : batches) {
+        std::vector<uint8_t> buffered = logRecords(records, n, writes, starts,
+                                                   header);
+        bool same = buffered == straight;
+        fprintf(stderr, "  buffer of %2u      %5.2f block writes, %5.2f card "
+                        "starts per record, file %s\n",
+                n, writes, starts, same ? "identical" : "DIFFERENT");
+        if (!same || writes >= unbuffered) ok = false;
+    }
+    fprintf(stderr, "%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
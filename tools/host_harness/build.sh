@@ -0,0 +1,20 @@
+#!/bin/sh
+# Builds one of the host drivers in this folder against the library in ../../src
+# with the stand-in Arduino headers in stubs/.  This is NOT part of the library
+# and needs only a C++11 compiler; nothing here runs on a logger.
+#
+# usage: build.sh driver.cpp output [more sources or compiler flags]
+HERE=$(cd "$(dirname "$0")" && pwd)
+S="$HERE/../../src"
+DRIVER=$1
+OUT=$2
+shift 2
+exec g++ -std=gnu++11 -O1 -D__AVR__ -DARDUINO_ARCH_AVR \
+    -DSTANDARD_SERIAL_OUTPUT=Serial -I"$HERE/stubs" -I"$HERE" -I"$S" "$@" \
+    -o "$OUT" "$DRIVER" \
+    "$S/LoggerBase.cpp" "$S/LoggerModem.cpp" "$S/VariableArray.cpp" \
+    "$S/VariableBase.cpp" "$S/SensorBase.cpp" "$S/LogBuffer.cpp" \
+    "$S/EnergyLedger.cpp" "$S/StatisticVariable.cpp" "$S/ProcessorIdle.cpp" \
+    "$S/dataPublisherBase.cpp" "$S/publishers/EnviroDIYPublisher.cpp" \
+    "$S/publishers/DreamHostPublisher.cpp" \
+    "$HERE/arduino_impl.cpp" "$HERE/avr_sleep_impl.cpp"
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+# Checks the log of fake_portal.py against the records the driver logged:
+# every record reached each publisher with the right values, with the first
+# arrivals in time order.  Duplicates are counted but allowed, since delivery
+# is at least once.
+#
+# usage: check_queue.py queue_expect.txt portal_log [token,token...]
+import json, sys
+
+rows = [l.split() for l in open(sys.argv[1])]
+tokens = sys.argv[3].split(",") if len(sys.argv) > 3 else ["token-one", "token-two"]
+got = {}
+for line in open(sys.argv[2]):
+    r = json.loads(line)
+    p = r["payload"]
+    if r["token"] == "dreamhost":
+        got.setdefault("dreamhost", []).append(
+            (p["timestamp"], p["A"], p["B"]))
+    else:
+        got.setdefault(r["token"], []).append(
+            (p["timestamp"], "%s" % p["12345678-abcd-1234-ef00-1234567890ab"],
+             "%s" % p["12345678-abcd-1234-ef00-1234567890ac"]))
+ok = True
+for token in tokens:
+    if len(rows[0]) == 4:
+        expect = [[r[1], r[2], r[3]] if token == "dreamhost" else [r[0], r[2], r[3]] for r in rows]
+    else:
+        expect = rows
+    arrivals = got.get(token, [])
+    times = [a[0] for a in arrivals]
+    firsts = []
+    seen = set()
+    for t in times:
+        if t not in seen:
+            seen.add(t)
+            firsts.append(t)
+    missing = [e for e in expect if e[0] not in seen]
+    dupes = len(times) - len(seen)
+    ordered = firsts == sorted(firsts, key=lambda t: int(t) if t.isdigit() else t)
+    # Values must match what was logged at that time
+    byTime = {e[0]: e for e in expect}
+    wrong = [a for a in arrivals
+             if abs(float(a[1]) - float(byTime[a[0]][1])) > 0.001 or
+             float(a[2]) != float(byTime[a[0]][2])]
+    print("%s: %d records, %d arrivals, %d missing, %d duplicates, oldest-first %s, wrong values %d"
+          % (token, len(expect), len(times), len(missing), dupes, ordered, len(wrong)))
+    ok = ok and not missing and ordered and not wrong
+sys.exit(0 if ok else 1)
@@ -0,0 +1,216 @@
+// Host driver for the clock drift fit, the sync schedule it sets, and the
+// drift compensation steps.
+//
+// Runs a year of 5-minute Logger::logDataAndPublish() cycles against a
+// stand-in clock that runs fast by a set number of parts per million, with a
+// stand-in modem that takes 10 to 40 s to connect and gives the true time
+// cut to the second, like AT+CCLK.  The cases are daily syncs as before,
+// drift tracking, tracking with compensation, a drift that swings with the
+// seasons, and a reset part way through the year.
+//
+// Each case prints the syncs made, the compensation steps, the worst and RMS
+// clock error at the marked times, and the fitted drift against the true one.
+// For the steps it also prints the clock reads per step, since each one waits
+// for the clock's next tick.  It fails if tracking doesn't cut the syncs, if
+// the error passes the 5 s limit, or if a step reads the clock more than a few
+// hundred times.
+//
+// usage: clock_drift [days]
+// Run it with run_clock_drift.sh rather than by hand.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "LoggerModem.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+extern unsigned long g_millis;
+
+// True time at the last marked time, and the millis() then
+double        g_markTrue   = 0;
+unsigned long g_markMillis = 0;
+unsigned long g_queries    = 0;
+double trueNow() {
+    return g_markTrue + (g_millis - g_markMillis) / 1000.0;
+}
+double rtcNow() {
+    return g_rtc + (g_millis - g_rtcSetMillis) / 1000.0;
+}
+
+// Connects slowly and gives the true time, cut to the second
+class TimeModem : public loggerModem {
+ public:
+    bool awake = false;
+    TimeModem()
+        : loggerModem(10, -1, HIGH, -1, LOW, 0, -1, HIGH, 0, 0, 0, 500,
+                      5000) {
+        _modemName = "Time";
+    }
+    bool modemWake() override {
+        if (_millisPowerOn == 0) modemPowerUp();
+        delay(3000);
+        awake = true;
+        return true;
+    }
+    bool connectInternet(uint32_t) override {
+        delay(10000 + rand() % 30001);
+        return true;
+    }
+    void     disconnectInternet() override { delay(500); }
+    uint32_t getModemNetworkTime() override {
+        delay(35);
+        g_queries++;
+        return static_cast<uint32_t>(floor(trueNow()));
+    }
+    bool     syncModemClockSNTP() override { return false; }
+    uint32_t getNISTTime() override { return 0; }
+    bool     getModemSignalQuality(int16_t& rssi, int16_t& percent) override {
+        rssi    = -70;
+        percent = 60;
+        return true;
+    }
+    bool getModemBatteryStats(uint8_t& c, int8_t& p, uint16_t& m) override {
+        c = 0;
+        p = 0;
+        m = 0;
+        return true;
+    }
+    float getModemChipTemperature() override { return 25; }
+    bool  modemSleepPowerDown() override {
+        delay(1500);
+        _millisPowerOn = 0;
+        awake          = false;
+        return true;
+    }
+    bool isInternetAvailable() override { return awake; }
+    bool modemSleepFxn() override { return true; }
+    bool modemWakeFxn() override { return true; }
+    bool extraModemSetup() override { return true; }
+    bool isModemAwake() override { return awake; }
+};
+
+float fa() { return 1; }
+
+struct DriftCase {
+    const char* label;
+    bool        track;
+    bool        compensate;
+    double      ppm;
+    double      seasonalPpm;  // the size of a yearly swing in the drift
+    int         resetDay;     // -1 for none
+};
+
+Logger* makeLogger(VariableArray& va, TimeModem& modem, const DriftCase& c) {
+    Logger* lg = new Logger("DRIFT", 5, &va);
+    lg->setSDCardSS(1);
+    lg->setSamplingFeatureUUID("12345678-abcd-1234-ef00-1234567890ff");
+    lg->setLoggerTimeZone(0);
+    lg->attachModem(modem);
+    if (c.track) lg->setClockDriftTracking(true, c.compensate, 5);
+    lg->begin();
+    return lg;
+}
+
+// Runs a case and returns the number of syncs; ok is cleared on a failure
+unsigned long runCase(const DriftCase& c, int days, bool& ok) {
+    clearCard();
+    srand(5);
+    g_rtcTicks           = true;
+    Variable*     vars[] = {new Variable(fa, 0, "a", "u", "A", "")};
+    VariableArray va(1, vars);
+    TimeModem     modem;
+    Logger*       lg = makeLogger(va, modem, c);
+
+    // Start one interval before noon, the clock 0.3 s fast
+    g_rtc          = 1600000000UL - 1600000000UL % 86400 + 43200 - 300;
+    g_rtcSetMillis = g_millis;
+    double        rtcErr = 0.3, lastMark = g_rtc;
+    double        worst = 0, sumSq = 0;
+    unsigned long syncs = 0, steps = 0, stepReads = 0;
+    int           cycles = days * 288;
+    for (int i = 0; i < cycles; i++) {
+        double rate = 1e-6 *
+            (c.ppm + c.seasonalPpm * sin(2 * M_PI * i / (365.0 * 288)));
+        // The next alarm, by the clock's own time; the clock drifts while
+        // the logger is awake, too
+        uint32_t mark = static_cast<uint32_t>(floor(rtcNow())) / 300 * 300 +
+            300;
+        rtcErr += (mark - rtcNow()) * rate + (rtcNow() - lastMark) * rate;
+        lastMark       = mark;
+        g_rtc          = mark;
+        g_rtcSetMillis = g_millis;
+        g_markTrue     = mark - rtcErr;
+        g_markMillis   = g_millis;
+        Logger::resetClockCache();
+        if (fabs(rtcErr) > worst) worst = fabs(rtcErr);
+        sumSq += rtcErr * rtcErr;
+        if (i == c.resetDay * 288) {
+            delete lg;
+            lg = makeLogger(va, modem, c);
+        }
+
+        unsigned long queries = g_queries, sets = g_rtcSets;
+        unsigned long reads   = g_rtcReads;
+        lg->logDataAndPublish();
+        if (g_queries != queries) {
+            syncs++;
+        } else if (g_rtcSets != sets) {
+            steps++;
+            stepReads += g_rtcReads - reads;
+        }
+        rtcErr = rtcNow() - trueNow();
+    }
+    double fitted = lg->getClockDrift();
+    fprintf(stderr,
+            "  %-26s %4lu syncs, %3lu steps, worst error %4.2f s, rms %4.2f "
+            "s, fitted %+.3f s/day (true %+.3f)\n",
+            c.label, syncs, steps, worst, sqrt(sumSq / cycles), fitted,
+            c.ppm * 0.0864);
+    if (steps > 0) {
+        fprintf(stderr, "  %-26s %4lu clock reads per step\n", "",
+                stepReads / steps);
+        if (stepReads / steps > 300) ok = false;
+    }
+    if (worst > 5) ok = false;
+    g_rtcTicks = false;
+    delete lg;
+    delete vars[0];
+    return syncs;
+}
+
+int main(int argc, char** argv) {
+    int  days = argc > 1 ? atoi(argv[1]) : 365;
+    bool ok   = true;
+    fprintf(stderr, "%d days of 5-minute cycles, syncs at noon, 5 s limit\n",
+            days);
+    const DriftCase cases[] = {
+        {"daily syncs, 2 ppm", false, false, 2, 0, -1},
+        {"tracking, 2 ppm", true, false, 2, 0, -1},
+        {"compensating, 20 ppm", true, true, 20, 0, -1},
+        {"compensating, 2 +-3 ppm", true, true, 2, 3, -1},
+        {"compensating, 20 ppm, reset", true, true, 20, 0, days / 2}};
+    unsigned long daily = 0;
+    for (const DriftCase& c : cases) {
+        unsigned long syncs = runCase(c, days, ok);
+        if (!c.track) {
+            daily = syncs;
+        } else if (syncs >= daily) {
+            ok = false;
+        }
+    }
+    fprintf(stderr, "%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
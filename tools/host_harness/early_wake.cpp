@@ -0,0 +1,170 @@
+// Host driver for Logger::setEarlyModemWake() on the SIM7000 class.
+//
+// Runs a day of 5-minute Logger::logDataAndPublish() cycles, each one
+// publishing, with the modem woken after the sensor update and then with it
+// woken before.  The TinyGSM stand-in in tinygsm_time/ takes 10 to 40 s,
+// chosen at random for each cycle, to register after the module boots, and
+// the network sends its time.  One sensor is quick and the other is slow,
+// like a turbidity sensor with a wiper: 2 s to warm up, 10 s to stabilize,
+// and five 1.5 s measurements.  The client answers each post after a
+// cellular round trip.
+//
+// For each mode it prints the time the logger is awake per cycle, the worst
+// cycle, the time the processor is active, and how long each modem step
+// takes.  Both modes must post every cycle, and waking early must shorten
+// the average cycle.
+//
+// usage: early_wake [cycles] [seed]
+// Run it with run_early_wake.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "modems/SIMComSIM7000.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include "publishers/EnviroDIYPublisher.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+unsigned long g_regDone = 0, g_regDelay = 0, g_epochNow = 0;
+bool          g_nitz = true, g_clockSet = false, g_nistUp = true;
+float         g_netTz = 0, g_clockTz = 0;
+long          g_clockOff = 0;
+int           g_ntpPort  = 0;
+extern unsigned long g_millis;
+extern unsigned long g_slept;
+
+// Answers each post after a cellular round trip
+class SlowClient : public Client {
+ public:
+    const char*   reply = "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n";
+    int           pos   = 0;
+    bool          open  = false;
+    unsigned long posts = 0;
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char*, uint16_t) override {
+        delay(900);
+        pos  = 0;
+        open = true;
+        posts++;
+        return 1;
+    }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t n) override { return n; }
+    int available() override {
+        if (pos == 0) delay(700);
+        return strlen(reply) - pos;
+    }
+    int read() override { return reply[pos] ? reply[pos++] : -1; }
+    int read(uint8_t* b, size_t n) override {
+        size_t i = 0;
+        while (i < n && reply[pos]) b[i++] = reply[pos++];
+        return i;
+    }
+    int     peek() override { return reply[pos] ? reply[pos] : -1; }
+    void    flush() override {}
+    void    stop() override { open = false; }
+    uint8_t connected() override { return open; }
+    operator bool() override { return true; }
+};
+IPAddress::IPAddress() {}
+
+// A sensor with one value and set warm-up, stabilization and measurement times
+class TimedSensor : public Sensor {
+ public:
+    TimedSensor(const char* name, uint32_t warmUp, uint32_t stabilization,
+                uint32_t measurement, int8_t powerPin, uint8_t measurements)
+        : Sensor(name, 1, warmUp, stabilization, measurement, powerPin, -1,
+                 measurements) {}
+    String getSensorLocation() override {
+        return String("host");
+    }
+    bool addSingleMeasurementResult() override {
+        verifyAndAddMeasurementResult(0, 1.0f);
+        _millisMeasurementRequested = 0;
+        _sensorStatus &= 0b10011111;
+        return true;
+    }
+};
+
+// Runs the cycles and returns the average time awake per cycle in seconds
+double runCycles(bool early, int cycles, unsigned seed, bool& ok) {
+    srand(seed);
+    TimedSensor quick("Quick", 500, 0, 200, 5, 1);
+    TimedSensor slow("Slow", 2000, 10000, 1500, 6, 5);
+    Variable*   vars[] = {
+        new Variable(&quick, 0, 1, "x", "u", "X",
+                     "12345678-abcd-1234-ef00-1234567890a1"),
+        new Variable(&slow, 0, 1, "y", "u", "Y",
+                     "12345678-abcd-1234-ef00-1234567890a2")};
+    StaticVariableArray<2> va(vars);
+    Logger                 lg("WAKE", 5, &va);
+    lg.setLoggerTimeZone(0);
+    SIMComSIM7000 modem(&Serial, 10, -1, -1, -1, "apn");
+    lg.attachModem(modem);
+    lg.setEarlyModemWake(early);
+    SlowClient         client;
+    EnviroDIYPublisher publisher(lg, &client,
+                                 "12345678-abcd-1234-ef00-1234567890ee",
+                                 "12345678-abcd-1234-ef00-1234567890ff");
+    clearCard();
+    g_rtc = 1600000000UL - 1600000000UL % 86400;
+    Logger::resetClockCache();
+    lg.begin();
+    modem.resetPhaseTimes();
+
+    unsigned long awake = 0, worst = 0, active = 0;
+    for (int i = 0; i < cycles; i++) {
+        g_rtc += 300;
+        Logger::resetClockCache();
+        g_epochNow = g_rtc;
+        // The module was off, and takes a while to register once it boots
+        g_regDelay = 10000 + rand() % 30001;
+        g_regDone  = 0;
+        unsigned long start = g_millis, slept = g_slept;
+        lg.logDataAndPublish();
+        unsigned long took = g_millis - start;
+        awake += took;
+        if (took > worst) worst = took;
+        active += took - (g_slept - slept);
+    }
+    fprintf(stderr,
+            "%-10s %5.1f s awake per cycle (worst %4.1f), processor active "
+            "%5.1f s, %lu of %d cycles posted\n",
+            early ? "early wake" : "sequential", awake / 1000.0 / cycles,
+            worst / 1000.0, active / 1000.0 / cycles, client.posts, cycles);
+    const char* steps[] = {"wake", "connect", "time sync", "shutdown"};
+    for (int p = 0; p < MODEM_PHASE_NONE; p++) {
+        fprintf(stderr, "    %-9s %6.2f s, %6.2f s active per cycle\n",
+                steps[p],
+                modem.getPhaseTime(static_cast<modemPhase>(p)) / 1000.0 /
+                    cycles,
+                modem.getPhaseActiveTime(static_cast<modemPhase>(p)) /
+                    1000.0 / cycles);
+    }
+    if (client.posts < static_cast<unsigned long>(cycles)) ok = false;
+    for (int i = 0; i < 2; i++) delete vars[i];
+    return awake / 1000.0 / cycles;
+}
+
+int main(int argc, char** argv) {
+    int      cycles = argc > 1 ? atoi(argv[1]) : 288;
+    unsigned seed   = argc > 2 ? atoi(argv[2]) : 1;
+    bool     ok     = true;
+
+    double sequential = runCycles(false, cycles, seed, ok);
+    double early      = runCycles(true, cycles, seed, ok);
+    if (early >= sequential) ok = false;
+    fprintf(stderr, "%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+# Local UDP NTP stand-in for the SNTP path of time_sources.cpp.  It answers
+# in the mode written to the file ntp.mode in the working directory, and stops
+# after 60 s without a request.
+# usage: fake_ntp.py port ; control by writing a mode to ntp.mode:
+#   ok | drop | kod | skew <seconds>
+import os, socket, struct, sys, time
+
+port = int(sys.argv[1])
+s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+s.bind(("127.0.0.1", port))
+print("ready", flush=True)
+served = 0
+s.settimeout(60)
+while True:
+    try:
+        req, addr = s.recvfrom(512)
+    except socket.timeout:
+        break
+    mode = open("ntp.mode").read().split() if os.path.exists("ntp.mode") else ["ok"]
+    if len(req) < 48 or (req[0] & 7) != 3:
+        continue  # not a client request
+    if mode[0] == "drop":
+        continue
+    skew = float(mode[1]) if mode[0] == "skew" else 0.0
+    now = time.time() + skew + 2208988800
+    secs, frac = int(now), int((now % 1) * 2**32)
+    stratum = 0 if mode[0] == "kod" else 2
+    li = 3 if mode[0] == "kod" else 0
+    reply = struct.pack("!BBbb", (li << 6) | (4 << 3) | 4, stratum, 6, -20)
+    reply += struct.pack("!II", 0, 0) + (b"RATE" if stratum == 0 else b"GPS\0")
+    reply += struct.pack("!II", secs, frac)          # reference
+    reply += req[40:48]                              # originate
+    reply += struct.pack("!II", secs, frac) * 2      # receive, transmit
+    s.sendto(reply, addr)
+    served += 1
+print("served", served, file=sys.stderr, flush=True)
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+# Stand-in for the EnviroDIY portal and the DreamHost receiver that fails a
+# share of the requests three ways: a 500 response, a close with no answer, and
+# an accepted request whose answer is never sent.  Connections are kept alive
+# and pipelined requests are accepted, one thread per connection.  Every record
+# received is written to the log as a line of JSON.  While a file named
+# portal.calm exists in the working directory nothing fails.  The counts are
+# printed to stderr when it is stopped or after 30 s without a connection.
+#
+# usage: fake_portal.py port fail_share log_file [seed]
+import json, os, random, signal, socket, sys, threading
+from urllib.parse import urlparse, parse_qs
+
+port = int(sys.argv[1])
+fail_rate = float(sys.argv[2])
+log = open(sys.argv[3], "w")
+rng = random.Random(int(sys.argv[4]) if len(sys.argv) > 4 else 1)
+lock = threading.Lock()
+stats = {"ok": 0, "500": 0, "drop": 0, "lost": 0, "connections": 0,
+         "requests": 0, "reused": 0, "pipelined": 0, "max_open": 0,
+         "bytes_in": 0, "bytes_out": 0}
+open_now = [0]
+
+
+def reply(conn, text):
+    with lock:
+        stats["bytes_out"] += len(text)
+    conn.sendall(text)
+
+
+def record(token, payload):
+    # A batch is logged as one entry per timestamp
+    ts = payload["timestamp"]
+    if isinstance(ts, list):
+        for k, t in enumerate(ts):
+            one = {"timestamp": t}
+            for key, v in payload.items():
+                if key not in ("timestamp", "sampling_feature"):
+                    assert len(v) == len(ts), "list lengths differ"
+                    one[key] = v[k]
+            log.write(json.dumps({"token": token, "payload": one}) + "\n")
+    else:
+        log.write(json.dumps({"token": token, "payload": payload}) + "\n")
+    log.flush()
+
+
+def recv(conn):
+    chunk = conn.recv(4096)
+    with lock:
+        stats["bytes_in"] += len(chunk)
+    return chunk
+
+
+def handle(conn):
+    conn.settimeout(5)
+    data = b""
+    with lock:
+        stats["connections"] += 1
+        open_now[0] += 1
+        stats["max_open"] = max(stats["max_open"], open_now[0])
+    served = 0
+    try:
+        while True:
+            while b"\r\n\r\n" not in data:
+                chunk = recv(conn)
+                if not chunk:
+                    return
+                data += chunk
+            head, data = data.split(b"\r\n\r\n", 1)
+            lines = head.split(b"\r\n")
+            # A stray line break between requests is allowed
+            while lines and lines[0] == b"":
+                lines.pop(0)
+            method, target, _ = lines[0].split(b" ")
+            headers = {}
+            for line in lines[1:]:
+                k, v = line.split(b":", 1)
+                headers[k.strip().lower()] = v.strip()
+            length = int(headers.get(b"content-length", b"0"))
+            while len(data) < length:
+                chunk = recv(conn)
+                if not chunk:
+                    return
+                data += chunk
+            body, data = data[:length], data[length:]
+            # The EnviroDIY publisher ends its post with an extra line break
+            if data.startswith(b"\r\n"):
+                data = data[2:]
+            with lock:
+                stats["requests"] += 1
+                if served:
+                    stats["reused"] += 1
+                if b"\r\n\r\n" in data:
+                    stats["pipelined"] += 1  # the next one already arrived
+                roll = rng.random()
+                if os.path.exists("portal.calm"):
+                    roll = 1.0
+                if roll < fail_rate / 3:
+                    stats["500"] += 1
+                elif roll < 2 * fail_rate / 3:
+                    stats["drop"] += 1  # close without answering
+                    return
+                elif method == b"GET":
+                    q = parse_qs(urlparse(target.decode()).query)
+                    payload = {"timestamp": q.pop("Loggertime")[0]}
+                    q.pop("LoggerID")
+                    for k, v in q.items():
+                        payload[k] = v[0]
+                    record("dreamhost", payload)
+                else:
+                    # Parse strictly: a wrong Content-Length shows up here
+                    record(headers[b"token"].decode(),
+                           json.loads(body.decode()))
+                if fail_rate / 3 <= roll < fail_rate:
+                    stats["lost"] += 1  # accepted, the answer never arrives
+                    return
+                if roll >= fail_rate:
+                    stats["ok"] += 1
+            served += 1
+            if roll < fail_rate / 3:
+                reply(conn, b"HTTP/1.1 500 Internal Server Error\r\n"
+                            b"Content-Length: 5\r\n\r\noops\n")
+            else:
+                reply(conn, b"HTTP/1.1 201 Created\r\n"
+                            b"Content-Length: 2\r\n\r\nok")
+    except (ConnectionResetError, BrokenPipeError, socket.timeout):
+        pass  # the client closed without reading the whole response
+    except Exception as e:
+        print("error", repr(e), file=sys.stderr)
+    finally:
+        conn.close()
+        with lock:
+            open_now[0] -= 1
+
+
+def stop(*_):
+    print(json.dumps(stats), file=sys.stderr, flush=True)
+    sys.exit(0)
+
+
+signal.signal(signal.SIGTERM, stop)
+srv = socket.socket()
+srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+srv.bind(("127.0.0.1", port))
+srv.listen(8)
+print("ready", flush=True)
+srv.settimeout(1)
+idle = 0
+while idle < 30:
+    try:
+        conn, _ = srv.accept()
+    except socket.timeout:
+        idle += 1
+        continue
+    idle = 0
+    threading.Thread(target=handle, args=(conn,), daemon=True).start()
+stop()
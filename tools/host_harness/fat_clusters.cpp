@@ -0,0 +1,220 @@
+// Host driver for the FAT work of appending records, and for finding the end
+// of the data in a preallocated file after a restart.
+//
+// The first part logs a month of 15-minute records with Logger::logToSD() to
+// one growing file, to daily files, and to daily files preallocated with
+// createContiguous().  The in-memory card's FAT model counts the clusters
+// allocated and the FAT entries read to seek to the end of the file, and the
+// counts are printed per append.
+//
+// The second part fills preallocated CSV and binary files with a few or many
+// records over space erased to 0x00 or to 0xFF, then starts a new logger, as
+// after a reset, and appends one more record.  The new logger has to find
+// where the data ends by itself.  The record must land right after the old
+// data, with nothing overwritten and no gap.  The bytes read by the search are
+// printed.
+//
+// usage: fat_clusters [days]
+// Run it with run_fat_clusters.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+// Shows where the logger thinks the data ends
+class OpenLogger : public Logger {
+ public:
+    using Logger::Logger;
+    uint32_t dataEnd() {
+        return _fileDataEnd;
+    }
+};
+
+float g_values[6];
+float f0() { return g_values[0]; }
+float f1() { return g_values[1]; }
+float f2() { return g_values[2]; }
+float f3() { return g_values[3]; }
+float f4() { return g_values[4]; }
+float f5() { return g_values[5]; }
+
+// 2020-03-01 00:00:00
+const uint32_t start = 1583020800UL;
+
+// Logs a month of records and prints the FAT work per append
+void countClusters(const char* label, logRotation rotation, uint32_t fileBytes,
+                   int days) {
+    clearCard();
+    srand(99);
+    Variable* vars[] = {new Variable(f0, 2, "a", "u", "A", ""),
+                        new Variable(f1, 2, "b", "u", "B", ""),
+                        new Variable(f2, 1, "c", "u", "C", ""),
+                        new Variable(f3, 3, "d", "u", "D", ""),
+                        new Variable(f4, 0, "e", "u", "E", ""),
+                        new Variable(f5, 2, "f", "u", "F", "")};
+    StaticVariableArray<6> va(vars);
+    Logger                 lg("FAT", 15, &va);
+    lg.setSDCardSS(1);
+    lg.setLoggerTimeZone(0);
+    lg.setSamplingFeatureUUID("12345678-abcd-1234-ef00-1234567890ab");
+    lg.setLogRotation(rotation, fileBytes);
+    g_rtc = start;
+    Logger::resetClockCache();
+    lg.begin();
+
+    int           records = days * 96;
+    unsigned long appendAllocations = 0, createAllocations = 0;
+    unsigned long fatReads0 = g_fatReads;
+    for (int r = 0; r < records; r++) {
+        g_rtc = start + r * 900UL;
+        Logger::resetClockCache();
+        lg.markTime();
+        for (int i = 0; i < 6; i++) g_values[i] = (rand() % 100000) / 100.0f;
+        va.completeUpdate();
+        size_t        files       = disk.size();
+        unsigned long allocations = g_clusterAllocations;
+        lg.logToSD();
+        if (disk.size() > files) {
+            createAllocations += g_clusterAllocations - allocations;
+        } else {
+            appendAllocations += g_clusterAllocations - allocations;
+        }
+    }
+    for (int i = 0; i < 6; i++) delete vars[i];
+    fprintf(stderr,
+            "  %-26s %3u files | per append: %.3f clusters allocated, %.2f "
+            "FAT entries read | %lu clusters allocated with new files\n",
+            label, (unsigned)disk.size(), (double)appendAllocations / records,
+            (double)(g_fatReads - fatReads0) / records, createAllocations);
+}
+
+// Fills a preallocated file, restarts, appends one record, and checks where
+// it went.  Returns true if it's right after the old data.
+bool findDataEnd(logFileFormat format, uint8_t fill, int records,
+                 unsigned long& bytesRead) {
+    clearCard();
+    eraseFill    = fill;
+    Variable* vars[] = {new Variable(f0, 2, "a", "u", "A", ""),
+                        new Variable(f1, 0, "b", "u", "B", ""),
+                        new Variable(f2, 3, "c", "u", "C", "")};
+    StaticVariableArray<3> va(vars);
+    // Zero readings put zero bytes in binary records
+    g_values[0] = 0;
+    g_values[1] = 12;
+    g_values[2] = 0;
+    g_rtc       = start;
+    Logger::resetClockCache();
+
+    uint32_t    oldEnd;
+    std::string name;
+    {
+        OpenLogger lg("END", 1, &va);
+        lg.setSDCardSS(1);
+        lg.setLoggerTimeZone(0);
+        lg.setSamplingFeatureUUID("12345678-abcd-1234-ef00-1234567890ab");
+        lg.setLogFileFormat(format);
+        lg.setLogRotation(LOG_ROTATE_DAILY, 65536);
+        lg.begin();
+        lg.createLogFile(true);
+        for (int r = 0; r < records; r++) {
+            g_rtc = start + r * 60UL;
+            Logger::resetClockCache();
+            lg.markTime();
+            va.completeUpdate();
+            lg.logToSD();
+        }
+        name   = lg.getFileName().c_str();
+        oldEnd = lg.dataEnd();
+        if (records == 0) oldEnd = disk[name].size();
+    }
+    // For a file with no records, where the header ends
+    if (records == 0) {
+        oldEnd = 0;
+        while (oldEnd < disk[name].size() && disk[name][oldEnd] != fill) {
+            oldEnd++;
+        }
+        if (format == LOG_FILE_BINARY) oldEnd = 0;
+    }
+    std::vector<uint8_t> before = disk[name];
+
+    // A new logger, as after a reset, adds one more record
+    g_rtc = start + records * 60UL;
+    Logger::resetClockCache();
+    OpenLogger lg("END", 1, &va);
+    lg.setSDCardSS(1);
+    lg.setLoggerTimeZone(0);
+    lg.setSamplingFeatureUUID("12345678-abcd-1234-ef00-1234567890ab");
+    lg.setLogFileFormat(format);
+    lg.setLogRotation(LOG_ROTATE_DAILY, 65536);
+    lg.begin();
+    lg.markTime();
+    va.completeUpdate();
+    unsigned long reads0 = g_bytesRead;
+    lg.logToSD();
+    bytesRead                  = g_bytesRead - reads0;
+    std::vector<uint8_t> after = disk[name];
+    uint32_t             end   = lg.dataEnd();
+    for (int i = 0; i < 3; i++) delete vars[i];
+
+    // The header of a new binary file is only known from the file itself
+    if (records == 0 && format == LOG_FILE_BINARY) {
+        return end > 0 && end < after.size() && after[end] == fill;
+    }
+    if (lg.getFileName() != name.c_str() || end <= oldEnd ||
+        end >= after.size()) {
+        return false;
+    }
+    // The old data kept, the new record straight after it, then erased space
+    for (uint32_t i = 0; i < oldEnd; i++) {
+        if (after[i] != before[i]) return false;
+    }
+    for (uint32_t i = end; i < after.size(); i++) {
+        if (after[i] != fill) return false;
+    }
+    return before[oldEnd] == fill && after[oldEnd] != fill;
+}
+
+int main(int argc, char** argv) {
+    int  days = argc > 1 ? atoi(argv[1]) : 31;
+    bool ok   = true;
+
+    fprintf(stderr, "%d days of 15-minute records, 32 KiB clusters\n", days);
+    countClusters("one growing file", LOG_ROTATE_NEVER, 0, days);
+    countClusters("daily files", LOG_ROTATE_DAILY, 0, days);
+    countClusters("daily preallocated 64 KiB", LOG_ROTATE_DAILY, 65536, days);
+
+    fprintf(stderr, "\nfinding the end of the data after a restart\n");
+    const logFileFormat formats[] = {LOG_FILE_CSV, LOG_FILE_BINARY};
+    const uint8_t       fills[]   = {0x00, 0xFF};
+    const int           counts[]  = {0, 1, 7, 500};
+    for (logFileFormat format : formats) {
+        for (uint8_t fill : fills) {
+            for (int records : counts) {
+                unsigned long reads;
+                bool right = findDataEnd(format, fill, records, reads);
+                fprintf(stderr,
+                        "  %-6s erased to 0x%02X, %3d records: %s, %lu "
+                        "bytes read\n",
+                        format == LOG_FILE_BINARY ? "binary" : "CSV", fill,
+                        records, right ? "right" : "WRONG", reads);
+                ok &= right;
+            }
+        }
+    }
+    eraseFill = 0xFF;
+    fprintf(stderr, "%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+// Host driver that fails on any heap allocation made by the library during a
+// full log-and-publish cycle.
+//
+// malloc() and its relatives are replaced with versions that count every
+// allocation made while the trap is armed, except those made by the host
+// stand-ins themselves (marked with a HostHeap in host_stubs.inc).  On the
+// host the stand-in String keeps its text in a std::string, so every String
+// the library builds is caught too.  One cycle runs first with the trap off,
+// so files are created and the C library sets up its own buffers; then
+// Logger::logDataAndPublish() runs with a stand-in modem, an EnviroDIY
+// publisher, the publish queue, the log buffer and the record journal, and
+// each allocation is printed with where it came from.
+//
+// usage: heap_check [cycles]
+// Run it with run_heap_check.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <execinfo.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "LoggerModem.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include "publishers/EnviroDIYPublisher.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+// ---------------- the allocation trap ----------------
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void  __libc_free(void*);
+
+static bool   g_armed  = false;
+static bool   g_inTrap = false;
+unsigned long g_libraryAllocations = 0;
+
+static void noteAllocation(size_t n) {
+    if (!g_armed || g_hostHeap > 0 || g_inTrap) return;
+    g_inTrap = true;
+    g_libraryAllocations++;
+    // Only the first few, so one String in a loop doesn't flood the output
+    if (g_libraryAllocations <= 5) {
+        fprintf(stderr, "HEAP allocation of %lu bytes from:\n",
+                (unsigned long)n);
+        void* frames[24];
+        int   count = backtrace(frames, 24);
+        backtrace_symbols_fd(frames, count, 2);
+    }
+    g_inTrap = false;
+}
+extern "C" void* malloc(size_t n) {
+    noteAllocation(n);
+    return __libc_malloc(n);
+}
+extern "C" void* calloc(size_t k, size_t n) {
+    noteAllocation(k * n);
+    return __libc_calloc(k, n);
+}
+extern "C" void* realloc(void* p, size_t n) {
+    noteAllocation(n);
+    return __libc_realloc(p, n);
+}
+extern "C" void free(void* p) {
+    __libc_free(p);
+}
+
+// ---------------- stand-ins for the modem and the network ----------------
+extern unsigned long g_millis;
+
+class ScriptModem : public loggerModem {
+ public:
+    bool awake = false;
+    ScriptModem()
+        : loggerModem(10, -1, HIGH, -1, LOW, 0, -1, HIGH, 0, 0, 0, 500,
+                      5000) {
+        _modemName = "Script";
+    }
+    bool modemWake() override {
+        if (_millisPowerOn == 0) modemPowerUp();
+        delay(3500);
+        awake = true;
+        return true;
+    }
+    bool connectInternet(uint32_t) override {
+        delay(1500);
+        return true;
+    }
+    void     disconnectInternet() override { delay(800); }
+    uint32_t getNISTTime() override { return 0; }
+    uint32_t getModemNetworkTime() override { return 0; }
+    bool     syncModemClockSNTP() override { return false; }
+    bool     getModemSignalQuality(int16_t& rssi, int16_t& percent) override {
+        rssi    = -70;
+        percent = 60;
+        return true;
+    }
+    bool getModemBatteryStats(uint8_t& c, int8_t& p, uint16_t& m) override {
+        c = 0;
+        p = 0;
+        m = 0;
+        return true;
+    }
+    float getModemChipTemperature() override { return 25; }
+    bool  modemSleepPowerDown() override {
+        _millisPowerOn = 0;
+        awake          = false;
+        return true;
+    }
+    bool isInternetAvailable() override { return awake; }
+    bool modemSleepFxn() override { return true; }
+    bool modemWakeFxn() override { return true; }
+    bool extraModemSetup() override { return true; }
+    bool isModemAwake() override { return awake; }
+};
+
+// Answers every request with "201 Created"
+class AcceptingClient : public Client {
+ public:
+    const char* reply = "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n";
+    int         pos   = 0;
+    bool        open  = false;
+    unsigned long requests = 0;
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char*, uint16_t) override {
+        open = true;
+        return 1;
+    }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t n) override {
+        if (pos != 0 || requests == 0) requests++;
+        pos = 0;
+        return n;
+    }
+    int available() override { return strlen(reply) - pos; }
+    int read() override { return reply[pos] ? reply[pos++] : -1; }
+    int read(uint8_t* b, size_t n) override {
+        size_t i = 0;
+        while (i < n && reply[pos]) b[i++] = reply[pos++];
+        return i;
+    }
+    int     peek() override { return reply[pos] ? reply[pos] : -1; }
+    void    flush() override {}
+    void    stop() override { open = false; }
+    uint8_t connected() override { return open; }
+    operator bool() override { return true; }
+};
+IPAddress::IPAddress() {}
+
+// A sensor with one value and a short measurement
+class QuickSensor : public Sensor {
+ public:
+    QuickSensor() : Sensor("Quick", 2, 100, 0, 200, 5, -1, 3) {}
+    bool addSingleMeasurementResult() override {
+        verifyAndAddMeasurementResult(0, (float)(rand() % 1000) / 10);
+        verifyAndAddMeasurementResult(1, (float)(rand() % 100));
+        _millisMeasurementRequested = 0;
+        _sensorStatus &= 0b10011111;
+        return true;
+    }
+};
+
+int main(int argc, char** argv) {
+    int cycles = argc > 1 ? atoi(argv[1]) : 24;
+    // backtrace() loads its helper library on first use
+    void* frame;
+    backtrace(&frame, 1);
+
+    QuickSensor sensor;
+    Variable*   vars[] = {
+        new Variable(&sensor, 0, 1, "temperature", "degreeCelsius", "T",
+                     "12345678-abcd-1234-ef00-1234567890a1"),
+        new Variable(&sensor, 1, 0, "count", "count", "N",
+                     "12345678-abcd-1234-ef00-1234567890a2")};
+    StaticVariableArray<2> va(vars);
+    Logger                 lg("HEAP", 5, &va);
+    lg.setLoggerTimeZone(0);
+    lg.setRTCWakePin(7);
+    lg.setSDCardSS(1);
+    static uint8_t logBuffer[512];
+    lg.setLogBuffer(logBuffer, sizeof(logBuffer), 3);
+    lg.setLogJournal(true);
+    lg.setPublishQueue(true, 100, 0);
+    ScriptModem modem;
+    lg.attachModem(modem);
+    AcceptingClient    client;
+    EnviroDIYPublisher publisher(lg, &client,
+                                 "12345678-abcd-1234-ef00-1234567890tk",
+                                 "12345678-abcd-1234-ef00-1234567890ff");
+    lg.begin();
+    g_rtc = 1600000000UL - 1600000000UL % 300;
+
+    for (int c = 0; c <= cycles; c++) {
+        g_rtc += 300;
+        Logger::resetClockCache();
+        // The first cycle creates the files and runs untrapped
+        g_armed = c > 0;
+        lg.logDataAndPublish();
+        g_armed = false;
+    }
+    fprintf(stderr,
+            "%d cycles, %lu requests sent, %lu heap allocations by the "
+            "library\n",
+            cycles, client.requests, g_libraryAllocations);
+    return g_libraryAllocations == 0 ? 0 : 1;
+}
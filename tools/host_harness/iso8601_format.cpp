@@ -0,0 +1,125 @@
+// Host microbenchmark for formatting timestamps as ISO8601 text.
+//
+// Compares Logger::formatDateTime_ISO8601(DateTime&, char*) and the cached
+// Logger::getMarkedISO8601() with the String formatter they replaced, copied
+// here on a std::string so it allocates on the heap the way String does on a
+// board.  All three must give the same text for every date and time zone
+// tried.  The times are for this computer, not a logger; only the ratios mean
+// anything.
+//
+// usage: iso8601_format [calls]
+// Run it with run_iso8601_format.sh rather than by hand.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+// The String formatter as it was, with DateTime::addToString() written out
+static void addTwo(std::string& s, int v) {
+    if (v < 10) s += '0';
+    s += std::to_string(v);
+}
+std::string formatWithString(DateTime& dt, int8_t tz) {
+    std::string dateTimeStr = std::to_string(dt.year());
+    dateTimeStr += '-';
+    addTwo(dateTimeStr, dt.month());
+    dateTimeStr += '-';
+    addTwo(dateTimeStr, dt.date());
+    dateTimeStr += ' ';
+    addTwo(dateTimeStr, dt.hour());
+    dateTimeStr += ':';
+    addTwo(dateTimeStr, dt.minute());
+    dateTimeStr += ':';
+    addTwo(dateTimeStr, dt.second());
+    dateTimeStr.replace(10, 1, "T");
+    std::string tzString = std::to_string(tz);
+    if (-24 <= tz && tz <= -10) {
+        tzString += ":00";
+    } else if (-10 < tz && tz < 0) {
+        tzString = tzString.substr(0, 1) + '0' + tzString.substr(1, 1) + ":00";
+    } else if (tz == 0) {
+        tzString = "Z";
+    } else if (0 < tz && tz < 10) {
+        tzString = "+0" + tzString + ":00";
+    } else if (10 <= tz && tz <= 24) {
+        tzString = "+" + tzString + ":00";
+    }
+    dateTimeStr += tzString;
+    return dateTimeStr;
+}
+
+volatile size_t g_sink;
+
+template <typename F>
+double nanosPerCall(int calls, F f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) f(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+        calls;
+}
+
+int main(int argc, char** argv) {
+    int          calls = argc > 1 ? atoi(argv[1]) : 2000000;
+    const int8_t zones[] = {-12, -10, -9, -5, 0, 1, 9, 10, 14};
+    int          checked = 0, mismatches = 0;
+    char         buffer[ISO8601_BUFFER_SIZE];
+
+    for (int8_t tz : zones) {
+        Logger::setLoggerTimeZone(tz);
+        for (int k = 0; k < 2000; k++) {
+            DateTime dt(2000 + k % 100, 1 + k % 12, 1 + k % 28, k % 24,
+                        k % 60, (k * 7) % 60);
+            Logger::formatDateTime_ISO8601(dt, buffer);
+            Logger::markedEpochTime = dt.getEpoch();
+            std::string expected    = formatWithString(dt, tz);
+            if (expected != buffer ||
+                expected != Logger::getMarkedISO8601()) {
+                if (mismatches++ < 5) {
+                    fprintf(stderr, "MISMATCH %s | %s | %s\n",
+                            expected.c_str(), buffer,
+                            Logger::getMarkedISO8601());
+                }
+            }
+            checked++;
+        }
+    }
+    fprintf(stderr, "%d dates in %u time zones, %d mismatches\n", checked,
+            (unsigned)(sizeof(zones) / sizeof(zones[0])), mismatches);
+
+    Logger::setLoggerTimeZone(-5);
+    DateTime dt(2020, 3, 9, 14, 5, 0);
+    double   withString = nanosPerCall(calls, [&](int i) {
+        DateTime t(dt.get() + i % 60);
+        g_sink += formatWithString(t, -5).size();
+    });
+    double intoBuffer = nanosPerCall(calls, [&](int i) {
+        DateTime t(dt.get() + i % 60);
+        Logger::formatDateTime_ISO8601(t, buffer);
+        g_sink += buffer[18];
+    });
+    // Three publishers ask for each marked time
+    double cached = nanosPerCall(calls, [&](int i) {
+        Logger::markedEpochTime = 1583762700UL + i / 3;
+        g_sink += Logger::getMarkedISO8601()[18];
+    });
+    fprintf(stderr, "String formatter      %7.1f ns per call\n", withString);
+    fprintf(stderr, "into a char buffer    %7.1f ns per call\n", intoBuffer);
+    fprintf(stderr, "cached marked time    %7.1f ns per call (3 per mark)\n",
+            cached);
+    return mismatches == 0 ? 0 : 1;
+}
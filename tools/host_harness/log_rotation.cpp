@@ -0,0 +1,132 @@
+// Host driver for daily and monthly log rotation, with and without the RAM
+// log buffer and preallocated files.
+//
+// Logs 15-minute records from before a month's end to after it, with the
+// clock running a few seconds behind each marked time the way it does while
+// the sensors are read.  Then it reads every data file back from the
+// in-memory card and checks that each row is in the file named for its own
+// day or month and that no row is lost or written twice.  Records held in the
+// log buffer over midnight are the case to watch: they must be written to the
+// old day's file before the new one is started.
+//
+// usage: log_rotation [days]
+// Run it with run_log_rotation.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+float g_a = 0;
+float fa() { return g_a; }
+
+// Logs the records and returns how many rows were in the wrong file, lost, or
+// written twice
+int checkRotation(logRotation rotation, uint8_t recordsPerFlush,
+                  uint32_t fileBytes, int days) {
+    clearCard();
+    Variable*              vars[] = {new Variable(fa, 0, "n", "u", "N", "")};
+    StaticVariableArray<1> va(vars);
+    Logger                 lg("ROT", 15, &va);
+    lg.setSDCardSS(1);
+    lg.setLoggerTimeZone(0);
+    lg.setSamplingFeatureUUID("12345678-abcd-1234-ef00-1234567890ab");
+    lg.setLogRotation(rotation, fileBytes);
+    static uint8_t logBuffer[1024];
+    lg.setLogBuffer(recordsPerFlush > 0 ? logBuffer : NULL, sizeof(logBuffer),
+                    recordsPerFlush);
+    // 2020-01-30 00:00:00, so the records pass a day's and a month's end
+    const uint32_t start = 1580342400UL;
+    g_rtc                = start;
+    Logger::resetClockCache();
+    lg.begin();
+
+    int records = days * 96;
+    for (int r = 0; r < records; r++) {
+        // Mark the time, then read the sensors for a few seconds
+        g_rtc = start + r * 900UL;
+        Logger::resetClockCache();
+        lg.markTime();
+        g_rtc += 7;
+        Logger::resetClockCache();
+        g_a = r;
+        va.completeUpdate();
+        lg.logToSD();
+    }
+    lg.flushLogBuffer();
+    delete vars[0];
+
+    // Read every row back from its file
+    size_t           periodLength = rotation == LOG_ROTATE_MONTHLY ? 7 : 10;
+    std::vector<int> seen(records, 0);
+    int              misfiled = 0, files = 0;
+    for (auto& file : disk) {
+        const std::string& name = file.first;
+        if (name.compare(0, 4, "ROT_") != 0) continue;
+        files++;
+        std::string period = name.substr(4, periodLength);
+        std::string text;
+        for (uint8_t c : file.second) {
+            if (c == 0x00 || c == 0xFF) break;  // reserved, erased space
+            text += static_cast<char>(c);
+        }
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t      end  = text.find('\n', pos);
+            std::string line = text.substr(pos, end - pos);
+            pos              = end == std::string::npos ? text.size() : end + 1;
+            if (line.empty() || line[0] < '0' || line[0] > '9') continue;
+            if (line.compare(0, periodLength, period) != 0) {
+                if (misfiled++ < 3) {
+                    fprintf(stderr, "    row %s is in %s\n",
+                            line.substr(0, 19).c_str(), name.c_str());
+                }
+            }
+            int n = atoi(line.c_str() + line.find(',') + 1);
+            if (n >= 0 && n < records) seen[n]++;
+        }
+    }
+    int lost = 0, twice = 0;
+    for (int n : seen) {
+        if (n == 0) lost++;
+        if (n > 1) twice++;
+    }
+    fprintf(stderr,
+            "  %-7s buffer %2u, preallocated %5lu: %d files, %d rows in the "
+            "wrong file, %d lost, %d written twice\n",
+            rotation == LOG_ROTATE_MONTHLY ? "monthly" : "daily",
+            recordsPerFlush, (unsigned long)fileBytes, files, misfiled, lost,
+            twice);
+    return misfiled + lost + twice;
+}
+
+int main(int argc, char** argv) {
+    int days = argc > 1 ? atoi(argv[1]) : 3;
+    int bad  = 0;
+    fprintf(stderr, "%d days of 15-minute records across a month's end\n",
+            days);
+    const logRotation rotations[] = {LOG_ROTATE_DAILY, LOG_ROTATE_MONTHLY};
+    const uint8_t     buffers[]   = {0, 5, 7, 12};
+    const uint32_t    sizes[]     = {0, 65536};
+    for (logRotation rotation : rotations) {
+        for (uint8_t n : buffers) {
+            for (uint32_t bytes : sizes) {
+                bad += checkRotation(rotation, n, bytes, days);
+            }
+        }
+    }
+    fprintf(stderr, "%s\n", bad == 0 ? "PASS" : "FAIL");
+    return bad == 0 ? 0 : 1;
+}
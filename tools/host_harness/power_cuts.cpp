@@ -0,0 +1,257 @@
+// Host driver for the record journal under power cuts.
+//
+// Each trial boots a journaling logger twelve times against the in-memory
+// card and logs a few records on every boot.  On all but the last boot the
+// power fails after a random number of bytes, and the card keeps a random
+// part of what was written since each file's last sync.  A final clean boot
+// runs the recovery on what is left.  The trials cover CSV and binary files,
+// buffered and unbuffered writes, preallocated files or not, and erased space
+// of 0x00 or 0xFF.
+//
+// After each trial the data file is read back.  It must hold only whole
+// records with good CRCs, numbered from 1 without gaps, and nothing after them
+// but erased space.  No record that was in a synced journal entry may be
+// lost.  With "norecover" the journal is deleted before every boot, so
+// nothing is recovered and the same checks are expected to fail.
+//
+// usage: power_cuts [trials] [norecover]
+// Run it with run_power_cuts.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+float g_a = 0, g_b = 0;
+float fa() { return g_a; }
+float fb() { return g_b; }
+
+// The same reflected CRC-32 as the journal
+uint32_t crc32(const uint8_t* bytes, size_t n) {
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= bytes[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+bool isErased(uint8_t c) {
+    return c == 0x00 || c == 0xFF;
+}
+
+// Checks a binary file; last is set to the last record number
+bool checkBinary(const std::vector<uint8_t>& d, uint32_t& last,
+                 std::string& why) {
+    // Skip the header: the fixed part, then the strings of the logger and of
+    // each variable, each variable's five strings followed by its resolution
+    if (d.size() < 9) {
+        why = "a partial header";
+        return false;
+    }
+    size_t   p       = 9;
+    int      strings = 3 + 5 * d[5];
+    uint16_t size    = d[7] | (d[8] << 8);
+    while (strings > 0 && p < d.size()) {
+        if (d[p++] == 0 && --strings > 0 && strings % 5 == 0) p++;
+    }
+    p += 4;
+    if (strings > 0 || p > d.size() || size <= 8) {
+        why = "a partial header";
+        return false;
+    }
+    for (; p + size <= d.size(); p += size) {
+        bool erased = isErased(d[p]);
+        for (int i = 1; erased && i < size; i++) erased = d[p + i] == d[p];
+        if (erased) break;
+        uint32_t crc, seq;
+        memcpy(&crc, &d[p + size - 4], 4);
+        memcpy(&seq, &d[p + 4], 4);
+        if (crc32(&d[p], size - 4) != crc) {
+            why = "bad CRC at byte " + std::to_string(p);
+            return false;
+        }
+        if (seq != last + 1) {
+            why = "record " + std::to_string(seq) + " after " +
+                std::to_string(last);
+            return false;
+        }
+        last = seq;
+    }
+    for (; p < d.size(); p++) {
+        if (!isErased(d[p])) {
+            why = "data after the last whole record";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks a CSV file; last is set to the last record number
+bool checkCSV(const std::vector<uint8_t>& d, uint32_t& last,
+              std::string& why) {
+    std::string s(d.begin(), d.end());
+    size_t      p = 0;
+    // Skip the header rows
+    while (p < s.size() && !isErased(s[p]) && (s[p] < '0' || s[p] > '9')) {
+        size_t e = s.find('\n', p);
+        if (e == std::string::npos) {
+            why = "a partial header";
+            return false;
+        }
+        p = e + 1;
+    }
+    while (p < s.size() && !isErased(s[p])) {
+        size_t e = s.find('\n', p);
+        if (e == std::string::npos) {
+            why = "a partial row at the end";
+            return false;
+        }
+        std::string line = s.substr(p, e - p);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t c2 = line.rfind(',');
+        size_t c1 = c2 == std::string::npos || c2 == 0
+            ? std::string::npos
+            : line.rfind(',', c2 - 1);
+        if (c1 == std::string::npos) {
+            why = "a row without a record number: " + line;
+            return false;
+        }
+        char   hex[9];
+        snprintf(hex, sizeof(hex), "%08X",
+                 crc32(reinterpret_cast<const uint8_t*>(line.data()), c2));
+        if (line.substr(c2 + 1) != hex) {
+            why = "bad CRC: " + line;
+            return false;
+        }
+        uint32_t seq = strtoul(line.c_str() + c1 + 1, NULL, 10);
+        if (seq != last + 1) {
+            why = "record " + std::to_string(seq) + " after " +
+                std::to_string(last);
+            return false;
+        }
+        last = seq;
+        p    = e + 1;
+    }
+    for (; p < s.size(); p++) {
+        if (!isErased(s[p])) {
+            why = "data after the last whole row";
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned long g_records = 0;
+
+// Boots a logger and logs records until the power fails; returns true if it
+// did
+bool boot(const char* name, bool binary, bool buffered, bool preallocated,
+          int records, bool recover) {
+    if (!recover) disk.erase(MS_JOURNAL_FILE_NAME);
+    Variable* vars[] = {new Variable(fa, 2, "a", "u", "A", ""),
+                        new Variable(fb, 0, "b", "u", "B", "")};
+    StaticVariableArray<2> va(vars);
+    Logger                 lg("CUT", 1, &va);
+    lg.setSDCardSS(1);
+    lg.setLoggerTimeZone(0);
+    lg.setSamplingFeatureUUID("12345678-abcd-1234-ef00-1234567890ab");
+    lg.setLogFileFormat(binary ? LOG_FILE_BINARY : LOG_FILE_CSV);
+    if (preallocated) lg.setLogRotation(LOG_ROTATE_NEVER, 8192);
+    static uint8_t logBuffer[400];
+    if (buffered) lg.setLogBuffer(logBuffer, sizeof(logBuffer), 4);
+    lg.setFileName(name);
+    lg.setLogJournal(true);
+    bool cut = false;
+    try {
+        lg.begin();
+        for (int r = 0; r < records; r++) {
+            g_rtc += 60;
+            Logger::resetClockCache();
+            lg.markTime();
+            g_a = (rand() % 10000) / 100.0f;
+            g_b = rand() % 100;
+            va.completeUpdate();
+            lg.logToSD();
+            g_records++;
+        }
+        lg.flushLogBuffer();
+    } catch (PowerCut&) {
+        powerFail();
+        cut = true;
+    }
+    budget = -1;
+    for (int i = 0; i < 2; i++) delete vars[i];
+    return cut;
+}
+
+int main(int argc, char** argv) {
+    int           trials   = argc > 1 ? atoi(argv[1]) : 400;
+    bool          recover  = !(argc > 2 && strcmp(argv[2], "norecover") == 0);
+    int           failures = 0;
+    unsigned long cuts     = 0;
+    srand(12345);
+    g_rtc = 1600000000UL;
+
+    for (int trial = 0; trial < trials; trial++) {
+        bool binary       = trial % 2;
+        bool buffered     = (trial / 2) % 2;
+        bool preallocated = (trial / 4) % 2;
+        const char* name  = binary ? "DATA.bin" : "DATA.csv";
+        clearCard();
+        eraseFill  = (trial / 8) % 2 ? 0xFF : 0x00;
+        durableSeq = 0;
+
+        for (int b = 0; b < 12; b++) {
+            budget = b == 11 ? -1 : 1 + rand() % 900;
+            if (boot(name, binary, buffered, preallocated, 20, recover)) {
+                cuts++;
+            }
+        }
+        // One last clean boot runs the recovery on what's left
+        boot(name, binary, buffered, preallocated, 0, recover);
+
+        uint32_t    last = 0;
+        std::string why;
+        bool        ok = true;
+        if (disk.count(name)) {
+            ok = binary ? checkBinary(disk[name], last, why)
+                        : checkCSV(disk[name], last, why);
+        }
+        if (ok && last < durableSeq) {
+            ok  = false;
+            why = "journaled up to record " + std::to_string(durableSeq) +
+                " but only " + std::to_string(last) + " left";
+        }
+        if (!ok && failures++ < 5) {
+            fprintf(stderr,
+                    "  trial %d (%s, %s, %s, erased to 0x%02X): %s\n", trial,
+                    binary ? "binary" : "CSV",
+                    buffered ? "buffered" : "unbuffered",
+                    preallocated ? "preallocated" : "growing", eraseFill,
+                    why.c_str());
+        }
+    }
+    eraseFill = 0xFF;
+    fprintf(stderr,
+            "%d trials%s: %lu records logged whole, %lu power cuts, %d trials "
+            "failed\n",
+            trials, recover ? "" : " without recovery", g_records, cuts,
+            failures);
+    fprintf(stderr, "%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// Host driver for publishers that send every X logging intervals, sharing
+// kept-alive connections.
+//
+// An EnviroDIY publisher and a DreamHost publisher send over real sockets to
+// fake_portal.py, both every X intervals and at different offsets.  Intervals
+// when neither is due only queue their record, as logDataAndPublish() does.
+// The counts of connections and bytes are printed after the requested number
+// of intervals.  Then everything left is sent, so check_queue.py can check
+// that nothing was lost.  With failures, the last 40 intervals are calm unless
+// a ninth argument is given.
+//
+// usage: publish_batch [cycles] [port] [offline share] [drain bytes]
+//        [send every X] [offset] [queue on (1/0)] [fail to the end]
+// Run it with run_publish_batch.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include "publishers/EnviroDIYPublisher.h"
+#include "publishers/DreamHostPublisher.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+int g_srvPort = 18080;
+class SocketClient : public Client {
+ public:
+    int fd = -1;
+    unsigned long connects = 0, sent = 0, received = 0;
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char*, uint16_t) override {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_port   = htons(g_srvPort);
+        inet_pton(AF_INET, "127.0.0.1", &a.sin_addr);
+        if (::connect(fd, (sockaddr*)&a, sizeof(a)) != 0) { ::close(fd); fd = -1; return 0; }
+        connects++;
+        return 1;
+    }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* b, size_t n) override { if (fd < 0) return 0; ssize_t r = send(fd, b, n, MSG_NOSIGNAL); if (r > 0) sent += r; return r < 0 ? 0 : r; }
+    int available() override {
+        if (fd < 0) return 0;
+        pollfd p{fd, POLLIN, 0};
+        poll(&p, 1, 5);
+        int n = 0; ioctl(fd, FIONREAD, &n);
+        return n;
+    }
+    int read() override { uint8_t c; if (fd < 0) return -1; pollfd p{fd, POLLIN, 0}; if (poll(&p, 1, 200) <= 0) return -1; if (recv(fd, &c, 1, 0) != 1) { return -1; } received++; return c; }
+    int read(uint8_t* b, size_t n) override { size_t i = 0; for (; i < n; i++) { int c = read(); if (c < 0) break; b[i] = c; } return i; }
+    int peek() override { return -1; }
+    void flush() override {}
+    void stop() override { if (fd >= 0) ::close(fd); fd = -1; }
+    uint8_t connected() override {
+        // Like TinyGSM: still "connected" while unread data remains
+        if (fd < 0) return 0;
+        char c; ssize_t r = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return r != 0;
+    }
+    operator bool() override { return true; }
+};
+IPAddress::IPAddress() {}
+
+float g_a = 0, g_b = 0;
+float fa() { return g_a; }
+float fb() { return g_b; }
+
+int main(int argc, char** argv) {
+    int cycles = argc > 1 ? atoi(argv[1]) : 288;
+    g_srvPort = argc > 2 ? atoi(argv[2]) : 18080;
+    double outage = argc > 3 ? atof(argv[3]) : 0;
+    uint32_t drainBytes = argc > 4 ? atol(argv[4]) : 0;
+    int everyX = argc > 5 ? atoi(argv[5]) : 1;
+    int offset = argc > 6 ? atoi(argv[6]) : 0;
+    bool queueOn = argc > 7 ? atoi(argv[7]) : 1;
+    srand(4321);
+    Variable* vars[] = {new Variable(fa, 2, "a", "u", "A", "12345678-abcd-1234-ef00-1234567890ab"),
+                        new Variable(fb, 0, "b", "u", "B", "12345678-abcd-1234-ef00-1234567890ac")};
+    StaticVariableArray<2> va(vars);
+    Logger lg("X", 5, &va);
+    lg.setSDCardSS(1);
+    lg.setLoggerTimeZone(-5);
+    SocketClient c1, c2;
+    EnviroDIYPublisher p1(lg, &c1, "token-one", "12345678-abcd-1234-ef00-1234567890ff", everyX, offset);
+    DreamHostPublisher p2(lg, &c2, "/portal/rx.php", everyX, (offset + 5) % (everyX ? everyX : 1));
+    if (queueOn) lg.setPublishQueue(true, 600, drainBytes);
+    lg.begin();
+    FILE* expect = fopen("queue_expect.txt", "w");
+    unsigned long offline = 0, maxQueue = 0, wakes = 0;
+    auto queued = [&]() -> unsigned long {
+        return disk.count(MS_PUBLISH_QUEUE_FILE_NAME) ? (disk[MS_PUBLISH_QUEUE_FILE_NAME].size() - 8) / (8 + 2 * MS_VALUE_STRING_LENGTH) : 0;
+    };
+    remove("portal.calm");
+    int cycle = 0;
+    int calmFrom = outage > 0 ? cycles - 40 : 0;
+    if (argc > 8) calmFrom = cycles;  // failures right to the end of the day
+    for (; cycle < cycles || (queued() > 0 && cycle < cycles + 3000); cycle++) {
+        if (cycle == calmFrom) fclose(fopen("portal.calm", "w"));
+        if (cycle == cycles) {
+            fprintf(stderr, "RESULT cycles %d modem wakes %lu offline %lu longest queue %lu | EnviroDIY connects %lu tx %lu rx %lu | DreamHost connects %lu tx %lu rx %lu\n",
+                    cycle, wakes, offline, maxQueue, c1.connects, c1.sent, c1.received, c2.connects, c2.sent, c2.received);
+            // Then send everything left, to check nothing was lost
+            p1.setSendFrequency(1, 0);
+            p2.setSendFrequency(1, 0);
+            lg.setPublishQueue(true, 600, 0);
+        }
+        g_rtc += 300; Logger::resetClockCache();
+        lg.markTime();
+        g_a = (rand() % 10000) / 100.0f; g_b = cycle;
+        va.completeUpdate();
+        fprintf(expect, "%s %lu %s %s\n", Logger::getMarkedISO8601(), (unsigned long)(Logger::markedEpochTime - 946684800), lg.getValueCharsAtI(0), lg.getValueCharsAtI(1));
+        // As logDataAndPublish() does: no modem unless someone is due
+        if (!lg.isPublishingDue()) {
+            lg.queueDataForRemotes();
+        } else if (cycle < calmFrom && rand() < outage * RAND_MAX) {
+            wakes++;
+            offline++;
+            lg.queueDataForRemotes();
+        } else {
+            wakes++;
+            lg.publishDataToRemotes();
+        }
+        if (queued() > maxQueue) maxQueue = queued();
+    }
+    fclose(expect);
+    fprintf(stderr, "FINAL cycles %d left %lu\n", cycle, queued());
+    return 0;
+}
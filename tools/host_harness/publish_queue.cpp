@@ -0,0 +1,129 @@
+// Host driver for the publish queue (Logger::setPublishQueue()).
+//
+// Two EnviroDIY publishers send over real sockets to fake_portal.py, which
+// fails some of the requests.  A random share of the logging intervals are
+// "offline" and only queue their record.  The last 40 intervals are always
+// online with no failures, so the queue must empty.  Every logged record is
+// written to queue_expect.txt for check_queue.py.
+//
+// usage: publish_queue [cycles] [port] [offline share] [drain bytes]
+// Run it with run_publish_queue.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include "publishers/EnviroDIYPublisher.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+int g_srvPort = 18080;
+class SocketClient : public Client {
+ public:
+    int fd = -1;
+    unsigned long connects = 0;
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char*, uint16_t) override {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_port   = htons(g_srvPort);
+        inet_pton(AF_INET, "127.0.0.1", &a.sin_addr);
+        if (::connect(fd, (sockaddr*)&a, sizeof(a)) != 0) { ::close(fd); fd = -1; return 0; }
+        connects++;
+        return 1;
+    }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* b, size_t n) override { if (fd < 0) return 0; ssize_t r = send(fd, b, n, MSG_NOSIGNAL); return r < 0 ? 0 : r; }
+    int available() override {
+        if (fd < 0) return 0;
+        pollfd p{fd, POLLIN, 0};
+        poll(&p, 1, 5);
+        int n = 0; ioctl(fd, FIONREAD, &n);
+        return n;
+    }
+    int read() override { uint8_t c; if (fd < 0) return -1; pollfd p{fd, POLLIN, 0}; if (poll(&p, 1, 200) <= 0) return -1; return recv(fd, &c, 1, 0) == 1 ? c : -1; }
+    int read(uint8_t* b, size_t n) override { size_t i = 0; for (; i < n; i++) { int c = read(); if (c < 0) break; b[i] = c; } return i; }
+    int peek() override { return -1; }
+    void flush() override {}
+    void stop() override { if (fd >= 0) ::close(fd); fd = -1; }
+    uint8_t connected() override {
+        // Like TinyGSM: still "connected" while unread data remains
+        if (fd < 0) return 0;
+        char c; ssize_t r = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        return r != 0;
+    }
+    operator bool() override { return true; }
+};
+IPAddress::IPAddress() {}
+
+float g_a = 0, g_b = 0;
+float fa() { return g_a; }
+float fb() { return g_b; }
+
+int main(int argc, char** argv) {
+    int cycles = argc > 1 ? atoi(argv[1]) : 300;
+    g_srvPort = argc > 2 ? atoi(argv[2]) : 18080;
+    double outage = argc > 3 ? atof(argv[3]) : 0.2;
+    uint32_t drainBytes = argc > 4 ? atol(argv[4]) : 4000;
+    srand(4321);
+    Variable* vars[] = {new Variable(fa, 2, "a", "u", "A", "12345678-abcd-1234-ef00-1234567890ab"),
+                        new Variable(fb, 0, "b", "u", "B", "12345678-abcd-1234-ef00-1234567890ac")};
+    StaticVariableArray<2> va(vars);
+    Logger lg("X", 5, &va);
+    lg.setSDCardSS(1);
+    lg.setLoggerTimeZone(-5);
+    SocketClient c1, c2;
+    EnviroDIYPublisher p1(lg, &c1, "token-one", "12345678-abcd-1234-ef00-1234567890ff");
+    EnviroDIYPublisher p2(lg, &c2, "token-two", "12345678-abcd-1234-ef00-1234567890ff");
+    lg.setPublishQueue(true, 600, drainBytes);
+    lg.begin();
+    FILE* expect = fopen("queue_expect.txt", "w");
+    unsigned long offline = 0, maxQueue = 0;
+    remove("portal.calm");
+    auto queued = [&]() -> unsigned long {
+        return disk.count(MS_PUBLISH_QUEUE_FILE_NAME) ? (disk[MS_PUBLISH_QUEUE_FILE_NAME].size() - 8) / (8 + 2 * MS_VALUE_STRING_LENGTH) : 0;
+    };
+    int cycle = 0;
+    for (; cycle < cycles || (queued() > 0 && cycle < cycles + 3000); cycle++) {
+        if (cycle == cycles - 40) fclose(fopen("portal.calm", "w"));
+        g_rtc += 300; Logger::resetClockCache();
+        lg.markTime();
+        g_a = (rand() % 10000) / 100.0f; g_b = cycle;
+        va.completeUpdate();
+        fprintf(expect, "%s %s %s\n", Logger::getMarkedISO8601(), lg.getValueCharsAtI(0), lg.getValueCharsAtI(1));
+        // The last stretch is always online, so the queue should empty
+        if (cycle < cycles - 40 && rand() < outage * RAND_MAX) {
+            offline++;
+            lg.queueDataForRemotes();
+        } else {
+            lg.publishDataToRemotes();
+        }
+        if (disk.count(MS_PUBLISH_QUEUE_FILE_NAME)) {
+            unsigned long len = (disk[MS_PUBLISH_QUEUE_FILE_NAME].size() - 8) / (8 + 2 * MS_VALUE_STRING_LENGTH);
+            if (len > maxQueue) maxQueue = len;
+        }
+    }
+    fclose(expect);
+    unsigned long left = queued(); cycles = cycle;
+    fprintf(stderr, "RESULT cycles %d offline %lu longest queue %lu records left %lu connections %lu/%lu bytes %lu\n",
+            cycles, offline, maxQueue, left, c1.connects, c2.connects, (unsigned long)dataPublisher::getTxByteCount());
+    return 0;
+}
@@ -0,0 +1,204 @@
+// Host benchmark for building EnviroDIY and DreamHost requests.
+//
+// Times each publisher's publishData() against a client that takes
+// everything and always answers "201 Created", for 5, 10 and 20 variables,
+// and prints the microseconds, processor cycles and request bytes per post.
+// The debugging echo of each request goes to stdout, which the run script
+// throws away.  The times are for this computer, not a logger; only the
+// ratios mean anything.  Cycles are read from the time stamp counter, so
+// they are only printed on x86.
+//
+// Built with COUNT_STRING_BYTES and -fno-builtin, as run_publish_requests.sh
+// does the second time, the C string and memory routines below replace the
+// C library's.  They go a byte at a time as on AVR and count the bytes they
+// scan for a terminator and the bytes they copy.
+//
+// usage: publish_requests [posts]
+// Run it with run_publish_requests.sh rather than by hand.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include "publishers/EnviroDIYPublisher.h"
+#include "publishers/DreamHostPublisher.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER
+#endif
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+// ---------------- counted string routines ----------------
+unsigned long long g_scanned = 0, g_copied = 0;
+#ifdef COUNT_STRING_BYTES
+extern "C" {
+size_t strlen(const char* s) {
+    const char* p = s;
+    while (*p) p++;
+    g_scanned += p - s + 1;
+    return p - s;
+}
+char* strcpy(char* d, const char* s) {
+    char* r = d;
+    while ((*d++ = *s++)) g_copied++;
+    g_copied++;
+    return r;
+}
+char* strcat(char* d, const char* s) {
+    char* r = d;
+    while (*d) {
+        d++;
+        g_scanned++;
+    }
+    while ((*d++ = *s++)) g_copied++;
+    g_copied++;
+    return r;
+}
+void* memcpy(void* d, const void* s, size_t n) {
+    char*       a = static_cast<char*>(d);
+    const char* b = static_cast<const char*>(s);
+    g_copied += n;
+    while (n--) *a++ = *b++;
+    return d;
+}
+}
+#endif
+
+// Takes everything and always answers "201 Created"
+class NullClient : public Client {
+ public:
+    const char*   reply = "HTTP/1.1 201 Created\r\nContent-Length: 0\r\n\r\n";
+    int           pos   = 0;
+    unsigned long bytes = 0;
+    int connect(IPAddress, uint16_t) override { return 0; }
+    int connect(const char*, uint16_t) override {
+        pos = 0;
+        return 1;
+    }
+    size_t write(uint8_t) override {
+        bytes++;
+        return 1;
+    }
+    size_t write(const uint8_t*, size_t n) override {
+        bytes += n;
+        return n;
+    }
+    int available() override { return strlen(reply) - pos; }
+    int read() override { return reply[pos] ? reply[pos++] : -1; }
+    int read(uint8_t* b, size_t n) override {
+        size_t i = 0;
+        while (i < n && reply[pos]) b[i++] = reply[pos++];
+        return i;
+    }
+    int     peek() override { return reply[pos] ? reply[pos] : -1; }
+    void    flush() override {}
+    void    stop() override {}
+    uint8_t connected() override { return 1; }
+    operator bool() override { return true; }
+};
+IPAddress::IPAddress() {}
+
+float g_values[20];
+template <int K>
+float value() {
+    return g_values[K];
+}
+float (*const valueFxns[20])() = {
+    value<0>,  value<1>,  value<2>,  value<3>,  value<4>,
+    value<5>,  value<6>,  value<7>,  value<8>,  value<9>,
+    value<10>, value<11>, value<12>, value<13>, value<14>,
+    value<15>, value<16>, value<17>, value<18>, value<19>};
+
+uint64_t cycles() {
+#ifdef HAVE_CYCLE_COUNTER
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Posts the same record over and over and prints the cost of each post
+void timePosts(bool toDreamHost, uint8_t nVars, int posts) {
+    static char uuids[20][37];
+    Variable*   vars[20];
+    for (uint8_t i = 0; i < nVars; i++) {
+        snprintf(uuids[i], sizeof(uuids[i]),
+                 "12345678-abcd-1234-ef00-1234567890%02u", i);
+        vars[i]     = new Variable(valueFxns[i], 3, "v", "u", "V", uuids[i]);
+        g_values[i] = 1234.567f / (i + 1);
+    }
+    // Keep the formatted values, as a logger's variable array does
+    VariableArray va(nVars, vars);
+    static char   valueSlots[20][MS_VALUE_STRING_LENGTH];
+    va.setValueStringBuffer(valueSlots, nVars);
+    Logger lg("REQ", 5, &va);
+    lg.setLoggerTimeZone(-5);
+    NullClient         client;
+    EnviroDIYPublisher enviroDIY(lg, &client,
+                                 "12345678-abcd-1234-ef00-1234567890ee",
+                                 "12345678-abcd-1234-ef00-1234567890ff");
+    DreamHostPublisher dreamHost(
+        lg, &client, "http://data.example.org/portalRX_dreamhost.php");
+    dataPublisher* publisher = toDreamHost
+        ? static_cast<dataPublisher*>(&dreamHost)
+        : static_cast<dataPublisher*>(&enviroDIY);
+    g_rtc = 1600000000UL;
+    Logger::resetClockCache();
+    lg.markTime();
+    va.completeUpdate();
+    // The first post works out the fixed length of the EnviroDIY JSON
+    publisher->publishData(&client);
+
+    unsigned long      bytes0   = client.bytes;
+    unsigned long long scanned0 = g_scanned, copied0 = g_copied;
+    auto               start    = std::chrono::steady_clock::now();
+    uint64_t           cycles0  = cycles();
+    for (int p = 0; p < posts; p++) publisher->publishData(&client);
+    uint64_t cycles1 = cycles();
+    auto     end     = std::chrono::steady_clock::now();
+    fprintf(stderr, "  %-9s %2u variables  %7.2f us",
+            toDreamHost ? "DreamHost" : "EnviroDIY", nVars,
+            std::chrono::duration<double, std::micro>(end - start).count() /
+                posts);
+#ifdef HAVE_CYCLE_COUNTER
+    fprintf(stderr, "  %7.0f cycles", (double)(cycles1 - cycles0) / posts);
+#else
+    (void)cycles0;
+    (void)cycles1;
+#endif
+    fprintf(stderr, "  %5lu request bytes", (client.bytes - bytes0) / posts);
+#ifdef COUNT_STRING_BYTES
+    fprintf(stderr, "  %6llu bytes scanned  %6llu bytes copied",
+            (g_scanned - scanned0) / posts, (g_copied - copied0) / posts);
+#else
+    (void)scanned0;
+    (void)copied0;
+#endif
+    fprintf(stderr, "\n");
+    for (uint8_t i = 0; i < nVars; i++) delete vars[i];
+}
+
+int main(int argc, char** argv) {
+    int posts = argc > 1 ? atoi(argv[1]) : 20000;
+#ifdef COUNT_STRING_BYTES
+    fprintf(stderr, "Posts with byte-at-a-time string routines:\n");
+#else
+    fprintf(stderr, "Posts with the C library's string routines:\n");
+#endif
+    const uint8_t counts[] = {5, 10, 20};
+    for (uint8_t n : counts) timePosts(false, n, posts);
+    for (uint8_t n : counts) timePosts(true, n, posts);
+    return 0;
+}
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Builds averaging_modes.cpp and runs it.  The times are for the host
+# computer, so only compare them with each other; an 8-bit logger is much
+# slower.
+#
+# usage: run_averaging_modes.sh [updates]
+HERE=$(cd "$(dirname "$0")" && pwd)
+UPDATES=${1:-2000}
+sh "$HERE/build.sh" "$HERE/averaging_modes.cpp" ./averaging_modes || exit 1
+./averaging_modes "$UPDATES" > /dev/null
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Builds block_writes.cpp and runs it.  The in-memory card counts the blocks
+# SdFat's one-block cache would write, so the counts depend on that model, not
+# on any particular card's own write buffering.
+#
+# usage: run_block_writes.sh [records]
+HERE=$(cd "$(dirname "$0")" && pwd)
+RECORDS=${1:-96}
+sh "$HERE/build.sh" "$HERE/block_writes.cpp" ./block_writes || exit 1
+./block_writes "$RECORDS" > /dev/null
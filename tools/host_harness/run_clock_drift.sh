@@ -0,0 +1,8 @@
+#!/bin/sh
+# Builds clock_drift.cpp and runs it.
+#
+# usage: run_clock_drift.sh [days]
+HERE=$(cd "$(dirname "$0")" && pwd)
+DAYS=${1:-365}
+sh "$HERE/build.sh" "$HERE/clock_drift.cpp" ./clock_drift || exit 1
+./clock_drift "$DAYS" > /dev/null
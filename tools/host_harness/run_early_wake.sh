@@ -0,0 +1,11 @@
+#!/bin/sh
+# Builds early_wake.cpp with the TinyGSM stand-in in tinygsm_time/ and runs it.
+#
+# usage: run_early_wake.sh [cycles] [seed]
+HERE=$(cd "$(dirname "$0")" && pwd)
+CYCLES=${1:-288}
+SEED=${2:-1}
+sh "$HERE/build.sh" "$HERE/early_wake.cpp" ./early_wake \
+    -I"$HERE/tinygsm_time" "$HERE/../../src/modems/SIMComSIM7000.cpp" ||
+    exit 1
+./early_wake "$CYCLES" "$SEED" > /dev/null
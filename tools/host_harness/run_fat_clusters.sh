@@ -0,0 +1,8 @@
+#!/bin/sh
+# Builds fat_clusters.cpp and runs it.
+#
+# usage: run_fat_clusters.sh [days]
+HERE=$(cd "$(dirname "$0")" && pwd)
+DAYS=${1:-31}
+sh "$HERE/build.sh" "$HERE/fat_clusters.cpp" ./fat_clusters || exit 1
+./fat_clusters "$DAYS" > /dev/null
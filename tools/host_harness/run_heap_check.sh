@@ -0,0 +1,13 @@
+#!/bin/sh
+# Builds heap_check.cpp and runs it.  It exits non-zero if the library used the
+# heap during any logging cycle after the first, and prints where the first few
+# allocations came from.
+#
+# usage: run_heap_check.sh [cycles]
+HERE=$(cd "$(dirname "$0")" && pwd)
+CYCLES=${1:-24}
+sh "$HERE/build.sh" "$HERE/heap_check.cpp" ./heap_check -rdynamic || exit 1
+./heap_check "$CYCLES" > /dev/null 2> heap_check.log
+RESULT=$?
+c++filt < heap_check.log
+exit $RESULT
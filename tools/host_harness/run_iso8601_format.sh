@@ -0,0 +1,9 @@
+#!/bin/sh
+# Builds iso8601_format.cpp and runs it.  The times are for this computer and
+# the harness's -O1 build; compare them with each other, not with a logger.
+#
+# usage: run_iso8601_format.sh [calls]
+HERE=$(cd "$(dirname "$0")" && pwd)
+CALLS=${1:-2000000}
+sh "$HERE/build.sh" "$HERE/iso8601_format.cpp" ./iso8601_format || exit 1
+./iso8601_format "$CALLS" > /dev/null
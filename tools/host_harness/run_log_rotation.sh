@@ -0,0 +1,8 @@
+#!/bin/sh
+# Builds log_rotation.cpp and runs it.
+#
+# usage: run_log_rotation.sh [days]
+HERE=$(cd "$(dirname "$0")" && pwd)
+DAYS=${1:-3}
+sh "$HERE/build.sh" "$HERE/log_rotation.cpp" ./log_rotation || exit 1
+./log_rotation "$DAYS" > /dev/null
@@ -0,0 +1,8 @@
+#!/bin/sh
+# Builds power_cuts.cpp and runs it.
+#
+# usage: run_power_cuts.sh [trials] [norecover]
+HERE=$(cd "$(dirname "$0")" && pwd)
+TRIALS=${1:-400}
+sh "$HERE/build.sh" "$HERE/power_cuts.cpp" ./power_cuts || exit 1
+./power_cuts "$TRIALS" $2 > /dev/null
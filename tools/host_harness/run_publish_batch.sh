@@ -0,0 +1,26 @@
+#!/bin/sh
+# Builds publish_batch.cpp, runs it against fake_portal.py, and checks that
+# every record reached both publishers.  Files are written to the working
+# directory.  fake_portal.py prints how many connections were opened, how many
+# requests reused one, and how many were pipelined.
+#
+# usage: run_publish_batch.sh [fail share] [send every X] [offline share]
+#        [drain bytes] [cycles] [port]
+# e.g.   run_publish_batch.sh 0 6
+HERE=$(cd "$(dirname "$0")" && pwd)
+FAIL=${1:-0}
+EVERY=${2:-6}
+OFFLINE=${3:-0}
+BYTES=${4:-0}
+CYCLES=${5:-288}
+PORT=${6:-18081}
+sh "$HERE/build.sh" "$HERE/publish_batch.cpp" ./publish_batch || exit 1
+python3 "$HERE/fake_portal.py" "$PORT" "$FAIL" portal.log 7 > /dev/null 2> portal.err &
+PORTAL=$!
+sleep 1
+./publish_batch "$CYCLES" "$PORT" "$OFFLINE" "$BYTES" "$EVERY" 0 1 > /dev/null 2> run.out
+grep -E "RESULT|FINAL" run.out
+kill $PORTAL
+wait $PORTAL 2> /dev/null
+cat portal.err
+python3 "$HERE/check_queue.py" queue_expect.txt portal.log token-one,dreamhost
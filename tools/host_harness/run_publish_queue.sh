@@ -0,0 +1,24 @@
+#!/bin/sh
+# Builds publish_queue.cpp, runs it against fake_portal.py, and checks that
+# every record reached both publishers.  Files are written to the working
+# directory.
+#
+# usage: run_publish_queue.sh [fail share] [offline share] [drain bytes]
+#        [cycles] [port]
+# e.g.   run_publish_queue.sh 0.3 0.2 4000
+HERE=$(cd "$(dirname "$0")" && pwd)
+FAIL=${1:-0.3}
+OFFLINE=${2:-0.2}
+BYTES=${3:-4000}
+CYCLES=${4:-300}
+PORT=${5:-18080}
+sh "$HERE/build.sh" "$HERE/publish_queue.cpp" ./publish_queue || exit 1
+python3 "$HERE/fake_portal.py" "$PORT" "$FAIL" portal.log 7 > /dev/null 2> portal.err &
+PORTAL=$!
+sleep 1
+./publish_queue "$CYCLES" "$PORT" "$OFFLINE" "$BYTES" > /dev/null 2> run.out
+grep RESULT run.out
+kill $PORTAL
+wait $PORTAL 2> /dev/null
+cat portal.err
+python3 "$HERE/check_queue.py" queue_expect.txt portal.log token-one,token-two
@@ -0,0 +1,13 @@
+#!/bin/sh
+# Builds publish_requests.cpp twice and runs it: with the C library's string
+# routines, then with the counted byte-at-a-time ones.
+#
+# usage: run_publish_requests.sh [posts]
+HERE=$(cd "$(dirname "$0")" && pwd)
+POSTS=${1:-20000}
+sh "$HERE/build.sh" "$HERE/publish_requests.cpp" ./publish_requests || exit 1
+sh "$HERE/build.sh" "$HERE/publish_requests.cpp" ./publish_requests_counted \
+    -DCOUNT_STRING_BYTES -fno-builtin -fno-tree-loop-distribute-patterns ||
+    exit 1
+./publish_requests "$POSTS" > /dev/null || exit 1
+./publish_requests_counted "$POSTS" > /dev/null
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Builds time_sources.cpp and runs it against fake_ntp.py.  Files are written
+# to the working directory.
+#
+# usage: run_time_sources.sh [port]
+HERE=$(cd "$(dirname "$0")" && pwd)
+PORT=${1:-18123}
+sh "$HERE/build.sh" "$HERE/time_sources.cpp" ./time_sources \
+    -I"$HERE/tinygsm_time" "$HERE/../../src/modems/SIMComSIM7000.cpp" ||
+    exit 1
+python3 "$HERE/fake_ntp.py" "$PORT" > /dev/null 2> ntp.err &
+NTP=$!
+sleep 1
+./time_sources "$PORT" 2> /dev/null
+RESULT=$?
+kill $NTP
+exit $RESULT
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Builds update_timing.cpp and runs it.  The simulated millis() moves on one
+# millisecond for every 100 calls, so the "active" time counts how often the
+# clock is read while the update runs, not real processor time.
+#
+# usage: run_update_timing.sh [updates]
+HERE=$(cd "$(dirname "$0")" && pwd)
+UPDATES=${1:-10}
+sh "$HERE/build.sh" "$HERE/update_timing.cpp" ./update_timing || exit 1
+./update_timing "$UPDATES" > /dev/null
@@ -0,0 +1,175 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+typedef uint8_t byte;
+typedef bool boolean;
+#define F(x) x
+#define PROGMEM
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define RISING 3
+#define FALLING 2
+#define DEC 10
+#define HEX 16
+#define BIN 2
+typedef const char __FlashStringHelper;
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+int analogRead(uint8_t);
+void analogReference(uint8_t);
+void yield();
+void noInterrupts();
+void interrupts();
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(a,l,h) ((a)<(l)?(l):((a)>(h)?(h):(a)))
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+char* dtostrf(double, signed char, unsigned char, char*);
+char* ltoa(long, char*, int);
+char* itoa(int, char*, int);
+char* ultoa(unsigned long, char*, int);
+class String {
+ public:
+  String(const char* s = "");
+  String(const String&);
+  String(char);
+  String(int, unsigned char base = 10);
+  String(unsigned int, unsigned char base = 10);
+  String(long, unsigned char base = 10);
+  String(unsigned long, unsigned char base = 10);
+  String(float, unsigned char decimalPlaces = 2);
+  String(double, unsigned char decimalPlaces = 2);
+  ~String();
+  String& operator=(const String&);
+  String& operator=(const char*);
+  unsigned int length() const;
+  const char* c_str() const;
+  String substring(unsigned int, unsigned int) const;
+  String substring(unsigned int) const;
+  int indexOf(char) const;
+  int indexOf(const String&) const;
+  long toInt() const;
+  float toFloat() const;
+  void trim();
+  bool reserve(unsigned int);
+  bool concat(const String&);
+  char charAt(unsigned int) const;
+  char operator[](unsigned int) const;
+  char& operator[](unsigned int);
+  bool equals(const String&) const;
+  bool operator==(const String&) const;
+  bool operator!=(const String&) const;
+  bool operator==(const char*) const;
+  bool operator!=(const char*) const;
+  String& operator+=(const String&);
+  String& operator+=(const char*);
+  String& operator+=(char);
+  String& operator+=(int);
+  String& operator+=(long);
+  String& operator+=(unsigned long);
+  String& operator+=(unsigned int);
+  void toCharArray(char*, unsigned int, unsigned int idx = 0) const;
+  void getBytes(unsigned char*, unsigned int, unsigned int idx = 0) const;
+  void replace(const String&, const String&);
+  bool startsWith(const String&) const;
+  bool endsWith(const String&) const;
+  void toUpperCase();
+  void toLowerCase();
+  void remove(unsigned int, unsigned int);
+};
+String operator+(const String&, const String&);
+String operator+(const String&, const char*);
+String operator+(const char*, const String&);
+String operator+(const String&, char);
+String operator+(const String&, int);
+String operator+(const String&, long);
+String operator+(const String&, unsigned long);
+String operator+(const String&, unsigned int);
+String operator+(const String&, float);
+String operator+(const String&, double);
+class Print {
+ public:
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* buf, size_t size);
+  size_t write(const char* s);
+  size_t write(const char* b, size_t n) { return write((const uint8_t*)b, n); }
+  virtual void flush() {}
+  virtual int availableForWrite() { return 0; }
+  size_t print(const String&);
+  size_t print(const char*);
+  size_t print(char);
+  size_t print(unsigned char, int = DEC);
+  size_t print(int, int = DEC);
+  size_t print(unsigned int, int = DEC);
+  size_t print(long, int = DEC);
+  size_t print(unsigned long, int = DEC);
+  size_t print(double, int = 2);
+  size_t println(const String&);
+  size_t println(const char*);
+  size_t println(char);
+  size_t println(unsigned char, int = DEC);
+  size_t println(int, int = DEC);
+  size_t println(unsigned int, int = DEC);
+  size_t println(long, int = DEC);
+  size_t println(unsigned long, int = DEC);
+  size_t println(double, int = 2);
+  size_t println();
+  virtual ~Print() {}
+};
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long);
+  bool find(const char*);
+  long parseInt();
+  float parseFloat();
+  size_t readBytes(char*, size_t);
+  size_t readBytes(uint8_t*, size_t);
+  size_t readBytesUntil(char, char*, size_t);
+  String readString();
+  String readStringUntil(char);
+};
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long);
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override;
+  using Print::write;
+  operator bool();
+};
+extern HardwareSerial Serial;
+typedef void (*voidFuncPtr)(void);
+#define NOT_AN_INTERRUPT -1
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t, voidFuncPtr, int);
+void detachInterrupt(uint8_t);
+#define SDA 20
+#define SCL 21
+#define SS 10
+#define A0 14
+#define LED_BUILTIN 13
+#undef abs
+#define abs(x) ((x)>0?(x):-(x))
+#define digitalPinToBitMask(p) (1)
+#define digitalPinToPort(p) (0)
+extern volatile uint8_t* portInputRegister(int);
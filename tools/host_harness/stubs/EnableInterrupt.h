@@ -0,0 +1,4 @@
+#pragma once
+#include <Arduino.h>
+void enableInterrupt(uint8_t, void(*)(), uint8_t);
+void disableInterrupt(uint8_t);
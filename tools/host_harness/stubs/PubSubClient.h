@@ -0,0 +1,3 @@
+#pragma once
+#include <Client.h>
+class PubSubClient { public: PubSubClient(); PubSubClient(Client&); void setServer(const char*, uint16_t); void setClient(Client&); bool connect(const char*); bool connect(const char*, const char*, const char*); bool publish(const char*, const char*); bool publish(const char*, const char*, bool); void disconnect(); int state(); bool connected();};
@@ -0,0 +1,3 @@
+#pragma once
+#include <Arduino.h>
+class RTCZero { public: void begin(bool=false); uint32_t getEpoch(); void setEpoch(uint32_t); void setAlarmSeconds(uint8_t); void enableAlarm(int); void disableAlarm(); void attachInterrupt(void(*)()); void detachInterrupt(); void standbyMode(); enum {MATCH_SS}; };
@@ -0,0 +1,6 @@
+#pragma once
+#include <Arduino.h>
+class SDI12 : public Stream {
+ public:
+  SDI12(int8_t p=-1); void begin(); void end(); void setDataPin(int8_t); int available() override; int read() override; int peek() override; size_t write(uint8_t) override; void clearBuffer(); void sendCommand(String&); void sendCommand(const char*); bool setActive(); bool isActive(); void forceListen(); void forceHold(); uint8_t getDataPin(); void setTimeoutValue(int16_t); static void handleInterrupt();
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#define O_READ 0x01
+#define O_RDONLY 0x00
+#define O_WRITE 0x02
+#define O_WRONLY 0x01
+#define O_RDWR 0x02
+#define O_AT_END 0x04
+#define O_APPEND 0x08
+#define O_CREAT 0x10
+#define O_EXCL 0x20
+#define O_TRUNC 0x40
+#define T_ACCESS 1
+#define T_CREATE 2
+#define T_WRITE 4
+#define SPI_FULL_SPEED 4
+#define SD_SCK_MHZ(x) (x)
+#define FILE_WRITE (O_RDWR|O_CREAT|O_AT_END)
+#define FILE_READ O_READ
+class File : public Stream {
+ public:
+  File();
+  bool open(const char*, uint8_t mode = O_READ);
+  bool open(const char*, int mode);
+  bool close();
+  bool sync();
+  bool timestamp(uint8_t, uint16_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t);
+  bool isOpen() const;
+  bool seekSet(uint32_t);
+  bool seekEnd(int32_t off = 0);
+  bool seek(uint32_t);
+  uint32_t fileSize() const;
+  uint32_t size() const;
+  uint32_t curPosition() const;
+  uint32_t position() const;
+  bool preAllocate(uint32_t);
+  bool truncate(uint32_t);
+  bool truncate();
+  bool contiguousRange(uint32_t*, uint32_t*);
+  bool createContiguous(const char*, uint32_t);
+  int read(void*, size_t);
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override;
+  size_t write(const uint8_t*, size_t) override;
+  using Print::write;
+  bool getName(char*, size_t);
+  bool isDir() const;
+  bool remove();
+  bool rename(const char*);
+  File openNextFile(uint8_t mode = O_READ);
+  bool openNext(File*, uint8_t mode = O_READ);
+  void rewind();
+  operator bool();
+  int _id = -1; uint32_t _pos = 0;
+};
+class SdSpiCard { public: bool erase(uint32_t, uint32_t); };
+class SdFat { public: SdSpiCard* card(); bool begin(uint8_t, uint32_t); bool exists(const char*); bool remove(const char*); bool rename(const char*, const char*); bool mkdir(const char*); File open(const char*, uint8_t mode = O_READ); uint32_t freeClusterCount(); uint8_t sectorsPerCluster(); bool chdir(bool set = false);};
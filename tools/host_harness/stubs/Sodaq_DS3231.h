@@ -0,0 +1,17 @@
+#pragma once
+#include <Arduino.h>
+#include <time.h>
+class DateTime {
+ public:
+  DateTime(long t = 0);
+  DateTime(uint16_t year, uint8_t month, uint8_t date, uint8_t hour, uint8_t min, uint8_t sec, uint8_t wday = 0);
+  uint16_t year() const; uint8_t month() const; uint8_t date() const; uint8_t hour() const; uint8_t minute() const; uint8_t second() const; uint8_t dayOfWeek() const;
+  long get() const;
+  uint32_t getEpoch() const;
+  void addToString(String&) const;
+  long _t;
+  struct tm _tm;  // the fields, worked out once as the real class does
+};
+class Sodaq_DS3231 { public: void begin(); DateTime now(); void setEpoch(uint32_t); void setDateTime(const DateTime&); void enableInterrupts(uint8_t); void disableInterrupts(); void clearINTStatus(); float getTemperature(); void convertTemperature(); };
+extern Sodaq_DS3231 rtc;
+#define EveryMinute 0x01
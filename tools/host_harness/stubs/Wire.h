@@ -0,0 +1,4 @@
+#pragma once
+#include <Arduino.h>
+class TwoWire : public Stream { public: void begin(); void setClock(uint32_t); void end(); void beginTransmission(uint8_t); uint8_t endTransmission(bool=true); uint8_t requestFrom(uint8_t, uint8_t); int available() override; int read() override; int peek() override; size_t write(uint8_t) override; using Print::write;};
+extern TwoWire Wire;
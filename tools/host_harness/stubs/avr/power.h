@@ -0,0 +1,2 @@
+#pragma once
+void power_all_disable(); void power_all_enable(); void power_usart0_enable();
@@ -0,0 +1,11 @@
+#pragma once
+#include <stdint.h>
+#define SLEEP_MODE_PWR_DOWN 2
+void set_sleep_mode(int); void sleep_enable(); void sleep_disable(); void sleep_cpu(); void sleep_bod_disable();
+extern volatile uint8_t ADCSRA; extern volatile uint8_t MCUCR;
+#define ADEN 7
+#define BODS 6
+#define BODSE 5
+#define _BV(b) (1 << (b))
+#define SLEEP_MODE_IDLE 0
+void sleep_mode();
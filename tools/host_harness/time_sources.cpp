@@ -0,0 +1,112 @@
+// Host driver for loggerModem::getUTCTime() on the SIM7000 class.
+//
+// The TinyGSM stand-in in tinygsm_time/ keeps a module clock, sets it from
+// the network (NITZ) when asked, and runs an SNTP client that sends real UDP
+// requests to fake_ntp.py.  Each case checks which time source was used and
+// how far the time was off.  parseNetworkTime() is also checked against
+// timegm() on random dates and offsets.
+//
+// usage: time_sources [NTP port]
+// Run it with run_time_sources.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <map>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#include <vector>
+#include <Arduino.h>
+#include <Client.h>
+#include <ctime>
+#include <cstring>
+#include <vector>
+#define protected public
+#include "modems/SIMComSIM7000.h"
+#undef protected
+#include "LoggerBase.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+IPAddress::IPAddress() {}
+
+unsigned long g_regDone = 0, g_regDelay = 5000, g_epochNow = 0;
+bool  g_nitz = false, g_clockSet = false, g_nistUp = true;
+float g_netTz = 0, g_clockTz = 0;
+long  g_clockOff = 0;
+int   g_ntpPort = 18123;
+extern unsigned long g_millis;
+
+static int failures = 0;
+static void mode(const char* m) { FILE* f = fopen("ntp.mode", "w"); fputs(m, f); fclose(f); }
+static const char* names[] = {"network", "sntp", "rfc868", "none"};
+
+static void run(SIMComSIM7000& modem, const char* what, modemTimeSource expect, long expectErr) {
+    g_epochNow = time(NULL);
+    uint32_t t = modem.getUTCTime();
+    modemTimeSource src = modem.getLastTimeSource();
+    long err = t ? (long)t - (long)g_epochNow : 0;
+    bool ok = src == expect && (t == 0) == (expect == MODEM_TIME_NONE) &&
+        labs(err - expectErr) <= 1;
+    if (!ok) failures++;
+    printf("%-34s source %-7s error %+4ld s  ", what, names[src], err);
+    for (int s = 0; s < MODEM_TIME_NONE; s++)
+        printf(" %s %lu ms/%ld", names[s], (unsigned long)modem.getTimeSourceLatency((modemTimeSource)s),
+               (long)modem.getTimeSourceAccuracy((modemTimeSource)s));
+    printf("  %s\n", ok ? "ok" : "FAIL");
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) g_ntpPort = atoi(argv[1]);
+    // parseNetworkTime against timegm over random dates and offsets
+    srand(7);
+    for (int i = 0; i < 200000; i++) {
+        time_t utc = 1546300800 + (time_t)(((unsigned long)rand() << 8 ^ rand()) % (1893456000UL - 1546300800UL - 200000));
+        float tz = (rand() % 105 - 48) / 4.0f;  // -12:00 to +14:00 in quarter hours
+        time_t local = utc + (time_t)(tz * 3600);
+        struct tm lt; gmtime_r(&local, &lt);
+        uint32_t got = loggerModem::parseNetworkTime(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday,
+                                                     lt.tm_hour, lt.tm_min, lt.tm_sec, tz);
+        if (got != (uint32_t)utc) {
+            if (failures++ < 5) printf("parse %ld tz %.2f gave %lu\n", (long)utc, tz, (unsigned long)got);
+        }
+    }
+    if (loggerModem::parseNetworkTime(1980, 1, 6, 0, 0, 5, 0) != 0) failures++;
+    if (loggerModem::parseNetworkTime(2004, 1, 1, 0, 0, 5, 0) != 0) failures++;
+    printf("parseNetworkTime: %s\n", failures ? "FAIL" : "ok");
+
+    SIMComSIM7000 modem(&Serial, 10, -1, -1, -1, "apn");
+    modem.modemWake();
+    modem.connectInternet(60000L);
+
+    // A carrier that sends NITZ with local time at UTC-5
+    g_nitz = true; g_netTz = -5; g_clockSet = false;
+    modem.isInternetAvailable(); modem.connectInternet(60000L);
+    run(modem, "NITZ at UTC-5", MODEM_TIME_NETWORK, 0);
+    g_netTz = 5.75; g_clockSet = false; modem.connectInternet(60000L);
+    run(modem, "NITZ at UTC+5:45", MODEM_TIME_NETWORK, 0);
+
+    // No NITZ: the module's own SNTP client against the stand-in
+    g_nitz = false; g_clockSet = false; mode("ok");
+    run(modem, "no NITZ, SNTP server answers", MODEM_TIME_SNTP, 0);
+    g_clockSet = false; mode("skew 7");
+    run(modem, "no NITZ, SNTP server 7 s ahead", MODEM_TIME_SNTP, 7);
+    g_clockSet = false; mode("kod");
+    run(modem, "no NITZ, SNTP kiss-o'-death", MODEM_TIME_RFC868, 0);
+    g_clockSet = false; mode("drop");
+    run(modem, "no NITZ, SNTP server silent", MODEM_TIME_RFC868, 0);
+    g_clockSet = false; g_nistUp = false;
+    run(modem, "nothing answers", MODEM_TIME_NONE, 0);
+    g_nistUp = true; mode("ok");
+    printf("%s\n", failures ? "FAILED" : "all ok");
+    return failures != 0;
+}
@@ -0,0 +1,138 @@
+// TinyGSM stand-in with a module clock, NITZ and an SNTP client that really
+// queries a UDP server, for time_sources.cpp
+// Every call blocks for about as long as the AT exchange on a real module.
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+#define TINY_GSM_MODEM_HAS_GPRS
+#define TINY_GSM_MODEM_HAS_TIME
+#define TINY_GSM_MODEM_HAS_NTP
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <ctime>
+#define GF(x) x
+#define GFP(x) x
+#define GSM_OK "OK"
+#define GSM_NL "\r\n"
+extern unsigned long g_millis;
+extern unsigned long g_regDone;  // when the module finishes registering
+extern unsigned long g_regDelay; // how long it takes after booting
+extern unsigned long g_epochNow;
+extern bool  g_nitz;       // whether the network sends its time
+extern float g_netTz;      // the local offset the network reports
+extern long  g_clockOff;   // module clock minus true time; unset if g_clockSet false
+extern bool  g_clockSet;
+extern float g_clockTz;
+extern int   g_ntpPort;
+extern bool  g_nistUp;
+class TinyGsm {
+ public:
+    explicit TinyGsm(Stream& s) : stream(s) {}
+    Stream& stream;
+    bool testAT(uint32_t t = 10000) {  // boot, then search on its own
+        delay(2500);
+        if (g_regDone == 0) g_regDone = g_millis + g_regDelay;
+        return true;
+    }
+    bool init(const char* pin = NULL) { delay(600); return true; }
+    bool begin(const char* pin = NULL) { return init(); }
+    void streamClear() {}
+    template <typename... A> void sendAT(A...) { delay(5); }
+    template <typename... A> int8_t waitResponse(A...) { delay(20); return 1; }
+    bool isNetworkConnected() {
+        delay(40);
+        bool reg = g_millis >= g_regDone;
+        if (reg && g_nitz && !g_clockSet) {  // NITZ arrives with registration
+            g_clockSet = true; g_clockOff = 0; g_clockTz = g_netTz;
+        }
+        return reg;
+    }
+    bool getNetworkTime(int* y, int* mo, int* d, int* h, int* mi, int* s, float* tz) {
+        delay(35);  // AT+CCLK?
+        if (!g_clockSet) {  // "80/01/06,00:00:xx+00"
+            *y = 1980; *mo = 1; *d = 6; *h = 0; *mi = 0; *s = 0; *tz = 0;
+            return true;
+        }
+        time_t local = (time_t)(g_epochNow + g_clockOff + (long)(g_clockTz * 3600));
+        struct tm t; gmtime_r(&local, &t);
+        *y = t.tm_year + 1900; *mo = t.tm_mon + 1; *d = t.tm_mday;
+        *h = t.tm_hour; *mi = t.tm_min; *s = t.tm_sec; *tz = g_clockTz;
+        return true;
+    }
+    // Like +CNTP: the module sends the request and sets its clock
+    byte NTPServerSync(String server = "pool.ntp.org", byte TimeZone = 3) {
+        delay(300);
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in a{}; a.sin_family = AF_INET; a.sin_port = htons(g_ntpPort);
+        inet_pton(AF_INET, "127.0.0.1", &a.sin_addr);
+        uint8_t pkt[48] = {0};
+        pkt[0] = (0 << 6) | (4 << 3) | 3;  // LI 0, version 4, client
+        uint32_t tx = g_epochNow + 2208988800UL;
+        for (int i = 0; i < 4; i++) pkt[40 + i] = tx >> (24 - 8 * i);
+        sendto(fd, pkt, 48, 0, (sockaddr*)&a, sizeof(a));
+        pollfd p{fd, POLLIN, 0};
+        int got = poll(&p, 1, 500) > 0 ? recv(fd, pkt, 48, 0) : -1;
+        close(fd);
+        if (got < 48) { delay(10000); return 61; }  // network error after a timeout
+        delay(800);
+        uint8_t li = pkt[0] >> 6, mode = pkt[0] & 7, stratum = pkt[1];
+        bool originOk = true;
+        for (int i = 0; i < 4; i++) originOk &= pkt[24 + i] == (uint8_t)(tx >> (24 - 8 * i));
+        if (li == 3 || mode != 4 || stratum == 0 || stratum > 15 || !originOk) return 64;
+        uint32_t secs = 0;
+        for (int i = 0; i < 4; i++) secs = (secs << 8) | pkt[40 + i];
+        g_clockSet = true; g_clockTz = TimeZone / 4.0f;
+        g_clockOff = (long)(secs - 2208988800UL) - (long)g_epochNow;
+        return 1;
+    }
+    bool waitForNetwork(uint32_t t = 60000L, bool c = false) {
+        for (uint32_t start = millis(); millis() - start < t;) {
+            if (isNetworkConnected()) return true;
+            delay(250);
+        }
+        return false;
+    }
+    bool isGprsConnected() { delay(40); return true; }
+    bool gprsConnect(const char*, const char* = NULL, const char* = NULL) { delay(1500); return true; }
+    bool gprsDisconnect() { delay(600); return true; }
+    int16_t getSignalQuality() { delay(40); return 20; }
+    bool getBattStats(uint8_t& a, int8_t& b, uint16_t& c) { delay(40); a = 0; b = 80; c = 3900; return true; }
+    float getTemperature() { delay(40); return 25; }
+    String getModemName() { return "SIM7000"; }
+    String getModemInfo() { return ""; }
+    String getIMEI() { return ""; }
+    String getSimCCID() { return ""; }
+    bool poweroff() { delay(300); g_regDone = 0; return true; }
+    bool sleepEnable(bool = true) { return true; }
+    bool restart() { return true; }
+    bool setNetworkMode(uint8_t) { return true; }
+    bool setPreferredMode(uint8_t) { return true; }
+};
+class TinyGsmClient : public Client {
+ public:
+    unsigned long opened = 0; int pos = 4;
+    TinyGsmClient() {}
+    explicit TinyGsmClient(TinyGsm&, uint8_t = 0) {}
+    bool init(TinyGsm*, uint8_t = 0) { return true; }
+    int connect(IPAddress, uint16_t) override { return 1; }
+    int connect(const char* h, uint16_t p) override { return connect(h, p, 75); }
+    int connect(const char*, uint16_t, int) { delay(700); if (!g_nistUp) return 0; opened = g_millis; pos = 0; return 1; }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t n) override { return n; }
+    int available() override { delay(2); return g_millis - opened > 450 ? 4 - pos : 0; }
+    int read() override { return -1; }
+    int read(uint8_t* b, size_t n) override {
+        uint32_t t = g_epochNow + 2208988800UL;
+        for (size_t i = 0; i < n && i < 4; i++) b[i] = t >> (24 - 8 * i);
+        pos = 4; return n;
+    }
+    int peek() override { return -1; }
+    void flush() override {}
+    void stop() override { delay(200); }
+    void stop(uint32_t) {}
+    uint8_t connected() override { return 0; }
+    operator bool() override { return true; }
+};
@@ -0,0 +1,88 @@
+// Host driver for the time the processor is kept busy by a sensor update.
+//
+// Runs VariableArray::completeUpdate() over a mixed set of stand-in sensors
+// with the simulated millis() and prints, per update, the time from start to
+// finish, the part of it the processor spent asleep in idleUntil(), and the
+// part it was active.  Before the updates idled between sensor deadlines they
+// polled every sensor in a loop until it was ready, so the processor was
+// active for the whole update; that is the "busy-wait" column.
+//
+// usage: update_timing [updates]
+// Run it with run_update_timing.sh rather than by hand.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+#include "LoggerBase.h"
+#include "VariableArray.h"
+#include "WatchDogs/WatchDogAVR.h"
+#include <Wire.h>
+#include <EnableInterrupt.h>
+#include <Sodaq_DS3231.h>
+#undef min
+#undef max
+
+#include "host_stubs.inc"
+
+extern unsigned long g_millis, g_slept, g_calls;
+
+// A sensor with the given warm-up, stabilization and measurement times that
+// always returns a good value
+class TimedSensor : public Sensor {
+ public:
+    int  id;
+    long results = 0;
+    TimedSensor(int sensorId, uint32_t warmUp, uint32_t stabilization,
+                uint32_t measurement, int8_t powerPin, uint8_t toAverage)
+        : Sensor("Timed", 1, warmUp, stabilization, measurement, powerPin, -1,
+                 toAverage),
+          id(sensorId) {}
+    bool addSingleMeasurementResult() override {
+        results++;
+        verifyAndAddMeasurementResult(0, (float)id);
+        _millisMeasurementRequested = 0;
+        _sensorStatus &= 0b10011111;
+        return true;
+    }
+    String getSensorLocation() override { return String(id); }
+};
+
+int main(int argc, char** argv) {
+    int updates = argc > 1 ? atoi(argv[1]) : 10;
+    // Sensors like the ones on a typical station: a slow-warming sonar, a
+    // conductivity probe, an always-powered pressure sensor averaged a few
+    // times, and a turbidity sensor on its own power pin
+    TimedSensor sonar(0, 160, 0, 166, 5, 5), ctd(1, 500, 0, 1000, 5, 3),
+        pressure(2, 0, 0, 50, -1, 4), turbidity(3, 500, 2000, 500, 6, 10);
+    Variable* vars[] = {
+        new Variable(&sonar, 0, 0, "distance", "mm", "S", ""),
+        new Variable(&ctd, 0, 1, "cond", "uS", "C", ""),
+        new Variable(&pressure, 0, 2, "pressure", "mb", "P", ""),
+        new Variable(&turbidity, 0, 1, "turbidity", "NTU", "T", "")};
+    StaticVariableArray<4> va(vars);
+    va.begin();
+
+    unsigned long wall = 0, slept = 0, calls = 0;
+    for (int u = 0; u < updates; u++) {
+        unsigned long t0 = g_millis, s0 = g_slept, c0 = g_calls;
+        va.completeUpdate();
+        wall += g_millis - t0;
+        slept += g_slept - s0;
+        calls += g_calls - c0;
+    }
+    long expected = (5 + 3 + 4 + 10) * (long)updates;
+    long got = sonar.results + ctd.results + pressure.results +
+        turbidity.results;
+    fprintf(stderr, "%d updates, %ld of %ld measurements\n", updates, got,
+            expected);
+    fprintf(stderr,
+            "per update: %.1f ms long | busy-wait: %.1f ms active | idling: "
+            "%.1f ms active, %.1f ms asleep | %.0f millis() calls\n",
+            (double)wall / updates, (double)wall / updates,
+            (double)(wall - slept) / updates, (double)slept / updates,
+            (double)calls / updates);
+    return got == expected ? 0 : 1;
+}